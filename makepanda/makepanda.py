@@ -5788,6 +5788,13 @@ if not PkgSkip("PANDATOOL"):
   TargetAdd('bam-info.exe', input=COMMON_PANDA_LIBS)
   TargetAdd('bam-info.exe', opts=['ADVAPI', 'FFTW'])
 
+  TargetAdd('bam-simplify_bamSimplify.obj', opts=OPTS, input='bamSimplify.cxx')
+  TargetAdd('bam-simplify.exe', input='bam-simplify_bamSimplify.obj')
+  TargetAdd('bam-simplify.exe', input='libp3progbase.lib')
+  TargetAdd('bam-simplify.exe', input='libp3pandatoolbase.lib')
+  TargetAdd('bam-simplify.exe', input=COMMON_PANDA_LIBS)
+  TargetAdd('bam-simplify.exe', opts=['ADVAPI', 'FFTW'])
+
   if not PkgSkip("EGG"):
     TargetAdd('bam2egg_bamToEgg.obj', opts=OPTS, input='bamToEgg.cxx')
     TargetAdd('bam2egg.exe', input='bam2egg_bamToEgg.obj')
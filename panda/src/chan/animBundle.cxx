@@ -47,6 +47,21 @@ copy_bundle() const {
   return DCAST(AnimBundle, group.p());
 }
 
+/**
+ * Returns a full copy of the bundle and its entire tree of nested AnimGroups,
+ * in which each AnimChannelMatrixXfmTable is replaced with an equivalent
+ * AnimChannelMatrixCompressed.  The compressed tables occupy much less memory,
+ * and are decoded as the animation is played.
+ *
+ * The tolerances of the compression are given by the
+ * compress-anim-*-tolerance config variables.
+ */
+PT(AnimBundle) AnimBundle::
+copy_bundle_compressed() const {
+  PT(AnimGroup) group = copy_subtree(nullptr, true);
+  return DCAST(AnimBundle, group.p());
+}
+
 /**
  * Writes a one-line description of the bundle.
  */
@@ -34,6 +34,7 @@ PUBLISHED:
   INLINE explicit AnimBundle(const std::string &name, PN_stdfloat fps, int num_frames);
 
   PT(AnimBundle) copy_bundle() const;
+  PT(AnimBundle) copy_bundle_compressed() const;
 
   INLINE double get_base_frame_rate() const;
   INLINE int get_num_frames() const;
@@ -12,6 +12,7 @@
  */
 
 #include "animBundleNode.h"
+#include "config_chan.h"
 #include "datagram.h"
 #include "datagramIterator.h"
 #include "bamReader.h"
@@ -97,6 +98,19 @@ complete_pointers(TypedWritable **p_list, BamReader* manager) {
   return pi;
 }
 
+/**
+ * Called by the BamReader to perform any final actions needed for setting up
+ * the object after all objects have been read and all pointers have been
+ * completed.  If compress-anim-tables is set, this replaces the bundle with a
+ * compressed copy.
+ */
+void AnimBundleNode::
+finalize(BamReader *) {
+  if (compress_anim_tables && _bundle != nullptr) {
+    _bundle = _bundle->copy_bundle_compressed();
+  }
+}
+
 /**
  * This function is called by the BamReader's factory when a new object of
  * this type is encountered in the Bam file.  It should create the object and
@@ -122,4 +136,8 @@ void AnimBundleNode::
 fillin(DatagramIterator &scan, BamReader* manager) {
   PandaNode::fillin(scan, manager);
   manager->read_pointer(scan);
+
+  if (compress_anim_tables) {
+    manager->register_finalize(this);
+  }
 }
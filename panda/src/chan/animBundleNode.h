@@ -53,6 +53,7 @@ public:
   virtual void write_datagram(BamWriter* manager, Datagram &me);
   virtual int complete_pointers(TypedWritable **p_list,
                                 BamReader *manager);
+  virtual void finalize(BamReader *manager);
 
 protected:
   static TypedWritable *make_from_bam(const FactoryParams &params);
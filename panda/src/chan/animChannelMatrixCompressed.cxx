@@ -0,0 +1,664 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelMatrixCompressed.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "animChannelMatrixCompressed.h"
+#include "animChannelMatrixXfmTable.h"
+#include "config_chan.h"
+
+#include "indent.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+
+#include <algorithm>
+
+
+TypeHandle AnimChannelMatrixCompressed::_type_handle;
+
+// The greatest number of frames that may separate two keys.  This bounds the
+// time spent in compress_table() for long, smooth tables.
+static const int max_key_span = 256;
+
+// The most bits that a quantized value may take.  get_bits() reads 64 bits at
+// a time, so this could be as high as 32, but at 24 bits the step is already
+// below the precision of a 32-bit float across the range of the table, so
+// more bits would gain nothing.
+static const int max_value_bits = 24;
+
+/**
+ * Returns the value at frame f between the keys (f0, q0) and (f1, q1), in
+ * quantized units.  This is used both to decode a frame and to test the
+ * candidate keys while compressing, so that the error is measured against
+ * exactly what will be decoded.
+ */
+static INLINE PN_stdfloat
+interpolate_key(int f, int f0, PN_stdfloat q0, int f1, PN_stdfloat q1) {
+  return q0 + (q1 - q0) * (PN_stdfloat)(f - f0) / (PN_stdfloat)(f1 - f0);
+}
+
+/**
+ * Used only for bam loader.
+ */
+AnimChannelMatrixCompressed::
+AnimChannelMatrixCompressed() {
+  for (int i = 0; i < num_matrix_components; i++) {
+    Track &track = _tracks[i];
+    track._base = matrix_component_defaults[i];
+    track._step = 0.0f;
+    track._first_key = 0;
+    track._first_bit = 0;
+    track._num_keys = 0;
+    track._num_frames = 0;
+    track._num_bits = 0;
+  }
+}
+
+/**
+ * Creates a new AnimChannelMatrixCompressed, just like this one, without
+ * copying any children.  The new copy is added to the indicated parent.
+ * Intended to be called by make_copy() only.
+ */
+AnimChannelMatrixCompressed::
+AnimChannelMatrixCompressed(AnimGroup *parent, const AnimChannelMatrixCompressed &copy) :
+  AnimChannelMatrix(parent, copy),
+  _key_frames(copy._key_frames),
+  _values(copy._values)
+{
+  for (int i = 0; i < num_matrix_components; i++) {
+    _tracks[i] = copy._tracks[i];
+  }
+}
+
+/**
+ * Creates a new channel with no data.  Use set_tables() to fill it in.
+ */
+AnimChannelMatrixCompressed::
+AnimChannelMatrixCompressed(AnimGroup *parent, const std::string &name) :
+  AnimChannelMatrix(parent, name)
+{
+  for (int i = 0; i < num_matrix_components; i++) {
+    Track &track = _tracks[i];
+    track._base = matrix_component_defaults[i];
+    track._step = 0.0f;
+    track._first_key = 0;
+    track._first_bit = 0;
+    track._num_keys = 0;
+    track._num_frames = 0;
+    track._num_bits = 0;
+  }
+}
+
+/**
+ *
+ */
+AnimChannelMatrixCompressed::
+~AnimChannelMatrixCompressed() {
+}
+
+/**
+ * Replaces the contents of this channel with a compressed form of the tables
+ * of the indicated channel, using the tolerances given by the
+ * compress-anim-scale-tolerance, compress-anim-hpr-tolerance and
+ * compress-anim-pos-tolerance config variables.
+ */
+void AnimChannelMatrixCompressed::
+set_tables(const AnimChannelMatrixXfmTable *source) {
+  set_tables(source, compress_anim_scale_tolerance,
+             compress_anim_hpr_tolerance, compress_anim_pos_tolerance);
+}
+
+/**
+ * Replaces the contents of this channel with a compressed form of the tables
+ * of the indicated channel.  No frame of the scale and shear, the rotation (in
+ * degrees), or the translation components will differ from the source by
+ * more than the corresponding tolerance, plus the quantization error of the
+ * keys.
+ */
+void AnimChannelMatrixCompressed::
+set_tables(const AnimChannelMatrixXfmTable *source,
+           PN_stdfloat scale_tolerance, PN_stdfloat hpr_tolerance,
+           PN_stdfloat pos_tolerance) {
+  nassertv(source != nullptr);
+
+  _key_frames.clear();
+  _values.clear();
+
+  size_t num_value_bits = 0;
+  for (int i = 0; i < num_matrix_components; i++) {
+    PN_stdfloat tolerance;
+    if (i < 6) {
+      tolerance = scale_tolerance;
+    } else if (i < 9) {
+      tolerance = hpr_tolerance;
+    } else {
+      tolerance = pos_tolerance;
+    }
+
+    CPTA_stdfloat table = source->get_table(matrix_component_letters[i]);
+    compress_table(i, table.empty() ? nullptr : &table[0], table.size(),
+                   tolerance, num_value_bits);
+  }
+
+  if (num_value_bits == 0) {
+    _values.clear();
+  }
+  _key_frames.shrink_to_fit();
+  _values.shrink_to_fit();
+}
+
+/**
+ * Returns the number of bytes occupied by the compressed data of this
+ * channel, not counting the overhead of the channel object itself.
+ */
+size_t AnimChannelMatrixCompressed::
+get_data_size() const {
+  return sizeof(_tracks) +
+    _key_frames.size() * sizeof(uint16_t) +
+    _values.size() * sizeof(uint32_t);
+}
+
+/**
+ * Returns true if the value has changed since the last call to has_changed().
+ * last_frame is the frame number of the last call; this_frame is the current
+ * frame number.
+ */
+bool AnimChannelMatrixCompressed::
+has_changed(int last_frame, double last_frac,
+            int this_frame, double this_frac) {
+  if (last_frame != this_frame) {
+    for (int i = 0; i < num_matrix_components; i++) {
+      const Track &track = _tracks[i];
+      if (track._num_frames != 0 &&
+          decode(track, last_frame) != decode(track, this_frame)) {
+        return true;
+      }
+    }
+  }
+
+  if (last_frac != this_frac) {
+    // If we have some fractional changes, also check the next subsequent
+    // frame (since we'll be blending with that).
+    for (int i = 0; i < num_matrix_components; i++) {
+      const Track &track = _tracks[i];
+      if (track._num_frames != 0 &&
+          decode(track, last_frame) != decode(track, this_frame + 1)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Gets the value of the channel at the indicated frame.
+ */
+void AnimChannelMatrixCompressed::
+get_value(int frame, LMatrix4 &mat) {
+  PN_stdfloat components[num_matrix_components];
+  get_components(frame, components);
+  compose_matrix(mat, components);
+}
+
+/**
+ * Gets the value of the channel at the indicated frame, without any scale or
+ * shear information.
+ */
+void AnimChannelMatrixCompressed::
+get_value_no_scale_shear(int frame, LMatrix4 &mat) {
+  PN_stdfloat components[num_matrix_components];
+  components[0] = 1.0f;
+  components[1] = 1.0f;
+  components[2] = 1.0f;
+  components[3] = 0.0f;
+  components[4] = 0.0f;
+  components[5] = 0.0f;
+
+  for (int i = 6; i < num_matrix_components; i++) {
+    components[i] = get_component(frame, i);
+  }
+
+  compose_matrix(mat, components);
+}
+
+/**
+ * Gets the scale value at the indicated frame.
+ */
+void AnimChannelMatrixCompressed::
+get_scale(int frame, LVecBase3 &scale) {
+  for (int i = 0; i < 3; i++) {
+    scale[i] = get_component(frame, i);
+  }
+}
+
+/**
+ * Returns the h, p, and r components associated with the current frame.  As
+ * above, this only makes sense for a matrix-type channel.
+ */
+void AnimChannelMatrixCompressed::
+get_hpr(int frame, LVecBase3 &hpr) {
+  for (int i = 0; i < 3; i++) {
+    hpr[i] = get_component(frame, i + 6);
+  }
+}
+
+/**
+ * Returns the rotation component associated with the current frame, expressed
+ * as a quaternion.  As above, this only makes sense for a matrix-type
+ * channel.
+ */
+void AnimChannelMatrixCompressed::
+get_quat(int frame, LQuaternion &quat) {
+  LVecBase3 hpr;
+  get_hpr(frame, hpr);
+  quat.set_hpr(hpr);
+}
+
+/**
+ * Returns the x, y, and z translation components associated with the current
+ * frame.  As above, this only makes sense for a matrix-type channel.
+ */
+void AnimChannelMatrixCompressed::
+get_pos(int frame, LVecBase3 &pos) {
+  for (int i = 0; i < 3; i++) {
+    pos[i] = get_component(frame, i + 9);
+  }
+}
+
+/**
+ * Returns the a, b, and c shear components associated with the current frame.
+ * As above, this only makes sense for a matrix-type channel.
+ */
+void AnimChannelMatrixCompressed::
+get_shear(int frame, LVecBase3 &shear) {
+  for (int i = 0; i < 3; i++) {
+    shear[i] = get_component(frame, i + 3);
+  }
+}
+
+/**
+ * Fills in all twelve components of the transform at the indicated frame, in
+ * the order expected by compose_matrix().
+ */
+void AnimChannelMatrixCompressed::
+get_components(int frame, PN_stdfloat components[num_matrix_components]) const {
+  // The animated tracks usually all have the same number of frames, so the
+  // frame number is only wrapped again when that changes.
+  int num_frames = 0;
+  int f = 0;
+  for (int i = 0; i < num_matrix_components; i++) {
+    const Track &track = _tracks[i];
+    if (track._num_frames == 0) {
+      components[i] = track._base;
+    } else {
+      if (track._num_frames != num_frames) {
+        num_frames = track._num_frames;
+        f = frame % num_frames;
+      }
+      components[i] = decode_frame(track, f);
+    }
+  }
+}
+
+/**
+ * Writes a brief description of the channel and all of its descendants.
+ */
+void AnimChannelMatrixCompressed::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level)
+    << get_type() << " " << get_name() << " ";
+
+  // Write a list of all the components that are animated, with the number of
+  // frames of each, and the number of keys of those that have them.
+  bool found_any = false;
+  for (int i = 0; i < num_matrix_components; i++) {
+    const Track &track = _tracks[i];
+    if (track._num_frames != 0) {
+      out << matrix_component_letters[i];
+      if (track._num_keys != 0) {
+        out << track._num_keys << "/";
+      }
+      out << track._num_frames;
+      found_any = true;
+    }
+  }
+
+  if (!found_any) {
+    out << "(constant)";
+  }
+
+  if (!_children.empty()) {
+    out << " {\n";
+    write_descendants(out, indent_level + 2);
+    indent(out, indent_level) << "}";
+  }
+
+  out << "\n";
+}
+
+/**
+ * Returns a copy of this object, and attaches it to the indicated parent
+ * (which may be NULL only if this is an AnimBundle).  Intended to be called
+ * by copy_subtree() only.
+ */
+AnimGroup *AnimChannelMatrixCompressed::
+make_copy(AnimGroup *parent) const {
+  return new AnimChannelMatrixCompressed(parent, *this);
+}
+
+/**
+ * Decodes the value of the indicated track, which must have keys, at frame f,
+ * which must already be less than the number of frames of the track.
+ */
+PN_stdfloat AnimChannelMatrixCompressed::
+decode_keys(const Track &track, int f) const {
+  int num_bits = track._num_bits;
+
+  // The first key is always at frame 0, and the last at the last frame.  The
+  // keys tend to be evenly spread, so we find the key that begins the segment
+  // containing f by guessing from its position and stepping from there.
+  const uint16_t *frames = _key_frames.data() + track._first_key;
+  int last = track._num_keys - 1;
+  int k = (int)((size_t)f * last / (track._num_frames - 1));
+  while (k > 0 && frames[k] > f) {
+    --k;
+  }
+  while (k < last && frames[k + 1] <= f) {
+    ++k;
+  }
+
+  size_t bit = track._first_bit + (size_t)k * num_bits;
+  PN_stdfloat q0 = (PN_stdfloat)get_bits(bit, num_bits);
+  if (k == last || frames[k] == f) {
+    return track._base + track._step * q0;
+  }
+
+  PN_stdfloat q1 = (PN_stdfloat)get_bits(bit + num_bits, num_bits);
+  return track._base + track._step *
+    interpolate_key(f, frames[k], q0, frames[k + 1], q1);
+}
+
+/**
+ * Builds the track for the indicated component from the indicated table of
+ * values, appending its keys to _key_frames and its values to _values,
+ * beginning at bit num_value_bits, which is advanced past them.
+ */
+void AnimChannelMatrixCompressed::
+compress_table(int table_index, const PN_stdfloat *data, size_t size,
+               PN_stdfloat tolerance, size_t &num_value_bits) {
+  Track &track = _tracks[table_index];
+  track._step = 0.0f;
+  track._first_key = (uint32_t)_key_frames.size();
+  track._first_bit = (uint32_t)num_value_bits;
+  track._num_keys = 0;
+  track._num_frames = 0;
+  track._num_bits = 0;
+
+  if (size == 0) {
+    track._base = matrix_component_defaults[table_index];
+    return;
+  }
+
+  if (size > (size_t)max_frames) {
+    chan_cat.error()
+      << "Cannot compress a table of " << size << " frames; the limit is "
+      << (int)max_frames << ".\n";
+    track._base = data[0];
+    return;
+  }
+
+  PN_stdfloat min_value = data[0];
+  PN_stdfloat max_value = data[0];
+  for (size_t i = 1; i < size; ++i) {
+    min_value = std::min(min_value, data[i]);
+    max_value = std::max(max_value, data[i]);
+  }
+
+  PN_stdfloat range = max_value - min_value;
+  if (range == 0.0f || range * 0.5f <= tolerance) {
+    // The whole table can be represented by a single value.
+    track._base = min_value + range * 0.5f;
+    return;
+  }
+
+  // Use the fewest bits that keep the quantization error, which is half of
+  // the step, within half of the tolerance.  A tolerance too small to reach
+  // even with max_value_bits is treated as the precision of the table.
+  int num_bits = 1;
+  while (num_bits < max_value_bits &&
+         range > tolerance * (PN_stdfloat)((1 << num_bits) - 1)) {
+    ++num_bits;
+  }
+  unsigned int max_q = (1u << num_bits) - 1u;
+
+  track._base = min_value;
+  track._step = range / (PN_stdfloat)max_q;
+  track._num_frames = (uint16_t)size;
+  track._num_bits = (uint8_t)num_bits;
+
+  pvector<unsigned int> quantized(size);
+  for (size_t i = 0; i < size; ++i) {
+    PN_stdfloat q = cfloor((data[i] - min_value) / track._step + 0.5f);
+    quantized[i] = (unsigned int)std::max((PN_stdfloat)0, std::min(q, (PN_stdfloat)max_q));
+  }
+
+  // Starting from the first frame, extend each key as far ahead as the
+  // interpolated values of the skipped frames remain within the tolerance.
+  pvector<int> keys;
+  int last = (int)size - 1;
+  int a = 0;
+  keys.push_back(0);
+  while (a < last) {
+    int best = a + 1;
+    int limit = std::min(last, a + max_key_span);
+    for (int b = a + 2; b <= limit; ++b) {
+      bool ok = true;
+      for (int f = a + 1; f < b && ok; ++f) {
+        PN_stdfloat q = interpolate_key(f, a, (PN_stdfloat)quantized[a],
+                                        b, (PN_stdfloat)quantized[b]);
+        PN_stdfloat value = track._base + track._step * q;
+        ok = (cabs(value - data[f]) <= tolerance);
+      }
+      if (!ok) {
+        break;
+      }
+      best = b;
+    }
+
+    keys.push_back(best);
+    a = best;
+  }
+
+  // Keep the keys only if they take less room than the values of all of the
+  // frames.
+  if (keys.size() * (16 + num_bits) < size * num_bits) {
+    track._num_keys = (uint16_t)keys.size();
+    for (int key : keys) {
+      _key_frames.push_back((uint16_t)key);
+      add_bits(num_value_bits, quantized[key], num_bits);
+    }
+  } else {
+    for (size_t i = 0; i < size; ++i) {
+      add_bits(num_value_bits, quantized[i], num_bits);
+    }
+  }
+}
+
+/**
+ * Packs the indicated num_bits-bit value into _values at the indicated bit,
+ * and advances bit past it.
+ */
+void AnimChannelMatrixCompressed::
+add_bits(size_t &bit, unsigned int value, int num_bits) {
+  size_t word = bit >> 5;
+  if (_values.size() < word + 2) {
+    _values.resize(word + 2, 0);
+  }
+  uint64_t shifted = (uint64_t)value << (bit & 31);
+  _values[word] |= (uint32_t)shifted;
+  _values[word + 1] |= (uint32_t)(shifted >> 32);
+  bit += num_bits;
+}
+
+/**
+ * Returns true if the indicated track, as read from a bam file, can be decoded
+ * using only the key frames and values that were read with it.
+ */
+bool AnimChannelMatrixCompressed::
+is_track_valid(const Track &track) const {
+  if (track._num_frames == 0) {
+    // A constant track reads nothing.
+    return true;
+  }
+  if (track._num_bits < 1 || track._num_bits > max_value_bits) {
+    return false;
+  }
+
+  size_t num_values = track._num_frames;
+  if (track._num_keys != 0) {
+    // decode_keys() needs the keys in increasing order, the first at frame 0
+    // and the last at the last frame, which also requires at least two frames.
+    num_values = track._num_keys;
+    if (track._num_frames < 2 || track._num_keys < 2 ||
+        (size_t)track._first_key + track._num_keys > _key_frames.size()) {
+      return false;
+    }
+    const uint16_t *frames = _key_frames.data() + track._first_key;
+    if (frames[0] != 0 || frames[track._num_keys - 1] != track._num_frames - 1) {
+      return false;
+    }
+    for (int k = 1; k < track._num_keys; ++k) {
+      if (frames[k] <= frames[k - 1]) {
+        return false;
+      }
+    }
+  }
+
+  // get_bits() reads the word that holds the start of the last value, and the
+  // one after it.
+  size_t last_bit = (size_t)track._first_bit + (num_values - 1) * track._num_bits;
+  return (last_bit >> 5) + 2 <= _values.size();
+}
+
+/**
+ * Function to write the important information in the particular object to a
+ * Datagram
+ */
+void AnimChannelMatrixCompressed::
+write_datagram(BamWriter *manager, Datagram &me) {
+  AnimChannelMatrix::write_datagram(manager, me);
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    const Track &track = _tracks[i];
+    me.add_stdfloat(track._base);
+    me.add_stdfloat(track._step);
+    me.add_uint32(track._first_key);
+    me.add_uint32(track._first_bit);
+    me.add_uint16(track._num_keys);
+    me.add_uint16(track._num_frames);
+    me.add_uint8(track._num_bits);
+  }
+
+  me.add_uint32(_key_frames.size());
+  for (uint16_t frame : _key_frames) {
+    me.add_uint16(frame);
+  }
+  me.add_uint32(_values.size());
+  for (uint32_t word : _values) {
+    me.add_uint32(word);
+  }
+}
+
+/**
+ * Function that reads out of the datagram (or asks manager to read) all of
+ * the data that is needed to re-create this object and stores it in the
+ * appropiate place
+ */
+void AnimChannelMatrixCompressed::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  AnimChannelMatrix::fillin(scan, manager);
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    Track &track = _tracks[i];
+    track._base = scan.get_stdfloat();
+    track._step = scan.get_stdfloat();
+    track._first_key = scan.get_uint32();
+    track._first_bit = scan.get_uint32();
+    track._num_keys = scan.get_uint16();
+    track._num_frames = scan.get_uint16();
+    track._num_bits = scan.get_uint8();
+  }
+
+  _key_frames.clear();
+  _values.clear();
+
+  size_t num_key_frames = scan.get_uint32();
+  if (num_key_frames * 2 > scan.get_remaining_size()) {
+    chan_cat.error()
+      << "Key frames of " << get_name()
+      << " extend past end of datagram, is bam file corrupt?\n";
+    num_key_frames = 0;
+  }
+  _key_frames.resize(num_key_frames);
+  for (size_t i = 0; i < num_key_frames; ++i) {
+    _key_frames[i] = scan.get_uint16();
+  }
+  size_t num_words = scan.get_uint32();
+  if (num_words * 4 > scan.get_remaining_size()) {
+    chan_cat.error()
+      << "Values of " << get_name()
+      << " extend past end of datagram, is bam file corrupt?\n";
+    num_words = 0;
+  }
+  _values.resize(num_words);
+  for (size_t i = 0; i < num_words; ++i) {
+    _values[i] = scan.get_uint32();
+  }
+
+  // Make sure that decoding a track won't read past the end of the arrays.
+  // A track that fails the check holds its base value instead.
+  for (int i = 0; i < num_matrix_components; i++) {
+    Track &track = _tracks[i];
+    if (!is_track_valid(track)) {
+      chan_cat.error()
+        << "Track " << matrix_component_letters[i] << " of " << get_name()
+        << " is invalid, is bam file corrupt?\n";
+      track._num_keys = 0;
+      track._num_frames = 0;
+      track._num_bits = 0;
+    }
+  }
+}
+
+/**
+ * Factory method to generate an AnimChannelMatrixCompressed object.
+ */
+TypedWritable *AnimChannelMatrixCompressed::
+make_AnimChannelMatrixCompressed(const FactoryParams &params) {
+  AnimChannelMatrixCompressed *me = new AnimChannelMatrixCompressed;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * Factory method to generate an AnimChannelMatrixCompressed object.
+ */
+void AnimChannelMatrixCompressed::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_AnimChannelMatrixCompressed);
+}
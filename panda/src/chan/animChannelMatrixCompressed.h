@@ -0,0 +1,143 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animChannelMatrixCompressed.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef ANIMCHANNELMATRIXCOMPRESSED_H
+#define ANIMCHANNELMATRIXCOMPRESSED_H
+
+#include "pandabase.h"
+
+#include "animChannel.h"
+#include "pvector.h"
+#include "compose_matrix.h"
+
+class AnimChannelMatrixXfmTable;
+
+/**
+ * An animation channel that holds the same twelve component tables as
+ * AnimChannelMatrixXfmTable, but stored in a compact form that is decoded
+ * each time a frame is requested, to reduce the memory footprint of large
+ * sets of animations.
+ *
+ * The values of each table are quantized over the range of the table, with
+ * as few bits as will keep the quantization error within half of the
+ * tolerance given by the compress-anim-*-tolerance config variables, and
+ * packed together.  If it is smaller, a table is instead reduced to a set of
+ * keyframes, between which the values are linearly interpolated, chosen so
+ * that no frame differs from the original table by more than the tolerance.
+ * A table that does not change is stored as a single value.
+ */
+class EXPCL_PANDA_CHAN AnimChannelMatrixCompressed : public AnimChannelMatrix {
+protected:
+  AnimChannelMatrixCompressed();
+  AnimChannelMatrixCompressed(AnimGroup *parent, const AnimChannelMatrixCompressed &copy);
+
+PUBLISHED:
+  explicit AnimChannelMatrixCompressed(AnimGroup *parent, const std::string &name);
+  virtual ~AnimChannelMatrixCompressed();
+
+  void set_tables(const AnimChannelMatrixXfmTable *source);
+  void set_tables(const AnimChannelMatrixXfmTable *source,
+                  PN_stdfloat scale_tolerance, PN_stdfloat hpr_tolerance,
+                  PN_stdfloat pos_tolerance);
+
+  size_t get_data_size() const;
+
+public:
+  // The frame numbers of the keys are stored in 16 bits, so a table with more
+  // frames than this can't be compressed.
+  enum { max_frames = 0xffff };
+
+  virtual bool has_changed(int last_frame, double last_frac,
+                           int this_frame, double this_frac);
+  virtual void get_value(int frame, LMatrix4 &mat);
+
+  virtual void get_value_no_scale_shear(int frame, LMatrix4 &value);
+  virtual void get_scale(int frame, LVecBase3 &scale);
+  virtual void get_hpr(int frame, LVecBase3 &hpr);
+  virtual void get_quat(int frame, LQuaternion &quat);
+  virtual void get_pos(int frame, LVecBase3 &pos);
+  virtual void get_shear(int frame, LVecBase3 &shear);
+
+  void get_components(int frame, PN_stdfloat components[num_matrix_components]) const;
+
+  virtual void write(std::ostream &out, int indent_level) const;
+
+protected:
+  virtual AnimGroup *make_copy(AnimGroup *parent) const;
+
+private:
+  // One of these is stored for each of the twelve components.  If
+  // _num_frames is 0, the component has the constant value _base.
+  // Otherwise, its quantized values are packed into _values, _num_bits each,
+  // starting at bit _first_bit, and each decodes to _base + _step * value.
+  // If _num_keys is 0, there is one value for each frame; otherwise, there is
+  // one for each of the keys, whose frame numbers are found in _key_frames
+  // starting at _first_key.
+  class Track {
+  public:
+    PN_stdfloat _base;
+    PN_stdfloat _step;
+    uint32_t _first_key;
+    uint32_t _first_bit;
+    uint16_t _num_keys;
+    uint16_t _num_frames;
+    uint8_t _num_bits;
+  };
+  Track _tracks[num_matrix_components];
+
+  INLINE PN_stdfloat get_component(int frame, int table_index) const;
+  INLINE PN_stdfloat decode(const Track &track, int frame) const;
+  INLINE PN_stdfloat decode_frame(const Track &track, int f) const;
+  PN_stdfloat decode_keys(const Track &track, int f) const;
+  INLINE unsigned int get_bits(size_t bit, int num_bits) const;
+  void compress_table(int table_index, const PN_stdfloat *data, size_t size,
+                      PN_stdfloat tolerance, size_t &num_value_bits);
+  void add_bits(size_t &bit, unsigned int value, int num_bits);
+  bool is_track_valid(const Track &track) const;
+
+  pvector<uint16_t> _key_frames;
+
+  // This always has one more word than is needed to hold the values, so that
+  // get_bits() may read two words at a time.
+  pvector<uint32_t> _values;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter* manager, Datagram &me);
+
+  static TypedWritable *make_AnimChannelMatrixCompressed(const FactoryParams &params);
+
+protected:
+  void fillin(DatagramIterator& scan, BamReader* manager);
+
+public:
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AnimChannelMatrix::init_type();
+    register_type(_type_handle, "AnimChannelMatrixCompressed",
+                  AnimChannelMatrix::get_class_type());
+  }
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "animChannelMatrixCompressed.I"
+
+#endif
@@ -12,6 +12,7 @@
  */
 
 #include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
 #include "animBundle.h"
 #include "config_chan.h"
 
@@ -30,7 +31,9 @@ TypeHandle AnimChannelMatrixXfmTable::_type_handle;
  * Used only for bam loader.
  */
 AnimChannelMatrixXfmTable::
-AnimChannelMatrixXfmTable() {
+AnimChannelMatrixXfmTable() :
+  _tables_modified(0)
+{
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
@@ -43,7 +46,8 @@ AnimChannelMatrixXfmTable() {
  */
 AnimChannelMatrixXfmTable::
 AnimChannelMatrixXfmTable(AnimGroup *parent, const AnimChannelMatrixXfmTable &copy) :
-  AnimChannelMatrix(parent, copy)
+  AnimChannelMatrix(parent, copy),
+  _tables_modified(0)
 {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = copy._tables[i];
@@ -55,7 +59,8 @@ AnimChannelMatrixXfmTable(AnimGroup *parent, const AnimChannelMatrixXfmTable &co
  */
 AnimChannelMatrixXfmTable::
 AnimChannelMatrixXfmTable(AnimGroup *parent, const std::string &name)
-  : AnimChannelMatrix(parent, name)
+  : AnimChannelMatrix(parent, name),
+    _tables_modified(0)
 {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
@@ -249,6 +254,7 @@ set_table(char table_id, const CPTA_stdfloat &table) {
   }
 
   _tables[i] = table;
+  ++_tables_modified;
 }
 
 
@@ -261,6 +267,7 @@ clear_all_tables() {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
+  ++_tables_modified;
 }
 
 /**
@@ -303,6 +310,26 @@ make_copy(AnimGroup *parent) const {
   return new AnimChannelMatrixXfmTable(parent, *this);
 }
 
+/**
+ * Returns an AnimChannelMatrixCompressed with the same name and tables as
+ * this object, compressed according to the compress-anim-*-tolerance config
+ * variables, and attaches it to the indicated parent.  If a table is too long
+ * to be compressed, returns an uncompressed copy instead.  Intended to be
+ * called by copy_subtree() only.
+ */
+AnimGroup *AnimChannelMatrixXfmTable::
+make_compressed_copy(AnimGroup *parent) const {
+  for (int i = 0; i < num_matrix_components; i++) {
+    if (_tables[i].size() > (size_t)AnimChannelMatrixCompressed::max_frames) {
+      return make_copy(parent);
+    }
+  }
+
+  AnimChannelMatrixCompressed *copy = new AnimChannelMatrixCompressed(parent, get_name());
+  copy->set_tables(this);
+  return copy;
+}
+
 /**
  * Returns the table index number, a value between 0 and
  * num_matrix_components, that corresponds to the indicated table id.  Returns
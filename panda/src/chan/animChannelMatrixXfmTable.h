@@ -66,6 +66,7 @@ public:
 
 protected:
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
+  virtual AnimGroup *make_compressed_copy(AnimGroup *parent) const;
 
   INLINE static char get_table_id(int table_index);
   static int get_table_index(char table_id);
@@ -73,6 +74,9 @@ protected:
 
   CPTA_stdfloat _tables[num_matrix_components];
 
+  // Incremented whenever one of the above tables is replaced.
+  unsigned int _tables_modified;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
@@ -98,6 +102,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class AnimProgram;
 };
 
 #include "animChannelMatrixXfmTable.I"
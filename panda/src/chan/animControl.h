@@ -118,6 +118,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class AnimProgram;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const AnimControl &control);
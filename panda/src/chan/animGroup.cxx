@@ -223,16 +223,34 @@ make_copy(AnimGroup *parent) const {
 
 
 /**
- * Returns a full copy of the subtree at this node and below.
+ * Returns a copy of this object in a form that occupies less memory, and
+ * attaches it to the indicated parent.  The default is to return an ordinary
+ * copy; channels that have a compressed form return that instead.  Intended
+ * to be called by copy_subtree() only.
+ */
+AnimGroup *AnimGroup::
+make_compressed_copy(AnimGroup *parent) const {
+  return make_copy(parent);
+}
+
+/**
+ * Returns a full copy of the subtree at this node and below.  If compress is
+ * true, each node is copied with make_compressed_copy() instead of
+ * make_copy().
  */
 PT(AnimGroup) AnimGroup::
-copy_subtree(AnimGroup *parent) const {
-  PT(AnimGroup) new_group = make_copy(parent);
-  nassertr(new_group->get_type() == get_type(), (AnimGroup *)this);
+copy_subtree(AnimGroup *parent, bool compress) const {
+  PT(AnimGroup) new_group;
+  if (compress) {
+    new_group = make_compressed_copy(parent);
+  } else {
+    new_group = make_copy(parent);
+    nassertr(new_group->get_type() == get_type(), (AnimGroup *)this);
+  }
 
   Children::const_iterator ci;
   for (ci = _children.begin(); ci != _children.end(); ++ci) {
-    (*ci)->copy_subtree(new_group);
+    (*ci)->copy_subtree(new_group, compress);
   }
 
   return new_group;
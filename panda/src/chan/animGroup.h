@@ -61,7 +61,8 @@ protected:
   void write_descendants(std::ostream &out, int indent_level) const;
 
   virtual AnimGroup *make_copy(AnimGroup *parent) const;
-  PT(AnimGroup) copy_subtree(AnimGroup *parent) const;
+  virtual AnimGroup *make_compressed_copy(AnimGroup *parent) const;
+  PT(AnimGroup) copy_subtree(AnimGroup *parent, bool compress = false) const;
 
 protected:
   typedef pvector< PT(AnimGroup) > Children;
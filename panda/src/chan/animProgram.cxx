@@ -0,0 +1,325 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animProgram.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "animProgram.h"
+#include "partBundle.h"
+#include "movingPartMatrix.h"
+#include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
+#include "animControl.h"
+#include "compose_matrix.h"
+#include "lsimd.h"
+
+/**
+ * Computes the sines and cosines of the indicated number of angles, which
+ * are given in degrees.
+ */
+static void
+batch_sincos(const PN_stdfloat *angles, PN_stdfloat *sines,
+             PN_stdfloat *cosines, size_t num_angles) {
+  size_t i = 0;
+
+#if defined(LINMATH_SSE2) && !defined(STDFLOAT_DOUBLE)
+  const __m128 to_rad = _mm_set1_ps((float)(MathNumbers::pi / 180.0));
+  for (; i + 4 <= num_angles; i += 4) {
+    __m128 s, c;
+    lsimd_sincos(_mm_mul_ps(_mm_loadu_ps(angles + i), to_rad), s, c);
+    _mm_storeu_ps(sines + i, s);
+    _mm_storeu_ps(cosines + i, c);
+  }
+#endif
+
+  for (; i < num_angles; ++i) {
+    csincos(deg_2_rad(angles[i]), &sines[i], &cosines[i]);
+  }
+}
+
+/**
+ * Post-multiplies the indicated matrix by a rotation about the indicated
+ * axis, which is much cheaper than composing the full rotation matrix for an
+ * arbitrary axis.  s is the sine of the angle, with the sign of the axis and
+ * the handedness of the coordinate system already applied.
+ */
+static INLINE void
+rotate_about_axis(LMatrix3 &mat, int axis, PN_stdfloat s, PN_stdfloat c) {
+  int i = (axis + 1) % 3;
+  int j = (axis + 2) % 3;
+  for (int row = 0; row < 3; ++row) {
+    PN_stdfloat a = mat(row, i);
+    PN_stdfloat b = mat(row, j);
+    mat(row, i) = a * c - b * s;
+    mat(row, j) = a * s + b * c;
+  }
+}
+
+/**
+ * Builds the program for the parts of the indicated PartBundle, which must
+ * currently be animated by the indicated AnimControl alone.
+ */
+AnimProgram::
+AnimProgram(PartBundle *root, AnimControl *control) :
+  _num_xfm_parts(0),
+  _control(control)
+{
+  r_compile(root, -1);
+
+  _xfm_states.resize(_num_xfm_parts);
+  _decoded_frames.resize(_num_xfm_parts, -1);
+  _part_changed.resize(_parts.size());
+
+  // compose_matrix() applies the roll, then the pitch, then the heading, each
+  // about one of the coordinate system's axes.
+  _cs = get_default_coordinate_system();
+  LVector3 axes[3] = {
+    LVector3::forward(_cs), LVector3::right(_cs), LVector3::up(_cs)
+  };
+  PN_stdfloat handedness = IS_LEFT_HANDED_COORDSYSTEM(_cs) ? -1.0f : 1.0f;
+  for (int a = 0; a < 3; ++a) {
+    int k = 0;
+    while (k < 2 && axes[a][k] == 0.0f) {
+      ++k;
+    }
+    _rotate_axis[a] = k;
+    _rotate_sign[a] = (axes[a][k] < 0.0f) ? -handedness : handedness;
+  }
+}
+
+/**
+ * Updates all of the parts for the current frame.  This has the same effect
+ * as PartBundle::do_update(), as long as the AnimControl is still the only
+ * one in effect without frame blending, which the caller must ensure.
+ *
+ * The return value is true if any part has changed, false otherwise.
+ */
+bool AnimProgram::
+update(PartBundle *root, const CycleData *root_cdata, bool parent_changed,
+       bool anim_changed, Thread *current_thread) {
+  compute_values(anim_changed, root->get_lod_distance());
+
+  bool any_changed = false;
+  size_t num_parts = _parts.size();
+  for (size_t i = 0; i < num_parts; ++i) {
+    const Part &part = _parts[i];
+    bool this_parent_changed = parent_changed;
+    if (part._ancestor >= 0) {
+      this_parent_changed = (_part_changed[part._ancestor] != 0);
+    }
+
+    bool needs_update;
+    MovingPartBase *moving = part._part;
+    if (part._xfm_index >= 0 && _xfm_states[part._xfm_index] != XS_other) {
+      // The value has already been computed by compute_values().
+      needs_update = (_xfm_states[part._xfm_index] == XS_changed);
+      if (this_parent_changed || needs_update) {
+        if (moving->update_internals(root, part._parent, needs_update,
+                                     this_parent_changed, current_thread)) {
+          any_changed = true;
+        }
+      }
+    } else {
+      needs_update = moving->update_self(root, root_cdata, part._parent,
+                                         this_parent_changed, anim_changed,
+                                         any_changed, current_thread);
+    }
+
+    _part_changed[i] = (this_parent_changed || needs_update);
+  }
+
+  return any_changed;
+}
+
+/**
+ * Recursively adds the moving parts below the indicated group to the
+ * program, in the order in which PartGroup::do_update() would visit them.
+ * ancestor is the index of the nearest enclosing moving part, or -1.
+ */
+void AnimProgram::
+r_compile(PartGroup *group, int ancestor) {
+  PartGroup::Children::const_iterator ci;
+  for (ci = group->_children.begin(); ci != group->_children.end(); ++ci) {
+    PartGroup *child = (*ci);
+    int child_ancestor = ancestor;
+
+    if (child->is_of_type(MovingPartBase::get_class_type())) {
+      MovingPartBase *moving = DCAST(MovingPartBase, child);
+
+      Part part;
+      part._part = moving;
+      part._parent = group;
+      part._ancestor = ancestor;
+      part._matrix = nullptr;
+      part._xfm_channel = nullptr;
+      part._compressed_channel = nullptr;
+      part._tables_modified = 0;
+      part._xfm_index = -1;
+      part._begin_table = 0;
+      part._end_table = 0;
+
+      AnimChannelBase *channel = moving->_effective_channel;
+      if (moving->_effective_control == _control && channel != nullptr &&
+          moving->is_of_type(MovingPartMatrix::get_class_type()) &&
+          channel->is_exact_type(AnimChannelMatrixXfmTable::get_class_type())) {
+        AnimChannelMatrixXfmTable *xfm_channel = DCAST(AnimChannelMatrixXfmTable, channel);
+        part._matrix = DCAST(MovingPartMatrix, moving);
+        part._channel = channel;
+        part._xfm_channel = xfm_channel;
+        part._tables_modified = xfm_channel->_tables_modified;
+        part._xfm_index = (int)_num_xfm_parts++;
+
+        // Store the constant components now, and remember where to find the
+        // others.
+        part._begin_table = _tables.size();
+        for (int i = 0; i < num_matrix_components; ++i) {
+          const CPTA_stdfloat &table = xfm_channel->_tables[i];
+          if (table.size() == 0) {
+            _components.push_back(AnimChannelMatrixXfmTable::get_default_value(i));
+          } else {
+            _components.push_back(table[0]);
+            if (table.size() > 1) {
+              Table t;
+              t._data = &table[0];
+              t._size = table.size();
+              t._component = i;
+              _tables.push_back(t);
+            }
+          }
+        }
+        part._end_table = _tables.size();
+
+      } else if (moving->_effective_control == _control && channel != nullptr &&
+                 moving->is_of_type(MovingPartMatrix::get_class_type()) &&
+                 channel->is_exact_type(AnimChannelMatrixCompressed::get_class_type())) {
+        AnimChannelMatrixCompressed *compressed_channel = DCAST(AnimChannelMatrixCompressed, channel);
+        part._matrix = DCAST(MovingPartMatrix, moving);
+        part._channel = channel;
+        part._compressed_channel = compressed_channel;
+        part._xfm_index = (int)_num_xfm_parts++;
+        part._begin_table = _tables.size();
+        part._end_table = _tables.size();
+        _components.resize(_components.size() + num_matrix_components);
+      }
+
+      child_ancestor = (int)_parts.size();
+      _parts.push_back(part);
+    }
+
+    r_compile(child, child_ancestor);
+  }
+}
+
+/**
+ * Computes the new values of all of the matrix parts for the current frame
+ * of the AnimControl, leaving alone the ones that have not changed since the
+ * control was last marked.  This is the equivalent of the has_changed() and
+ * get_value() methods of the channels, done for all of the parts at once.
+ * Parts that are held because of their hold distance at lod_distance, or
+ * that have just been released, are left to MovingPartBase::update_self().
+ */
+void AnimProgram::
+compute_values(bool anim_changed, PN_stdfloat lod_distance) {
+  int this_frame = _control->get_frame();
+  int last_frame = _control->_marked_frame;
+  bool check = !anim_changed && last_frame >= 0 && last_frame != this_frame;
+  bool all_changed = anim_changed || last_frame < 0;
+
+  // First, read the components from the tables, and collect the angles of the
+  // parts that have changed.
+  _changed.clear();
+  _angles.clear();
+  for (size_t pi = 0; pi < _parts.size(); ++pi) {
+    const Part &part = _parts[pi];
+    if (part._xfm_index < 0) {
+      continue;
+    }
+    MovingPartBase *moving = part._part;
+    if (moving->_forced_channel != nullptr ||
+        moving->_effective_channel != part._channel ||
+        moving->_held ||
+        (moving->_hold_distance > 0.0f && lod_distance > moving->_hold_distance) ||
+        (part._xfm_channel != nullptr &&
+         part._xfm_channel->_tables_modified != part._tables_modified)) {
+      _xfm_states[part._xfm_index] = XS_other;
+      _decoded_frames[part._xfm_index] = -1;
+      continue;
+    }
+
+    PN_stdfloat *components = &_components[part._xfm_index * num_matrix_components];
+    bool changed = all_changed;
+    if (part._compressed_channel != nullptr) {
+      AnimChannelMatrixCompressed *compressed_channel = part._compressed_channel;
+      int &decoded_frame = _decoded_frames[part._xfm_index];
+      if (check && !changed && decoded_frame == last_frame) {
+        // The components of the last frame are still here to compare with.
+        PN_stdfloat last_components[num_matrix_components];
+        memcpy(last_components, components, sizeof(last_components));
+        compressed_channel->get_components(this_frame, components);
+        changed = (memcmp(last_components, components, sizeof(last_components)) != 0);
+      } else {
+        if (check && !changed) {
+          changed = compressed_channel->has_changed(last_frame, 0.0, this_frame, 0.0);
+        }
+        compressed_channel->get_components(this_frame, components);
+      }
+      decoded_frame = this_frame;
+    } else {
+      const Table *tables = _tables.data();
+      for (size_t ti = part._begin_table; ti < part._end_table; ++ti) {
+        const Table &table = tables[ti];
+        PN_stdfloat value = table._data[this_frame % table._size];
+        components[table._component] = value;
+        if (check && !changed) {
+          changed = (table._data[last_frame % table._size] != value);
+        }
+      }
+    }
+
+    if (changed) {
+      _xfm_states[part._xfm_index] = XS_changed;
+      _changed.push_back((int)pi);
+      _angles.push_back(components[8]);
+      _angles.push_back(components[7]);
+      _angles.push_back(components[6]);
+    } else {
+      _xfm_states[part._xfm_index] = XS_unchanged;
+    }
+  }
+
+  size_t num_angles = _angles.size();
+  _sines.resize(num_angles);
+  _cosines.resize(num_angles);
+  batch_sincos(_angles.data(), _sines.data(), _cosines.data(), num_angles);
+
+  // Now compose the matrices, in the same way as compose_matrix(): the scale
+  // and shear, followed by the roll, pitch and heading.
+  const PN_stdfloat *sines = _sines.data();
+  const PN_stdfloat *cosines = _cosines.data();
+  for (int pi : _changed) {
+    const Part &part = _parts[pi];
+    const PN_stdfloat *components = &_components[part._xfm_index * num_matrix_components];
+
+    LMatrix3 mat;
+    mat.set_scale_shear_mat(LVecBase3(components[0], components[1], components[2]),
+                            LVecBase3(components[3], components[4], components[5]),
+                            _cs);
+    for (int a = 0; a < 3; ++a) {
+      if (!IS_NEARLY_ZERO(components[8 - a])) {
+        rotate_about_axis(mat, _rotate_axis[a], sines[a] * _rotate_sign[a],
+                          cosines[a]);
+      }
+    }
+    sines += 3;
+    cosines += 3;
+
+    part._matrix->_value = LMatrix4(mat, LVecBase3(components[9], components[10], components[11]));
+  }
+}
@@ -0,0 +1,131 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file animProgram.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef ANIMPROGRAM_H
+#define ANIMPROGRAM_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "animChannelBase.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pta_stdfloat.h"
+#include "luse.h"
+#include "coordinateSystem.h"
+
+class PartBundle;
+class PartGroup;
+class MovingPartBase;
+class MovingPartMatrix;
+class AnimControl;
+class AnimChannelMatrixXfmTable;
+class AnimChannelMatrixCompressed;
+class CycleData;
+class Thread;
+
+/**
+ * A flattened form of the binding between a PartBundle and the single
+ * AnimControl that animates it, used by PartBundle::update() in place of the
+ * recursive walk through the part hierarchy.
+ *
+ * The moving parts are listed in the order they would be visited by that
+ * walk, each with the index of its nearest moving ancestor.  The channel
+ * tables of the joints that are animated by an AnimChannelMatrixXfmTable or
+ * an AnimChannelMatrixCompressed are read for all of the joints at once, and
+ * the joints whose components have changed are composed into matrices
+ * together, computing the sines and cosines of all of their angles in one
+ * pass.  Any other part, or any joint whose binding has changed since the
+ * program was built, is updated in the usual way.
+ */
+class EXPCL_PANDA_CHAN AnimProgram : public ReferenceCount {
+public:
+  AnimProgram(PartBundle *root, AnimControl *control);
+
+  INLINE AnimControl *get_control() const;
+  INLINE size_t get_num_parts() const;
+  INLINE size_t get_num_xfm_parts() const;
+
+  bool update(PartBundle *root, const CycleData *root_cdata,
+              bool parent_changed, bool anim_changed, Thread *current_thread);
+
+private:
+  void r_compile(PartGroup *group, int ancestor);
+  void compute_values(bool anim_changed, PN_stdfloat lod_distance);
+
+  class Part {
+  public:
+    MovingPartBase *_part;
+    PartGroup *_parent;
+    int _ancestor;
+
+    // These are only set if the part is a MovingPartMatrix that is animated
+    // by an AnimChannelMatrixXfmTable or an AnimChannelMatrixCompressed.
+    MovingPartMatrix *_matrix;
+    PT(AnimChannelBase) _channel;
+    AnimChannelMatrixXfmTable *_xfm_channel;
+    AnimChannelMatrixCompressed *_compressed_channel;
+    unsigned int _tables_modified;
+    int _xfm_index;
+
+    // The range of _tables that belongs to this part.  This is empty for a
+    // compressed channel, which decodes all of its components itself.
+    size_t _begin_table;
+    size_t _end_table;
+  };
+  typedef pvector<Part> Parts;
+  Parts _parts;
+  size_t _num_xfm_parts;
+
+  // One of these is stored for each table that has more than one frame.  The
+  // other components are read once, when the program is built.
+  class Table {
+  public:
+    const PN_stdfloat *_data;
+    size_t _size;
+    int _component;
+  };
+  typedef pvector<Table> Tables;
+  Tables _tables;
+
+  AnimControl *_control;
+
+  // The coordinate system's axes of roll, pitch and heading, as the index of
+  // the axis and the sign to apply to the sine of each angle.
+  int _rotate_axis[3];
+  PN_stdfloat _rotate_sign[3];
+  CoordinateSystem _cs;
+
+  enum XfmState {
+    XS_unchanged,
+    XS_changed,
+    XS_other,
+  };
+
+  // The components and state of each of the matrix parts, and some scratch
+  // space for the angles of the ones that have changed.
+  pvector<PN_stdfloat> _components;
+  pvector<unsigned char> _xfm_states;
+
+  // The frame whose components are currently stored for each part with a
+  // compressed channel, or -1, so that they need not be decoded twice.
+  pvector<int> _decoded_frames;
+  pvector<int> _changed;
+  pvector<PN_stdfloat> _angles;
+  pvector<PN_stdfloat> _sines;
+  pvector<PN_stdfloat> _cosines;
+  pvector<unsigned char> _part_changed;
+};
+
+#include "animProgram.I"
+
+#endif
@@ -16,6 +16,7 @@
 #include "animBundleNode.h"
 #include "animChannelBase.h"
 #include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
 #include "animChannelMatrixDynamic.h"
 #include "animChannelMatrixFixed.h"
 #include "animChannelScalarTable.h"
@@ -101,11 +102,45 @@ PRC_DESC("This specifies the priority assign to an asynchronous bind "
          "model loads).  A higher number here makes the animations "
          "load sooner."));
 
+ConfigVariableBool compile_anim_programs
+("compile-anim-programs", true,
+PRC_DESC("When this is true, a PartBundle that is animated by only one "
+         "AnimControl at a time, without frame blending, updates its joints "
+         "with a flattened list of its parts that is built when the "
+         "animation is started, instead of walking the part hierarchy.  "
+         "Set this false to always walk the hierarchy."));
+
+ConfigVariableBool compress_anim_tables
+("compress-anim-tables", false,
+PRC_DESC("Set this true to replace the AnimChannelMatrixXfmTable channels of "
+         "animations loaded from bam files with AnimChannelMatrixCompressed "
+         "channels, which store their tables as quantized keyframes and "
+         "decode them as the animation plays.  This reduces the memory "
+         "footprint of the animations, within the error allowed by the "
+         "compress-anim-*-tolerance variables, at some cost in CPU time."));
+
+ConfigVariableDouble compress_anim_scale_tolerance
+("compress-anim-scale-tolerance", 0.0005,
+PRC_DESC("The greatest error allowed in the scale and shear components of a "
+         "compressed animation channel.  See compress-anim-tables."));
+
+ConfigVariableDouble compress_anim_hpr_tolerance
+("compress-anim-hpr-tolerance", 0.05,
+PRC_DESC("The greatest error, in degrees, allowed in the rotation components "
+         "of a compressed animation channel.  See compress-anim-tables."));
+
+ConfigVariableDouble compress_anim_pos_tolerance
+("compress-anim-pos-tolerance", 0.001,
+PRC_DESC("The greatest error allowed in the translation components of a "
+         "compressed animation channel, in model units.  See "
+         "compress-anim-tables."));
+
 ConfigureFn(config_chan) {
   AnimBundle::init_type();
   AnimBundleNode::init_type();
   AnimChannelBase::init_type();
   AnimChannelMatrixXfmTable::init_type();
+  AnimChannelMatrixCompressed::init_type();
   AnimChannelMatrixDynamic::init_type();
   AnimChannelMatrixFixed::init_type();
   AnimChannelScalarTable::init_type();
@@ -137,6 +172,7 @@ ConfigureFn(config_chan) {
   AnimBundle::register_with_read_factory();
   AnimBundleNode::register_with_read_factory();
   AnimChannelMatrixXfmTable::register_with_read_factory();
+  AnimChannelMatrixCompressed::register_with_read_factory();
   AnimChannelMatrixDynamic::register_with_read_factory();
   AnimChannelMatrixFixed::register_with_read_factory();
   AnimChannelScalarTable::register_with_read_factory();
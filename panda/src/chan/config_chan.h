@@ -18,6 +18,7 @@
 #include "notifyCategoryProxy.h"
 #include "configVariableBool.h"
 #include "configVariableInt.h"
+#include "configVariableDouble.h"
 
 // Configure variables for chan package.
 NotifyCategoryDecl(chan, EXPCL_PANDA_CHAN, EXPTP_PANDA_CHAN);
@@ -28,5 +29,10 @@ EXPCL_PANDA_CHAN extern ConfigVariableBool read_compressed_channels;
 EXPCL_PANDA_CHAN extern ConfigVariableBool interpolate_frames;
 EXPCL_PANDA_CHAN extern ConfigVariableBool restore_initial_pose;
 EXPCL_PANDA_CHAN extern ConfigVariableInt async_bind_priority;
+EXPCL_PANDA_CHAN extern ConfigVariableBool compile_anim_programs;
+EXPCL_PANDA_CHAN extern ConfigVariableBool compress_anim_tables;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compress_anim_scale_tolerance;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compress_anim_hpr_tolerance;
+EXPCL_PANDA_CHAN extern ConfigVariableDouble compress_anim_pos_tolerance;
 
 #endif
@@ -29,7 +29,9 @@ MovingPartBase::
 MovingPartBase(PartGroup *parent, const std::string &name) :
   PartGroup(parent, name),
   _num_effective_channels(0),
-  _effective_control(nullptr)
+  _effective_control(nullptr),
+  _hold_distance(0.0f),
+  _held(false)
 {
 }
 
@@ -39,7 +41,9 @@ MovingPartBase(PartGroup *parent, const std::string &name) :
 MovingPartBase::
 MovingPartBase() :
   _num_effective_channels(0),
-  _effective_control(nullptr)
+  _effective_control(nullptr),
+  _hold_distance(0.0f),
+  _held(false)
 {
 }
 
@@ -112,11 +116,50 @@ do_update(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
           bool parent_changed, bool anim_changed,
           Thread *current_thread) {
   bool any_changed = false;
+  bool needs_update = update_self(root, root_cdata, parent, parent_changed,
+                                  anim_changed, any_changed, current_thread);
+
+  // Now recurse.
+  Children::iterator ci;
+  for (ci = _children.begin(); ci != _children.end(); ++ci) {
+    if ((*ci)->do_update(root, root_cdata, this,
+                         parent_changed || needs_update,
+                         anim_changed, current_thread)) {
+      any_changed = true;
+    }
+  }
+
+  return any_changed;
+}
+
+/**
+ * Performs the part of do_update() that concerns this part only, without
+ * recursing to its children.  Sets any_changed true if the part has changed.
+ *
+ * The return value is true if the part's value was recomputed, false if its
+ * channels have not changed since last time.
+ */
+bool MovingPartBase::
+update_self(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
+            bool parent_changed, bool anim_changed, bool &any_changed,
+            Thread *current_thread) {
   bool needs_update = anim_changed;
 
+  if (_hold_distance > 0.0f && root->get_lod_distance() > _hold_distance) {
+    // The part is too far away to be worth animating.  It keeps its current
+    // value, but still follows its parent below.
+    _held = true;
+    needs_update = false;
+
+  } else if (_held) {
+    // It has just come back into range, so catch up with the animation.
+    _held = false;
+    needs_update = true;
+  }
+
   // See if any of the channel values have changed since last time.
 
-  if (!needs_update) {
+  if (!needs_update && !_held) {
     if (_forced_channel != nullptr) {
       needs_update = _forced_channel->has_changed(0, 0.0, 0, 0.0);
 
@@ -150,21 +193,13 @@ do_update(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
   }
 
   if (parent_changed || needs_update) {
-    any_changed = update_internals(root, parent, needs_update, parent_changed,
-                                   current_thread);
-  }
-
-  // Now recurse.
-  Children::iterator ci;
-  for (ci = _children.begin(); ci != _children.end(); ++ci) {
-    if ((*ci)->do_update(root, root_cdata, this,
-                         parent_changed || needs_update,
-                         anim_changed, current_thread)) {
+    if (update_internals(root, parent, needs_update, parent_changed,
+                         current_thread)) {
       any_changed = true;
     }
   }
 
-  return any_changed;
+  return needs_update;
 }
 
 
@@ -47,6 +47,11 @@ PUBLISHED:
   virtual bool clear_forced_channel();
   virtual AnimChannelBase *get_forced_channel() const;
 
+  INLINE void set_hold_distance(PN_stdfloat distance);
+  INLINE PN_stdfloat get_hold_distance() const;
+  INLINE bool is_held() const;
+  MAKE_PROPERTY(hold_distance, get_hold_distance, set_hold_distance);
+
   virtual void write(std::ostream &out, int indent_level) const;
   virtual void write_with_value(std::ostream &out, int indent_level) const;
   virtual void output_value(std::ostream &out) const=0;
@@ -55,6 +60,9 @@ public:
   virtual bool do_update(PartBundle *root, const CycleData *root_cdata,
                          PartGroup *parent, bool parent_changed,
                          bool anim_changed, Thread *current_thread);
+  bool update_self(PartBundle *root, const CycleData *root_cdata,
+                   PartGroup *parent, bool parent_changed, bool anim_changed,
+                   bool &any_changed, Thread *current_thread);
 
   virtual void get_blend_value(const PartBundle *root)=0;
   virtual bool update_internals(PartBundle *root, PartGroup *parent,
@@ -93,6 +101,12 @@ protected:
   // set_forced_channel().  It overrides all of the above if set.
   PT(AnimChannelBase) _forced_channel;
 
+  // Beyond this distance from the viewer, the part holds its last value
+  // instead of being animated.  0 means the part is always animated.  _held
+  // is true while the part is being held.
+  PN_stdfloat _hold_distance;
+  bool _held;
+
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
   virtual int complete_pointers(TypedWritable **plist, BamReader *manager);
@@ -118,6 +132,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class AnimProgram;
 };
 
 #include "movingPartBase.I"
@@ -4,6 +4,7 @@
 #include "animChannel.cxx"
 #include "animChannelBase.cxx"
 #include "animChannelFixed.cxx"
+#include "animChannelMatrixCompressed.cxx"
 #include "animChannelMatrixDynamic.cxx"
 #include "animChannelMatrixFixed.cxx"
 #include "animChannelMatrixXfmTable.cxx"
@@ -12,4 +13,5 @@
 #include "animControl.cxx"
 #include "animControlCollection.cxx"
 #include "animGroup.cxx"
+#include "animProgram.cxx"
 
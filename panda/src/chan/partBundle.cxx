@@ -55,6 +55,7 @@ PartBundle(const PartBundle &copy) :
 {
   _anim_preload = copy._anim_preload;
   _update_delay = 0.0;
+  _lod_distance = 0.0f;
 
   CDWriter cdata(_cycler, true);
   CDReader cdata_from(copy._cycler);
@@ -73,6 +74,7 @@ PartBundle(const string &name) :
   PartGroup(name)
 {
   _update_delay = 0.0;
+  _lod_distance = 0.0f;
 }
 
 /**
@@ -484,8 +486,7 @@ update() {
     bool anim_changed = cdata->_anim_changed;
     bool frame_blend_flag = cdata->_frame_blend_flag;
 
-    any_changed = do_update(this, cdata, nullptr, false, anim_changed,
-                            current_thread);
+    any_changed = do_update_parts(cdata, false, anim_changed, current_thread);
 
     // Now update all the controls for next time.
     ChannelBlend::const_iterator cbi;
@@ -509,7 +510,7 @@ bool PartBundle::
 force_update() {
   Thread *current_thread = Thread::get_current_thread();
   CDWriter cdata(_cycler, false, current_thread);
-  bool any_changed = do_update(this, cdata, nullptr, true, true, current_thread);
+  bool any_changed = do_update_parts(cdata, true, true, current_thread);
 
   // Now update all the controls for next time.
   ChannelBlend::const_iterator cbi;
@@ -750,6 +751,33 @@ clear_and_stop_intersecting(AnimControl *control, CData *cdata) {
   }
 }
 
+/**
+ * Updates all of the parts in the bundle for the current frame.  If the
+ * bundle is animated by just one AnimControl, this is done by an AnimProgram
+ * built for that control, which is kept until the animation changes;
+ * otherwise, the part hierarchy is walked with do_update().
+ *
+ * The return value is true if any part has changed, false otherwise.
+ */
+bool PartBundle::
+do_update_parts(CData *cdata, bool parent_changed, bool anim_changed,
+                Thread *current_thread) {
+  if (compile_anim_programs && cdata->_blend.size() == 1 &&
+      !cdata->_frame_blend_flag) {
+    AnimControl *control = (*cdata->_blend.begin()).first;
+    if (cdata->_program == nullptr || cdata->_anim_changed ||
+        cdata->_program->get_control() != control) {
+      cdata->_program = new AnimProgram(this, control);
+    }
+    return cdata->_program->update(this, cdata, parent_changed, anim_changed,
+                                   current_thread);
+  }
+
+  cdata->_program.clear();
+  return do_update(this, cdata, nullptr, parent_changed, anim_changed,
+                   current_thread);
+}
+
 /**
  * Called by the BamReader to perform any final actions needed for setting up
  * the object after all objects have been read and all pointers have been
@@ -858,7 +886,8 @@ CData(const PartBundle::CData &copy) :
   _blend(copy._blend),
   _net_blend(copy._net_blend),
   _anim_changed(copy._anim_changed),
-  _last_update(copy._last_update)
+  _last_update(copy._last_update),
+  _program(copy._program)
 {
   // Note that this copy constructor is not used by the PartBundle copy
   // constructor!  Any elements that must be copied between PartBundles should
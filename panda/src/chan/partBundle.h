@@ -20,6 +20,7 @@
 #include "animControl.h"
 #include "partSubset.h"
 #include "animPreloadTable.h"
+#include "animProgram.h"
 #include "pointerTo.h"
 #include "thread.h"
 #include "cycleData.h"
@@ -142,6 +143,10 @@ PUBLISHED:
   bool control_joint(const std::string &joint_name, PandaNode *node);
   bool release_joint(const std::string &joint_name);
 
+  INLINE void set_lod_distance(PN_stdfloat distance);
+  INLINE PN_stdfloat get_lod_distance() const;
+  MAKE_PROPERTY(lod_distance, get_lod_distance, set_lod_distance);
+
   bool update();
   bool force_update();
 
@@ -166,6 +171,8 @@ private:
   PN_stdfloat do_get_control_effect(AnimControl *control, const CData *cdata) const;
   void recompute_net_blend(CData *cdata);
   void clear_and_stop_intersecting(AnimControl *control, CData *cdata);
+  bool do_update_parts(CData *cdata, bool parent_changed, bool anim_changed,
+                       Thread *current_thread);
 
   COWPT(AnimPreloadTable) _anim_preload;
 
@@ -176,6 +183,7 @@ private:
   AppliedTransforms _applied_transforms;
 
   double _update_delay;
+  PN_stdfloat _lod_distance;
 
   // This is the data that must be cycled between pipeline stages.
   class CData : public CycleData {
@@ -199,6 +207,7 @@ private:
     PN_stdfloat _net_blend;
     bool _anim_changed;
     double _last_update;
+    PT(AnimProgram) _program;
   };
 
   PipelineCycler<CData> _cycler;
@@ -149,6 +149,7 @@ private:
   friend class Character;
   friend class CharacterJointBundle;
   friend class PartBundle;
+  friend class AnimProgram;
 };
 
 #include "partGroup.I"
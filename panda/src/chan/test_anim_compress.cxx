@@ -0,0 +1,220 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_anim_compress.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "pandabase.h"
+#include "partBundle.h"
+#include "partGroup.h"
+#include "partSubset.h"
+#include "movingPartMatrix.h"
+#include "animBundle.h"
+#include "animGroup.h"
+#include "animControl.h"
+#include "animChannelMatrixXfmTable.h"
+#include "animChannelMatrixCompressed.h"
+#include "clockObject.h"
+#include "configVariableBool.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "string_utils.h"
+
+// This program compresses a set of generated, motion-capture-like animations
+// with AnimBundle::copy_bundle_compressed(), and reports the memory saved, the
+// largest error of each kind of component, and the time taken to play the
+// original and the compressed animations, with and without
+// compile-anim-programs.  Build with optimizations, and without _DEBUG, for
+// meaningful timings.
+
+namespace {
+  const int num_joints = 60;
+  const int num_frames = 240;
+}
+
+/**
+ * Appends the indicated group and all of its descendants to the list.
+ */
+static void
+collect_groups(AnimGroup *group, pvector<AnimGroup *> &groups) {
+  groups.push_back(group);
+  int num_children = group->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    collect_groups(group->get_child(i), groups);
+  }
+}
+
+/**
+ * Makes an animation for a chain of joints.  Each table is the sum of two
+ * sinusoids; some of the scale and translation tables are constant.
+ */
+static PT(AnimBundle)
+make_anim(Randomizer &random) {
+  PT(AnimBundle) anim = new AnimBundle("anim", 24, num_frames);
+  AnimGroup *parent = new AnimGroup(anim, "<skeleton>");
+  for (int j = 0; j < num_joints; ++j) {
+    AnimChannelMatrixXfmTable *channel =
+      new AnimChannelMatrixXfmTable(parent, "j" + format_string(j));
+    for (int c = 0; c < 12; ++c) {
+      if (c >= 3 && c < 6) {
+        // No shear.
+        continue;
+      }
+      double amplitude = (c < 3) ? 0.05 : ((c < 9) ? 40.0 : 2.0);
+      double base = (c < 3) ? 1.0 : random.random_real(10.0);
+      double f1 = random.random_real(1.0) + 0.25;
+      double f2 = random.random_real(1.0) + 0.5;
+      double phase = random.random_real(6.0);
+      bool animated = (c >= 6 && c < 9) || random.random_real(1.0) < 0.2;
+
+      PTA_stdfloat table;
+      int size = animated ? num_frames : 1;
+      for (int f = 0; f < size; ++f) {
+        double x = (double)f / num_frames * 2.0 * MathNumbers::pi;
+        table.push_back(base + amplitude * (0.7 * sin(f1 * x + phase) + 0.3 * sin(f2 * x)));
+      }
+      channel->set_table("ijkabchprxyz"[c], table);
+    }
+    parent = channel;
+  }
+  return anim;
+}
+
+/**
+ * Makes a chain of joints to play the animation on.
+ */
+static PT(PartBundle)
+make_bundle() {
+  PT(PartBundle) bundle = new PartBundle("anim");
+  PartGroup *parent = new PartGroup(bundle, "<skeleton>");
+  for (int j = 0; j < num_joints; ++j) {
+    parent = new MovingPartMatrix(parent, "j" + format_string(j), LMatrix4::ident_mat());
+  }
+  return bundle;
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_anims = (argc > 1) ? atoi(argv[1]) : 50;
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+
+  Randomizer random(5);
+  pvector<PT(AnimBundle)> anims;
+  pvector<PT(PartBundle)> bundles;
+  for (int i = 0; i < num_anims; ++i) {
+    anims.push_back(make_anim(random));
+    bundles.push_back(make_bundle());
+  }
+
+  double start = true_clock->get_short_time();
+  pvector<PT(AnimBundle)> compressed;
+  for (PT(AnimBundle) &anim : anims) {
+    compressed.push_back(anim->copy_bundle_compressed());
+  }
+  double elapsed = true_clock->get_short_time() - start;
+  nout << "Compressed " << num_anims * num_joints << " channels in "
+       << elapsed * 1000.0 << " ms\n";
+
+  // Compare the memory used by the tables, and the values of every frame.
+  size_t table_size = 0;
+  size_t compressed_size = 0;
+  double scale_error = 0.0, hpr_error = 0.0, pos_error = 0.0, matrix_error = 0.0;
+  for (int i = 0; i < num_anims; ++i) {
+    pvector<AnimGroup *> sources, channels;
+    collect_groups(anims[i], sources);
+    collect_groups(compressed[i], channels);
+    nassertr(sources.size() == channels.size(), 1);
+
+    for (size_t gi = 0; gi < sources.size(); ++gi) {
+      if (!sources[gi]->is_exact_type(AnimChannelMatrixXfmTable::get_class_type())) {
+        continue;
+      }
+      AnimChannelMatrixXfmTable *source = DCAST(AnimChannelMatrixXfmTable, sources[gi]);
+      AnimChannelMatrixCompressed *channel;
+      DCAST_INTO_R(channel, channels[gi], 1);
+
+      for (int c = 0; c < 12; ++c) {
+        table_size += source->get_table("ijkabchprxyz"[c]).size() * sizeof(PN_stdfloat);
+      }
+      compressed_size += channel->get_data_size();
+
+      for (int f = 0; f < num_frames; ++f) {
+        LVecBase3 a, b;
+        source->get_scale(f, a);
+        channel->get_scale(f, b);
+        for (int k = 0; k < 3; ++k) {
+          scale_error = std::max(scale_error, (double)cabs(a[k] - b[k]));
+        }
+        source->get_hpr(f, a);
+        channel->get_hpr(f, b);
+        for (int k = 0; k < 3; ++k) {
+          hpr_error = std::max(hpr_error, (double)cabs(a[k] - b[k]));
+        }
+        source->get_pos(f, a);
+        channel->get_pos(f, b);
+        for (int k = 0; k < 3; ++k) {
+          pos_error = std::max(pos_error, (double)cabs(a[k] - b[k]));
+        }
+
+        LMatrix4 ma, mb;
+        source->get_value(f, ma);
+        channel->get_value(f, mb);
+        for (int k = 0; k < 16; ++k) {
+          matrix_error = std::max(matrix_error, (double)cabs(ma.get_data()[k] - mb.get_data()[k]));
+        }
+      }
+    }
+  }
+  nout << "Tables: " << table_size << " bytes, compressed: " << compressed_size
+       << " bytes (" << (double)table_size / (double)compressed_size << " to 1)\n"
+       << "Largest error: scale " << scale_error << ", hpr " << hpr_error
+       << ", pos " << pos_error << ", matrix " << matrix_error << "\n";
+
+  // Now time the playback.
+  ClockObject *clock = ClockObject::get_global_clock();
+  clock->set_mode(ClockObject::M_non_real_time);
+  ConfigVariableBool compile_anim_programs("compile-anim-programs");
+  static const char *const names[4] = {
+    "tables, program:     ",
+    "compressed, program: ",
+    "tables, walk:        ",
+    "compressed, walk:    ",
+  };
+  for (int pass = 0; pass < 4; ++pass) {
+    compile_anim_programs.set_value(pass < 2);
+    const pvector<PT(AnimBundle)> &play = (pass & 1) ? compressed : anims;
+
+    pvector<PT(AnimControl)> controls;
+    for (int i = 0; i < num_anims; ++i) {
+      PT(AnimControl) control = bundles[i]->bind_anim(play[i], 0, PartSubset());
+      control->pose(0);
+      bundles[i]->force_update();
+      controls.push_back(control);
+    }
+
+    start = true_clock->get_short_time();
+    for (int frame = 0; frame < 100; ++frame) {
+      clock->tick();
+      for (int i = 0; i < num_anims; ++i) {
+        controls[i]->pose(frame * 1.3);
+        bundles[i]->update();
+      }
+    }
+    elapsed = true_clock->get_short_time() - start;
+    nout << names[pass] << elapsed * 1.0e9 / (100.0 * num_anims * num_joints)
+         << " ns/joint\n";
+
+    for (AnimControl *control : controls) {
+      control->stop();
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,302 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_anim_program.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "pandabase.h"
+#include "partBundle.h"
+#include "partGroup.h"
+#include "partSubset.h"
+#include "movingPartMatrix.h"
+#include "animBundle.h"
+#include "animGroup.h"
+#include "animControl.h"
+#include "animChannelMatrixXfmTable.h"
+#include "clockObject.h"
+#include "configVariableBool.h"
+#include "trueClock.h"
+#include "randomizer.h"
+#include "string_utils.h"
+
+// This program animates two identical skeletons, one with
+// compile-anim-programs turned on (some of the time) and one with it turned
+// off, and checks that they arrive at the same joint values every frame.
+// Afterwards, it reports the time taken per joint by either path.  Build
+// with optimizations, and without _DEBUG, for meaningful timings.
+
+namespace {
+  const int num_joints = 60;
+  const int num_frames = 30;
+
+  // One skeleton, with two animations bound to it.
+  class Rig {
+  public:
+    PT(PartBundle) _bundle;
+    pvector<MovingPartMatrix *> _joints;
+    PT(AnimBundle) _anims[2];
+    PT(AnimControl) _controls[2];
+  };
+
+  int num_failures = 0;
+
+  void
+  check(bool condition, const char *description) {
+    if (!condition) {
+      nout << "FAILED: " << description << "\n";
+      ++num_failures;
+    }
+  }
+}
+
+/**
+ * Returns a table of random values for the indicated component.
+ */
+static PTA_stdfloat
+make_table(Randomizer &random, int component, int size) {
+  PTA_stdfloat table;
+  for (int f = 0; f < size; ++f) {
+    if (component < 3) {
+      table.push_back(1.0f + 0.1f * random.random_real(1.0));
+    } else if (component < 6) {
+      table.push_back(0.0f);
+    } else if (component < 9) {
+      table.push_back(random.random_real(30.0));
+    } else {
+      table.push_back(random.random_real(1.0));
+    }
+  }
+  return table;
+}
+
+/**
+ * Makes an animation for the skeleton.  If skip is nonzero, some of the
+ * joints have no channel at all, so that only part of the skeleton is bound.
+ * Some channels are constant, and some tables are left empty so that the
+ * default value is used.
+ */
+static PT(AnimBundle)
+make_anim(Randomizer &random, int skip) {
+  PT(AnimBundle) anim = new AnimBundle("rig", 24, num_frames);
+  AnimGroup *parent = new AnimGroup(anim, "<skeleton>");
+  for (int j = 0; j < num_joints; ++j) {
+    if (skip != 0 && j % skip == 5) {
+      continue;
+    }
+    std::string name = "j" + format_string(j);
+    AnimChannelMatrixXfmTable *channel = new AnimChannelMatrixXfmTable(parent, name);
+    bool constant = (j % 6 == 2);
+    for (int c = 0; c < 12; ++c) {
+      if (c == 3 || (c == 10 && j % 3 == 0)) {
+        continue;
+      }
+      int size = 1;
+      if (!constant && ((c >= 6 && c < 9) || (c == 11 && j % 4 == 1))) {
+        size = num_frames;
+      }
+      channel->set_table("ijkabchprxyz"[c], make_table(random, c, size));
+    }
+    if (j % 4 != 3) {
+      parent = channel;
+    }
+  }
+  return anim;
+}
+
+/**
+ * Makes a skeleton with some siblings and some non-moving groups, and binds
+ * two animations to it.  The random seed determines the animations, so two
+ * rigs made with the same arguments are the same.
+ */
+static Rig
+make_rig(int seed, int skip) {
+  Randomizer random(seed + 1);
+  Rig rig;
+  rig._bundle = new PartBundle("rig");
+  PartGroup *parent = new PartGroup(rig._bundle, "<skeleton>");
+  for (int j = 0; j < num_joints; ++j) {
+    std::string name = "j" + format_string(j);
+    MovingPartMatrix *joint =
+      new MovingPartMatrix(parent, name, LMatrix4::translate_mat(0, 0, 1));
+    rig._joints.push_back(joint);
+    if (j % 4 != 3) {
+      parent = joint;
+    }
+    if (j % 10 == 9) {
+      new PartGroup(joint, "group" + name);
+    }
+  }
+
+  int hierarchy_match_flags =
+    PartGroup::HMF_ok_part_extra | PartGroup::HMF_ok_anim_extra;
+  for (int a = 0; a < 2; ++a) {
+    rig._anims[a] = make_anim(random, a == 0 ? skip : 0);
+    rig._controls[a] = rig._bundle->bind_anim(rig._anims[a], hierarchy_match_flags, PartSubset());
+  }
+  rig._controls[0]->pose(0);
+  return rig;
+}
+
+/**
+ * Returns the largest difference between the joint values of the two rigs.
+ */
+static double
+max_difference(const Rig &a, const Rig &b) {
+  double result = 0.0;
+  for (int j = 0; j < num_joints; ++j) {
+    LMatrix4 ma = a._joints[j]->get_value();
+    LMatrix4 mb = b._joints[j]->get_value();
+    for (int k = 0; k < 16; ++k) {
+      result = std::max(result, (double)cabs(ma.get_data()[k] - mb.get_data()[k]));
+    }
+  }
+  return result;
+}
+
+/**
+ * Makes the same change to the indicated rig for the indicated frame.  Every
+ * ten frames, the rig switches between playing one animation, blending two,
+ * and playing the other; in between, joints are frozen and released, tables
+ * are replaced and the same frame is held for a while.
+ */
+static void
+change_rig(Rig &rig, int index, int frame) {
+  PartBundle *bundle = rig._bundle;
+  int phase = (frame / 10) % 4;
+  if (frame % 10 == 0) {
+    switch (phase) {
+    case 0:
+      rig._controls[0]->pose(0);
+      break;
+
+    case 1:
+      bundle->set_anim_blend_flag(true);
+      rig._controls[1]->pose(3);
+      bundle->set_control_effect(rig._controls[0], 0.5);
+      bundle->set_control_effect(rig._controls[1], 0.5);
+      break;
+
+    case 2:
+      bundle->set_control_effect(rig._controls[1], 0.0);
+      break;
+
+    case 3:
+      bundle->set_anim_blend_flag(false);
+      rig._controls[1]->pose(1);
+      break;
+    }
+  }
+
+  // Force a joint to a fixed value, and later let it go again.
+  if (index % 5 == 0 && frame % 10 == 3) {
+    if (phase == 0 || phase == 2) {
+      bundle->freeze_joint("j7", LVecBase3(1, 2, 3), LVecBase3(10, 20, 30), LVecBase3(1, 1, 1));
+    } else {
+      bundle->release_joint("j7");
+    }
+  }
+
+  // Replace a table of a channel that the program has already been built
+  // for.
+  if (index % 4 == 1 && frame % 10 == 6) {
+    AnimBundle *anim = rig._anims[phase == 3 ? 1 : 0];
+    AnimChannelMatrixXfmTable *channel =
+      DCAST(AnimChannelMatrixXfmTable, anim->find_child("j12"));
+    Randomizer random(frame);
+    channel->set_table('h', make_table(random, 6, num_frames));
+    channel->set_table('x', make_table(random, 9, 1));
+  }
+
+  // Hold the same frame for a while now and then.
+  if (frame % 7 != 0 && frame % 10 < 8) {
+    AnimControl *control = rig._controls[phase == 3 ? 1 : 0];
+    control->pose(frame * 1.7 + index % 7);
+  }
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_rigs = (argc > 1) ? atoi(argv[1]) : 50;
+  ConfigVariableBool compile_anim_programs("compile-anim-programs");
+
+  // Each rig in tested has an identical twin in expected, which is always
+  // updated without a program.  A third of them are only partly bound.
+  pvector<Rig> tested, expected;
+  for (int i = 0; i < num_rigs; ++i) {
+    int skip = (i % 3 == 0) ? 9 : 0;
+    tested.push_back(make_rig(i, skip));
+    expected.push_back(make_rig(i, skip));
+  }
+
+  ClockObject *clock = ClockObject::get_global_clock();
+  clock->set_mode(ClockObject::M_non_real_time);
+  clock->set_frame_rate(24);
+
+  double worst = 0.0;
+  for (int frame = 0; frame < 80; ++frame) {
+    clock->tick();
+    for (int i = 0; i < num_rigs; ++i) {
+      change_rig(tested[i], i, frame);
+      change_rig(expected[i], i, frame);
+    }
+
+    // Switch the programs off for a few frames in the middle.
+    compile_anim_programs.set_value(frame < 45 || frame >= 50);
+    for (Rig &rig : tested) {
+      rig._bundle->update();
+    }
+    compile_anim_programs.set_value(false);
+    for (Rig &rig : expected) {
+      rig._bundle->update();
+    }
+
+    for (int i = 0; i < num_rigs; ++i) {
+      double difference = max_difference(tested[i], expected[i]);
+      worst = std::max(worst, difference);
+      if (!(difference < 1.0e-4)) {
+        nout << "frame " << frame << ", rig " << i << ": difference "
+             << difference << "\n";
+        check(false, "program gives the same joint values as the walk");
+        break;
+      }
+    }
+  }
+  nout << "Largest difference: " << worst << "\n";
+
+  // Now time the common case: a single animation playing on every rig.
+  TrueClock *true_clock = TrueClock::get_global_ptr();
+  for (int pass = 0; pass < 2; ++pass) {
+    compile_anim_programs.set_value(pass == 0);
+    for (Rig &rig : tested) {
+      rig._bundle->set_control_effect(rig._controls[1], 0.0);
+      rig._controls[0]->pose(0);
+      rig._bundle->update();
+    }
+
+    double start = true_clock->get_short_time();
+    for (int frame = 0; frame < 50; ++frame) {
+      clock->tick();
+      for (Rig &rig : tested) {
+        rig._controls[0]->pose(frame * 1.3);
+        rig._bundle->update();
+      }
+    }
+    double elapsed = true_clock->get_short_time() - start;
+    nout << (pass == 0 ? "program: " : "walk:    ")
+         << elapsed * 1.0e9 / (50.0 * num_rigs * num_joints) << " ns/joint\n";
+  }
+
+  if (num_failures != 0) {
+    nout << num_failures << " checks failed.\n";
+    return 1;
+  }
+  nout << "All checks passed.\n";
+  return 0;
+}
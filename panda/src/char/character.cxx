@@ -27,10 +27,23 @@
 #include "camera.h"
 #include "cullTraverser.h"
 #include "cullTraverserData.h"
+#include "characterUpdateManager.h"
+#include "workerPool.h"
+#include "lens.h"
+#include "boundingSphere.h"
+#include "finiteBoundingVolume.h"
+#include "lightMutexHolder.h"
+#include "deg_2_rad.h"
 
 TypeHandle Character::_type_handle;
 
 PStatCollector Character::_animation_pcollector("*:Animation");
+PStatCollector Character::_lod_full_pcollector("Characters:Full");
+PStatCollector Character::_lod_reduced_rate_pcollector("Characters:Reduced rate");
+PStatCollector Character::_lod_held_parts_pcollector("Characters:Held parts");
+PStatCollector Character::_lod_frozen_pcollector("Characters:Frozen");
+LightMutex Character::_lod_count_lock;
+int Character::_lod_count_frame_all = -1;
 
 /**
  * Use make_copy() or copy_subgraph() to copy a Character.
@@ -43,6 +56,12 @@ Character(const Character &copy, bool copy_bundles) :
   _lod_near_distance(copy._lod_near_distance),
   _lod_delay_factor(copy._lod_delay_factor),
   _do_lod_animation(copy._do_lod_animation),
+  _lod_min_hold_distance(copy._lod_min_hold_distance),
+  _lod_freeze_size(copy._lod_freeze_size),
+  _do_lod_detail(copy._do_lod_detail),
+  _lod_level(LL_full),
+  _skinning_frozen(false),
+  _lod_count_frame(-1),
   _joints_pcollector(copy._joints_pcollector),
   _skinning_pcollector(copy._skinning_pcollector)
 {
@@ -67,6 +86,11 @@ Character(const Character &copy, bool copy_bundles) :
   _last_auto_update = -1.0;
   _view_frame = -1;
   _view_distance2 = 0.0f;
+  _view_screen_size = 0.0f;
+  _last_view_frame = -1;
+  _last_view_distance2 = 0.0f;
+  _last_view_screen_size = 0.0f;
+  _visible_frame = -1;
 }
 
 /**
@@ -80,9 +104,20 @@ Character(const std::string &name) :
 {
   set_cull_callback();
   clear_lod_animation();
+  _lod_min_hold_distance = 0.0f;
+  _lod_freeze_size = 0.0f;
+  _do_lod_detail = false;
+  _lod_level = LL_full;
+  _skinning_frozen = false;
+  _lod_count_frame = -1;
   _last_auto_update = -1.0;
   _view_frame = -1;
   _view_distance2 = 0.0f;
+  _view_screen_size = 0.0f;
+  _last_view_frame = -1;
+  _last_view_distance2 = 0.0f;
+  _last_view_screen_size = 0.0f;
+  _visible_frame = -1;
 }
 
 /**
@@ -168,36 +203,48 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
   // We may need a better way to do this optimization later, to handle
   // characters that might animate themselves in front of the view frustum.
 
-  if (_do_lod_animation) {
-    int this_frame = ClockObject::get_global_clock()->get_frame_count();
+  int this_frame = ClockObject::get_global_clock()->get_frame_count();
 
+  if (_do_lod_animation || _do_lod_detail) {
+    // Only note how this camera sees the character here.  If several cameras
+    // see it, the level of detail is decided from the closest of them, once
+    // per frame, when the character is updated; see apply_lod_view().
     CPT(TransformState) rel_transform = get_rel_transform(trav, data);
     LPoint3 center = _lod_center * rel_transform->get_mat();
     PN_stdfloat dist2 = center.dot(center);
+    PN_stdfloat screen_size = 0.0f;
+    if (_do_lod_detail && _lod_freeze_size > 0.0f) {
+      screen_size = get_screen_size(trav, rel_transform, csqrt(dist2));
+    }
 
-    if (this_frame != _view_frame || dist2 < _view_distance2) {
+    if (this_frame != _view_frame) {
+      _last_view_frame = _view_frame;
+      _last_view_distance2 = _view_distance2;
+      _last_view_screen_size = _view_screen_size;
       _view_frame = this_frame;
       _view_distance2 = dist2;
-
-      // Now compute the lod delay.
-      PN_stdfloat dist = sqrt(dist2);
-      double delay = 0.0;
-      if (dist > _lod_near_distance) {
-        delay = _lod_delay_factor * (dist - _lod_near_distance) / (_lod_far_distance - _lod_near_distance);
-        nassertr(delay > 0.0, false);
-      }
-      set_lod_current_delay(delay);
-
-      if (char_cat.is_spam()) {
-        char_cat.spam()
-          << "Distance to " << NodePath::any_path(this) << " in frame "
-          << this_frame << " is " << dist << ", computed delay is " << delay
-          << "\n";
-      }
+      _view_screen_size = screen_size;
+    } else {
+      _view_distance2 = std::min(_view_distance2, (double)dist2);
+      _view_screen_size = std::max(_view_screen_size, screen_size);
     }
   }
 
+  if (parallel_character_update &&
+      WorkerPool::get_global_ptr()->get_num_threads() > 0) {
+    CharacterUpdateManager::get_global_ptr()->
+      cull_character(this, trav->get_current_thread());
+  }
+
   update();
+
+#ifdef DO_PSTATS
+  // This is counted after the update, which decides the level of detail.
+  if (_lod_full_pcollector.is_active()) {
+    count_lod(this_frame);
+  }
+#endif
+
   return true;
 }
 
@@ -349,6 +396,52 @@ clear_lod_animation() {
   set_lod_current_delay(0.0);
 }
 
+/**
+ * Specifies that the named joint or slider need not be animated when the
+ * character is farther than the indicated distance from the camera.  Beyond
+ * this distance, the part holds whatever value it had, while the joints below
+ * it continue to animate relative to it; this is intended for small details,
+ * such as fingers or facial sliders, that cannot be seen at a distance.
+ *
+ * The distance is measured in the same way as for set_lod_animation(), and a
+ * distance of 0 means to always animate the part.  Returns true if the part
+ * was found, false otherwise.
+ */
+bool Character::
+set_lod_hold_distance(const std::string &part_name, PN_stdfloat distance) {
+  nassertr(distance >= 0.0f, false);
+
+  bool found_any = false;
+  int num_bundles = get_num_bundles();
+  for (int i = 0; i < num_bundles; ++i) {
+    PartGroup *part = get_bundle(i)->find_child(part_name);
+    if (part != nullptr && part->is_of_type(MovingPartBase::get_class_type())) {
+      DCAST(MovingPartBase, part)->set_hold_distance(distance);
+      found_any = true;
+    }
+  }
+
+  update_lod_detail();
+  return found_any;
+}
+
+/**
+ * Specifies that the character should stop updating its skinned vertices
+ * when it covers less than the indicated fraction of the height of the
+ * screen.  The joints are still animated, so that anything exposed on them
+ * still moves, but the vertices keep the shape they had until the character
+ * is seen larger again.  A size of 0 means the skinning is never frozen.
+ *
+ * The size of the character is measured from its bounding volume, as seen
+ * from the same point that is used for set_lod_animation().
+ */
+void Character::
+set_lod_freeze_size(PN_stdfloat screen_size) {
+  nassertv(screen_size >= 0.0f);
+  _lod_freeze_size = screen_size;
+  update_lod_detail();
+}
+
 /**
  * Returns a pointer to the joint with the given name, if there is such a
  * joint, or NULL if there is no such joint.  This will not return a pointer
@@ -564,6 +657,10 @@ get_rel_transform(CullTraverser *trav, CullTraverserData &data) {
  */
 void Character::
 do_update() {
+  if (_do_lod_animation || _do_lod_detail) {
+    apply_lod_view();
+  }
+
   // Update all the joints and sliders.
   if (even_animation) {
     int num_bundles = get_num_bundles();
@@ -578,6 +675,74 @@ do_update() {
   }
 }
 
+/**
+ * Decides the level of detail of the character for the current frame, from
+ * the closest view that any camera had of it.  This is called once per frame,
+ * before the bundles are updated.
+ *
+ * The update happens when the first camera sees the character, before the
+ * other cameras have, so the view of the previous frame is used if the
+ * character was seen then.  Otherwise, the character has just come into
+ * view, and whatever has seen it so far in this frame is used.  Since the
+ * decision is made only once per frame, the skinning is not frozen and thawed
+ * again within a frame, when the cameras disagree.
+ */
+void Character::
+apply_lod_view() {
+  int this_frame = ClockObject::get_global_clock()->get_frame_count();
+
+  double dist2;
+  PN_stdfloat screen_size;
+  if (_view_frame == this_frame - 1) {
+    dist2 = _view_distance2;
+    screen_size = _view_screen_size;
+  } else if (_view_frame == this_frame && _last_view_frame == this_frame - 1) {
+    dist2 = _last_view_distance2;
+    screen_size = _last_view_screen_size;
+  } else if (_view_frame == this_frame) {
+    dist2 = _view_distance2;
+    screen_size = _view_screen_size;
+  } else {
+    // The character hasn't been seen lately; leave it as it was.
+    return;
+  }
+
+  // Now compute the lod delay.
+  PN_stdfloat dist = csqrt(dist2);
+  double delay = 0.0;
+  if (_do_lod_animation && dist > _lod_near_distance) {
+    delay = _lod_delay_factor * (dist - _lod_near_distance) / (_lod_far_distance - _lod_near_distance);
+    nassertv(delay > 0.0);
+  }
+  if (_do_lod_animation) {
+    set_lod_current_delay(delay);
+  }
+
+  _lod_level = (delay > 0.0) ? LL_reduced_rate : LL_full;
+
+  if (_do_lod_detail) {
+    // Tell the bundles how far away we are, so that the parts with a hold
+    // distance can decide whether to skip their animation.
+    set_lod_current_distance(dist);
+    if (_lod_min_hold_distance > 0.0f && dist > _lod_min_hold_distance) {
+      _lod_level = LL_held_parts;
+    }
+
+    bool frozen = (_lod_freeze_size > 0.0f && screen_size < _lod_freeze_size);
+    set_skinning_frozen(frozen, Thread::get_current_thread());
+    if (frozen) {
+      _lod_level = LL_frozen;
+    }
+  }
+
+  if (char_cat.is_spam()) {
+    char_cat.spam()
+      << "Distance to " << NodePath::any_path(this) << " in frame "
+      << this_frame << " is " << dist << ", computed delay is " << delay
+      << ", lod level is " << (int)_lod_level << "\n";
+  }
+}
+
 /**
  * Changes the amount of delay we should impose due to the LOD animation
  * setting.
@@ -590,6 +755,181 @@ set_lod_current_delay(double delay) {
   }
 }
 
+/**
+ * Tells the bundles how far away the character is from the camera, for the
+ * benefit of the parts that have a hold distance.
+ */
+void Character::
+set_lod_current_distance(PN_stdfloat distance) {
+  int num_bundles = get_num_bundles();
+  for (int i = 0; i < num_bundles; ++i) {
+    get_bundle(i)->set_lod_distance(distance);
+  }
+}
+
+/**
+ * Freezes or unfreezes the skinned vertices of the character.  When they are
+ * unfrozen, the skinning matrices are brought up to date with the joints.
+ */
+void Character::
+set_skinning_frozen(bool frozen, Thread *current_thread) {
+  if (frozen == _skinning_frozen) {
+    return;
+  }
+  _skinning_frozen = frozen;
+
+  if (!frozen) {
+    int num_bundles = get_num_bundles();
+    for (int i = 0; i < num_bundles; ++i) {
+      r_thaw_skinning(get_bundle(i), current_thread);
+    }
+  }
+}
+
+/**
+ * Returns the approximate fraction of the height of the screen that is
+ * covered by the character's bounding volume, which is dist units away from
+ * the camera.
+ */
+PN_stdfloat Character::
+get_screen_size(CullTraverser *trav, const TransformState *rel_transform,
+                PN_stdfloat distance) const {
+  const Lens *lens = trav->get_scene()->get_lens();
+  if (lens == nullptr) {
+    return 1.0f;
+  }
+
+  CPT(BoundingVolume) bounds = get_bounds(trav->get_current_thread());
+  PN_stdfloat radius;
+  const BoundingSphere *sphere = bounds->as_bounding_sphere();
+  if (sphere != nullptr) {
+    radius = sphere->get_radius();
+  } else {
+    const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+    if (fbv == nullptr) {
+      // Empty or infinite.
+      return bounds->is_empty() ? 0.0f : 1.0f;
+    }
+    radius = (fbv->get_max() - fbv->get_min()).length() * 0.5f;
+  }
+
+  // Account for any scale on the character.
+  const LMatrix4 &mat = rel_transform->get_mat();
+  PN_stdfloat scale = std::max(std::max(mat.get_row3(0).length(),
+                                        mat.get_row3(1).length()),
+                               mat.get_row3(2).length());
+  radius *= scale;
+
+  if (lens->is_perspective()) {
+    if (distance <= radius) {
+      // The camera is within the character.
+      return 1.0f;
+    }
+    PN_stdfloat half_height = distance * ctan(deg_2_rad(lens->get_vfov() * 0.5f));
+    return radius / half_height;
+  } else {
+    return radius * 2.0f / lens->get_film_size()[1];
+  }
+}
+
+/**
+ * Counts the character's current level of detail in the PStats levels, once
+ * per frame.
+ */
+void Character::
+count_lod(int frame) {
+  if (frame == _lod_count_frame) {
+    return;
+  }
+  _lod_count_frame = frame;
+
+  LightMutexHolder holder(_lod_count_lock);
+  if (frame != _lod_count_frame_all) {
+    // This is the first character counted this frame.
+    _lod_count_frame_all = frame;
+    _lod_full_pcollector.clear_level();
+    _lod_reduced_rate_pcollector.clear_level();
+    _lod_held_parts_pcollector.clear_level();
+    _lod_frozen_pcollector.clear_level();
+  }
+
+  switch (_lod_level) {
+  case LL_full:
+    _lod_full_pcollector.add_level(1);
+    break;
+
+  case LL_reduced_rate:
+    _lod_reduced_rate_pcollector.add_level(1);
+    break;
+
+  case LL_held_parts:
+    _lod_held_parts_pcollector.add_level(1);
+    break;
+
+  case LL_frozen:
+    _lod_frozen_pcollector.add_level(1);
+    break;
+  }
+}
+
+/**
+ * Recomputes _do_lod_detail after the hold distances or the freeze size have
+ * changed.
+ */
+void Character::
+update_lod_detail() {
+  PN_stdfloat min_distance = 0.0f;
+  int num_bundles = get_num_bundles();
+  for (int i = 0; i < num_bundles; ++i) {
+    r_update_lod_detail(get_bundle(i), min_distance);
+  }
+  _lod_min_hold_distance = min_distance;
+  _do_lod_detail = (_lod_min_hold_distance > 0.0f || _lod_freeze_size > 0.0f);
+
+  if (!_do_lod_detail) {
+    set_lod_current_distance(0.0f);
+    set_skinning_frozen(false, Thread::get_current_thread());
+  }
+
+  // Make sure the new settings are applied from the next time we are seen.
+  _view_frame = -1;
+  _last_view_frame = -1;
+}
+
+/**
+ * Recursively finds the smallest nonzero hold distance of any part.
+ */
+void Character::
+r_update_lod_detail(PartGroup *part, PN_stdfloat &min_distance) {
+  if (part->is_of_type(MovingPartBase::get_class_type())) {
+    PN_stdfloat distance = DCAST(MovingPartBase, part)->get_hold_distance();
+    if (distance > 0.0f && (min_distance == 0.0f || distance < min_distance)) {
+      min_distance = distance;
+    }
+  }
+
+  int num_children = part->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_update_lod_detail(part->get_child(i), min_distance);
+  }
+}
+
+/**
+ * Recursively brings the skinning matrices of the joints up to date, after
+ * the skinning has been frozen for a time.
+ */
+void Character::
+r_thaw_skinning(PartGroup *part, Thread *current_thread) {
+  if (part->is_character_joint()) {
+    DCAST(CharacterJoint, part)->update_skinning_matrix(current_thread);
+  }
+
+  int num_children = part->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_thaw_skinning(part->get_child(i), current_thread);
+  }
+}
+
 /**
  * After the joint hierarchy has already been copied from the indicated
  * hierarchy, this recursively walks through the joints and builds up a
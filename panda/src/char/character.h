@@ -28,6 +28,7 @@
 #include "transformTable.h"
 #include "transformBlendTable.h"
 #include "sliderTable.h"
+#include "lightMutex.h"
 
 class CharacterJointBundle;
 
@@ -68,6 +69,11 @@ PUBLISHED:
                          PN_stdfloat delay_factor);
   void clear_lod_animation();
 
+  bool set_lod_hold_distance(const std::string &part_name, PN_stdfloat distance);
+  void set_lod_freeze_size(PN_stdfloat screen_size);
+  INLINE PN_stdfloat get_lod_freeze_size() const;
+  INLINE bool is_skinning_frozen() const;
+
   CharacterJoint *find_joint(const std::string &name) const;
   CharacterSlider *find_slider(const std::string &name) const;
 
@@ -87,7 +93,17 @@ protected:
 
 private:
   void do_update();
+  void apply_lod_view();
   void set_lod_current_delay(double delay);
+  void set_lod_current_distance(PN_stdfloat distance);
+  void set_skinning_frozen(bool frozen, Thread *current_thread);
+  PN_stdfloat get_screen_size(CullTraverser *trav,
+                              const TransformState *rel_transform,
+                              PN_stdfloat distance) const;
+  void count_lod(int frame);
+  void update_lod_detail();
+  static void r_update_lod_detail(PartGroup *part, PN_stdfloat &min_distance);
+  static void r_thaw_skinning(PartGroup *part, Thread *current_thread);
 
   typedef pmap<const PandaNode *, PandaNode *> NodeMap;
   typedef pmap<const PartGroup *, PartGroup *> JointMap;
@@ -132,8 +148,20 @@ private:
 
   double _last_auto_update;
 
+  // The closest distance to, and the largest size on the screen of, the
+  // character as seen by any camera in _view_frame, and the same for the
+  // frame in which it was seen before that.  The level of detail is decided
+  // from these once per frame, by apply_lod_view().
   int _view_frame;
   double _view_distance2;
+  PN_stdfloat _view_screen_size;
+  int _last_view_frame;
+  double _last_view_distance2;
+  PN_stdfloat _last_view_screen_size;
+
+  // The last frame in which the CharacterUpdateManager was told that this
+  // Character is visible.  This is protected by the manager's lock.
+  int _visible_frame;
 
   LPoint3 _lod_center;
   PN_stdfloat _lod_far_distance;
@@ -141,10 +169,33 @@ private:
   PN_stdfloat _lod_delay_factor;
   bool _do_lod_animation;
 
+  // These implement the finer levels of detail: the parts that hold their
+  // values beyond a certain distance, and freezing the skinning when the
+  // character is too small on screen to see it move.
+  PN_stdfloat _lod_min_hold_distance;
+  PN_stdfloat _lod_freeze_size;
+  bool _do_lod_detail;
+
+  enum LODLevel {
+    LL_full,
+    LL_reduced_rate,
+    LL_held_parts,
+    LL_frozen,
+  };
+  LODLevel _lod_level;
+  bool _skinning_frozen;
+  int _lod_count_frame;
+
   // Statistics
   PStatCollector _joints_pcollector;
   PStatCollector _skinning_pcollector;
   static PStatCollector _animation_pcollector;
+  static PStatCollector _lod_full_pcollector;
+  static PStatCollector _lod_reduced_rate_pcollector;
+  static PStatCollector _lod_held_parts_pcollector;
+  static PStatCollector _lod_frozen_pcollector;
+  static LightMutex _lod_count_lock;
+  static int _lod_count_frame_all;
 
   // This variable is only used temporarily, while reading from the bam file.
   unsigned int _temp_num_parts;
@@ -175,6 +226,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class CharacterUpdateManager;
 };
 
 #include "character.I"
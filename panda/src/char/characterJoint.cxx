@@ -14,6 +14,7 @@
 #include "characterJoint.h"
 #include "config_char.h"
 #include "jointVertexTransform.h"
+#include "character.h"
 #include "characterJointEffect.h"
 #include "datagram.h"
 #include "datagramIterator.h"
@@ -145,14 +146,11 @@ update_internals(PartBundle *root, PartGroup *parent, bool self_changed,
       }
     }
 
-    // Recompute the transform used by any vertices animated by this joint.
-    _skinning_matrix = _initial_net_transform_inverse * _net_transform;
-
-    // Also tell our related JointVertexTransforms that we've changed their
-    // underlying matrix.
-    VertexTransforms::iterator vti;
-    for (vti = _vertex_transforms.begin(); vti != _vertex_transforms.end(); ++vti) {
-      (*vti)->mark_modified(current_thread);
+    // Recompute the transform used by any vertices animated by this joint,
+    // unless the character is too small on screen for this to be worthwhile;
+    // the character will catch up when it is unfrozen.
+    if (_character == nullptr || !_character->is_skinning_frozen()) {
+      update_skinning_matrix(current_thread);
     }
   }
 
@@ -171,6 +169,22 @@ update_internals(PartBundle *root, PartGroup *parent, bool self_changed,
   return self_changed || net_changed;
 }
 
+/**
+ * Recomputes the matrix used by any vertices animated by this joint from the
+ * joint's current net transform.
+ */
+void CharacterJoint::
+update_skinning_matrix(Thread *current_thread) {
+  _skinning_matrix = _initial_net_transform_inverse * _net_transform;
+
+  // Also tell our related JointVertexTransforms that we've changed their
+  // underlying matrix.
+  VertexTransforms::iterator vti;
+  for (vti = _vertex_transforms.begin(); vti != _vertex_transforms.end(); ++vti) {
+    (*vti)->mark_modified(current_thread);
+  }
+}
+
 /**
  * Called by PartBundle::xform(), this indicates the indicated transform is
  * being applied to the root joint.
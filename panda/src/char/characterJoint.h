@@ -72,6 +72,7 @@ PUBLISHED:
 
 private:
   void set_character(Character *character);
+  void update_skinning_matrix(Thread *current_thread);
 
 private:
   // Not a reference-counted pointer.
@@ -0,0 +1,241 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file characterUpdateManager.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "characterUpdateManager.h"
+#include "config_char.h"
+#include "clockObject.h"
+#include "lightMutexHolder.h"
+#include "mutexHolder.h"
+#include "pStatTimer.h"
+#include "workerPool.h"
+#include "pmap.h"
+
+AtomicAdjust::Pointer CharacterUpdateManager::_global_ptr = nullptr;
+Mutex CharacterUpdateManager::_global_lock("CharacterUpdateManager::_global_lock");
+PStatCollector CharacterUpdateManager::_update_pcollector("*:Animation:Parallel update");
+
+/**
+ * Updates each of the Characters in one group of Characters that share their
+ * PartBundles.
+ */
+class CharacterUpdateManager::UpdateJob : public WorkerPool::Job {
+public:
+  virtual void run_item(size_t index, Thread *current_thread);
+
+  typedef pvector<PT(Character)> Group;
+  pvector<Group> _groups;
+};
+
+/**
+ *
+ */
+CharacterUpdateManager::
+CharacterUpdateManager() :
+  _frame(-1)
+{
+}
+
+/**
+ * Adds the indicated Character to the set of Characters that will be updated
+ * by the next call to update().  It is not an error to add the same Character
+ * more than once.
+ */
+void CharacterUpdateManager::
+add_character(Character *character) {
+  nassertv(character != nullptr);
+  LightMutexHolder holder(_lock);
+  _characters.push_back(character);
+}
+
+/**
+ * Returns the number of Characters that have been added with add_character()
+ * and not yet updated.
+ */
+int CharacterUpdateManager::
+get_num_characters() const {
+  LightMutexHolder holder(_lock);
+  return (int)_characters.size();
+}
+
+/**
+ * Removes all of the Characters that have been added with add_character(),
+ * without updating them.
+ */
+void CharacterUpdateManager::
+clear() {
+  LightMutexHolder holder(_lock);
+  _characters.clear();
+}
+
+/**
+ * Updates all of the Characters that have been added with add_character(),
+ * and then removes them.  The update is distributed over the threads of the
+ * WorkerPool, and this method returns when it is complete.  As with
+ * Character::update(), a Character that has already been updated this frame
+ * is not updated again.
+ *
+ * The return value is the number of different Characters that were
+ * considered.
+ */
+int CharacterUpdateManager::
+update(Thread *current_thread) {
+  LightMutexHolder holder(_lock);
+  Characters characters;
+  characters.swap(_characters);
+  return do_update(characters, current_thread);
+}
+
+/**
+ * Returns the global CharacterUpdateManager, which is used by the cull
+ * traversal.
+ */
+CharacterUpdateManager *CharacterUpdateManager::
+get_global_ptr() {
+  // This may be called first by several cull threads at once.
+  CharacterUpdateManager *mgr =
+    (CharacterUpdateManager *)AtomicAdjust::get_ptr(_global_ptr);
+  if (mgr == nullptr) {
+    MutexHolder holder(_global_lock);
+    mgr = (CharacterUpdateManager *)AtomicAdjust::get_ptr(_global_ptr);
+    if (mgr == nullptr) {
+      mgr = new CharacterUpdateManager;
+      AtomicAdjust::set_ptr(_global_ptr, mgr);
+    }
+  }
+  return mgr;
+}
+
+/**
+ * Called by Character::cull_callback() when parallel-character-update is in
+ * effect, before the Character updates itself.  If this is the first
+ * Character to be visited this frame, this first updates all of the
+ * Characters that were visible in the previous frame, as well as any that
+ * were added with add_character().  Other threads that reach this point in
+ * the meantime wait for that update to finish.
+ */
+void CharacterUpdateManager::
+cull_character(Character *character, Thread *current_thread) {
+  int frame = ClockObject::get_global_clock()->get_frame_count(current_thread);
+
+  LightMutexHolder holder(_lock);
+  if (frame != _frame) {
+    _frame = frame;
+
+    Characters characters;
+    characters.swap(_visible);
+    characters.insert(characters.end(), _characters.begin(), _characters.end());
+    _characters.clear();
+    do_update(characters, current_thread);
+  }
+
+  // A Character may be visited once for each camera that sees it, but it
+  // only needs to be remembered once.
+  if (character->_visible_frame != frame) {
+    character->_visible_frame = frame;
+    _visible.push_back(character);
+  }
+}
+
+/**
+ * The implementation of update().  Assumes the lock is held.
+ */
+int CharacterUpdateManager::
+do_update(Characters &characters, Thread *current_thread) {
+  if (characters.empty()) {
+    return 0;
+  }
+
+  PStatTimer timer(_update_pcollector, current_thread);
+
+  // Sort the Characters into groups, such that any two Characters that share
+  // a PartBundle end up in the same group, since a PartBundle may only be
+  // updated by one thread at a time.  Each group starts out on its own, and
+  // the groups are merged whenever a PartBundle turns out to be shared.
+  typedef pmap<Character *, int> Indices;
+  typedef pmap<PartBundle *, int> BundleGroups;
+  Indices indices;
+  BundleGroups bundle_groups;
+  pvector<PT(Character)> chars;
+  pvector<int> parent;
+
+  for (const WPT(Character) &wp : characters) {
+    PT(Character) character = wp.lock();
+    if (character == nullptr ||
+        !indices.insert(Indices::value_type(character, (int)chars.size())).second) {
+      continue;
+    }
+    int index = (int)chars.size();
+    chars.push_back(character);
+    parent.push_back(index);
+
+    int num_bundles = character->get_num_bundles();
+    for (int i = 0; i < num_bundles; ++i) {
+      PartBundle *bundle = character->get_bundle(i);
+      std::pair<BundleGroups::iterator, bool> result =
+        bundle_groups.insert(BundleGroups::value_type(bundle, index));
+      if (!result.second) {
+        // Another Character already has this bundle; join its group.
+        int a = (*result.first).second;
+        while (parent[a] != a) {
+          a = parent[a];
+        }
+        int b = index;
+        while (parent[b] != b) {
+          b = parent[b];
+        }
+        parent[std::max(a, b)] = std::min(a, b);
+      }
+    }
+  }
+
+  UpdateJob job;
+  pvector<int> group_index(chars.size(), -1);
+  for (size_t i = 0; i < chars.size(); ++i) {
+    int root = (int)i;
+    while (parent[root] != root) {
+      root = parent[root];
+    }
+    if (group_index[root] < 0) {
+      group_index[root] = (int)job._groups.size();
+      job._groups.push_back(UpdateJob::Group());
+    }
+    job._groups[group_index[root]].push_back(chars[i]);
+  }
+
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  if (pool->get_num_threads() > 0 && job._groups.size() > 1) {
+    pool->run(job, job._groups.size(), current_thread);
+  } else {
+    for (size_t gi = 0; gi < job._groups.size(); ++gi) {
+      job.run_item(gi, current_thread);
+    }
+  }
+
+  if (char_cat.is_debug()) {
+    char_cat.debug()
+      << "Updated " << chars.size() << " characters in "
+      << job._groups.size() << " groups\n";
+  }
+
+  return (int)chars.size();
+}
+
+/**
+ *
+ */
+void CharacterUpdateManager::UpdateJob::
+run_item(size_t index, Thread *current_thread) {
+  for (Character *character : _groups[index]) {
+    character->update();
+  }
+}
@@ -0,0 +1,73 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file characterUpdateManager.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef CHARACTERUPDATEMANAGER_H
+#define CHARACTERUPDATEMANAGER_H
+
+#include "pandabase.h"
+#include "character.h"
+#include "weakPointerTo.h"
+#include "lightMutex.h"
+#include "pmutex.h"
+#include "atomicAdjust.h"
+#include "pStatCollector.h"
+#include "pvector.h"
+
+/**
+ * Collects the Characters that need to be animated in a frame, and updates
+ * all of their joints and sliders at once, spreading the work over the
+ * threads of the WorkerPool.
+ *
+ * Characters may be added explicitly with add_character(), and updated with
+ * update().  Additionally, if parallel-character-update is set, each
+ * Character that is visited by the cull traversal is remembered, and the
+ * first Character to be visited in the next frame triggers an update of all
+ * of them before the traversal continues.  A Character that was not visible
+ * in the previous frame is still updated on demand, as before.
+ *
+ * Characters that share a PartBundle are always updated by the same thread.
+ */
+class EXPCL_PANDA_CHAR CharacterUpdateManager {
+protected:
+  CharacterUpdateManager();
+
+PUBLISHED:
+  void add_character(Character *character);
+  int get_num_characters() const;
+  void clear();
+
+  int update(Thread *current_thread = Thread::get_current_thread());
+
+  static CharacterUpdateManager *get_global_ptr();
+
+public:
+  void cull_character(Character *character, Thread *current_thread);
+
+private:
+  typedef pvector<WPT(Character)> Characters;
+
+  int do_update(Characters &characters, Thread *current_thread);
+
+  class UpdateJob;
+
+  LightMutex _lock;
+  Characters _characters;
+  Characters _visible;
+  int _frame;
+
+  static PStatCollector _update_pcollector;
+  static AtomicAdjust::Pointer _global_ptr;
+  static Mutex _global_lock;
+};
+
+#endif
@@ -40,6 +40,15 @@ ConfigVariableBool even_animation
           "The default is to compute vertices only when they need to be "
           "computed, which can lead to an uneven frame rate."));
 
+ConfigVariableBool parallel_character_update
+("parallel-character-update", false,
+ PRC_DESC("Set this true to update the joints of all of the characters that "
+          "were visible in the previous frame at once, at the start of the "
+          "cull traversal, spreading the work over the threads of the "
+          "worker pool.  This has no effect unless worker-pool-threads is "
+          "also set.  Characters that share a PartBundle are updated by the "
+          "same thread."));
+
 
 /**
  * Initializes the library.  This must be called at least once before any of
@@ -25,6 +25,7 @@ NotifyCategoryDecl(char, EXPCL_PANDA_CHAR, EXPTP_PANDA_CHAR);
 
 // Configure variables for char package.
 extern EXPCL_PANDA_CHAR ConfigVariableBool even_animation;
+extern EXPCL_PANDA_CHAR ConfigVariableBool parallel_character_update;
 
 extern EXPCL_PANDA_CHAR void init_libchar();
 
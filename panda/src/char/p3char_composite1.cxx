@@ -2,4 +2,5 @@
 #include "character.cxx"
 #include "characterJoint.cxx"
 #include "characterJointBundle.cxx"
+#include "characterUpdateManager.cxx"
 
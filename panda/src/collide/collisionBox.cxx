@@ -196,6 +196,68 @@ compute_internal_bounds() const {
   return new BoundingSphere(_center, _radius);
 }
 
+/**
+ * Determines the first moment at which a capsule around the segment from
+ * from_a to from_b, moving by delta, touches the box.  from_a and from_b may
+ * be the same point, for a sphere.  Returns true if it does so before it has
+ * moved the whole of delta, and sets t to the fraction of delta at which it
+ * does (which is 0 if it was already touching), and from_point and into_point
+ * to the points at which they touch.
+ */
+bool CollisionBox::
+sweep_segment(double &t, LPoint3 &from_point, LPoint3 &into_point,
+              const LPoint3 &from_a, const LPoint3 &from_b,
+              const LVector3 &delta, PN_stdfloat radius) const {
+  if (from_a[0] >= _min[0] && from_a[0] <= _max[0] &&
+      from_a[1] >= _min[1] && from_a[1] <= _max[1] &&
+      from_a[2] >= _min[2] && from_a[2] <= _max[2]) {
+    // It starts out inside the box.
+    t = 0.0;
+    from_point = from_a;
+    into_point = from_a;
+    return true;
+  }
+
+  // Otherwise, it must touch one of the sides first.
+  bool is_sphere = (from_a == from_b);
+  double best_t = 2.0;
+  for (int ip = 0; ip < 6 && best_t > 0.0; ++ip) {
+    LPoint3 side[4] = {
+      _vertex[plane_def[ip][0]],
+      _vertex[plane_def[ip][1]],
+      _vertex[plane_def[ip][2]],
+      _vertex[plane_def[ip][3]],
+    };
+
+    double side_t;
+    LPoint3 side_from_point, side_into_point;
+    if (is_sphere) {
+      if (!sweep_sphere_into_polygon(side_t, side_into_point, from_a, delta,
+                                     radius, side, 4, false)) {
+        continue;
+      }
+      side_from_point = from_a + delta * side_t;
+
+    } else if (!sweep_segment_into_polygon(side_t, side_from_point,
+                                           side_into_point, from_a, from_b,
+                                           delta, radius, side, 4, false)) {
+      continue;
+    }
+
+    if (side_t < best_t) {
+      best_t = side_t;
+      from_point = side_from_point;
+      into_point = side_into_point;
+    }
+  }
+
+  if (best_t > 1.0) {
+    return false;
+  }
+  t = best_t;
+  return true;
+}
+
 /**
  * Double dispatch point for sphere as FROM object
  */
@@ -210,10 +272,7 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
 
   const LMatrix4 &wrt_mat = wrt_space->get_mat();
 
-  LPoint3 orig_center = sphere->get_center() * wrt_mat;
-  LPoint3 from_center = orig_center;
-  bool moved_from_center = false;
-  PN_stdfloat t = 1.0f;
+  LPoint3 from_center = sphere->get_center() * wrt_mat;
   LPoint3 contact_point(from_center);
   PN_stdfloat actual_t = 1.0f;
 
@@ -222,6 +281,42 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
   PN_stdfloat from_radius_2 = from_radius_v.length_squared();
   PN_stdfloat from_radius = csqrt(from_radius_2);
 
+  if (wrt_prev_space != wrt_space && entry.get_into_clip_planes() == nullptr) {
+    // If we have a delta between the previous position and the current
+    // position, find the moment at which the sphere first touched the box.
+    // If it wasn't touching it already, that is where it collided, even if
+    // it has since passed all the way through.
+    LPoint3 a = sphere->get_center() * wrt_prev_space->get_mat();
+    LVector3 delta = from_center - a;
+
+    double t;
+    LPoint3 from_point, into_point;
+    if (!sweep_segment(t, from_point, into_point, a, a, delta, from_radius)) {
+      return nullptr;
+    }
+    if (t > 0.0) {
+      contact_point = a + delta * t;
+      LVector3 default_normal = contact_point - _center;
+      default_normal.normalize();
+      return make_swept_entry(entry, t, contact_point, into_point, delta,
+                              contact_point, default_normal);
+    }
+
+    // It was touching the box already.  If it has since passed all the way
+    // through, it collided right at the start; otherwise, test it where it
+    // is now.
+    contact_point = a;
+    LPoint3 now_from_point, now_into_point;
+    if (!sweep_segment(t, now_from_point, now_into_point, from_center,
+                       from_center, LVector3::zero(), from_radius)) {
+      LVector3 default_normal = contact_point - _center;
+      default_normal.normalize();
+      return make_swept_entry(entry, 0.0, contact_point, into_point, delta,
+                              contact_point, default_normal);
+    }
+    actual_t = 0.0f;
+  }
+
   int ip;
   PN_stdfloat max_dist = 0.0;
   PN_stdfloat dist = 0.0;
@@ -234,56 +329,6 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
     if (_points[ip].size() < 3) {
       continue;
     }
-    if (wrt_prev_space != wrt_space) {
-      // If we have a delta between the previous position and the current
-      // position, we use that to determine some more properties of the
-      // collision.
-      LPoint3 b = from_center;
-      LPoint3 a = sphere->get_center() * wrt_prev_space->get_mat();
-      LVector3 delta = b - a;
-
-      // First, there is no collision if the "from" object is definitely
-      // moving in the same direction as the plane's normal.
-      PN_stdfloat dot = delta.dot(plane.get_normal());
-      if (dot > 0.1f) {
-        continue; // no intersection
-      }
-
-      if (IS_NEARLY_ZERO(dot)) {
-        // If we're moving parallel to the plane, the sphere is tested at its
-        // final point.  Leave it as it is.
-
-      } else {
-/*
- * Otherwise, we're moving into the plane; the sphere is tested at the point
- * along its path that is closest to intersecting the plane.  This may be the
- * actual intersection point, or it may be the starting point or the final
- * point.  dot is equal to the (negative) magnitude of 'delta' along the
- * direction of the plane normal t = ratio of (distance from start pos to
- * plane) to (distance from start pos to end pos), along axis of plane normal
- */
-        PN_stdfloat dist_to_p = plane.dist_to_plane(a);
-        t = (dist_to_p / -dot);
-
-        // also compute the actual contact point and time of contact for
-        // handlers that need it
-        actual_t = ((dist_to_p - from_radius) / -dot);
-        actual_t = min((PN_stdfloat)1.0, max((PN_stdfloat)0.0, actual_t));
-        contact_point = a + (actual_t * delta);
-
-        if (t >= 1.0f) {
-          // Leave it where it is.
-
-        } else if (t < 0.0f) {
-          from_center = a;
-          moved_from_center = true;
-        } else {
-          from_center = a + t * delta;
-          moved_from_center = true;
-        }
-      }
-    }
-
     normal = (has_effective_normal() && sphere->get_respect_effective_normal()) ? get_effective_normal() : plane.get_normal();
 
 #ifndef NDEBUG
@@ -376,13 +421,6 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
   PT(CollisionEntry) new_entry = new CollisionEntry(entry);
 
   PN_stdfloat into_depth = max_dist - dist;
-  if (moved_from_center) {
-    // We have to base the depth of intersection on the sphere's final resting
-    // point, not the point from which we tested the intersection.
-    PN_stdfloat orig_dist;
-    plane.intersects_line(orig_dist, orig_center, -normal);
-    into_depth = max_dist - orig_dist;
-  }
 
   // Clamp the surface point to the box bounds.
   LPoint3 surface = from_center - normal * dist;
@@ -492,6 +530,35 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ */
+bool CollisionBox::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  double t1, t2;
+  if (!intersects_line(t1, t2, origin, direction) || t2 < 0.0) {
+    return false;
+  }
+
+  // As for a CollisionRay, if the origin is inside the box, the exit is
+  // taken as the surface point.
+  t = (t1 < 0.0) ? t2 : t1;
+  if (t > max_t) {
+    return false;
+  }
+
+  LPoint3 point = origin + t * direction;
+  normal.set(
+    IS_NEARLY_EQUAL(point[0], _max[0]) - IS_NEARLY_EQUAL(point[0], _min[0]),
+    IS_NEARLY_EQUAL(point[1], _max[1]) - IS_NEARLY_EQUAL(point[1], _min[1]),
+    IS_NEARLY_EQUAL(point[2], _max[2]) - IS_NEARLY_EQUAL(point[2], _min[2])
+  );
+  normal.normalize();
+  return true;
+}
+
 /**
  * Double dispatch point for segment as a FROM object
  */
@@ -554,7 +621,10 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
   const CollisionCapsule *capsule;
   DCAST_INTO_R(capsule, entry.get_from(), nullptr);
 
-  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
 
   LPoint3 from_a = capsule->get_point_a() * wrt_mat;
   LPoint3 from_b = capsule->get_point_b() * wrt_mat;
@@ -562,6 +632,42 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
   PN_stdfloat radius_sq = wrt_mat.xform_vec(LVector3(0, 0, capsule->get_radius())).length_squared();
   PN_stdfloat radius = csqrt(radius_sq);
 
+  LPoint3 contact_point = (from_a + from_b) * 0.5f;
+  PN_stdfloat actual_t = 1.0f;
+
+  if (wrt_prev_space != wrt_space) {
+    // The capsule is moving.  Find the moment at which it first touched the
+    // box; if it wasn't touching it already, that is where it collided.
+    const LMatrix4 &prev_mat = wrt_prev_space->get_mat();
+    LPoint3 prev_a = capsule->get_point_a() * prev_mat;
+    LPoint3 prev_b = capsule->get_point_b() * prev_mat;
+    LVector3 delta = from_a - prev_a;
+
+    double t;
+    LPoint3 from_point, into_point;
+    if (!sweep_segment(t, from_point, into_point, prev_a, prev_b, delta,
+                       radius)) {
+      return nullptr;
+    }
+    contact_point = (prev_a + prev_b) * 0.5f + delta * t;
+    LVector3 default_normal = contact_point - _center;
+    default_normal.normalize();
+    if (t > 0.0) {
+      return make_swept_entry(entry, t, from_point, into_point, delta,
+                              contact_point, default_normal);
+    }
+
+    // It was touching the box already.  If it has since passed all the way
+    // through, it collided right at the start.
+    LPoint3 now_from_point, now_into_point;
+    if (!sweep_segment(t, now_from_point, now_into_point, from_a, from_b,
+                       LVector3::zero(), radius)) {
+      return make_swept_entry(entry, 0.0, from_point, into_point, delta,
+                              contact_point, default_normal);
+    }
+    actual_t = 0.0f;
+  }
+
   LPoint3 box_min = get_min();
   LPoint3 box_max = get_max();
   LVector3 dimensions = box_max - box_min;
@@ -687,6 +793,9 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
   } else {
     new_entry->set_surface_normal(normal);
   }
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_contact_normal(normal);
+  new_entry->set_t(actual_t);
 
   return new_entry;
 }
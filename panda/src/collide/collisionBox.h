@@ -41,6 +41,10 @@ public:
 
   virtual PT(CollisionEntry)
     test_intersection(const CollisionEntry &entry) const;
+
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
   virtual void xform(const LMatrix4 &mat);
 
   virtual PStatCollector &get_volume_pcollector();
@@ -93,6 +97,11 @@ protected:
                        const LPoint3 &from, const LVector3 &delta,
                        PN_stdfloat inflate_size=0) const;
 
+private:
+  bool sweep_segment(double &t, LPoint3 &from_point, LPoint3 &into_point,
+                     const LPoint3 &from_a, const LPoint3 &from_b,
+                     const LVector3 &delta, PN_stdfloat radius) const;
+
 private:
   LPoint3 _center;
   LPoint3 _min;
@@ -327,6 +327,32 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ */
+bool CollisionCapsule::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  double t1, t2;
+  if (!intersects_line(t1, t2, origin, direction, 0.0f) ||
+      t2 < 0.0 || t1 > max_t) {
+    return false;
+  }
+
+  t = max(t1, 0.0);
+  normal = (origin + t * direction) * _inv_mat;
+  if (normal[1] > _length) {
+    // The point is within the top endcap.
+    normal[1] -= _length;
+  } else if (normal[1] > 0.0f) {
+    // The point is within the cylinder body.
+    normal[1] = 0;
+  }
+  normal = normalize(normal * _mat);
+  return true;
+}
+
 /**
  *
  */
@@ -402,7 +428,10 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
   LPoint3 into_a = _a;
   LVector3 into_direction = _b - into_a;
 
-  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
 
   LPoint3 from_a = capsule->get_point_a() * wrt_mat;
   LPoint3 from_b = capsule->get_point_b() * wrt_mat;
@@ -412,6 +441,44 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
     LVector3(capsule->get_radius(), 0.0f, 0.0f) * wrt_mat;
   PN_stdfloat from_radius = length(from_radius_v);
 
+  LPoint3 contact_point = (from_a + from_b) * 0.5f;
+  PN_stdfloat actual_t = 1.0f;
+
+  if (wrt_prev_space != wrt_space) {
+    // The capsule is moving.  Find the moment at which its axis first came
+    // within the sum of the radii of ours; if they weren't touching already,
+    // that is where they collided, even if it has since passed right through.
+    const LMatrix4 &prev_mat = wrt_prev_space->get_mat();
+    LPoint3 prev_a = capsule->get_point_a() * prev_mat;
+    LPoint3 prev_b = capsule->get_point_b() * prev_mat;
+    LVector3 delta = from_a - prev_a;
+
+    double t;
+    LPoint3 from_point, into_point;
+    if (!sweep_segment_into_segment(t, from_point, into_point, prev_a, prev_b,
+                                    delta, _radius + from_radius, _a, _b)) {
+      return nullptr;
+    }
+    LVector3 normal = from_point - into_point;
+    normal.normalize();
+    contact_point = (prev_a + prev_b) * 0.5f + delta * t;
+    if (t > 0.0) {
+      return make_swept_entry(entry, t, from_point, into_point + normal * _radius,
+                              delta, contact_point, normal);
+    }
+
+    // They were touching already.  If it has since passed all the way
+    // through, they collided right at the start.
+    LPoint3 now_from_point, now_into_point;
+    if (!sweep_segment_into_segment(t, now_from_point, now_into_point, from_a,
+                                    from_b, LVector3::zero(),
+                                    _radius + from_radius, _a, _b)) {
+      return make_swept_entry(entry, 0.0, from_point, into_point + normal * _radius,
+                              delta, contact_point, normal);
+    }
+    actual_t = 0.0f;
+  }
+
   // Determine the points on each segment with the smallest distance between.
   double into_t, from_t;
   calc_closest_segment_points(into_t, from_t,
@@ -447,10 +514,13 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
     } else if (distance != 0) {
       new_entry->set_surface_normal(surface_normal);
     }
+    new_entry->set_contact_normal(surface_normal);
   } else {
     // The rare case of the line segments touching exactly.
     set_intersection_point(new_entry, into_closest, 0);
   }
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_t(actual_t);
 
   return new_entry;
 }
@@ -44,6 +44,9 @@ public:
   virtual PT(CollisionEntry)
   test_intersection(const CollisionEntry &entry) const;
 
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
   virtual void xform(const LMatrix4 &mat);
 
   virtual PStatCollector &get_volume_pcollector();
@@ -154,6 +157,8 @@ private:
   static TypeHandle _type_handle;
 
   friend class CollisionBox;
+  friend class CollisionSolid;
+  friend class CollisionTriangleMesh;
 };
 
 #include "collisionCapsule.I"
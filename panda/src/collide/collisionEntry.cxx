@@ -17,6 +17,8 @@
 
 TypeHandle CollisionEntry::_type_handle;
 
+PStatCollector CollisionEntry::_created_pcollector("Collision Entries");
+
 /**
  *
  */
@@ -37,6 +39,9 @@ CollisionEntry(const CollisionEntry &copy) :
   _contact_pos(copy._contact_pos),
   _contact_normal(copy._contact_normal)
 {
+#ifdef DO_PSTATS
+  _created_pcollector.add_level(1);
+#endif  // DO_PSTATS
 }
 
 /**
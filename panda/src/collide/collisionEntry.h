@@ -28,6 +28,8 @@
 #include "pandaNode.h"
 #include "nodePath.h"
 #include "clipPlaneAttrib.h"
+#include "deletedChain.h"
+#include "pStatCollector.h"
 
 /**
  * Defines a single collision event.  One of these is created for each
@@ -44,6 +46,9 @@ public:
   INLINE CollisionEntry();
   CollisionEntry(const CollisionEntry &copy);
   void operator = (const CollisionEntry &copy);
+  ALLOC_DELETED_CHAIN(CollisionEntry);
+
+  INLINE static void flush_level();
 
 PUBLISHED:
   INLINE const CollisionSolid *get_from() const;
@@ -149,6 +154,8 @@ private:
   LPoint3 _contact_pos;
   LVector3 _contact_normal;
 
+  static PStatCollector _created_pcollector;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -166,6 +173,7 @@ public:
 private:
   static TypeHandle _type_handle;
 
+  friend class CollisionSolid;
   friend class CollisionTraverser;
   friend class CollisionHandlerFluidPusher;
 };
@@ -132,9 +132,49 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   DCAST_INTO_R(ray, entry.get_from(), nullptr);
   LPoint3 from_origin = ray->get_origin() * entry.get_wrt_mat();
 
-  double fx = from_origin[0];
-  double fy = from_origin[1];
+  PN_stdfloat z;
+  if (!find_floor(z, from_origin[0], from_origin[1])) {
+    return nullptr;
+  }
+
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+  new_entry->set_surface_normal(LPoint3(0, 0, 1));
+  new_entry->set_surface_point(LPoint3(from_origin[0], from_origin[1], z));
+  return new_entry;
+}
+
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ *
+ * Like test_intersection_from_ray(), this finds the floor directly above or
+ * below the origin of the ray, whichever way the ray is pointing.
+ */
+bool CollisionFloorMesh::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  PN_stdfloat z;
+  if (!find_floor(z, origin[0], origin[1])) {
+    return false;
+  }
+
+  LPoint3 point(origin[0], origin[1], z);
+  t = (point - origin).dot(direction) / direction.length_squared();
+  if (t > max_t) {
+    return false;
+  }
+
+  normal.set(0, 0, 1);
+  return true;
+}
 
+/**
+ * Finds the triangle of the mesh that contains the indicated point in the
+ * XY plane, and fills in the height of the floor at that point.  Returns
+ * false if there is no such triangle.
+ */
+bool CollisionFloorMesh::
+find_floor(PN_stdfloat &z, double fx, double fy) const {
   CollisionFloorMesh::Triangles::const_iterator ti;
   for (ti = _triangles.begin(); ti < _triangles.end(); ++ti) {
     TriangleIndices tri = *ti;
@@ -177,14 +217,10 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
 
     PN_stdfloat uz = (p2[2] - p0z) *  mag;
     PN_stdfloat vz = (p1[2] - p0z) *  mag;
-    PN_stdfloat finalz = p0z + vz + (((uz - vz) * u) / (u + v));
-    PT(CollisionEntry) new_entry = new CollisionEntry(entry);
-
-    new_entry->set_surface_normal(LPoint3(0, 0, 1));
-    new_entry->set_surface_point(LPoint3(fx, fy, finalz));
-    return new_entry;
+    z = p0z + vz + (((uz - vz) * u) / (u + v));
+    return true;
   }
-  return nullptr;
+  return false;
 }
 
 
@@ -66,6 +66,9 @@ public:
 
   virtual void xform(const LMatrix4 &mat);
 
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
   virtual PStatCollector &get_volume_pcollector();
   virtual PStatCollector &get_test_pcollector();
 
@@ -85,6 +88,8 @@ protected:
   virtual void fill_viz_geom();
 
 private:
+  bool find_floor(PN_stdfloat &z, double fx, double fy) const;
+
   typedef pvector<LPoint3> Vertices;
   typedef pvector<TriangleIndices> Triangles;
 
@@ -16,6 +16,7 @@
 #include "collisionEntry.h"
 #include "collisionPolygon.h"
 #include "collisionSphere.h"
+#include "collisionCapsule.h"
 #include "config_collide.h"
 #include "dcast.h"
 
@@ -134,12 +135,22 @@ handle_entries() {
       CPT(TransformState) prev_trans(from_node_path.get_prev_transform(wrt_node));
       const LPoint3 orig_prev_pos(prev_trans->get_pos());
 
-      // currently we only support spheres as the collider
-      const CollisionSphere *sphere;
-      DCAST_INTO_R(sphere, entries.front()->get_from(), false);
+      // we support spheres and capsules as the collider; the contact position
+      // is that of the center of the sphere, or the middle of the capsule
+      const CollisionSolid *from_solid = entries.front()->get_from();
+      LPoint3 center;
+      if (from_solid->is_of_type(CollisionSphere::get_class_type())) {
+        center = ((const CollisionSphere *)from_solid)->get_center();
+      } else if (from_solid->is_of_type(CollisionCapsule::get_class_type())) {
+        const CollisionCapsule *capsule = (const CollisionCapsule *)from_solid;
+        center = (capsule->get_point_a() + capsule->get_point_b()) * 0.5f;
+      } else {
+        nassert_raise("CollisionHandlerFluidPusher requires a sphere or capsule");
+        return false;
+      }
 
       from_node_path.set_pos(wrt_node, 0,0,0);
-      LPoint3 sphere_offset = (sphere->get_center() *
+      LPoint3 center_offset = (center *
                                 from_node_path.get_transform(wrt_node)->get_mat());
       from_node_path.set_pos(wrt_node, orig_pos);
 
@@ -186,7 +197,7 @@ handle_entries() {
           break;
         }
         // calculate the position of the target node at the point of contact
-        contact_pos -= sphere_offset;
+        contact_pos -= center_offset;
 
         uncollided_pos = candidate_final_pos;
         candidate_final_pos = contact_pos;
@@ -222,6 +222,30 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ */
+bool CollisionInvSphere::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  double t1, t2;
+  if (!intersects_line(t1, t2, origin, direction, 0.0f)) {
+    // The ray is in the middle of space, and therefore intersects the
+    // sphere.
+    t2 = 0.0;
+  }
+
+  t = std::max(t2, 0.0);
+  if (t > max_t) {
+    return false;
+  }
+
+  normal = get_center() - (origin + t * direction);
+  normal.normalize();
+  return true;
+}
+
 /**
  *
  */
@@ -109,7 +109,10 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
   const CollisionSphere *sphere;
   DCAST_INTO_R(sphere, entry.get_from(), nullptr);
 
-  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
 
   LPoint3 from_center = sphere->get_center() * wrt_mat;
   LVector3 from_radius_v =
@@ -122,6 +125,20 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
     return nullptr;
   }
 
+  // Since everything behind the plane is solid, nothing can pass through it,
+  // but handlers still want to know when the sphere first touched it.
+  LPoint3 contact_point(from_center);
+  PN_stdfloat actual_t = 1.0f;
+  if (wrt_prev_space != wrt_space) {
+    LPoint3 a = sphere->get_center() * wrt_prev_space->get_mat();
+    PN_stdfloat prev_dist = dist_to_plane(a);
+    actual_t = 0.0f;
+    if (prev_dist > from_radius) {
+      actual_t = (prev_dist - from_radius) / (prev_dist - dist);
+    }
+    contact_point = a + (from_center - a) * actual_t;
+  }
+
   if (collide_cat.is_debug()) {
     collide_cat.debug()
       << "intersection detected from " << entry.get_from_node_path()
@@ -136,6 +153,9 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
   new_entry->set_surface_normal(normal);
   new_entry->set_surface_point(from_center - get_normal() * dist);
   new_entry->set_interior_point(from_center - get_normal() * from_radius);
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_contact_normal(get_normal());
+  new_entry->set_t(actual_t);
 
   return new_entry;
 }
@@ -237,6 +257,30 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ */
+bool CollisionPlane::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  if (_plane.dist_to_plane(origin) < 0.0f) {
+    // The origin of the ray is behind the plane.
+    t = 0.0;
+
+  } else {
+    PN_stdfloat plane_t;
+    if (!_plane.intersects_line(plane_t, origin, direction) ||
+        plane_t < 0.0f || plane_t > max_t) {
+      return false;
+    }
+    t = plane_t;
+  }
+
+  normal = get_normal();
+  return true;
+}
+
 /**
  *
  */
@@ -302,7 +346,10 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
   const CollisionCapsule *capsule;
   DCAST_INTO_R(capsule, entry.get_from(), nullptr);
 
-  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
 
   LPoint3 from_a = capsule->get_point_a() * wrt_mat;
   LPoint3 from_b = capsule->get_point_b() * wrt_mat;
@@ -318,6 +365,23 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
     return nullptr;
   }
 
+  // The capsule first touched the plane when the nearer of its ends did.
+  LPoint3 contact_point = (from_a + from_b) * 0.5f;
+  PN_stdfloat actual_t = 1.0f;
+  if (wrt_prev_space != wrt_space) {
+    const LMatrix4 &prev_mat = wrt_prev_space->get_mat();
+    LPoint3 prev_a = capsule->get_point_a() * prev_mat;
+    LPoint3 prev_b = capsule->get_point_b() * prev_mat;
+    PN_stdfloat prev_dist_a = _plane.dist_to_plane(prev_a);
+    PN_stdfloat prev_dist_b = _plane.dist_to_plane(prev_b);
+    PN_stdfloat prev_dist = std::min(prev_dist_a, prev_dist_b);
+    actual_t = 0.0f;
+    if (prev_dist > from_radius) {
+      actual_t = (prev_dist - from_radius) / (prev_dist - std::min(dist_a, dist_b));
+    }
+    contact_point = (prev_a + prev_b) * 0.5f + (from_a - prev_a) * actual_t;
+  }
+
   if (collide_cat.is_debug()) {
     collide_cat.debug()
       << "intersection detected from " << entry.get_from_node_path()
@@ -361,6 +425,10 @@ test_intersection_from_capsule(const CollisionEntry &entry) const {
     new_entry->set_interior_point(from_b - get_normal() * from_radius);
   }
 
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_contact_normal(get_normal());
+  new_entry->set_t(actual_t);
+
   return new_entry;
 }
 
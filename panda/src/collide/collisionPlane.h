@@ -39,6 +39,9 @@ public:
 
   virtual void xform(const LMatrix4 &mat);
 
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
   virtual PStatCollector &get_volume_pcollector();
   virtual PStatCollector &get_test_pcollector();
 
@@ -18,6 +18,7 @@
 #include "collisionLine.h"
 #include "collisionRay.h"
 #include "collisionSegment.h"
+#include "collisionCapsule.h"
 #include "collisionParabola.h"
 #include "config_collide.h"
 #include "cullTraverserData.h"
@@ -374,10 +375,7 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
 
   const LMatrix4 &wrt_mat = wrt_space->get_mat();
 
-  LPoint3 orig_center = sphere->get_center() * wrt_mat;
-  LPoint3 from_center = orig_center;
-  bool moved_from_center = false;
-  PN_stdfloat t = 1.0f;
+  LPoint3 from_center = sphere->get_center() * wrt_mat;
   LPoint3 contact_point(from_center);
   PN_stdfloat actual_t = 1.0f;
 
@@ -390,50 +388,46 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
     // If we have a delta between the previous position and the current
     // position, we use that to determine some more properties of the
     // collision.
-    LPoint3 b = from_center;
     LPoint3 a = sphere->get_center() * wrt_prev_space->get_mat();
-    LVector3 delta = b - a;
+    LVector3 delta = from_center - a;
 
     // First, there is no collision if the "from" object is definitely moving
     // in the same direction as the plane's normal.
-    PN_stdfloat dot = delta.dot(get_normal());
-    if (dot > 0.1f) {
+    if (delta.dot(get_normal()) > 0.1f) {
       return nullptr;
     }
 
-    if (IS_NEARLY_ZERO(dot)) {
-      // If we're moving parallel to the plane, the sphere is tested at its
-      // final point.  Leave it as it is.
-
-    } else {
-/*
- * Otherwise, we're moving into the plane; the sphere is tested at the point
- * along its path that is closest to intersecting the plane.  This may be the
- * actual intersection point, or it may be the starting point or the final
- * point.  dot is equal to the (negative) magnitude of 'delta' along the
- * direction of the plane normal t = ratio of (distance from start pos to
- * plane) to (distance from start pos to end pos), along axis of plane normal
- */
-      PN_stdfloat dist_to_p = dist_to_plane(a);
-      t = (dist_to_p / -dot);
-
-      // also compute the actual contact point and time of contact for
-      // handlers that need it
-      actual_t = ((dist_to_p - from_radius) / -dot);
-      actual_t = min((PN_stdfloat)1.0, max((PN_stdfloat)0.0, actual_t));
-      contact_point = a + (actual_t * delta);
-
-      if (t >= 1.0f) {
-        // Leave it where it is.
-
-      } else if (t < 0.0f) {
-        from_center = a;
-        moved_from_center = true;
+    if (entry.get_into_clip_planes() == nullptr) {
+      // Find the moment at which the sphere first touched the polygon.  If
+      // it wasn't touching it already, that is where it collided, even if it
+      // has since passed all the way through.
+      size_t num_points = _points.size();
+      LPoint3 *points = (LPoint3 *)alloca(sizeof(LPoint3) * num_points);
+      compute_points_3d(points);
+
+      double t;
+      LPoint3 into_point;
+      if (!sweep_sphere_into_polygon(t, into_point, a, delta, from_radius,
+                                     points, num_points, false)) {
+        return nullptr;
+      }
+      if (t > 0.0) {
+        contact_point = a + delta * t;
+        return make_swept_entry(entry, t, contact_point, into_point, delta,
+                                contact_point, get_normal());
+      }
 
-      } else {
-        from_center = a + t * delta;
-        moved_from_center = true;
+      // It was touching the polygon already.  If it has since passed all the
+      // way through, it collided right at the start; otherwise, test it where
+      // it is now.
+      contact_point = a;
+      LPoint3 now_point;
+      if (!sweep_sphere_into_polygon(t, now_point, from_center, LVector3::zero(),
+                                     from_radius, points, num_points, false)) {
+        return make_swept_entry(entry, 0.0, a, into_point, delta,
+                                contact_point, get_normal());
       }
+      actual_t = 0.0f;
     }
   }
 
@@ -519,13 +513,6 @@ test_intersection_from_sphere(const CollisionEntry &entry) const {
   PT(CollisionEntry) new_entry = new CollisionEntry(entry);
 
   PN_stdfloat into_depth = max_dist - dist;
-  if (moved_from_center) {
-    // We have to base the depth of intersection on the sphere's final resting
-    // point, not the point from which we tested the intersection.
-    PN_stdfloat orig_dist;
-    get_plane().intersects_line(orig_dist, orig_center, -normal);
-    into_depth = max_dist - orig_dist;
-  }
 
   new_entry->set_surface_normal(normal);
   new_entry->set_surface_point(from_center - normal * dist);
@@ -678,6 +665,32 @@ test_intersection_from_ray(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ */
+bool CollisionPolygon::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  if (_points.size() < 3) {
+    return false;
+  }
+
+  PN_stdfloat plane_t;
+  if (!get_plane().intersects_line(plane_t, origin, direction) ||
+      plane_t < 0.0f || plane_t > max_t) {
+    return false;
+  }
+
+  if (!point_is_inside(to_2d(origin + plane_t * direction), _points)) {
+    return false;
+  }
+
+  t = plane_t;
+  normal = get_normal();
+  return true;
+}
+
 /**
  * This is part of the double-dispatch implementation of test_intersection().
  * It is called when the "from" object is a segment.
@@ -753,6 +766,122 @@ test_intersection_from_segment(const CollisionEntry &entry) const {
   return new_entry;
 }
 
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a capsule.
+ */
+PT(CollisionEntry) CollisionPolygon::
+test_intersection_from_capsule(const CollisionEntry &entry) const {
+  if (_points.size() < 3) {
+    return nullptr;
+  }
+
+  if (entry.get_into_clip_planes() != nullptr) {
+    // Clip planes aren't supported for capsules; test against the plane.
+    return CollisionPlane::test_intersection_from_capsule(entry);
+  }
+
+  const CollisionCapsule *capsule;
+  DCAST_INTO_R(capsule, entry.get_from(), nullptr);
+
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
+
+  LPoint3 from_a = capsule->get_point_a() * wrt_mat;
+  LPoint3 from_b = capsule->get_point_b() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(capsule->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius = length(from_radius_v);
+
+  size_t num_points = _points.size();
+  LPoint3 *points = (LPoint3 *)alloca(sizeof(LPoint3) * num_points);
+  compute_points_3d(points);
+
+  LPoint3 contact_point = (from_a + from_b) * 0.5f;
+  PN_stdfloat actual_t = 1.0f;
+
+  double t;
+  LPoint3 from_point, into_point;
+  if (wrt_prev_space != wrt_space) {
+    // The capsule is moving.  Find the moment at which it first touched the
+    // polygon, as for a sphere.
+    const LMatrix4 &prev_mat = wrt_prev_space->get_mat();
+    LPoint3 prev_a = capsule->get_point_a() * prev_mat;
+    LPoint3 prev_b = capsule->get_point_b() * prev_mat;
+    LVector3 delta = from_a - prev_a;
+
+    if (delta.dot(get_normal()) > 0.1f) {
+      return nullptr;
+    }
+
+    if (!sweep_segment_into_polygon(t, from_point, into_point, prev_a, prev_b,
+                                    delta, from_radius, points, num_points,
+                                    false)) {
+      return nullptr;
+    }
+    if (t > 0.0) {
+      contact_point = (prev_a + prev_b) * 0.5f + delta * t;
+      return make_swept_entry(entry, t, from_point, into_point, delta,
+                              contact_point, get_normal());
+    }
+
+    // It was touching the polygon already.  If it has since passed all the
+    // way through, it collided right at the start.
+    contact_point = (prev_a + prev_b) * 0.5f;
+    LPoint3 now_from_point, now_into_point;
+    if (!sweep_segment_into_polygon(t, now_from_point, now_into_point, from_a,
+                                    from_b, LVector3::zero(), from_radius,
+                                    points, num_points, false)) {
+      return make_swept_entry(entry, 0.0, from_point, into_point, delta,
+                              contact_point, get_normal());
+    }
+    actual_t = 0.0f;
+  }
+
+  if (!sweep_segment_into_polygon(t, from_point, into_point, from_a, from_b,
+                                  LVector3::zero(), from_radius, points,
+                                  num_points, false)) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && capsule->get_respect_effective_normal()) ? get_effective_normal() : get_normal();
+
+  // As with CollisionPlane, the interior point is the deepest point of the
+  // capsule.
+  PN_stdfloat dist_a = dist_to_plane(from_a);
+  PN_stdfloat dist_b = dist_to_plane(from_b);
+  LPoint3 deepest;
+  PN_stdfloat dist;
+  if (IS_NEARLY_EQUAL(dist_a, dist_b)) {
+    deepest = (from_a + from_b) * 0.5f;
+    dist = (dist_a + dist_b) * 0.5f;
+  } else if (dist_a < dist_b) {
+    deepest = from_a;
+    dist = dist_a;
+  } else {
+    deepest = from_b;
+    dist = dist_b;
+  }
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(deepest - get_normal() * dist);
+  new_entry->set_interior_point(deepest - get_normal() * from_radius);
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_contact_normal(get_normal());
+  new_entry->set_t(actual_t);
+
+  return new_entry;
+}
+
 /**
  * This is part of the double-dispatch implementation of test_intersection().
  * It is called when the "from" object is a parabola.
@@ -1366,6 +1495,20 @@ legacy_to_3d(const LVecBase2 &point2d, int axis) const {
   return LPoint3(0.0f, 0.0f, 0.0f);
 }
 
+/**
+ * Fills the indicated array, which must have room for all of the points of
+ * the polygon, with the points in 3-d space.
+ */
+void CollisionPolygon::
+compute_points_3d(LPoint3 *points) const {
+  LMatrix4 to_3d_mat;
+  rederive_to_3d_mat(to_3d_mat);
+  size_t num_points = _points.size();
+  for (size_t i = 0; i < num_points; ++i) {
+    points[i] = to_3d(_points[i]._p, to_3d_mat);
+  }
+}
+
 /**
  * Clips the source_points of the polygon by the indicated clipping plane, and
  * modifies new_points to reflect the new set of clipped points (but does not
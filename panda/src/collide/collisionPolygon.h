@@ -67,6 +67,9 @@ PUBLISHED:
 public:
   virtual void xform(const LMatrix4 &mat);
 
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
   virtual PT(PandaNode) get_viz(const CullTraverser *trav,
                                 const CullTraverserData &data,
                                 bool bounds_only) const;
@@ -91,6 +94,8 @@ protected:
   virtual PT(CollisionEntry)
   test_intersection_from_segment(const CollisionEntry &entry) const;
   virtual PT(CollisionEntry)
+  test_intersection_from_capsule(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
   test_intersection_from_parabola(const CollisionEntry &entry) const;
   virtual PT(CollisionEntry)
   test_intersection_from_box(const CollisionEntry &entry) const;
@@ -132,6 +137,7 @@ private:
   INLINE void rederive_to_3d_mat(LMatrix4 &to_3d_mat) const;
   INLINE static LPoint3 to_3d(const LVecBase2 &point2d, const LMatrix4 &to_3d_mat);
   LPoint3 legacy_to_3d(const LVecBase2 &point2d, int axis) const;
+  void compute_points_3d(LPoint3 *points) const;
 
   bool clip_polygon(Points &new_points, const Points &source_points,
                     const LPlane &plane) const;
@@ -0,0 +1,382 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayQuery.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "collisionRayQuery.h"
+#include "collisionNode.h"
+#include "collisionSolid.h"
+#include "config_collide.h"
+#include "boundingBox.h"
+#include "geometricBoundingVolume.h"
+#include "spatialIndexNode.h"
+#include "transformState.h"
+#include "workerPool.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+PStatCollector CollisionRayQuery::_cast_pcollector("App:Collisions:Ray query");
+
+// The number of rays handed to each thread of the WorkerPool at a time.
+static const size_t rays_per_job = 256;
+
+/**
+ * Walks the scene graph on behalf of cast_rays(), carrying along the rays
+ * that might still hit something below the current node.
+ */
+class CollisionRayQuery::Walker {
+public:
+  Walker(const Ray *rays, Hit *hits, size_t num_rays, CollideMask from_mask,
+         Thread *current_thread);
+
+  void r_walk(PandaNode *node, size_t begin, size_t end,
+              const LMatrix4 &parent_inv);
+  void cast_into_node(CollisionNode *cnode, size_t begin, size_t end,
+                      const LMatrix4 &net_inv);
+
+  // A ray, as seen in the coordinate space of some node.
+  class LocalRay {
+  public:
+    size_t _index;
+    LPoint3 _origin;
+    LVector3 _direction;
+  };
+
+  const Ray *_rays;
+  Hit *_hits;
+  CollideMask _from_mask;
+  Thread *_current_thread;
+
+  // The parametric distance along each ray of the nearest hit so far, or of
+  // its far end if there is none yet.
+  pvector<double> _max_t;
+
+  // The rays for each level of the walk are pushed onto the end of this, so
+  // that they need not be reallocated at every node.
+  pvector<LocalRay> _stack;
+};
+
+/**
+ * Runs cast_rays() on a range of the rays for each item.
+ */
+class CollisionRayQuery::CastJob : public WorkerPool::Job {
+public:
+  CastJob(const NodePath &root, CollideMask from_mask, const Ray *rays,
+          Hit *hits, size_t num_rays) :
+    _root(root),
+    _from_mask(from_mask),
+    _rays(rays),
+    _hits(hits),
+    _num_rays(num_rays)
+  {
+  }
+
+  virtual void run_item(size_t index, Thread *current_thread) {
+    size_t begin = index * rays_per_job;
+    size_t count = std::min(rays_per_job, _num_rays - begin);
+    cast_rays(_root, _from_mask, _rays + begin, _hits + begin, count,
+              current_thread);
+  }
+
+  const NodePath &_root;
+  CollideMask _from_mask;
+  const Ray *_rays;
+  Hit *_hits;
+  size_t _num_rays;
+};
+
+/**
+ *
+ */
+CollisionRayQuery::
+CollisionRayQuery() :
+  _from_mask(CollideMask::all_on())
+{
+}
+
+/**
+ * Casts all of the rays into the scene graph at and below the indicated
+ * root, and records the nearest hit of each one, to be retrieved with
+ * has_hit() and related methods.
+ *
+ * If parallel-collide is enabled, large batches of rays are divided among
+ * the threads of the global WorkerPool.
+ */
+void CollisionRayQuery::
+cast(const NodePath &root) {
+  nassertv(!root.is_empty());
+  _root = root;
+  _hits.resize(_rays.size());
+  if (_rays.empty()) {
+    return;
+  }
+
+  PStatTimer timer(_cast_pcollector);
+
+  size_t num_rays = _rays.size();
+  size_t num_jobs = (num_rays + rays_per_job - 1) / rays_per_job;
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  if (parallel_collide && num_jobs > 1 && pool->get_num_threads() > 0) {
+    CastJob job(root, _from_mask, &_rays[0], &_hits[0], num_rays);
+    pool->run(job, num_jobs);
+  } else {
+    cast_rays(root, _from_mask, &_rays[0], &_hits[0], num_rays);
+  }
+}
+
+/**
+ * Returns the NodePath of the CollisionNode hit by the nth ray during the
+ * last cast(), or an empty NodePath if it didn't hit anything.  This
+ * searches below the root for the node, so it is best not called for every
+ * ray.
+ */
+NodePath CollisionRayQuery::
+get_hit_node_path(int n) const {
+  nassertr(n >= 0 && n < (int)_hits.size(), NodePath());
+  if (_hits[n]._node == nullptr) {
+    return NodePath();
+  }
+  if (_root.node() == _hits[n]._node) {
+    return _root;
+  }
+  return _root.find_path_to(_hits[n]._node);
+}
+
+/**
+ * Casts each of the indicated rays into the scene graph at and below the
+ * indicated root, and fills in the corresponding element of hits with the
+ * nearest CollisionNode solid that it hits, if any.  This is the function
+ * underlying cast(), for callers that want to manage their own arrays.
+ */
+void CollisionRayQuery::
+cast_rays(const NodePath &root, CollideMask from_mask, const Ray *rays,
+          Hit *hits, size_t num_rays, Thread *current_thread) {
+  nassertv(!root.is_empty());
+
+  Walker walker(rays, hits, num_rays, from_mask, current_thread);
+  if (walker._stack.empty()) {
+    return;
+  }
+
+  // The bounding volume of the root node is in the space of its parent, so
+  // the walk begins there.
+  CPT(TransformState) root_transform = root.get_transform(current_thread);
+  const LMatrix4 &root_mat = root_transform->get_mat();
+  for (Walker::LocalRay &ray : walker._stack) {
+    ray._origin = ray._origin * root_mat;
+    ray._direction = ray._direction * root_mat;
+  }
+
+  walker.r_walk(root.node(), 0, walker._stack.size(), root_mat);
+}
+
+/**
+ *
+ */
+CollisionRayQuery::Walker::
+Walker(const CollisionRayQuery::Ray *rays, CollisionRayQuery::Hit *hits,
+       size_t num_rays, CollideMask from_mask, Thread *current_thread) :
+  _rays(rays),
+  _hits(hits),
+  _from_mask(from_mask),
+  _current_thread(current_thread)
+{
+  _max_t.resize(num_rays);
+  _stack.reserve(num_rays * 4);
+
+  for (size_t i = 0; i < num_rays; ++i) {
+    const Ray &ray = rays[i];
+    Hit &hit = hits[i];
+    hit._node = nullptr;
+    hit._solid = nullptr;
+
+    PN_stdfloat length = ray._direction.length();
+    if (length == 0.0f || !(ray._max_distance >= 0.0f)) {
+      continue;
+    }
+    _max_t[i] = ray._max_distance / length;
+
+    LocalRay local;
+    local._index = i;
+    local._origin = ray._origin;
+    local._direction = ray._direction;
+    _stack.push_back(local);
+  }
+}
+
+/**
+ * Visits the indicated node with the rays in the indicated range of the
+ * stack, which are in the space of the node's parent.  parent_inv converts
+ * from the space of the root to the space of the parent.
+ */
+void CollisionRayQuery::Walker::
+r_walk(PandaNode *node, size_t begin, size_t end, const LMatrix4 &parent_inv) {
+  Thread *current_thread = _current_thread;
+  if ((node->get_net_collide_mask(current_thread) & _from_mask).is_zero()) {
+    return;
+  }
+
+  CPT(BoundingVolume) node_bv = node->get_bounds(current_thread);
+  if (node_bv->is_empty()) {
+    return;
+  }
+  const GeometricBoundingVolume *node_gbv = nullptr;
+  if (!node_bv->is_infinite()) {
+    node_gbv = node_bv->as_geometric_bounding_volume();
+  }
+
+  LMatrix4 net_inv = parent_inv;
+  LMatrix4 inv_mat;
+  CPT(TransformState) transform = node->get_transform(current_thread);
+  bool has_transform = !transform->is_identity();
+  if (has_transform) {
+    CPT(TransformState) inv_transform = transform->get_inverse();
+    if (!inv_transform->has_mat()) {
+      // No inverse.
+      return;
+    }
+    inv_mat = inv_transform->get_mat();
+    net_inv = parent_inv * inv_mat;
+  }
+
+  // Carry along only the rays that reach the node's bounding volume, in the
+  // space of the node.
+  size_t next_begin = _stack.size();
+  for (size_t i = begin; i < end; ++i) {
+    LocalRay ray = _stack[i];
+    if (node_gbv != nullptr) {
+      LPoint3 far_point = ray._origin + ray._direction * _max_t[ray._index];
+      if (node_gbv->contains(ray._origin, far_point) == BoundingVolume::IF_no_intersection) {
+        continue;
+      }
+    }
+    if (has_transform) {
+      ray._origin = ray._origin * inv_mat;
+      ray._direction = ray._direction * inv_mat;
+    }
+    _stack.push_back(ray);
+  }
+  size_t next_end = _stack.size();
+
+  if (next_begin != next_end) {
+    if (node->is_collision_node()) {
+      cast_into_node((CollisionNode *)node, next_begin, next_end, net_inv);
+    }
+
+    if (node->has_single_child_visibility()) {
+      // If it's a switch node or sequence node, visit just the one visible
+      // child.
+      int index = node->get_visible_child();
+      if (index >= 0 && index < node->get_num_children(current_thread)) {
+        r_walk(node->get_child(index, current_thread), next_begin, next_end,
+               net_inv);
+      }
+
+    } else if (node->is_of_type(SpatialIndexNode::get_class_type())) {
+      // If it's a SpatialIndexNode, give each child only the rays that might
+      // reach it.
+      SpatialIndexNode *index_node = (SpatialIndexNode *)node;
+      pvector<std::pair<int, size_t> > pairs;
+      vector_int found;
+      for (size_t i = next_begin; i < next_end; ++i) {
+        const LocalRay &ray = _stack[i];
+        LPoint3 far_point = ray._origin + ray._direction * _max_t[ray._index];
+        BoundingBox box(ray._origin.fmin(far_point), ray._origin.fmax(far_point));
+        index_node->find_children(&box, found, current_thread);
+        for (int child : found) {
+          pairs.push_back(std::pair<int, size_t>(child, i));
+        }
+      }
+      std::sort(pairs.begin(), pairs.end());
+
+      PandaNode::Children children = node->get_children(current_thread);
+      int num_children = children.get_num_children();
+      size_t p = 0;
+      while (p < pairs.size()) {
+        int child = pairs[p].first;
+        size_t child_begin = _stack.size();
+        for (; p < pairs.size() && pairs[p].first == child; ++p) {
+          LocalRay ray = _stack[pairs[p].second];
+          _stack.push_back(ray);
+        }
+        if (child < num_children) {
+          r_walk(children.get_child(child), child_begin, _stack.size(),
+                 net_inv);
+        }
+        _stack.resize(child_begin);
+      }
+
+    } else {
+      PandaNode::Children children = node->get_children(current_thread);
+      int num_children = children.get_num_children();
+      for (int i = 0; i < num_children; ++i) {
+        r_walk(children.get_child(i), next_begin, next_end, net_inv);
+      }
+    }
+  }
+
+  _stack.resize(next_begin);
+}
+
+/**
+ * Tests the rays in the indicated range of the stack, which are in the space
+ * of the CollisionNode, against each of its solids.
+ */
+void CollisionRayQuery::Walker::
+cast_into_node(CollisionNode *cnode, size_t begin, size_t end,
+               const LMatrix4 &net_inv) {
+  if ((cnode->get_into_collide_mask() & _from_mask).is_zero()) {
+    return;
+  }
+
+  size_t num_solids = cnode->get_num_solids();
+  for (size_t s = 0; s < num_solids; ++s) {
+    CPT(CollisionSolid) solid = cnode->get_solid(s);
+    CPT(BoundingVolume) solid_bv = solid->get_bounds();
+    const GeometricBoundingVolume *solid_gbv = nullptr;
+    if (!solid_bv->is_infinite()) {
+      solid_gbv = solid_bv->as_geometric_bounding_volume();
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+      const LocalRay &ray = _stack[i];
+      double &max_t = _max_t[ray._index];
+      if (solid_gbv != nullptr) {
+        LPoint3 far_point = ray._origin + ray._direction * max_t;
+        if (solid_gbv->contains(ray._origin, far_point) == BoundingVolume::IF_no_intersection) {
+          continue;
+        }
+      }
+
+      double t;
+      LVector3 normal;
+      Hit &hit = _hits[ray._index];
+      if (!solid->cast_ray(t, normal, ray._origin, ray._direction, max_t) ||
+          (hit._node != nullptr && t >= max_t)) {
+        continue;
+      }
+
+      // The normal is brought back into the space of the root with the
+      // inverse transpose of the matrix that takes points from there to here.
+      max_t = t;
+      const Ray &root_ray = _rays[ray._index];
+      hit._node = cnode;
+      hit._solid = solid;
+      hit._distance = t * root_ray._direction.length();
+      hit._point = root_ray._origin + root_ray._direction * t;
+      hit._normal.set(net_inv.get_row3(0).dot(normal),
+                      net_inv.get_row3(1).dot(normal),
+                      net_inv.get_row3(2).dot(normal));
+      hit._normal.normalize();
+    }
+  }
+}
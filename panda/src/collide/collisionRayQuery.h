@@ -0,0 +1,112 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayQuery.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef COLLISIONRAYQUERY_H
+#define COLLISIONRAYQUERY_H
+
+#include "pandabase.h"
+
+#include "collideMask.h"
+#include "luse.h"
+#include "nodePath.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+
+class CollisionNode;
+class CollisionSolid;
+
+/**
+ * Casts a batch of rays into the scene graph, and finds the nearest
+ * collision solid hit by each one.
+ *
+ * This is meant for things like line-of-sight tests, where many thousands of
+ * rays may need to be cast each frame.  Unlike a CollisionRay added to a
+ * CollisionTraverser, the rays are not put into the scene graph, and no
+ * CollisionHandler or CollisionEntry is created; the scene graph is walked
+ * once for the whole batch, and the results are written into a table that is
+ * reused from one call to cast() to the next.
+ *
+ * Only CollisionNodes are considered, not visible geometry.  The rays and the
+ * results are given in the coordinate space of the root passed to cast().
+ */
+class EXPCL_PANDA_COLLIDE CollisionRayQuery {
+PUBLISHED:
+  CollisionRayQuery();
+
+  INLINE void set_from_collide_mask(CollideMask mask);
+  INLINE CollideMask get_from_collide_mask() const;
+  MAKE_PROPERTY(from_collide_mask, get_from_collide_mask,
+                                   set_from_collide_mask);
+
+  INLINE void clear_rays();
+  INLINE int add_ray(const LPoint3 &origin, const LVector3 &direction,
+                     PN_stdfloat max_distance);
+  INLINE int get_num_rays() const;
+  INLINE const LPoint3 &get_ray_origin(int n) const;
+  INLINE const LVector3 &get_ray_direction(int n) const;
+  INLINE PN_stdfloat get_ray_max_distance(int n) const;
+
+  void cast(const NodePath &root);
+
+  INLINE bool has_hit(int n) const;
+  INLINE PN_stdfloat get_hit_distance(int n) const;
+  INLINE const LPoint3 &get_hit_point(int n) const;
+  INLINE const LVector3 &get_hit_normal(int n) const;
+  INLINE CollisionNode *get_hit_node(int n) const;
+  INLINE const CollisionSolid *get_hit_solid(int n) const;
+  NodePath get_hit_node_path(int n) const;
+
+public:
+  // One ray to cast.  The direction need not be normalized; the distance is
+  // measured in the units of the root's coordinate space.
+  class Ray {
+  public:
+    LPoint3 _origin;
+    LVector3 _direction;
+    PN_stdfloat _max_distance;
+  };
+
+  // The nearest thing hit by a ray.  _node is nullptr if the ray didn't hit
+  // anything.  The pointers are only valid as long as the scene graph is not
+  // changed.
+  class Hit {
+  public:
+    CollisionNode *_node;
+    const CollisionSolid *_solid;
+    PN_stdfloat _distance;
+    LPoint3 _point;
+    LVector3 _normal;
+  };
+
+  static void cast_rays(const NodePath &root, CollideMask from_mask,
+                        const Ray *rays, Hit *hits, size_t num_rays,
+                        Thread *current_thread = Thread::get_current_thread());
+
+private:
+  class Walker;
+  class CastJob;
+
+  CollideMask _from_mask;
+  NodePath _root;
+
+  typedef pvector<Ray> Rays;
+  typedef pvector<Hit> Hits;
+  Rays _rays;
+  Hits _hits;
+
+  static PStatCollector _cast_pcollector;
+};
+
+#include "collisionRayQuery.I"
+
+#endif
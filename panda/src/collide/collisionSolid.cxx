@@ -21,6 +21,7 @@
 #include "collisionParabola.h"
 #include "collisionBox.h"
 #include "collisionEntry.h"
+#include "collisionNode.h"
 #include "boundingSphere.h"
 #include "datagram.h"
 #include "datagramIterator.h"
@@ -111,6 +112,51 @@ test_intersection(const CollisionEntry &) const {
   return nullptr;
 }
 
+/**
+ * Finds the nearest point at which the indicated ray, given in the solid's
+ * own coordinate space, meets the solid, as used by CollisionRayQuery.  If
+ * it does so at a parametric distance no greater than max_t along the ray,
+ * fills in t and the surface normal at that point, and returns true.
+ *
+ * The default implementation goes through test_intersection_from_ray(),
+ * which means allocating a CollisionNode, a CollisionRay and a
+ * CollisionEntry on every call, so it is much slower than the direct tests
+ * that all of the solids in this library define.  A new solid that may be
+ * cast against should redefine this as well.
+ */
+bool CollisionSolid::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  PT(CollisionNode) node = new CollisionNode("ray");
+
+  CollisionEntry entry;
+  entry._from = new CollisionRay(origin, direction);
+  entry._into = this;
+  entry._from_node = node;
+  entry._into_node = node;
+  entry._from_node_path = NodePath(node);
+  entry._into_node_path = entry._from_node_path;
+
+  PT(CollisionEntry) result = test_intersection_from_ray(entry);
+  if (result == nullptr || !result->has_surface_point()) {
+    return false;
+  }
+
+  t = (result->_surface_point - origin).dot(direction) /
+      direction.length_squared();
+  if (t > max_t) {
+    return false;
+  }
+
+  if (result->has_surface_normal()) {
+    normal = result->_surface_normal;
+  } else {
+    normal = -direction;
+    normal.normalize();
+  }
+  return true;
+}
+
 /**
  * Transforms the solid by the indicated matrix.
  */
@@ -337,6 +383,356 @@ report_undefined_from_intersection(TypeHandle from_type) {
 #endif  // NDEBUG
 }
 
+/**
+ * Returns the unit-length normal of the indicated convex polygon, computed
+ * with Newell's method, or the zero vector if the polygon is degenerate.
+ */
+static LVector3
+calc_polygon_normal(const LPoint3 *points, size_t num_points) {
+  LVector3 normal(0.0f, 0.0f, 0.0f);
+  for (size_t i = 0; i < num_points; ++i) {
+    const LPoint3 &p = points[i];
+    const LPoint3 &q = points[(i + 1) % num_points];
+    normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+    normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+    normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+  }
+  if (!normal.normalize()) {
+    return LVector3::zero();
+  }
+  return normal;
+}
+
+/**
+ * Returns true if the indicated point, which is assumed to be in the plane of
+ * the convex polygon, is within the polygon.
+ */
+static bool
+point_in_polygon(const LPoint3 &point, const LPoint3 *points,
+                 size_t num_points, const LVector3 &normal) {
+  for (size_t i = 0; i < num_points; ++i) {
+    const LPoint3 &p = points[i];
+    const LPoint3 &q = points[(i + 1) % num_points];
+    if ((q - p).cross(point - p).dot(normal) < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Determines the first moment at which a sphere, moving from the indicated
+ * point by delta, touches the line segment from a to b.  Returns true if it
+ * does so before it has moved the whole of delta, and sets t to the fraction
+ * of delta at which it does (which is 0 if it was already touching), and
+ * into_point to the point on the segment that it touches.
+ */
+bool CollisionSolid::
+sweep_sphere_into_segment(double &t, LPoint3 &into_point,
+                          const LPoint3 &from, const LVector3 &delta,
+                          PN_stdfloat radius,
+                          const LPoint3 &a, const LPoint3 &b) {
+  LVector3 d = b - a;
+  LVector3 m = from - a;
+  double dd = d.dot(d);
+  double md = m.dot(d);
+  double nd = delta.dot(d);
+  double nn = delta.dot(delta);
+  double mn = m.dot(delta);
+  double rr = (double)radius * radius;
+
+  // Is it touching already?
+  double s = (dd > 0.0) ? std::min(1.0, std::max(0.0, md / dd)) : 0.0;
+  LPoint3 closest = a + d * s;
+  if ((from - closest).length_squared() <= rr) {
+    t = 0.0;
+    into_point = closest;
+    return true;
+  }
+
+  double best_t = 2.0;
+
+  // First, the sides of the capsule around the segment: the infinite
+  // cylinder, clipped to the length of the segment.
+  double qa = dd * nn - nd * nd;
+  if (dd > 0.0 && qa > 1.0e-12 * dd * nn) {
+    double qb = dd * mn - nd * md;
+    double qc = dd * (m.dot(m) - rr) - md * md;
+    double disc = qb * qb - qa * qc;
+    if (disc >= 0.0) {
+      double tc = (-qb - sqrt(disc)) / qa;
+      double sc = md + tc * nd;
+      if (tc >= 0.0 && tc <= 1.0 && sc >= 0.0 && sc <= dd) {
+        best_t = tc;
+      }
+    }
+  }
+
+  // Then the caps at either end.
+  if (nn > 0.0) {
+    const LPoint3 *ends[2] = { &a, &b };
+    for (int i = 0; i < 2; ++i) {
+      LVector3 me = from - *ends[i];
+      double mne = me.dot(delta);
+      double disc = mne * mne - nn * (me.dot(me) - rr);
+      if (disc >= 0.0) {
+        double te = (-mne - sqrt(disc)) / nn;
+        if (te >= 0.0 && te < best_t) {
+          best_t = te;
+        }
+      }
+    }
+  }
+
+  if (best_t > 1.0) {
+    return false;
+  }
+
+  t = best_t;
+  LPoint3 center = from + delta * t;
+  s = (dd > 0.0) ? std::min(1.0, std::max(0.0, (center - a).dot(d) / dd)) : 0.0;
+  into_point = a + d * s;
+  return true;
+}
+
+/**
+ * Determines the first moment at which a sphere, moving from the indicated
+ * point by delta, touches the indicated convex polygon.  Returns true if it
+ * does so before it has moved the whole of delta, and sets t to the fraction
+ * of delta at which it does (which is 0 if it was already touching), and
+ * into_point to the point on the polygon that it touches.
+ *
+ * If two_sided is false, a sphere that starts out entirely behind the
+ * polygon never touches it.
+ */
+bool CollisionSolid::
+sweep_sphere_into_polygon(double &t, LPoint3 &into_point,
+                          const LPoint3 &from, const LVector3 &delta,
+                          PN_stdfloat radius,
+                          const LPoint3 *points, size_t num_points,
+                          bool two_sided) {
+  double best_t = 2.0;
+
+  // A polygon that has collapsed into a line has no face; only its edges
+  // are tested.
+  LVector3 normal = calc_polygon_normal(points, num_points);
+  if (normal != LVector3::zero()) {
+    PN_stdfloat dist = (from - points[0]).dot(normal);
+    if (dist < -radius && !two_sided) {
+      return false;
+    }
+
+    if (cabs(dist) <= radius) {
+      LPoint3 projected = from - normal * dist;
+      if (point_in_polygon(projected, points, num_points, normal)) {
+        // It is touching the face already.
+        t = 0.0;
+        into_point = projected;
+        return true;
+      }
+
+    } else {
+      // The center reaches the face when it is one radius away from its
+      // plane, if that point is within the polygon.
+      LVector3 side = (dist < 0.0f) ? -normal : normal;
+      PN_stdfloat side_dist = cabs(dist);
+      double dn = delta.dot(side);
+      if (dn < 0.0) {
+        double tf = (side_dist - radius) / -dn;
+        if (tf <= 1.0) {
+          LPoint3 projected = from + delta * tf - side * radius;
+          if (point_in_polygon(projected, points, num_points, normal)) {
+            best_t = tf;
+            into_point = projected;
+          }
+        }
+      }
+    }
+  }
+
+  // Otherwise, it must touch one of the edges first.
+  for (size_t i = 0; i < num_points; ++i) {
+    double te;
+    LPoint3 edge_point;
+    if (sweep_sphere_into_segment(te, edge_point, from, delta, radius,
+                                  points[i], points[(i + 1) % num_points]) &&
+        te < best_t) {
+      best_t = te;
+      into_point = edge_point;
+    }
+  }
+
+  if (best_t > 1.0) {
+    return false;
+  }
+  t = best_t;
+  return true;
+}
+
+/**
+ * Determines the first moment at which a capsule around the segment from
+ * from_a to from_b, moving by delta, touches the line segment from a to b.
+ * Returns true if it does so before it has moved the whole of delta, and sets
+ * t to the fraction of delta at which it does (which is 0 if it was already
+ * touching), and from_point and into_point to the nearest points of the two
+ * segments at that moment.
+ */
+bool CollisionSolid::
+sweep_segment_into_segment(double &t, LPoint3 &from_point,
+                           LPoint3 &into_point,
+                           const LPoint3 &from_a, const LPoint3 &from_b,
+                           const LVector3 &delta, PN_stdfloat radius,
+                           const LPoint3 &a, const LPoint3 &b) {
+  // The segments touch when the origin, moved by delta, comes within radius
+  // of the parallelogram formed by the differences between their points.
+  LPoint3 diffs[4] = {
+    LPoint3(a - from_a),
+    LPoint3(b - from_a),
+    LPoint3(b - from_b),
+    LPoint3(a - from_b),
+  };
+  LPoint3 diff_point;
+  if (!sweep_sphere_into_polygon(t, diff_point, LPoint3::origin(), delta,
+                                 radius, diffs, 4, true)) {
+    return false;
+  }
+
+  LPoint3 moved_a = from_a + delta * t;
+  LVector3 from_direction = from_b - from_a;
+  LVector3 into_direction = b - a;
+  double t1, t2;
+  CollisionCapsule::calc_closest_segment_points(t1, t2, moved_a, from_direction,
+                                                a, into_direction);
+  from_point = moved_a + from_direction * t1;
+  into_point = a + into_direction * t2;
+  return true;
+}
+
+/**
+ * Determines the first moment at which a capsule around the segment from
+ * from_a to from_b, moving by delta, touches the indicated convex polygon.
+ * Returns true if it does so before it has moved the whole of delta, and sets
+ * t to the fraction of delta at which it does (which is 0 if it was already
+ * touching), and from_point and into_point to the nearest points of the
+ * segment and the polygon at that moment.
+ *
+ * If two_sided is false, a capsule that starts out entirely behind the
+ * polygon never touches it.
+ */
+bool CollisionSolid::
+sweep_segment_into_polygon(double &t, LPoint3 &from_point,
+                           LPoint3 &into_point,
+                           const LPoint3 &from_a, const LPoint3 &from_b,
+                           const LVector3 &delta, PN_stdfloat radius,
+                           const LPoint3 *points, size_t num_points,
+                           bool two_sided) {
+  LVector3 normal = calc_polygon_normal(points, num_points);
+  if (normal != LVector3::zero()) {
+    PN_stdfloat dist_a = (from_a - points[0]).dot(normal);
+    PN_stdfloat dist_b = (from_b - points[0]).dot(normal);
+    if (dist_a < -radius && dist_b < -radius && !two_sided) {
+      return false;
+    }
+
+    if ((dist_a <= 0.0f) != (dist_b <= 0.0f)) {
+      // Does the segment already pass through the polygon?
+      LPoint3 pierce = from_a + (from_b - from_a) * (dist_a / (dist_a - dist_b));
+      if (point_in_polygon(pierce, points, num_points, normal)) {
+        t = 0.0;
+        from_point = pierce;
+        into_point = pierce;
+        return true;
+      }
+    }
+  }
+
+  // Since the polygon is flat, the capsule can only touch it first with one
+  // of its ends, or along one of the edges of the polygon.
+  double best_t = 2.0;
+  LPoint3 end_point;
+  double te;
+  if (sweep_sphere_into_polygon(te, end_point, from_a, delta, radius,
+                                points, num_points, two_sided)) {
+    best_t = te;
+    from_point = from_a + delta * te;
+    into_point = end_point;
+  }
+  if (sweep_sphere_into_polygon(te, end_point, from_b, delta, radius,
+                                points, num_points, two_sided) &&
+      te < best_t) {
+    best_t = te;
+    from_point = from_b + delta * te;
+    into_point = end_point;
+  }
+
+  for (size_t i = 0; i < num_points && best_t > 0.0; ++i) {
+    LPoint3 axis_point, edge_point;
+    if (sweep_segment_into_segment(te, axis_point, edge_point, from_a, from_b,
+                                   delta, radius, points[i],
+                                   points[(i + 1) % num_points]) &&
+        te < best_t) {
+      best_t = te;
+      from_point = axis_point;
+      into_point = edge_point;
+    }
+  }
+
+  if (best_t > 1.0) {
+    return false;
+  }
+  t = best_t;
+  return true;
+}
+
+/**
+ * Creates a CollisionEntry for a "from" object that was found, by one of the
+ * sweep functions above, to have first touched this solid at the fraction t
+ * of its motion by delta.  from_point and into_point are the points at which
+ * they touched, and contact_pos is the position of the "from" object at that
+ * moment.  The interior point is placed such that pushing the "from" object
+ * out along the surface normal returns it to the point of contact.
+ *
+ * A t of 0 means that they were touching at the start, but no longer are;
+ * this is only a collision if the "from" object passed through the solid,
+ * rather than moving away from it, so this returns nullptr in the latter
+ * case.
+ */
+PT(CollisionEntry) CollisionSolid::
+make_swept_entry(const CollisionEntry &entry, double t,
+                 const LPoint3 &from_point, const LPoint3 &into_point,
+                 const LVector3 &delta, const LPoint3 &contact_pos,
+                 const LVector3 &default_normal) const {
+  LVector3 contact_normal = from_point - into_point;
+  if (!contact_normal.normalize()) {
+    contact_normal = default_normal;
+  }
+
+  if (t <= 0.0 && delta.dot(contact_normal) >= 0.0f) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << " at t = " << t << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && entry.get_from()->get_respect_effective_normal()) ? get_effective_normal() : contact_normal;
+
+  // This is how far the "from" object has gone past the point of contact.
+  PN_stdfloat depth = std::max(-delta.dot(contact_normal) * (PN_stdfloat)(1.0 - t), (PN_stdfloat)0.0f);
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(into_point);
+  new_entry->set_interior_point(into_point - contact_normal * depth);
+  new_entry->set_contact_pos(contact_pos);
+  new_entry->set_contact_normal(contact_normal);
+  new_entry->set_t(t);
+
+  return new_entry;
+}
+
 /**
  * Function to write the important information in the particular object to a
  * Datagram
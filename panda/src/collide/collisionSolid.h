@@ -79,6 +79,9 @@ public:
   virtual PT(CollisionEntry)
   test_intersection(const CollisionEntry &entry) const;
 
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
   virtual void xform(const LMatrix4 &mat);
 
   virtual PT(PandaNode) get_viz(const CullTraverser *trav,
@@ -118,6 +121,39 @@ protected:
                                                  TypeHandle into_type);
   static void report_undefined_from_intersection(TypeHandle from_type);
 
+  static bool sweep_sphere_into_segment(double &t, LPoint3 &into_point,
+                                        const LPoint3 &from,
+                                        const LVector3 &delta,
+                                        PN_stdfloat radius,
+                                        const LPoint3 &a, const LPoint3 &b);
+  static bool sweep_sphere_into_polygon(double &t, LPoint3 &into_point,
+                                        const LPoint3 &from,
+                                        const LVector3 &delta,
+                                        PN_stdfloat radius,
+                                        const LPoint3 *points,
+                                        size_t num_points, bool two_sided);
+  static bool sweep_segment_into_segment(double &t, LPoint3 &from_point,
+                                         LPoint3 &into_point,
+                                         const LPoint3 &from_a,
+                                         const LPoint3 &from_b,
+                                         const LVector3 &delta,
+                                         PN_stdfloat radius,
+                                         const LPoint3 &a, const LPoint3 &b);
+  static bool sweep_segment_into_polygon(double &t, LPoint3 &from_point,
+                                         LPoint3 &into_point,
+                                         const LPoint3 &from_a,
+                                         const LPoint3 &from_b,
+                                         const LVector3 &delta,
+                                         PN_stdfloat radius,
+                                         const LPoint3 *points,
+                                         size_t num_points, bool two_sided);
+  PT(CollisionEntry) make_swept_entry(const CollisionEntry &entry, double t,
+                                      const LPoint3 &from_point,
+                                      const LPoint3 &into_point,
+                                      const LVector3 &delta,
+                                      const LPoint3 &contact_pos,
+                                      const LVector3 &default_normal) const;
+
   INLINE void mark_viz_stale();
   virtual void fill_viz_geom();
 
@@ -23,6 +23,7 @@
 #include "collisionCapsule.h"
 #include "collisionPolygon.h"
 #include "collisionPlane.h"
+#include "collisionTriangleMesh.h"
 #include "config_collide.h"
 #include "boundingSphere.h"
 #include "transformState.h"
@@ -32,6 +33,10 @@
 #include "geomTriangles.h"
 #include "geomVertexReader.h"
 #include "lodNode.h"
+#include "spatialIndexNode.h"
+#include "boundingBoxTree.h"
+#include "finiteBoundingVolume.h"
+#include "pset.h"
 #include "nodePath.h"
 #include "pStatTimer.h"
 #include "indent.h"
@@ -65,6 +70,174 @@ public:
   const CollisionTraverser &_trav;
 };
 
+/**
+ * Fills result with the indices of the children of the indicated
+ * SpatialIndexNode that might be intersected by any of the active colliders
+ * in the level state, in increasing order.  Returns false if all of the
+ * children must be visited instead.
+ */
+template<class LevelState>
+static bool
+find_indexed_children(const LevelState &level_state, SpatialIndexNode *node,
+                      vector_int &result) {
+  result.clear();
+  vector_int found;
+
+  int num_colliders = level_state.get_num_colliders();
+  for (int c = 0; c < num_colliders; ++c) {
+    if (level_state.has_collider(c)) {
+      const GeometricBoundingVolume *bound = level_state.get_local_bound(c);
+      if (bound == nullptr) {
+        // No bounding volume; this collider might touch anything.
+        return false;
+      }
+      node->find_children(bound, found);
+      result.insert(result.end(), found.begin(), found.end());
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return true;
+}
+
+/**
+ * The working data of traverse_broadphase(): the nodes that might be collided
+ * into, and a spatial index over their bounding volumes.
+ */
+class CollisionTraverser::Broadphase {
+public:
+  // One of these is recorded for each CollisionNode or GeomNode found.
+  class Item {
+  public:
+    PandaNode *_node;
+    NodePath _node_path;
+    CollideMask _include_mask;
+    LMatrix4 _parent_inv;
+    LMatrix4 _node_inv;
+    int _chain;
+    bool _bounded;
+    bool _final;
+    LPoint3 _min;
+    LPoint3 _max;
+  };
+
+  // The colliders found above each Item are kept in a tree of these, since a
+  // collider is never tested against itself or anything below it.
+  class Link {
+  public:
+    PandaNode *_node;
+    int _parent;
+  };
+
+  // A collider that might collide with an Item, identified by its pass and
+  // its index within the pass.  These are sorted into the order in which
+  // r_traverse_single() would have tested them.
+  class Pair {
+  public:
+    bool operator < (const Pair &other) const {
+      if (_pass != other._pass) {
+        return _pass < other._pass;
+      }
+      if (_item != other._item) {
+        return _item < other._item;
+      }
+      return _collider < other._collider;
+    }
+
+    size_t _pass;
+    int _item;
+    int _collider;
+  };
+
+  bool is_below(const Item &item, const PandaNode *node) const {
+    for (int li = item._chain; li >= 0; li = _chain[li]._parent) {
+      if (_chain[li]._node == node) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Computes the box in the space of the root that contains the indicated
+  // bounding volume, which is in the space given by parent_mat.  Returns
+  // false if the volume is not finite.
+  static bool get_root_box(const BoundingVolume *bv, const LMatrix4 &parent_mat,
+                           LPoint3 &min, LPoint3 &max) {
+    const FiniteBoundingVolume *fbv = bv->as_finite_bounding_volume();
+    if (fbv == nullptr || bv->is_infinite()) {
+      return false;
+    }
+    LPoint3 bv_min = fbv->get_min();
+    LPoint3 bv_max = fbv->get_max();
+    for (int i = 0; i < 8; ++i) {
+      LPoint3 corner((i & 1) ? bv_max[0] : bv_min[0],
+                     (i & 2) ? bv_max[1] : bv_min[1],
+                     (i & 4) ? bv_max[2] : bv_min[2]);
+      corner = corner * parent_mat;
+      if (i == 0) {
+        min = corner;
+        max = corner;
+      } else {
+        min = min.fmin(corner);
+        max = max.fmax(corner);
+      }
+    }
+    return true;
+  }
+
+  pvector<Item> _items;
+  pvector<Link> _chain;
+  vector_int _unbounded;
+  pset<const PandaNode *> _collider_nodes;
+  CollideMask _from_mask;
+  BoundingBoxTree _tree;
+
+  // While walking below a node marked final, this holds that node's box.
+  // r_traverse_single() tests the colliders against the final node's bounds
+  // only, and not against anything below it, so the nodes below it are
+  // found with the final node's box instead of their own.
+  bool _in_final;
+  bool _final_bounded;
+  LPoint3 _final_min;
+  LPoint3 _final_max;
+};
+
+/**
+ * Collects the entries detected by one pass of traverse_parallel(), to be
+ * handed to the real handlers later.
+ */
+class CollisionTraverser::PassBuffer : public CollisionHandler {
+public:
+  virtual void add_entry(CollisionEntry *entry) {
+    _entries.push_back(entry);
+  }
+
+  pvector<PT(CollisionEntry)> _entries;
+};
+
+/**
+ * Runs the passes of traverse_parallel(), one per item.
+ */
+class CollisionTraverser::ParallelJob : public WorkerPool::Job {
+public:
+  ParallelJob(CollisionTraverser *trav, LevelStatesSingle &level_states) :
+    _trav(trav),
+    _level_states(level_states)
+  {
+  }
+
+  virtual void run_item(size_t pass, Thread *current_thread) {
+#ifdef DO_PSTATS
+    PStatTimer pass_timer(_trav->_pass_collectors[pass], current_thread);
+#endif
+    _trav->r_traverse_single(_level_states[pass], pass);
+  }
+
+  CollisionTraverser *_trav;
+  LevelStatesSingle &_level_states;
+};
+
 /**
  *
  */
@@ -74,6 +247,8 @@ CollisionTraverser(const std::string &name) :
   _this_pcollector(_collisions_pcollector, name)
 {
   _respect_prev_transform = respect_prev_transform;
+  _broadphase = collision_broadphase;
+  _pass_handlers = nullptr;
   #ifdef DO_COLLISION_RECORDING
   _recorder = nullptr;
   #endif
@@ -269,8 +444,25 @@ traverse(const NodePath &root) {
   }
 
   bool traversal_done = false;
-  if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
-      !allow_collider_multiple) {
+  if (_broadphase) {
+    traverse_broadphase(root);
+    traversal_done = true;
+  }
+
+  if (!traversal_done &&
+      (int)_colliders.size() > CollisionLevelStateSingle::get_max_colliders() &&
+      can_traverse_parallel()) {
+    // Divide the colliders into passes as usual, but hand the passes to the
+    // worker threads.
+    LevelStatesSingle level_states;
+    prepare_colliders_single(level_states, root);
+    traverse_parallel(level_states, WorkerPool::get_global_ptr());
+    traversal_done = true;
+  }
+
+  if (!traversal_done &&
+      ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
+       !allow_collider_multiple)) {
     // Use the single-word-at-a-time traverser, which might need to make lots
     // of passes.
     LevelStatesSingle level_states;
@@ -349,6 +541,8 @@ traverse(const NodePath &root) {
   CollisionPolygon::flush_level();
   CollisionPlane::flush_level();
   CollisionBox::flush_level();
+  CollisionTriangleMesh::flush_level();
+  CollisionEntry::flush_level();
 }
 
 #ifdef DO_COLLISION_RECORDING
@@ -470,6 +664,324 @@ write(std::ostream &out, int indent_level) const {
   }
 }
 
+/**
+ * Returns true if the passes of the next traversal may be run in parallel by
+ * traverse_parallel().
+ */
+bool CollisionTraverser::
+can_traverse_parallel() const {
+  if (!parallel_collide) {
+    return false;
+  }
+
+#ifdef DO_COLLISION_RECORDING
+  if (has_recorder()) {
+    // The recorder expects to be called from one thread.
+    return false;
+  }
+#endif  // DO_COLLISION_RECORDING
+
+  Handlers::const_iterator hi;
+  for (hi = _handlers.begin(); hi != _handlers.end(); ++hi) {
+    if ((*hi).first->wants_all_potential_collidees()) {
+      // This requires the real handler at the time of the test.
+      return false;
+    }
+  }
+
+  return WorkerPool::get_global_ptr()->get_num_threads() > 0;
+}
+
+/**
+ * Runs each of the indicated passes on the threads of the indicated pool.
+ * The entries detected by each pass are collected in a separate buffer, and
+ * are handed to the real handlers on the current thread once all of the
+ * passes are done, in the same order in which a serial traversal would have
+ * produced them.
+ */
+void CollisionTraverser::
+traverse_parallel(LevelStatesSingle &level_states, WorkerPool *pool) {
+  size_t num_passes = level_states.size();
+
+  pvector<PT(PassBuffer)> buffers;
+  pvector<CollisionHandler *> handlers;
+  buffers.reserve(num_passes);
+  handlers.reserve(num_passes);
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    buffers.push_back(new PassBuffer);
+    handlers.push_back(buffers.back());
+
+    // Make sure the collectors exist before the threads need them.
+    get_pass_collector(pass);
+  }
+
+  if (num_passes > 0) {
+    _pass_handlers = &handlers[0];
+    ParallelJob job(this, level_states);
+    pool->run(job, num_passes);
+    _pass_handlers = nullptr;
+  }
+
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    PassBuffer *buffer = buffers[pass];
+    for (CollisionEntry *entry : buffer->_entries) {
+      Colliders::const_iterator ci;
+      ci = _colliders.find(entry->get_from_node_path());
+      nassertd(ci != _colliders.end()) continue;
+      (*ci).second->add_entry(entry);
+    }
+  }
+}
+
+/**
+ * Performs the traversal begun by traverse() using a broadphase stage.  The
+ * scene graph is walked just once, to collect the nodes that might be
+ * collided into, along with their bounding volumes in the space of the root.
+ * Each collider then looks up the nodes near it in a BoundingBoxTree, and
+ * is compared only to those.
+ *
+ * The colliders are grouped into passes in the same way as for
+ * r_traverse_single(), and the pairs are tested in the same order in which
+ * it would have tested them, so the handlers receive the same entries in the
+ * same order.
+ */
+void CollisionTraverser::
+traverse_broadphase(const NodePath &root) {
+  LevelStatesSingle level_states;
+  prepare_colliders_single(level_states, root);
+
+  Broadphase bp;
+  bp._in_final = false;
+  size_t num_passes = level_states.size();
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    const CollisionLevelStateSingle &level_state = level_states[pass];
+    int num_colliders = level_state.get_num_colliders();
+    for (int c = 0; c < num_colliders; ++c) {
+      CollisionNode *cnode = level_state.get_collider_node(c);
+      bp._from_mask |= cnode->get_from_collide_mask();
+      bp._collider_nodes.insert(cnode);
+    }
+  }
+  if (bp._from_mask.is_zero()) {
+    return;
+  }
+
+  WorkingNodePath root_path(root);
+  r_collect_broadphase(bp, root_path, CollideMask::all_on(),
+                       LMatrix4::ident_mat(), LMatrix4::ident_mat(), -1);
+
+  int num_items = (int)bp._items.size();
+  bp._tree.set_num_items(num_items);
+  for (int i = 0; i < num_items; ++i) {
+    const Broadphase::Item &item = bp._items[i];
+    if (item._bounded) {
+      bp._tree.set_item(i, item._min, item._max);
+    }
+  }
+  bp._tree.rebuild();
+
+  // Find the pairs of colliders and nodes that might collide.
+  pvector<Broadphase::Pair> pairs;
+  vector_int found;
+  for (size_t pass = 0; pass < num_passes; ++pass) {
+    const CollisionLevelStateSingle &level_state = level_states[pass];
+    int num_colliders = level_state.get_num_colliders();
+    for (int c = 0; c < num_colliders; ++c) {
+      found.clear();
+      const GeometricBoundingVolume *bound = level_state.get_local_bound(c);
+      if (bound != nullptr && !bound->is_infinite()) {
+        const FiniteBoundingVolume *fbv = bound->as_finite_bounding_volume();
+        if (fbv != nullptr) {
+          bp._tree.find_overlaps(fbv->get_min(), fbv->get_max(), found);
+        } else {
+          // This is something like the BoundingLine of a ray.
+          bp._tree.find_overlaps(bound, found);
+        }
+        found.insert(found.end(), bp._unbounded.begin(), bp._unbounded.end());
+      } else {
+        // Without a bounding box, this collider might touch anything.
+        for (int i = 0; i < num_items; ++i) {
+          found.push_back(i);
+        }
+      }
+
+      CollisionNode *from_node = level_state.get_collider_node(c);
+      CollideMask from_mask = from_node->get_from_collide_mask();
+      for (int i : found) {
+        const Broadphase::Item &item = bp._items[i];
+        PandaNode *into_node = item._node;
+        CollideMask into_mask = into_node->is_collision_node()
+          ? ((CollisionNode *)into_node)->get_into_collide_mask()
+          : ((GeomNode *)into_node)->get_into_collide_mask();
+
+        if ((from_mask & into_mask).is_zero() ||
+            (from_mask & item._include_mask &
+             into_node->get_net_collide_mask()).is_zero() ||
+            bp.is_below(item, from_node)) {
+          continue;
+        }
+
+        Broadphase::Pair pair;
+        pair._pass = pass;
+        pair._item = i;
+        pair._collider = c;
+        pairs.push_back(pair);
+      }
+    }
+  }
+
+  std::sort(pairs.begin(), pairs.end());
+
+  // Now test them.
+  for (const Broadphase::Pair &pair : pairs) {
+    const CollisionLevelStateSingle &level_state = level_states[pair._pass];
+    const Broadphase::Item &item = bp._items[pair._item];
+
+    CollisionEntry entry;
+    entry._into_node = item._node;
+    entry._into_node_path = item._node_path;
+    if (_respect_prev_transform) {
+      entry._flags |= CollisionEntry::F_respect_prev_transform;
+    }
+    entry._from_node = level_state.get_collider_node(pair._collider);
+    entry._from_node_path = level_state.get_collider_node_path(pair._collider);
+    entry._from = level_state.get_collider(pair._collider);
+
+    // Put the collider's bounding volume into the spaces of the node and of
+    // its parent.
+    PT(GeometricBoundingVolume) parent_gbv, node_gbv;
+    const GeometricBoundingVolume *bound = level_state.get_local_bound(pair._collider);
+    if (bound != nullptr && !item._final) {
+      parent_gbv = (GeometricBoundingVolume *)bound->make_copy();
+      parent_gbv->xform(item._parent_inv);
+      node_gbv = (GeometricBoundingVolume *)bound->make_copy();
+      node_gbv->xform(item._node_inv);
+    }
+
+    CPT(BoundingVolume) into_bv = item._node->get_bounds();
+    const GeometricBoundingVolume *into_gbv = into_bv->as_geometric_bounding_volume();
+
+    if (item._node->is_collision_node()) {
+      compare_collider_to_node(entry, pair._pass, parent_gbv, node_gbv, into_gbv);
+    } else {
+      compare_collider_to_geom_node(entry, pair._pass, parent_gbv, node_gbv, into_gbv);
+    }
+  }
+}
+
+/**
+ * Walks the scene graph for traverse_broadphase(), recording each
+ * CollisionNode and GeomNode that any of the colliders might collide with.
+ * This follows the same rules as r_traverse_single() for which nodes are
+ * visited and with which collide mask.
+ */
+void CollisionTraverser::
+r_collect_broadphase(Broadphase &bp, const WorkingNodePath &node_path,
+                     CollideMask include_mask, const LMatrix4 &parent_mat,
+                     const LMatrix4 &parent_inv, int chain) {
+  PandaNode *node = node_path.node();
+  if ((node->get_net_collide_mask() & include_mask & bp._from_mask).is_zero()) {
+    return;
+  }
+
+  CPT(BoundingVolume) node_bv = node->get_bounds();
+  if (node_bv->is_empty()) {
+    return;
+  }
+
+  LMatrix4 net_mat = parent_mat;
+  LMatrix4 net_inv = parent_inv;
+  CPT(TransformState) transform = node->get_transform();
+  if (!transform->is_identity()) {
+    CPT(TransformState) inv_transform =
+      transform->invert_compose(TransformState::make_identity());
+    if (!inv_transform->has_mat()) {
+      // No inverse.
+      return;
+    }
+    net_mat = transform->get_mat() * parent_mat;
+    net_inv = parent_inv * inv_transform->get_mat();
+  }
+
+  // Remember the box of the outermost final node while we are below it.
+  bool entered_final = false;
+  if (node->is_final() && !bp._in_final) {
+    entered_final = true;
+    bp._in_final = true;
+    bp._final_bounded = Broadphase::get_root_box(node_bv, parent_mat,
+                                                 bp._final_min, bp._final_max);
+  }
+
+  if (bp._collider_nodes.find(node) != bp._collider_nodes.end()) {
+    Broadphase::Link link;
+    link._node = node;
+    link._parent = chain;
+    chain = (int)bp._chain.size();
+    bp._chain.push_back(link);
+  }
+
+  if (node->is_collision_node() || node->is_geom_node()) {
+    Broadphase::Item item;
+    item._node = node;
+    item._node_path = node_path.get_node_path();
+    item._include_mask = include_mask;
+    item._parent_inv = parent_inv;
+    item._node_inv = net_inv;
+    item._chain = chain;
+    item._final = bp._in_final;
+
+    if (bp._in_final) {
+      item._bounded = bp._final_bounded;
+      item._min = bp._final_min;
+      item._max = bp._final_max;
+    } else {
+      // The node's bounding volume is in the space of its parent; find the
+      // box that contains it in the space of the root.
+      item._bounded = Broadphase::get_root_box(node_bv, parent_mat,
+                                               item._min, item._max);
+    }
+    if (!item._bounded) {
+      bp._unbounded.push_back((int)bp._items.size());
+    }
+    bp._items.push_back(item);
+  }
+
+  if (node->has_single_child_visibility()) {
+    int index = node->get_visible_child();
+    if (index >= 0 && index < node->get_num_children()) {
+      WorkingNodePath next_path(node_path, node->get_child(index));
+      r_collect_broadphase(bp, next_path, include_mask, net_mat, net_inv, chain);
+    }
+
+  } else if (node->is_lod_node()) {
+    // As in r_traverse_single(), only the lowest level of detail may be
+    // collided with as visible geometry.
+    int index = DCAST(LODNode, node)->get_lowest_switch();
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      WorkingNodePath next_path(node_path, children.get_child(i));
+      CollideMask next_mask = include_mask;
+      if (i != index) {
+        next_mask &= ~GeomNode::get_default_collide_mask();
+      }
+      r_collect_broadphase(bp, next_path, next_mask, net_mat, net_inv, chain);
+    }
+
+  } else {
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i = 0; i < num_children; ++i) {
+      WorkingNodePath next_path(node_path, children.get_child(i));
+      r_collect_broadphase(bp, next_path, include_mask, net_mat, net_inv, chain);
+    }
+  }
+
+  if (entered_final) {
+    bp._in_final = false;
+  }
+}
+
 /**
  * Fills up the set of LevelStates corresponding to the active colliders in
  * use.
@@ -589,7 +1101,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
           entry._from = level_state.get_collider(c);
 
           compare_collider_to_node(
-              entry,
+              entry, pass,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               node_gbv);
@@ -634,7 +1146,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
           entry._from = level_state.get_collider(c);
 
           compare_collider_to_geom_node(
-              entry,
+              entry, pass,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               node_gbv);
@@ -643,6 +1155,7 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     }
   }
 
+  vector_int indices;
   if (node->has_single_child_visibility()) {
     // If it's a switch node or sequence node, visit just the one visible
     // child.
@@ -670,6 +1183,20 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
       r_traverse_single(next_state, pass);
     }
 
+  } else if (node->is_of_type(SpatialIndexNode::get_class_type()) &&
+             find_indexed_children(level_state, (SpatialIndexNode *)node,
+                                   indices)) {
+    // If it's a SpatialIndexNode, visit only the children that the colliders
+    // might reach.
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i : indices) {
+      if (i < num_children) {
+        CollisionLevelStateSingle next_state(level_state, children.get_child(i));
+        r_traverse_single(next_state, pass);
+      }
+    }
+
   } else {
     // Otherwise, visit all the children.
     PandaNode::Children children = node->get_children();
@@ -800,7 +1327,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
           entry._from = level_state.get_collider(c);
 
           compare_collider_to_node(
-              entry,
+              entry, pass,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               node_gbv);
@@ -845,7 +1372,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
           entry._from = level_state.get_collider(c);
 
           compare_collider_to_geom_node(
-              entry,
+              entry, pass,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               node_gbv);
@@ -854,6 +1381,7 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     }
   }
 
+  vector_int indices;
   if (node->has_single_child_visibility()) {
     // If it's a switch node or sequence node, visit just the one visible
     // child.
@@ -881,6 +1409,20 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
       r_traverse_double(next_state, pass);
     }
 
+  } else if (node->is_of_type(SpatialIndexNode::get_class_type()) &&
+             find_indexed_children(level_state, (SpatialIndexNode *)node,
+                                   indices)) {
+    // If it's a SpatialIndexNode, visit only the children that the colliders
+    // might reach.
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i : indices) {
+      if (i < num_children) {
+        CollisionLevelStateDouble next_state(level_state, children.get_child(i));
+        r_traverse_double(next_state, pass);
+      }
+    }
+
   } else {
     // Otherwise, visit all the children.
     PandaNode::Children children = node->get_children();
@@ -1011,7 +1553,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
           entry._from = level_state.get_collider(c);
 
           compare_collider_to_node(
-              entry,
+              entry, pass,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               node_gbv);
@@ -1056,7 +1598,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
           entry._from = level_state.get_collider(c);
 
           compare_collider_to_geom_node(
-              entry,
+              entry, pass,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               node_gbv);
@@ -1065,6 +1607,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     }
   }
 
+  vector_int indices;
   if (node->has_single_child_visibility()) {
     // If it's a switch node or sequence node, visit just the one visible
     // child.
@@ -1092,6 +1635,20 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
       r_traverse_quad(next_state, pass);
     }
 
+  } else if (node->is_of_type(SpatialIndexNode::get_class_type()) &&
+             find_indexed_children(level_state, (SpatialIndexNode *)node,
+                                   indices)) {
+    // If it's a SpatialIndexNode, visit only the children that the colliders
+    // might reach.
+    PandaNode::Children children = node->get_children();
+    int num_children = children.get_num_children();
+    for (int i : indices) {
+      if (i < num_children) {
+        CollisionLevelStateQuad next_state(level_state, children.get_child(i));
+        r_traverse_quad(next_state, pass);
+      }
+    }
+
   } else {
     // Otherwise, visit all the children.
     PandaNode::Children children = node->get_children();
@@ -1107,7 +1664,7 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
  *
  */
 void CollisionTraverser::
-compare_collider_to_node(CollisionEntry &entry,
+compare_collider_to_node(CollisionEntry &entry, size_t pass,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
                          const GeometricBoundingVolume *into_node_gbv) {
@@ -1137,10 +1694,9 @@ compare_collider_to_node(CollisionEntry &entry,
     // we just tested, is the same as the solid's bounding volume.)
     if (num_solids == 1) {
       entry._into = cnode->_solids[0].get_read_pointer(current_thread);
-      Colliders::const_iterator ci;
-      ci = _colliders.find(entry.get_from_node_path());
-      nassertv(ci != _colliders.end());
-      entry.test_intersection((*ci).second, this);
+      CollisionHandler *handler = get_entry_handler(entry, pass);
+      nassertv(handler != nullptr);
+      entry.test_intersection(handler, this);
     } else {
       CollisionNode::Solids::const_iterator si;
       for (si = cnode->_solids.begin(); si != cnode->_solids.end(); ++si) {
@@ -1156,7 +1712,7 @@ compare_collider_to_node(CollisionEntry &entry,
           solid_gbv = (const GeometricBoundingVolume *)solid_bv.p();
         }
 
-        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+        compare_collider_to_solid(entry, pass, from_node_gbv, solid_gbv);
       }
     }
   }
@@ -1166,7 +1722,7 @@ compare_collider_to_node(CollisionEntry &entry,
  *
  */
 void CollisionTraverser::
-compare_collider_to_geom_node(CollisionEntry &entry,
+compare_collider_to_geom_node(CollisionEntry &entry, size_t pass,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
                               const GeometricBoundingVolume *into_node_gbv) {
@@ -1197,7 +1753,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           DCAST_INTO_V(geom_gbv, geom_bv);
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, pass, geom, from_node_gbv, geom_gbv);
       }
     }
   }
@@ -1207,7 +1763,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
  *
  */
 void CollisionTraverser::
-compare_collider_to_solid(CollisionEntry &entry,
+compare_collider_to_solid(CollisionEntry &entry, size_t pass,
                           const GeometricBoundingVolume *from_node_gbv,
                           const GeometricBoundingVolume *solid_gbv) {
   bool within_solid_bounds = true;
@@ -1227,10 +1783,9 @@ compare_collider_to_solid(CollisionEntry &entry,
 #endif  // NDEBUG
   }
   if (within_solid_bounds) {
-    Colliders::const_iterator ci;
-    ci = _colliders.find(entry.get_from_node_path());
-    nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    CollisionHandler *handler = get_entry_handler(entry, pass);
+    nassertv(handler != nullptr);
+    entry.test_intersection(handler, this);
   }
 }
 
@@ -1238,7 +1793,8 @@ compare_collider_to_solid(CollisionEntry &entry,
  *
  */
 void CollisionTraverser::
-compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
+compare_collider_to_geom(CollisionEntry &entry, size_t pass,
+                         const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
                          const GeometricBoundingVolume *geom_gbv) {
   bool within_geom_bounds = true;
@@ -1248,9 +1804,8 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
     _geom_volume_pcollector.add_level(1);
   }
   if (within_geom_bounds) {
-    Colliders::const_iterator ci;
-    ci = _colliders.find(entry.get_from_node_path());
-    nassertv(ci != _colliders.end());
+    CollisionHandler *handler = get_entry_handler(entry, pass);
+    nassertv(handler != nullptr);
 
     if (geom->get_primitive_type() == Geom::PT_polygons) {
       Thread *current_thread = Thread::get_current_thread();
@@ -1291,7 +1846,7 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(LVecBase3(v[0]), LVecBase3(v[1]), LVecBase3(v[2]));
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                entry.test_intersection(handler, this);
               }
             }
           }
@@ -1321,7 +1876,7 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(LVecBase3(v[0]), LVecBase3(v[1]), LVecBase3(v[2]));
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                entry.test_intersection(handler, this);
               }
             }
           }
@@ -1384,6 +1939,22 @@ remove_handler(CollisionTraverser::Handlers::iterator hi) {
   return hi;
 }
 
+/**
+ * Returns the handler that should receive the entries detected for the
+ * collider of the indicated entry during the indicated pass.
+ */
+CollisionHandler *CollisionTraverser::
+get_entry_handler(const CollisionEntry &entry, size_t pass) const {
+  if (_pass_handlers != nullptr) {
+    return _pass_handlers[pass];
+  }
+
+  Colliders::const_iterator ci;
+  ci = _colliders.find(entry.get_from_node_path());
+  nassertr(ci != _colliders.end(), nullptr);
+  return (*ci).second;
+}
+
 /**
  * Returns the PStatCollector suitable for timing the nth pass.
  */
@@ -21,6 +21,7 @@
 
 #include "pointerTo.h"
 #include "pStatCollector.h"
+#include "workerPool.h"
 
 #include "pset.h"
 #include "register_type.h"
@@ -52,6 +53,10 @@ PUBLISHED:
   MAKE_PROPERTY(respect_preV_transform, get_respect_prev_transform,
                                         set_respect_prev_transform);
 
+  INLINE void set_broadphase(bool flag);
+  INLINE bool get_broadphase() const;
+  MAKE_PROPERTY(broadphase, get_broadphase, set_broadphase);
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -92,20 +97,35 @@ private:
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
   void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
 
-  void compare_collider_to_node(CollisionEntry &entry,
+  class Broadphase;
+  void traverse_broadphase(const NodePath &root);
+  void r_collect_broadphase(Broadphase &bp, const WorkingNodePath &node_path,
+                            CollideMask include_mask,
+                            const LMatrix4 &parent_mat,
+                            const LMatrix4 &parent_inv, int chain);
+
+  class PassBuffer;
+  class ParallelJob;
+  bool can_traverse_parallel() const;
+  void traverse_parallel(LevelStatesSingle &level_states, WorkerPool *pool);
+
+  void compare_collider_to_node(CollisionEntry &entry, size_t pass,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
                                 const GeometricBoundingVolume *into_node_gbv);
-  void compare_collider_to_geom_node(CollisionEntry &entry,
+  void compare_collider_to_geom_node(CollisionEntry &entry, size_t pass,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
                                      const GeometricBoundingVolume *into_node_gbv);
-  void compare_collider_to_solid(CollisionEntry &entry,
+  void compare_collider_to_solid(CollisionEntry &entry, size_t pass,
                                  const GeometricBoundingVolume *from_node_gbv,
                                  const GeometricBoundingVolume *solid_gbv);
-  void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
+  void compare_collider_to_geom(CollisionEntry &entry, size_t pass,
+                                const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
                                 const GeometricBoundingVolume *solid_gbv);
+  CollisionHandler *get_entry_handler(const CollisionEntry &entry,
+                                      size_t pass) const;
 
   PStatCollector &get_pass_collector(int pass);
 
@@ -129,6 +149,12 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  bool _broadphase;
+
+  // During traverse_parallel(), this holds the handler that buffers the
+  // entries of each pass.
+  CollisionHandler **_pass_handlers;
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
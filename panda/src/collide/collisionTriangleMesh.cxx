@@ -0,0 +1,1310 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionTriangleMesh.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "collisionTriangleMesh.h"
+#include "collisionEntry.h"
+#include "collisionSphere.h"
+#include "collisionCapsule.h"
+#include "collisionBox.h"
+#include "collisionLine.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionPolygon.h"
+#include "config_collide.h"
+#include "boundingBox.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomLinestrips.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "lightMutexHolder.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "indent.h"
+
+#include <algorithm>
+#include <limits>
+
+PStatCollector CollisionTriangleMesh::_volume_pcollector("Collision Volumes:CollisionTriangleMesh");
+PStatCollector CollisionTriangleMesh::_test_pcollector("Collision Tests:CollisionTriangleMesh");
+TypeHandle CollisionTriangleMesh::_type_handle;
+
+/**
+ * Returns true if the triangle v0, v1, v2 and the box with the indicated
+ * center and half-axes overlap, by looking for a separating axis.
+ */
+static bool
+triangle_overlaps_box(const LPoint3 &v0, const LPoint3 &v1, const LPoint3 &v2,
+                      const LPoint3 &center, const LVector3 axes[3]) {
+  LVector3 p0 = v0 - center;
+  LVector3 p1 = v1 - center;
+  LVector3 p2 = v2 - center;
+  LVector3 edges[3] = { p1 - p0, p2 - p1, p0 - p2 };
+
+  auto separated = [&](const LVector3 &axis) {
+    PN_stdfloat d0 = p0.dot(axis);
+    PN_stdfloat d1 = p1.dot(axis);
+    PN_stdfloat d2 = p2.dot(axis);
+    PN_stdfloat r = cabs(axes[0].dot(axis)) + cabs(axes[1].dot(axis)) +
+                    cabs(axes[2].dot(axis));
+    return std::min(std::min(d0, d1), d2) > r ||
+           std::max(std::max(d0, d1), d2) < -r;
+  };
+
+  // The normal of the triangle, and the axes of the box.
+  if (separated(edges[0].cross(edges[1]))) {
+    return false;
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (separated(axes[i])) {
+      return false;
+    }
+  }
+
+  // The cross products of the edges with the axes of the box.
+  for (int e = 0; e < 3; ++e) {
+    for (int i = 0; i < 3; ++i) {
+      if (separated(edges[e].cross(axes[i]))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ *
+ */
+CollisionTriangleMesh::
+CollisionTriangleMesh() :
+  _tree_stale(false),
+  _tree_lock("CollisionTriangleMesh")
+{
+}
+
+/**
+ *
+ */
+CollisionTriangleMesh::
+CollisionTriangleMesh(const CollisionTriangleMesh &copy) :
+  CollisionSolid(copy),
+  _tree_lock("CollisionTriangleMesh")
+{
+  LightMutexHolder holder(copy._tree_lock);
+  _vertices = copy._vertices;
+  _triangles = copy._triangles;
+  _nodes = copy._nodes;
+  _tree_stale = copy._tree_stale;
+}
+
+/**
+ *
+ */
+CollisionSolid *CollisionTriangleMesh::
+make_copy() {
+  return new CollisionTriangleMesh(*this);
+}
+
+/**
+ * Adds all of the triangles of the indicated Geom to the mesh, transformed by
+ * the indicated matrix.  Primitives that aren't polygons are ignored.
+ */
+void CollisionTriangleMesh::
+add_geom(const Geom *geom, const LMatrix4 &mat) {
+  nassertv(geom != nullptr);
+  CPT(GeomVertexData) vdata = geom->get_vertex_data();
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    add_primitive(vdata, geom->get_primitive(i), mat);
+  }
+}
+
+/**
+ * Adds all of the triangles of the indicated primitive to the mesh, with the
+ * vertices taken from the indicated GeomVertexData and transformed by the
+ * indicated matrix.  Nothing is added if the primitive isn't made of
+ * polygons.  Only the vertices that are used by the triangles are copied.
+ */
+void CollisionTriangleMesh::
+add_primitive(const GeomVertexData *vdata, const GeomPrimitive *prim,
+              const LMatrix4 &mat) {
+  nassertv(vdata != nullptr && prim != nullptr);
+  if (prim->get_primitive_type() != GeomPrimitive::PT_polygons) {
+    return;
+  }
+
+  CPT(GeomPrimitive) tris = prim->decompose();
+  nassertv(tris->is_of_type(GeomTriangles::get_class_type()));
+
+  GeomVertexReader vertex(vdata, InternalName::get_vertex());
+  if (!vertex.has_column()) {
+    return;
+  }
+
+  LightMutexHolder holder(_tree_lock);
+
+  // This maps each row of the vertex data to its index in _vertices, as it
+  // is added.
+  vector_int remap(vdata->get_num_rows(), -1);
+
+  int num_vertices = tris->get_num_vertices();
+  _triangles.reserve(_triangles.size() + num_vertices / 3);
+
+  for (int i = 0; i + 2 < num_vertices; i += 3) {
+    int rows[3];
+    LPoint3 v[3];
+    for (int j = 0; j < 3; ++j) {
+      rows[j] = tris->get_vertex(i + j);
+      nassertv(rows[j] >= 0 && rows[j] < (int)remap.size());
+      vertex.set_row_unsafe(rows[j]);
+      v[j] = LPoint3(vertex.get_data3()) * mat;
+    }
+
+    if (!CollisionPolygon::verify_points(v[0], v[1], v[2])) {
+      // Skip degenerate triangles.
+      continue;
+    }
+
+    Triangle tri;
+    for (int j = 0; j < 3; ++j) {
+      int &index = remap[rows[j]];
+      if (index < 0) {
+        index = (int)_vertices.size();
+        _vertices.push_back(v[j]);
+      }
+      tri._v[j] = (unsigned int)index;
+    }
+    _triangles.push_back(tri);
+  }
+
+  _tree_stale = true;
+  mark_internal_bounds_stale();
+  mark_viz_stale();
+}
+
+/**
+ * Builds the bounding volume hierarchy, if the triangles have changed since
+ * it was last built.  This is done automatically the first time the solid is
+ * tested, but it may take a moment for a large mesh, so you might prefer to
+ * call this up front.
+ */
+void CollisionTriangleMesh::
+build() {
+  check_tree();
+}
+
+/**
+ * Returns the point in space deemed to be the "origin" of the solid for
+ * collision purposes.  The closest intersection point to this origin point is
+ * considered to be the most significant.
+ */
+LPoint3 CollisionTriangleMesh::
+get_collision_origin() const {
+  // As with CollisionFloorMesh, there is no sensible origin for an arbitrary
+  // mesh.
+  return LPoint3::origin();
+}
+
+/**
+ * Transforms the solid by the indicated matrix.
+ */
+void CollisionTriangleMesh::
+xform(const LMatrix4 &mat) {
+  LightMutexHolder holder(_tree_lock);
+  Vertices::iterator vi;
+  for (vi = _vertices.begin(); vi != _vertices.end(); ++vi) {
+    (*vi) = (*vi) * mat;
+  }
+
+  // A transformed box doesn't generally fit tightly around its triangles, so
+  // the hierarchy has to be built again.
+  _tree_stale = true;
+
+  CollisionSolid::xform(mat);
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of bounding
+ * volume tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionTriangleMesh::
+get_volume_pcollector() {
+  return _volume_pcollector;
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of intersection
+ * tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionTriangleMesh::
+get_test_pcollector() {
+  return _test_pcollector;
+}
+
+/**
+ *
+ */
+void CollisionTriangleMesh::
+output(std::ostream &out) const {
+  out << "ctrimesh, " << _triangles.size() << " triangles";
+}
+
+/**
+ *
+ */
+void CollisionTriangleMesh::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << (*this) << "\n";
+}
+
+/**
+ *
+ */
+PT(BoundingVolume) CollisionTriangleMesh::
+compute_internal_bounds() const {
+  if (_vertices.empty()) {
+    return new BoundingBox;
+  }
+
+  Vertices::const_iterator vi = _vertices.begin();
+  LPoint3 min = *vi;
+  LPoint3 max = *vi;
+  for (++vi; vi != _vertices.end(); ++vi) {
+    min = min.fmin(*vi);
+    max = max.fmax(*vi);
+  }
+
+  return new BoundingBox(min, max);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a sphere.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+test_intersection_from_sphere(const CollisionEntry &entry) const {
+  const CollisionSphere *sphere;
+  DCAST_INTO_R(sphere, entry.get_from(), nullptr);
+
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
+
+  LPoint3 from_center = sphere->get_center() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(sphere->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius_2 = from_radius_v.length_squared();
+  PN_stdfloat from_radius = csqrt(from_radius_2);
+
+  LVector3 reach(from_radius);
+  vector_int found;
+
+  LPoint3 contact_point(from_center);
+  PN_stdfloat actual_t = 1.0f;
+  LVector3 delta = LVector3::zero();
+
+  // If the sphere was touching a triangle at the start, this is the one.
+  int start_tri = -1;
+  LPoint3 start_point;
+
+  if (wrt_prev_space != wrt_space) {
+    // The sphere is moving.  Find the moment at which it first touched any of
+    // the triangles; if it wasn't touching one already, that is where it
+    // collided, even if it has since passed right through.
+    LPoint3 a = sphere->get_center() * wrt_prev_space->get_mat();
+    delta = from_center - a;
+    find_triangles(found, a.fmin(from_center) - reach, a.fmax(from_center) + reach);
+
+    int best = -1;
+    double best_t = 2.0;
+    LPoint3 best_point;
+    for (int i : found) {
+      const Triangle &tri = _triangles[i];
+      LPoint3 points[3] = {
+        _vertices[tri._v[0]],
+        _vertices[tri._v[1]],
+        _vertices[tri._v[2]],
+      };
+      double t;
+      LPoint3 point;
+      if (sweep_sphere_into_polygon(t, point, a, delta, from_radius,
+                                    points, 3, true) && t < best_t) {
+        best = i;
+        best_t = t;
+        best_point = point;
+        if (t == 0.0) {
+          break;
+        }
+      }
+    }
+
+    if (best < 0) {
+      return nullptr;
+    }
+    if (best_t > 0.0) {
+      contact_point = a + delta * best_t;
+      return make_swept_entry(entry, best_t, contact_point, best_point, delta,
+                              contact_point, get_triangle_normal(_triangles[best]));
+    }
+
+    // It was touching already, so test it where it is now.
+    start_tri = best;
+    start_point = best_point;
+    contact_point = a;
+    actual_t = 0.0f;
+    found.clear();
+  }
+
+  find_triangles(found, from_center - reach, from_center + reach);
+
+  // Find the triangle nearest to the center of the sphere.
+  int best = -1;
+  PN_stdfloat best_dist_2 = from_radius_2;
+  LPoint3 best_point;
+  for (int i : found) {
+    LPoint3 point = closest_point(_triangles[i], from_center);
+    PN_stdfloat dist_2 = (from_center - point).length_squared();
+    if (dist_2 <= best_dist_2 && (best < 0 || dist_2 < best_dist_2)) {
+      best = i;
+      best_dist_2 = dist_2;
+      best_point = point;
+    }
+  }
+
+  if (best < 0) {
+    if (start_tri >= 0) {
+      // It has since passed all the way through, so it collided right at the
+      // start.
+      return make_swept_entry(entry, 0.0, contact_point, start_point, delta,
+                              contact_point,
+                              get_triangle_normal(_triangles[start_tri]));
+    }
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  // The sphere is pushed away from the nearest point, which may be on an edge
+  // or a corner rather than in the middle of the triangle.
+  LVector3 normal;
+  if (has_effective_normal() && sphere->get_respect_effective_normal()) {
+    normal = get_effective_normal();
+  } else {
+    normal = from_center - best_point;
+    if (!normal.normalize()) {
+      normal = get_triangle_normal(_triangles[best]);
+    }
+  }
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(best_point);
+  new_entry->set_interior_point(from_center - normal * from_radius);
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_contact_normal(normal);
+  new_entry->set_t(actual_t);
+
+  return new_entry;
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a line.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+test_intersection_from_line(const CollisionEntry &entry) const {
+  const CollisionLine *line;
+  DCAST_INTO_R(line, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = line->get_origin() * wrt_mat;
+  LVector3 from_direction = line->get_direction() * wrt_mat;
+
+  return intersect_line(entry, from_origin, from_direction,
+                        -std::numeric_limits<double>::max(),
+                        std::numeric_limits<double>::max());
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a ray.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+test_intersection_from_ray(const CollisionEntry &entry) const {
+  const CollisionRay *ray;
+  DCAST_INTO_R(ray, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_origin = ray->get_origin() * wrt_mat;
+  LVector3 from_direction = ray->get_direction() * wrt_mat;
+
+  return intersect_line(entry, from_origin, from_direction,
+                        0.0, std::numeric_limits<double>::max());
+}
+
+/**
+ * Finds the nearest point at which the indicated ray meets the solid, as
+ * used by CollisionRayQuery.  See CollisionSolid::cast_ray().
+ */
+bool CollisionTriangleMesh::
+cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+         const LVector3 &direction, double max_t) const {
+  int best = find_first_triangle(t, origin, direction, 0.0, max_t);
+  if (best < 0) {
+    return false;
+  }
+
+  normal = get_triangle_normal(_triangles[best]);
+  return true;
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a segment.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+test_intersection_from_segment(const CollisionEntry &entry) const {
+  const CollisionSegment *segment;
+  DCAST_INTO_R(segment, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_a = segment->get_point_a() * wrt_mat;
+  LPoint3 from_b = segment->get_point_b() * wrt_mat;
+
+  return intersect_line(entry, from_a, from_b - from_a, 0.0, 1.0);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a capsule.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+test_intersection_from_capsule(const CollisionEntry &entry) const {
+  const CollisionCapsule *capsule;
+  DCAST_INTO_R(capsule, entry.get_from(), nullptr);
+
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
+
+  LPoint3 from_a = capsule->get_point_a() * wrt_mat;
+  LPoint3 from_b = capsule->get_point_b() * wrt_mat;
+  LVector3 from_direction = from_b - from_a;
+  PN_stdfloat radius_2 = wrt_mat.xform_vec(LVector3(0, 0, capsule->get_radius())).length_squared();
+  PN_stdfloat radius = csqrt(radius_2);
+
+  LVector3 reach(radius);
+  vector_int found;
+
+  LPoint3 contact_point = (from_a + from_b) * 0.5f;
+  PN_stdfloat actual_t = 1.0f;
+  LVector3 delta = LVector3::zero();
+
+  // If the capsule was touching a triangle at the start, this is the one.
+  int start_tri = -1;
+  LPoint3 start_from_point, start_into_point;
+
+  if (wrt_prev_space != wrt_space) {
+    // The capsule is moving.  As for a sphere, find the moment at which it
+    // first touched any of the triangles.
+    const LMatrix4 &prev_mat = wrt_prev_space->get_mat();
+    LPoint3 prev_a = capsule->get_point_a() * prev_mat;
+    LPoint3 prev_b = capsule->get_point_b() * prev_mat;
+    delta = from_a - prev_a;
+    find_triangles(found,
+                   prev_a.fmin(prev_b).fmin(from_a).fmin(from_b) - reach,
+                   prev_a.fmax(prev_b).fmax(from_a).fmax(from_b) + reach);
+
+    int best = -1;
+    double best_t = 2.0;
+    LPoint3 best_from_point, best_into_point;
+    for (int i : found) {
+      const Triangle &tri = _triangles[i];
+      LPoint3 points[3] = {
+        _vertices[tri._v[0]],
+        _vertices[tri._v[1]],
+        _vertices[tri._v[2]],
+      };
+      double t;
+      LPoint3 from_point, into_point;
+      if (sweep_segment_into_polygon(t, from_point, into_point, prev_a, prev_b,
+                                     delta, radius, points, 3, true) &&
+          t < best_t) {
+        best = i;
+        best_t = t;
+        best_from_point = from_point;
+        best_into_point = into_point;
+        if (t == 0.0) {
+          break;
+        }
+      }
+    }
+
+    if (best < 0) {
+      return nullptr;
+    }
+    contact_point = (prev_a + prev_b) * 0.5f + delta * best_t;
+    if (best_t > 0.0) {
+      return make_swept_entry(entry, best_t, best_from_point, best_into_point,
+                              delta, contact_point,
+                              get_triangle_normal(_triangles[best]));
+    }
+
+    // It was touching already, so test it where it is now.
+    start_tri = best;
+    start_from_point = best_from_point;
+    start_into_point = best_into_point;
+    actual_t = 0.0f;
+    found.clear();
+  }
+
+  find_triangles(found, from_a.fmin(from_b) - reach, from_a.fmax(from_b) + reach);
+
+  // Find the triangle that comes nearest to the axis of the capsule.
+  int best = -1;
+  PN_stdfloat best_dist_2 = radius_2;
+  LPoint3 best_axis_point = LPoint3::zero();
+  LPoint3 best_point = LPoint3::zero();
+  for (int i : found) {
+    const Triangle &tri = _triangles[i];
+    LPoint3 axis_point, point;
+    PN_stdfloat dist_2;
+
+    double t;
+    if (intersects_line(t, tri, from_a, from_direction) && t >= 0.0 && t <= 1.0) {
+      // The axis passes right through the triangle.
+      axis_point = from_a + from_direction * t;
+      point = axis_point;
+      dist_2 = 0.0f;
+
+    } else {
+      // Otherwise, the nearest point is either at one of the ends of the
+      // axis, or on one of the edges of the triangle.
+      point = closest_point(tri, from_a);
+      axis_point = from_a;
+      dist_2 = (axis_point - point).length_squared();
+
+      LPoint3 p = closest_point(tri, from_b);
+      PN_stdfloat d2 = (from_b - p).length_squared();
+      if (d2 < dist_2) {
+        axis_point = from_b;
+        point = p;
+        dist_2 = d2;
+      }
+
+      for (int e = 0; e < 3; ++e) {
+        const LPoint3 &v0 = _vertices[tri._v[e]];
+        LVector3 edge = _vertices[tri._v[(e + 1) % 3]] - v0;
+        double u1, u2;
+        CollisionCapsule::calc_closest_segment_points(u1, u2, from_a, from_direction, v0, edge);
+        LPoint3 a = from_a + from_direction * u1;
+        LPoint3 b = v0 + edge * u2;
+        d2 = (a - b).length_squared();
+        if (d2 < dist_2) {
+          axis_point = a;
+          point = b;
+          dist_2 = d2;
+        }
+      }
+    }
+
+    if (dist_2 <= best_dist_2 && (best < 0 || dist_2 < best_dist_2)) {
+      best = i;
+      best_dist_2 = dist_2;
+      best_axis_point = axis_point;
+      best_point = point;
+    }
+  }
+
+  if (best < 0) {
+    if (start_tri >= 0) {
+      // It has since passed all the way through, so it collided right at the
+      // start.
+      return make_swept_entry(entry, 0.0, start_from_point, start_into_point,
+                              delta, contact_point,
+                              get_triangle_normal(_triangles[start_tri]));
+    }
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal;
+  if (has_effective_normal() && capsule->get_respect_effective_normal()) {
+    normal = get_effective_normal();
+  } else {
+    normal = best_axis_point - best_point;
+    if (!normal.normalize()) {
+      normal = get_triangle_normal(_triangles[best]);
+    }
+  }
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(best_point);
+  new_entry->set_interior_point(best_axis_point - normal * radius);
+  new_entry->set_contact_pos(contact_point);
+  new_entry->set_contact_normal(normal);
+  new_entry->set_t(actual_t);
+
+  return new_entry;
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a box.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+test_intersection_from_box(const CollisionEntry &entry) const {
+  const CollisionBox *box;
+  DCAST_INTO_R(box, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+
+  LPoint3 from_center = box->get_center() * wrt_mat;
+  LVector3 from_extents = box->get_dimensions() * 0.5f;
+  LVector3 axes[3] = {
+    wrt_mat.get_row3(0) * from_extents[0],
+    wrt_mat.get_row3(1) * from_extents[1],
+    wrt_mat.get_row3(2) * from_extents[2],
+  };
+
+  LVector3 reach;
+  for (int a = 0; a < 3; ++a) {
+    reach[a] = cabs(axes[0][a]) + cabs(axes[1][a]) + cabs(axes[2][a]);
+  }
+  vector_int found;
+  find_triangles(found, from_center - reach, from_center + reach);
+
+  // Of the triangles that the box touches, find the one whose plane it
+  // reaches furthest through.
+  int best = -1;
+  PN_stdfloat best_depth = 0.0f;
+  LVector3 best_normal;
+  for (int i : found) {
+    const Triangle &tri = _triangles[i];
+    const LPoint3 &v0 = _vertices[tri._v[0]];
+    const LPoint3 &v1 = _vertices[tri._v[1]];
+    const LPoint3 &v2 = _vertices[tri._v[2]];
+    if (!triangle_overlaps_box(v0, v1, v2, from_center, axes)) {
+      continue;
+    }
+
+    LVector3 normal = get_triangle_normal(tri);
+    PN_stdfloat dist = (from_center - v0).dot(normal);
+    if (dist < 0.0f) {
+      normal = -normal;
+      dist = -dist;
+    }
+    PN_stdfloat depth = cabs(axes[0].dot(normal)) + cabs(axes[1].dot(normal)) +
+                        cabs(axes[2].dot(normal)) - dist;
+    if (best < 0 || depth > best_depth) {
+      best = i;
+      best_depth = depth;
+      best_normal = normal;
+    }
+  }
+
+  if (best < 0) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && box->get_respect_effective_normal()) ? get_effective_normal() : best_normal;
+  new_entry->set_surface_normal(normal);
+
+  // As in CollisionPolygon, the interior point is the corner of the box that
+  // is deepest below the plane of the triangle, and the surface point is that
+  // corner projected onto the plane.
+  LPoint3 interior_point = from_center;
+  for (int a = 0; a < 3; ++a) {
+    PN_stdfloat d = axes[a].dot(best_normal);
+    interior_point -= axes[a] * (PN_stdfloat)((d > 0) - (d < 0));
+  }
+  const LPoint3 &v0 = _vertices[_triangles[best]._v[0]];
+  new_entry->set_surface_point(interior_point + best_normal * (v0 - interior_point).dot(best_normal));
+  new_entry->set_interior_point(interior_point);
+
+  return new_entry;
+}
+
+/**
+ * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
+ * solid.
+ */
+void CollisionTriangleMesh::
+fill_viz_geom() {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Recomputing viz for " << *this << "\n";
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("collision", GeomVertexFormat::get_v3(),
+     Geom::UH_static);
+  vdata->unclean_set_num_rows(_vertices.size());
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+
+  Vertices::const_iterator vi;
+  for (vi = _vertices.begin(); vi != _vertices.end(); ++vi) {
+    vertex.set_data3(*vi);
+  }
+
+  PT(GeomTriangles) mesh = new GeomTriangles(Geom::UH_static);
+  PT(GeomLinestrips) wire = new GeomLinestrips(Geom::UH_static);
+  Triangles::const_iterator ti;
+  for (ti = _triangles.begin(); ti != _triangles.end(); ++ti) {
+    const Triangle &tri = *ti;
+    mesh->add_vertices(tri._v[0], tri._v[1], tri._v[2]);
+    wire->add_vertices(tri._v[0], tri._v[1], tri._v[2]);
+    wire->add_vertex(tri._v[0]);
+    wire->close_primitive();
+  }
+
+  PT(Geom) geom = new Geom(vdata);
+  PT(Geom) geom2 = new Geom(vdata);
+  geom->add_primitive(mesh);
+  geom2->add_primitive(wire);
+  _viz_geom->add_geom(geom, get_solid_viz_state());
+  _viz_geom->add_geom(geom2, get_wireframe_viz_state());
+
+  _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
+  _bounds_viz_geom->add_geom(geom2, get_wireframe_bounds_viz_state());
+}
+
+/**
+ * Builds the bounding volume hierarchy if it is out of date.
+ */
+void CollisionTriangleMesh::
+check_tree() const {
+  LightMutexHolder holder(_tree_lock);
+  if (_tree_stale) {
+    ((CollisionTriangleMesh *)this)->do_build();
+  }
+}
+
+/**
+ * Builds the bounding volume hierarchy from scratch, reordering the
+ * triangles so that the triangles of each leaf are together.  Assumes the
+ * lock is held.
+ */
+void CollisionTriangleMesh::
+do_build() {
+  _nodes.clear();
+  _tree_stale = false;
+
+  size_t num_triangles = _triangles.size();
+  if (num_triangles == 0) {
+    return;
+  }
+
+  // The box of each triangle is at boxes[i * 2] and boxes[i * 2 + 1].
+  pvector<LPoint3> boxes(num_triangles * 2);
+  vector_int order(num_triangles);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    const Triangle &tri = _triangles[i];
+    const LPoint3 &v0 = _vertices[tri._v[0]];
+    const LPoint3 &v1 = _vertices[tri._v[1]];
+    const LPoint3 &v2 = _vertices[tri._v[2]];
+    boxes[i * 2] = v0.fmin(v1).fmin(v2);
+    boxes[i * 2 + 1] = v0.fmax(v1).fmax(v2);
+    order[i] = (int)i;
+  }
+
+  _nodes.reserve(num_triangles * 2 / max_leaf_triangles + 1);
+  _nodes.push_back(Node());
+  r_build(boxes, order, 0, 0, num_triangles);
+
+  Triangles triangles;
+  triangles.reserve(num_triangles);
+  for (int i : order) {
+    triangles.push_back(_triangles[i]);
+  }
+  _triangles.swap(triangles);
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Built hierarchy of " << _nodes.size() << " nodes for " << *this
+      << "\n";
+  }
+}
+
+/**
+ * Fills in the indicated node, which will contain the indicated range of
+ * order, splitting it further if it has too many triangles.
+ */
+void CollisionTriangleMesh::
+r_build(pvector<LPoint3> &boxes, vector_int &order,
+        size_t ni, size_t first, size_t count) {
+  const LPoint3 *box0 = &boxes[order[first] * 2];
+  LPoint3 min = box0[0];
+  LPoint3 max = box0[1];
+  LPoint3 cmin = box0[0] + box0[1];
+  LPoint3 cmax = cmin;
+  for (size_t i = 1; i < count; ++i) {
+    const LPoint3 *box = &boxes[order[first + i] * 2];
+    LPoint3 center = box[0] + box[1];
+    min = min.fmin(box[0]);
+    max = max.fmax(box[1]);
+    cmin = cmin.fmin(center);
+    cmax = cmax.fmax(center);
+  }
+
+  Node &node = _nodes[ni];
+  node._min = min;
+  node._max = max;
+
+  if (count <= max_leaf_triangles) {
+    node._index = (unsigned int)first;
+    node._count = (unsigned int)count;
+    return;
+  }
+
+  // Split the triangles at the median of their centers along the longest
+  // axis.
+  LVector3 extent = cmax - cmin;
+  int axis = 0;
+  if (extent[1] > extent[axis]) {
+    axis = 1;
+  }
+  if (extent[2] > extent[axis]) {
+    axis = 2;
+  }
+
+  size_t half = count / 2;
+  std::nth_element(order.begin() + first, order.begin() + first + half,
+                   order.begin() + first + count,
+                   [&boxes, axis](int a, int b) {
+    return boxes[a * 2][axis] + boxes[a * 2 + 1][axis] <
+           boxes[b * 2][axis] + boxes[b * 2 + 1][axis];
+  });
+
+  size_t left = _nodes.size();
+  _nodes.push_back(Node());
+  _nodes.push_back(Node());
+  _nodes[ni]._index = (unsigned int)left;
+  _nodes[ni]._count = 0;
+  r_build(boxes, order, left, first, half);
+  r_build(boxes, order, left + 1, first + half, count - half);
+}
+
+/**
+ * Appends to result the indices of the triangles whose boxes overlap the
+ * indicated box.
+ */
+void CollisionTriangleMesh::
+find_triangles(vector_int &result, const LPoint3 &min,
+               const LPoint3 &max) const {
+  check_tree();
+  if (_nodes.empty()) {
+    return;
+  }
+
+  unsigned int stack[max_depth];
+  int sp = 0;
+  stack[sp++] = 0;
+  int num_tested = 0;
+
+  while (sp > 0) {
+    const Node &node = _nodes[stack[--sp]];
+    ++num_tested;
+    if (!box_overlaps(node, min, max)) {
+      continue;
+    }
+
+    if (node._count == 0) {
+      nassertv(sp + 2 <= max_depth);
+      stack[sp++] = node._index + 1;
+      stack[sp++] = node._index;
+    } else {
+      for (unsigned int i = node._index; i < node._index + node._count; ++i) {
+        const Triangle &tri = _triangles[i];
+        const LPoint3 &v0 = _vertices[tri._v[0]];
+        const LPoint3 &v1 = _vertices[tri._v[1]];
+        const LPoint3 &v2 = _vertices[tri._v[2]];
+        if (std::max(std::max(v0[0], v1[0]), v2[0]) >= min[0] &&
+            std::min(std::min(v0[0], v1[0]), v2[0]) <= max[0] &&
+            std::max(std::max(v0[1], v1[1]), v2[1]) >= min[1] &&
+            std::min(std::min(v0[1], v1[1]), v2[1]) <= max[1] &&
+            std::max(std::max(v0[2], v1[2]), v2[2]) >= min[2] &&
+            std::min(std::min(v0[2], v1[2]), v2[2]) <= max[2]) {
+          result.push_back((int)i);
+        }
+      }
+    }
+  }
+
+  _volume_pcollector.add_level(num_tested);
+}
+
+/**
+ * Finds the first triangle hit by the part of the line from + t * delta
+ * between min_t and max_t, and returns a new CollisionEntry for it, or
+ * nullptr if there is none.
+ */
+PT(CollisionEntry) CollisionTriangleMesh::
+intersect_line(const CollisionEntry &entry, const LPoint3 &from,
+               const LVector3 &delta, double min_t, double max_t) const {
+  double best_t;
+  int best = find_first_triangle(best_t, from, delta, min_t, max_t);
+  if (best < 0) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && entry.get_from()->get_respect_effective_normal()) ? get_effective_normal() : get_triangle_normal(_triangles[best]);
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(from + delta * best_t);
+
+  return new_entry;
+}
+
+/**
+ * Finds the first triangle hit by the part of the line from + t * delta
+ * between min_t and max_t, and returns its index, filling in t.  Returns -1
+ * if there is none.
+ */
+int CollisionTriangleMesh::
+find_first_triangle(double &t, const LPoint3 &from, const LVector3 &delta,
+                    double min_t, double max_t) const {
+  check_tree();
+  if (_nodes.empty() || delta == LVector3::zero()) {
+    return -1;
+  }
+
+  LVector3 inv_delta;
+  for (int a = 0; a < 3; ++a) {
+    inv_delta[a] = (delta[a] != 0.0f) ? 1.0f / delta[a] : 0.0f;
+  }
+
+  unsigned int stack[max_depth];
+  int sp = 0;
+  stack[sp++] = 0;
+  int num_tested = 0;
+
+  int best = -1;
+  double best_t = max_t;
+
+  while (sp > 0) {
+    const Node &node = _nodes[stack[--sp]];
+    ++num_tested;
+    if (!line_overlaps(node, from, delta, inv_delta, min_t, best_t)) {
+      continue;
+    }
+
+    if (node._count == 0) {
+      // Visit the nearer child first, since a hit there lets us skip most of
+      // the farther one.
+      const Node &a = _nodes[node._index];
+      const Node &b = _nodes[node._index + 1];
+      bool b_first = ((b._min + b._max) - (a._min + a._max)).dot(delta) < 0.0f;
+      nassertr(sp + 2 <= max_depth, -1);
+      if (b_first) {
+        stack[sp++] = node._index;
+        stack[sp++] = node._index + 1;
+      } else {
+        stack[sp++] = node._index + 1;
+        stack[sp++] = node._index;
+      }
+    } else {
+      for (unsigned int i = node._index; i < node._index + node._count; ++i) {
+        double t;
+        if (intersects_line(t, _triangles[i], from, delta) &&
+            t >= min_t && t <= best_t && (best < 0 || t < best_t)) {
+          best = (int)i;
+          best_t = t;
+        }
+      }
+    }
+  }
+
+  _volume_pcollector.add_level(num_tested);
+
+  t = best_t;
+  return best;
+}
+
+/**
+ * Returns the point on the indicated triangle that is nearest to the
+ * indicated point.
+ */
+LPoint3 CollisionTriangleMesh::
+closest_point(const Triangle &tri, const LPoint3 &point) const {
+  // This is the method described in Christer Ericson's book Real-Time
+  // Collision Detection: find the Voronoi region of the triangle that
+  // contains the point.
+  const LPoint3 &a = _vertices[tri._v[0]];
+  const LPoint3 &b = _vertices[tri._v[1]];
+  const LPoint3 &c = _vertices[tri._v[2]];
+
+  LVector3 ab = b - a;
+  LVector3 ac = c - a;
+  LVector3 ap = point - a;
+  PN_stdfloat d1 = ab.dot(ap);
+  PN_stdfloat d2 = ac.dot(ap);
+  if (d1 <= 0.0f && d2 <= 0.0f) {
+    return a;
+  }
+
+  LVector3 bp = point - b;
+  PN_stdfloat d3 = ab.dot(bp);
+  PN_stdfloat d4 = ac.dot(bp);
+  if (d3 >= 0.0f && d4 <= d3) {
+    return b;
+  }
+
+  PN_stdfloat vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+    return a + ab * (d1 / (d1 - d3));
+  }
+
+  LVector3 cp = point - c;
+  PN_stdfloat d5 = ab.dot(cp);
+  PN_stdfloat d6 = ac.dot(cp);
+  if (d6 >= 0.0f && d5 <= d6) {
+    return c;
+  }
+
+  PN_stdfloat vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+    return a + ac * (d2 / (d2 - d6));
+  }
+
+  PN_stdfloat va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+    return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+  }
+
+  // The point projects to the inside of the triangle.
+  PN_stdfloat denom = 1.0f / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+ * Returns the unit-length normal of the indicated triangle, facing the side
+ * from which its vertices appear counterclockwise.
+ */
+LVector3 CollisionTriangleMesh::
+get_triangle_normal(const Triangle &tri) const {
+  const LPoint3 &a = _vertices[tri._v[0]];
+  const LPoint3 &b = _vertices[tri._v[1]];
+  const LPoint3 &c = _vertices[tri._v[2]];
+  LVector3 normal = (b - a).cross(c - a);
+  normal.normalize();
+  return normal;
+}
+
+/**
+ * Returns true if the line from + t * delta passes through the indicated
+ * triangle, from either side, and sets t to the point at which it does.
+ */
+bool CollisionTriangleMesh::
+intersects_line(double &t, const Triangle &tri, const LPoint3 &from,
+                const LVector3 &delta) const {
+  const LPoint3 &a = _vertices[tri._v[0]];
+  LVector3 ab = _vertices[tri._v[1]] - a;
+  LVector3 ac = _vertices[tri._v[2]] - a;
+
+  LVector3 p = delta.cross(ac);
+  PN_stdfloat det = ab.dot(p);
+  if (IS_NEARLY_ZERO(det)) {
+    // The line is parallel to the triangle.
+    return false;
+  }
+
+  PN_stdfloat inv_det = 1.0f / det;
+  LVector3 s = from - a;
+  PN_stdfloat u = s.dot(p) * inv_det;
+  if (u < 0.0f || u > 1.0f) {
+    return false;
+  }
+
+  LVector3 q = s.cross(ab);
+  PN_stdfloat v = delta.dot(q) * inv_det;
+  if (v < 0.0f || u + v > 1.0f) {
+    return false;
+  }
+
+  t = ac.dot(q) * inv_det;
+  return true;
+}
+
+/**
+ * Tells the BamReader how to create objects of type CollisionTriangleMesh.
+ */
+void CollisionTriangleMesh::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_CollisionTriangleMesh);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.  The hierarchy is written too, so that it need not be built
+ * again when the file is loaded.
+ */
+void CollisionTriangleMesh::
+write_datagram(BamWriter *manager, Datagram &me) {
+  check_tree();
+  CollisionSolid::write_datagram(manager, me);
+
+  me.add_uint32(_vertices.size());
+  for (const LPoint3 &vertex : _vertices) {
+    vertex.write_datagram(me);
+  }
+
+  me.add_uint32(_triangles.size());
+  for (const Triangle &tri : _triangles) {
+    me.add_uint32(tri._v[0]);
+    me.add_uint32(tri._v[1]);
+    me.add_uint32(tri._v[2]);
+  }
+
+  me.add_uint32(_nodes.size());
+  for (const Node &node : _nodes) {
+    node._min.write_datagram(me);
+    node._max.write_datagram(me);
+    me.add_uint32(node._index);
+    me.add_uint32(node._count);
+  }
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type CollisionTriangleMesh is encountered in the Bam file.  It should
+ * create the CollisionTriangleMesh and extract its information from the
+ * file.
+ */
+TypedWritable *CollisionTriangleMesh::
+make_CollisionTriangleMesh(const FactoryParams &params) {
+  CollisionTriangleMesh *me = new CollisionTriangleMesh;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * This internal function is called by make_CollisionTriangleMesh to read in
+ * all of the relevant data from the BamFile for the new
+ * CollisionTriangleMesh.
+ */
+void CollisionTriangleMesh::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  CollisionSolid::fillin(scan, manager);
+
+  // The counts are checked against the size of the datagram, to protect
+  // against large allocations, and the indices against the counts, so that a
+  // corrupt file can't make the queries read out of bounds.
+  size_t num_vertices = scan.get_uint32();
+  if (num_vertices > scan.get_remaining_size()) {
+    collide_cat.error()
+      << "CollisionTriangleMesh vertices extend past end of datagram, is bam file corrupt?\n";
+    return;
+  }
+  _vertices.resize(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    _vertices[i].read_datagram(scan);
+  }
+
+  size_t num_triangles = scan.get_uint32();
+  if (num_triangles > scan.get_remaining_size()) {
+    collide_cat.error()
+      << "CollisionTriangleMesh triangles extend past end of datagram, is bam file corrupt?\n";
+    _vertices.clear();
+    return;
+  }
+  _triangles.resize(num_triangles);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    Triangle &tri = _triangles[i];
+    tri._v[0] = scan.get_uint32();
+    tri._v[1] = scan.get_uint32();
+    tri._v[2] = scan.get_uint32();
+    if (tri._v[0] >= num_vertices || tri._v[1] >= num_vertices ||
+        tri._v[2] >= num_vertices) {
+      collide_cat.error()
+        << "CollisionTriangleMesh triangle " << i
+        << " has a vertex index out of range, is bam file corrupt?\n";
+      _vertices.clear();
+      _triangles.clear();
+      return;
+    }
+  }
+
+  size_t num_nodes = scan.get_uint32();
+  if (num_nodes > scan.get_remaining_size()) {
+    collide_cat.error()
+      << "CollisionTriangleMesh nodes extend past end of datagram, is bam file corrupt?\n";
+    num_nodes = 0;
+  }
+  _nodes.resize(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    Node &node = _nodes[i];
+    node._min.read_datagram(scan);
+    node._max.read_datagram(scan);
+    node._index = scan.get_uint32();
+    node._count = scan.get_uint32();
+  }
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    // The children of an interior node always follow it, so the tree can't
+    // have a cycle.
+    const Node &node = _nodes[i];
+    bool valid;
+    if (node._count == 0) {
+      valid = node._index > i && (size_t)node._index + 1 < num_nodes;
+    } else {
+      valid = (size_t)node._index + node._count <= num_triangles;
+    }
+    if (!valid) {
+      // The triangles are still good, so the tree is simply rebuilt.
+      collide_cat.error()
+        << "CollisionTriangleMesh node " << i
+        << " has an index out of range, is bam file corrupt?\n";
+      _nodes.clear();
+      num_nodes = 0;
+      break;
+    }
+  }
+
+  _tree_stale = (num_nodes == 0 && num_triangles != 0);
+}
@@ -0,0 +1,194 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionTriangleMesh.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef COLLISIONTRIANGLEMESH_H
+#define COLLISIONTRIANGLEMESH_H
+
+#include "pandabase.h"
+
+#include "collisionSolid.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+#include "pvector.h"
+#include "vector_int.h"
+
+class Geom;
+class GeomVertexData;
+class GeomPrimitive;
+
+/**
+ * A solid made of an arbitrary number of triangles, such as the collision
+ * geometry of a whole level.  Unlike a CollisionPolygon for each triangle,
+ * or collisions with visible geometry, the triangles are kept in a bounding
+ * volume hierarchy, so that each test only looks at the few triangles near
+ * the "from" object.
+ *
+ * The hierarchy is built automatically the first time the solid is tested
+ * after it has been changed, and it is stored in the bam file along with the
+ * triangles.  Spheres, capsules, boxes, rays, lines and segments may be
+ * collided into it; each test reports only the nearest, or deepest, of the
+ * triangles it touches.
+ */
+class EXPCL_PANDA_COLLIDE CollisionTriangleMesh : public CollisionSolid {
+PUBLISHED:
+  CollisionTriangleMesh();
+
+  INLINE int add_vertex(const LPoint3 &vertex);
+  INLINE void add_triangle(int a, int b, int c);
+  void add_geom(const Geom *geom, const LMatrix4 &mat = LMatrix4::ident_mat());
+  void add_primitive(const GeomVertexData *vdata, const GeomPrimitive *prim,
+                     const LMatrix4 &mat = LMatrix4::ident_mat());
+
+  INLINE int get_num_vertices() const;
+  INLINE const LPoint3 &get_vertex(int n) const;
+  MAKE_SEQ(get_vertices, get_num_vertices, get_vertex);
+  INLINE int get_num_triangles() const;
+  INLINE LVecBase3i get_triangle(int n) const;
+  MAKE_SEQ(get_triangles, get_num_triangles, get_triangle);
+
+  void build();
+
+  virtual LPoint3 get_collision_origin() const;
+
+PUBLISHED:
+  MAKE_SEQ_PROPERTY(vertices, get_num_vertices, get_vertex);
+  MAKE_SEQ_PROPERTY(triangles, get_num_triangles, get_triangle);
+
+public:
+  CollisionTriangleMesh(const CollisionTriangleMesh &copy);
+  virtual CollisionSolid *make_copy();
+
+  virtual void xform(const LMatrix4 &mat);
+
+  virtual bool cast_ray(double &t, LVector3 &normal, const LPoint3 &origin,
+                        const LVector3 &direction, double max_t) const;
+
+  virtual PStatCollector &get_volume_pcollector();
+  virtual PStatCollector &get_test_pcollector();
+
+  virtual void output(std::ostream &out) const;
+  virtual void write(std::ostream &out, int indent_level = 0) const;
+
+  INLINE static void flush_level();
+
+protected:
+  virtual PT(BoundingVolume) compute_internal_bounds() const;
+
+  virtual PT(CollisionEntry)
+    test_intersection_from_sphere(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_line(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_ray(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_segment(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_capsule(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_box(const CollisionEntry &entry) const;
+
+  virtual void fill_viz_geom();
+
+private:
+  class Triangle {
+  public:
+    unsigned int _v[3];
+  };
+
+  // A node of the hierarchy.  A leaf covers _count triangles starting at
+  // _index; an interior node has a _count of 0, and its two children are at
+  // _index and _index + 1.
+  class Node {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    unsigned int _index;
+    unsigned int _count;
+  };
+
+  void check_tree() const;
+  void do_build();
+  void r_build(pvector<LPoint3> &boxes, vector_int &order,
+               size_t ni, size_t first, size_t count);
+
+  PT(CollisionEntry) intersect_line(const CollisionEntry &entry,
+                                    const LPoint3 &from, const LVector3 &delta,
+                                    double min_t, double max_t) const;
+  int find_first_triangle(double &t, const LPoint3 &from,
+                          const LVector3 &delta,
+                          double min_t, double max_t) const;
+  LPoint3 closest_point(const Triangle &tri, const LPoint3 &point) const;
+  LVector3 get_triangle_normal(const Triangle &tri) const;
+  bool intersects_line(double &t, const Triangle &tri, const LPoint3 &from,
+                       const LVector3 &delta) const;
+  void find_triangles(vector_int &result, const LPoint3 &min,
+                      const LPoint3 &max) const;
+
+  INLINE static bool box_overlaps(const Node &node, const LPoint3 &min,
+                                  const LPoint3 &max);
+  INLINE static bool line_overlaps(const Node &node, const LPoint3 &from,
+                                   const LVector3 &delta,
+                                   const LVector3 &inv_delta,
+                                   double min_t, double max_t);
+
+  enum {
+    // The maximum number of triangles in each leaf.
+    max_leaf_triangles = 4,
+
+    // The deepest the hierarchy can be.  Since it is split at the median,
+    // this is enough for any number of triangles that fits in an int.
+    max_depth = 64,
+  };
+
+  typedef pvector<LPoint3> Vertices;
+  typedef pvector<Triangle> Triangles;
+  typedef pvector<Node> Nodes;
+
+  Vertices _vertices;
+  Triangles _triangles;
+  Nodes _nodes;
+  bool _tree_stale;
+  LightMutex _tree_lock;
+
+  static PStatCollector _volume_pcollector;
+  static PStatCollector _test_pcollector;
+
+protected:
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+  static TypedWritable *make_CollisionTriangleMesh(const FactoryParams &params);
+
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CollisionSolid::init_type();
+    register_type(_type_handle, "CollisionTriangleMesh",
+                  CollisionSolid::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionTriangleMesh.I"
+
+#endif
@@ -38,6 +38,7 @@
 #include "collisionSegment.h"
 #include "collisionSolid.h"
 #include "collisionSphere.h"
+#include "collisionTriangleMesh.h"
 #include "collisionTraverser.h"
 #include "collisionVisualizer.h"
 #include "dconfig.h"
@@ -77,6 +78,24 @@ ConfigVariableBool allow_collider_multiple
           "false, a one-word BitMask is always used instead, which is faster "
           "per pass, but may require more passes."));
 
+ConfigVariableBool collision_broadphase
+("collision-broadphase", false,
+ PRC_DESC("This is the default value of CollisionTraverser::set_broadphase() "
+          "for newly created traversers.  Set it true to have traversers "
+          "walk the scene graph only once per traversal and pair each "
+          "collider with just the nodes near it, which is much faster when "
+          "there are many colliders."));
+
+ConfigVariableBool parallel_collide
+("parallel-collide", false,
+ PRC_DESC("Set this true to allow a CollisionTraverser with more colliders "
+          "than fit in a single pass to run its passes in parallel, on the "
+          "threads of the global WorkerPool (see worker-pool-threads).  The "
+          "detected collisions are still handed to the CollisionHandlers on "
+          "the thread that called traverse(), in the same order as they "
+          "would be without this option.  This has no effect if "
+          "worker-pool-threads is 0."));
+
 ConfigVariableBool flatten_collision_nodes
 ("flatten-collision-nodes", false,
  PRC_DESC("Set this true to allow NodePath::flatten_medium() and "
@@ -146,6 +165,7 @@ init_libcollide() {
   CollisionPlane::init_type();
   CollisionPolygon::init_type();
   CollisionFloorMesh::init_type();
+  CollisionTriangleMesh::init_type();
   CollisionRay::init_type();
   CollisionSegment::init_type();
   CollisionSolid::init_type();
@@ -170,6 +190,7 @@ init_libcollide() {
   CollisionPlane::register_with_read_factory();
   CollisionPolygon::register_with_read_factory();
   CollisionFloorMesh::register_with_read_factory();
+  CollisionTriangleMesh::register_with_read_factory();
   CollisionRay::register_with_read_factory();
   CollisionSegment::register_with_read_factory();
   CollisionSphere::register_with_read_factory();
@@ -7,9 +7,11 @@
 #include "collisionPolygon.cxx"
 #include "collisionFloorMesh.cxx"
 #include "collisionRay.cxx"
+#include "collisionRayQuery.cxx"
 #include "collisionRecorder.cxx"
 #include "collisionSegment.cxx"
 #include "collisionSolid.cxx"
 #include "collisionSphere.cxx"
 #include "collisionTraverser.cxx"
+#include "collisionTriangleMesh.cxx"
 #include "collisionVisualizer.cxx"
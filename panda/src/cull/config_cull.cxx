@@ -33,6 +33,32 @@ ConfigureFn(config_cull) {
   init_libcull();
 }
 
+ConfigVariableBool state_sorted_radix_sort
+("state-sorted-radix-sort", true,
+ PRC_DESC("Set this true to sort the objects in a \"state_sorted\" bin by "
+          "computing a packed 64-bit sort key for each object as it is "
+          "added, and radix-sorting the keys, or false to sort them by "
+          "comparing their RenderStates directly.  The former is much "
+          "faster for bins with many objects.  This is primarily useful "
+          "for comparing the performance of the two approaches."));
+
+ConfigVariableBool state_sorted_instancing
+("state-sorted-instancing", true,
+ PRC_DESC("Set this true to allow a \"state_sorted\" bin to collapse "
+          "objects that draw the same Geom with the same state into a single "
+          "instanced draw call, when the state's ShaderAttrib has the "
+          "F_hardware_instancing flag set and the GSG supports geometry "
+          "instancing.  The shader receives the transform of each instance, "
+          "relative to the first one, in the \"instance_transforms\" "
+          "input."));
+
+ConfigVariableInt state_sorted_max_instances
+("state-sorted-max-instances", 64,
+ PRC_DESC("The maximum number of objects that a \"state_sorted\" bin will "
+          "collapse into a single instanced draw call.  This should not be "
+          "larger than the size of the instance_transforms array declared "
+          "by the shaders that use F_hardware_instancing."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
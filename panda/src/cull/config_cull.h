@@ -26,6 +26,10 @@ class DSearchPath;
 ConfigureDecl(config_cull, EXPCL_PANDA_CULL, EXPTP_PANDA_CULL);
 NotifyCategoryDecl(cull, EXPCL_PANDA_CULL, EXPTP_PANDA_CULL);
 
+extern EXPCL_PANDA_CULL ConfigVariableBool state_sorted_radix_sort;
+extern EXPCL_PANDA_CULL ConfigVariableBool state_sorted_instancing;
+extern EXPCL_PANDA_CULL ConfigVariableInt state_sorted_max_instances;
+
 extern EXPCL_PANDA_CULL void init_libcull();
 
 #endif
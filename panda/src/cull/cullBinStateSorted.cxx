@@ -16,10 +16,21 @@
 #include "cullableObject.h"
 #include "cullHandler.h"
 #include "pStatTimer.h"
+#include "config_cull.h"
+#include "shaderAttrib.h"
+#include "textureAttrib.h"
+#include "materialAttrib.h"
+#include "boundingVolume.h"
+#include "internalName.h"
+#include "pta_LMatrix4.h"
+#include "pipeline.h"
 
 #include <algorithm>
+#include <string.h>
 
 
+PStatCollector CullBinStateSorted::_instanced_pcollector("Geoms:Instanced");
+
 TypeHandle CullBinStateSorted::_type_handle;
 
 /**
@@ -34,6 +45,32 @@ CullBinStateSorted::
   }
 }
 
+/**
+ * Used by make_next() to make the bin of the next frame, which inherits the
+ * instanced states of this one, but none of its objects.
+ */
+CullBinStateSorted::
+CullBinStateSorted(const CullBinStateSorted &copy) :
+  CullBin(copy),
+  _objects(get_class_type()),
+  _old_instances(copy._old_instances),
+  _last_state(nullptr),
+  _last_state_key(0),
+  _keys_overflowed(false)
+{
+  size_t num_stages = (size_t)Pipeline::get_render_pipeline()->get_num_stages();
+  _old_instances.push_front(copy._instances);
+  while (_old_instances.size() > num_stages) {
+    _old_instances.pop_back();
+  }
+  if (_old_instances.size() == num_stages) {
+    // These states were used as many frames ago as there are stages, so the
+    // pipeline is done with them.
+    _free_instances.swap(_old_instances.back());
+    _old_instances.pop_back();
+  }
+}
+
 /**
  * Factory constructor for passing to the CullBinManager.
  */
@@ -43,12 +80,46 @@ make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
   return new CullBinStateSorted(name, gsg, draw_region_pcollector);
 }
 
+/**
+ * Returns a newly-allocated CullBin object that contains a copy of just the
+ * subset of the data from this CullBin object that is worth keeping around
+ * for next frame.
+ */
+PT(CullBin) CullBinStateSorted::
+make_next() const {
+  if (_instances.empty() && _old_instances.empty()) {
+    return nullptr;
+  }
+  return new CullBinStateSorted(*this);
+}
+
 /**
  * Adds a geom, along with its associated state, to the bin for rendering.
  */
 void CullBinStateSorted::
 add_object(CullableObject *object, Thread *current_thread) {
-  _objects.push_back(ObjectData(object));
+  if (!state_sorted_radix_sort) {
+    // The sort key won't be used.
+    _objects.push_back(ObjectData(object, 0));
+    return;
+  }
+
+  // Consecutive objects very often share the same state.
+  const RenderState *state = object->_state;
+  if (state != _last_state) {
+    _last_state_key = get_state_key(state);
+    _last_state = state;
+  }
+
+  const GeomVertexFormat *format = nullptr;
+  if (object->_munged_data != nullptr) {
+    format = object->_munged_data->get_format();
+  }
+
+  uint64_t sort_key = _last_state_key;
+  sort_key |= get_id(_format_ids, format, SKB_format) << SKB_depth;
+  sort_key |= get_depth_key(object);
+  _objects.push_back(ObjectData(object, sort_key));
 }
 
 /**
@@ -59,7 +130,19 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinStateSorted::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+  if (!state_sorted_radix_sort || _keys_overflowed) {
+    sort(_objects.begin(), _objects.end(),
+         [](const ObjectData &a, const ObjectData &b) {
+           return a.compare_state(b);
+         });
+  } else {
+    radix_sort(_objects);
+  }
+
+  if (state_sorted_instancing && state_sorted_max_instances > 1 &&
+      _gsg->get_supports_geometry_instancing()) {
+    collapse_instances();
+  }
 }
 
 
@@ -103,3 +186,283 @@ fill_result_graph(CullBin::ResultGraphBuilder &builder) {
     builder.add_object(object);
   }
 }
+
+/**
+ * Called after sorting to look for runs of objects with the same state, whose
+ * shader has the F_hardware_instancing flag, and collapse the objects within
+ * each run that draw the same Geom into a single instanced object.
+ */
+void CullBinStateSorted::
+collapse_instances() {
+  size_t num_objects = _objects.size();
+  size_t num_instanced = 0;
+
+  size_t begin = 0;
+  while (begin < num_objects) {
+    const RenderState *state = _objects[begin]._object->_state;
+    size_t end = begin + 1;
+    while (end < num_objects && _objects[end]._object->_state == state) {
+      ++end;
+    }
+
+    const ShaderAttrib *sattr;
+    if (end - begin > 1 && state->get_attrib(sattr) &&
+        sattr->get_flag(ShaderAttrib::F_hardware_instancing) &&
+        sattr->get_instance_count() == 0) {
+      num_instanced += collapse_run(begin, end, sattr);
+    }
+    begin = end;
+  }
+
+  if (num_instanced != 0) {
+    // Remove the objects that were folded into another one.
+    _objects.erase(std::remove_if(_objects.begin(), _objects.end(),
+                                  [](const ObjectData &data) {
+                                    return data._object == nullptr;
+                                  }),
+                   _objects.end());
+    _instanced_pcollector.add_level(num_instanced);
+  }
+}
+
+/**
+ * Collapses the objects in the indicated range of _objects, which all share
+ * the indicated state, that draw the same Geom.  The first object of each
+ * group is replaced with an instanced one, and the rest are deleted, leaving
+ * nullptrs in their place.  Returns the number of objects that will be drawn
+ * by instanced draw calls.
+ *
+ * The first object of a group keeps its own transform.  The shader receives
+ * the transform of each instance relative to it, in the order of
+ * gl_InstanceID, in the "instance_transforms" input; the first of these is
+ * therefore always the identity matrix.
+ */
+size_t CullBinStateSorted::
+collapse_run(size_t begin, size_t end, const ShaderAttrib *sattr) {
+  static CPT_InternalName transforms_name("instance_transforms");
+  size_t max_instances = (size_t)state_sorted_max_instances;
+
+  // Chain together the objects that draw the same Geom, in their sorted
+  // order, in groups of no more than max_instances.  These are indexed
+  // relative to begin.
+  size_t num_objects = end - begin;
+  pvector<size_t> next(num_objects, num_objects);
+  pvector<size_t> tail(num_objects, num_objects);
+  pvector<size_t> count(num_objects, 0);
+
+  Ids heads;
+  for (size_t i = 0; i < num_objects; ++i) {
+    const CullableObject *object = _objects[begin + i]._object;
+    if (object->_draw_callback != nullptr || object->_geom == nullptr) {
+      continue;
+    }
+
+    int hi = heads.find(object->_geom);
+    if (hi != -1) {
+      size_t head = (size_t)heads.get_data(hi);
+      if (count[head] < max_instances &&
+          _objects[begin + head]._object->_munged_data == object->_munged_data) {
+        next[tail[head]] = i;
+        tail[head] = i;
+        ++count[head];
+        continue;
+      }
+    }
+
+    // This object starts a new group.
+    heads.store(object->_geom, i);
+    tail[i] = i;
+    count[i] = 1;
+  }
+
+  size_t num_instanced = 0;
+  for (size_t head = 0; head < num_objects; ++head) {
+    if (count[head] < 2) {
+      continue;
+    }
+    CullableObject *head_object = _objects[begin + head]._object;
+    LMatrix4 inv;
+    if (!inv.invert_from(head_object->_internal_transform->get_mat())) {
+      continue;
+    }
+
+    // Reuse the instanced state made for the same group in a frame that the
+    // pipeline is done with, if there was one, by overwriting its transforms.
+    InstanceStates &instances = _instances[head_object->_state];
+    size_t index = instances.size();
+    InstanceCache::iterator ci = _free_instances.find(head_object->_state);
+    if (ci != _free_instances.end() && index < (*ci).second.size() &&
+        (*ci).second[index]._transforms.size() == count[head]) {
+      instances.push_back((*ci).second[index]);
+    } else {
+      InstanceState instance;
+      instance._transforms = PTA_LMatrix4(count[head], LMatrix4::ident_mat());
+      CPT(RenderAttrib) attrib = sattr->set_instance_count((int)count[head]);
+      attrib = DCAST(ShaderAttrib, attrib)->set_shader_input(transforms_name, instance._transforms);
+      instance._state = head_object->_state->set_attrib(attrib);
+      instances.push_back(std::move(instance));
+    }
+
+    pvector<UnalignedLMatrix4> &transforms = instances.back()._transforms.v();
+    transforms[0] = LMatrix4::ident_mat();
+    size_t n = 1;
+    for (size_t i = next[head]; i != num_objects; i = next[i]) {
+      CullableObject *object = _objects[begin + i]._object;
+      transforms[n++] = object->_internal_transform->get_mat() * inv;
+      delete object;
+      _objects[begin + i]._object = nullptr;
+    }
+    nassertr(n == count[head], num_instanced);
+
+    head_object->_state = instances.back()._state;
+    num_instanced += n;
+  }
+
+  return num_instanced;
+}
+
+/**
+ * Returns the part of the sort key that depends only on the state: the ids of
+ * its shader, textures and material, and of the state itself, in their
+ * respective fields.
+ */
+uint64_t CullBinStateSorted::
+get_state_key(const RenderState *state) {
+  int si = _state_keys.find(state);
+  if (si != -1) {
+    return _state_keys.get_data(si);
+  }
+
+  const RenderAttrib *shader = state->get_attrib(ShaderAttrib::get_class_slot());
+  const RenderAttrib *texture = state->get_attrib(TextureAttrib::get_class_slot());
+  const RenderAttrib *material = state->get_attrib(MaterialAttrib::get_class_slot());
+
+  uint64_t key = get_id(_shader_ids, shader, SKB_shader);
+  key = (key << SKB_texture) | get_id(_texture_ids, texture, SKB_texture);
+  key = (key << SKB_material) | get_id(_material_ids, material, SKB_material);
+
+  // The states get their ids in the order they are encountered, just like
+  // everything else.
+  uint64_t state_id = _state_keys.get_num_entries();
+  if (state_id >= ((uint64_t)1 << SKB_state)) {
+    _keys_overflowed = true;
+    state_id = ((uint64_t)1 << SKB_state) - 1;
+  }
+  key = (key << SKB_state) | state_id;
+  key <<= SKB_format + SKB_depth;
+
+  _state_keys.store(state, key);
+  return key;
+}
+
+/**
+ * Returns a small integer that uniquely identifies the indicated pointer
+ * within this bin, assigning a new one if it has not been seen before.  If
+ * the id does not fit in the indicated number of bits, sets _keys_overflowed.
+ */
+uint64_t CullBinStateSorted::
+get_id(Ids &ids, const void *ptr, int num_bits) {
+  int i = ids.find(ptr);
+  if (i != -1) {
+    return ids.get_data(i);
+  }
+
+  uint64_t id = ids.get_num_entries();
+  if (id >= ((uint64_t)1 << num_bits)) {
+    _keys_overflowed = true;
+    id = ((uint64_t)1 << num_bits) - 1;
+  }
+  ids.store(ptr, id);
+  return id;
+}
+
+/**
+ * Returns the least significant part of the sort key, which orders objects
+ * with the same state approximately front-to-back.
+ */
+uint64_t CullBinStateSorted::
+get_depth_key(const CullableObject *object) const {
+  if (object->_geom == nullptr || object->_internal_transform == nullptr) {
+    return 0;
+  }
+
+  CPT(BoundingVolume) volume = object->_geom->get_bounds();
+  if (volume->is_empty() || volume->is_infinite()) {
+    return 0;
+  }
+  const GeometricBoundingVolume *gbv = volume->as_geometric_bounding_volume();
+  if (gbv == nullptr) {
+    return 0;
+  }
+
+  LPoint3 center = gbv->get_approx_center() * object->_internal_transform->get_mat();
+  float distance = (float)_gsg->compute_distance_to(center);
+  if (!(distance > 0.0f)) {
+    return 0;
+  }
+
+  // The bit pattern of a positive float increases monotonically with its
+  // value, so the exponent and the first few bits of the mantissa make a
+  // logarithmically-spaced depth bucket.
+  uint32_t bits;
+  memcpy(&bits, &distance, sizeof(bits));
+  return bits >> (31 - SKB_depth);
+}
+
+/**
+ * Sorts the objects by their sort keys, using a least-significant-digit radix
+ * sort, which never needs to look at the objects themselves.  Digits that are
+ * the same for all of the objects are skipped.
+ */
+void CullBinStateSorted::
+radix_sort(Objects &objects) {
+  static const int digit_bits = 8;
+  static const int num_digits = 64 / digit_bits;
+  static const int num_buckets = 1 << digit_bits;
+
+  size_t num_objects = objects.size();
+  if (num_objects < 64) {
+    // Not worth the overhead.
+    sort(objects.begin(), objects.end());
+    return;
+  }
+
+  // Count all of the digits in one pass.
+  size_t counts[num_digits][num_buckets];
+  memset(counts, 0, sizeof(counts));
+  for (const ObjectData &data : objects) {
+    uint64_t key = data._sort_key;
+    for (int d = 0; d < num_digits; ++d) {
+      ++counts[d][(key >> (d * digit_bits)) & (num_buckets - 1)];
+    }
+  }
+
+  Objects temp(num_objects, ObjectData(nullptr, 0), get_class_type());
+  ObjectData *from = &objects[0];
+  ObjectData *to = &temp[0];
+
+  for (int d = 0; d < num_digits; ++d) {
+    size_t *count = counts[d];
+    int shift = d * digit_bits;
+    if (count[(from[0]._sort_key >> shift) & (num_buckets - 1)] == num_objects) {
+      // All of the objects have the same value for this digit.
+      continue;
+    }
+
+    size_t offset = 0;
+    for (int b = 0; b < num_buckets; ++b) {
+      size_t c = count[b];
+      count[b] = offset;
+      offset += c;
+    }
+
+    for (size_t i = 0; i < num_objects; ++i) {
+      to[count[(from[i]._sort_key >> shift) & (num_buckets - 1)]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+
+  if (from != &objects[0]) {
+    objects.swap(temp);
+  }
+}
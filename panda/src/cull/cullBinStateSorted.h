@@ -22,6 +22,13 @@
 #include "transformState.h"
 #include "renderState.h"
 #include "pointerTo.h"
+#include "simpleHashMap.h"
+#include "pStatCollector.h"
+#include "pmap.h"
+#include "pdeque.h"
+#include "pta_LMatrix4.h"
+
+class ShaderAttrib;
 
 /**
  * A specific kind of CullBin that sorts geometry to collect items of the same
@@ -31,8 +38,23 @@
  * This also sorts objects front-to-back within a particular state, to take
  * advantage of hierarchical Z-buffer algorithms which can early-out when an
  * object appears behind another one.
+ *
+ * Rather than comparing the RenderStates of the objects during the sort, a
+ * 64-bit sort key is computed for each object as it is added.  This key packs
+ * together small ids for its shader, textures, material, state and vertex
+ * format, heaviest first, followed by its approximate distance from the
+ * camera.  The keys are then radix-sorted, without touching the objects
+ * themselves.
+ *
+ * If the shader of a state has the F_hardware_instancing flag, the objects
+ * with that state that draw the same Geom are collapsed into one instanced
+ * draw call after sorting.  The instanced states are handed on to the bins of
+ * later frames by make_next(), so that once the render pipeline is done with
+ * them they can be reused, rather than made anew every frame.
  */
 class EXPCL_PANDA_CULL CullBinStateSorted : public CullBin {
+protected:
+  CullBinStateSorted(const CullBinStateSorted &copy);
 public:
   INLINE CullBinStateSorted(const std::string &name,
                             GraphicsStateGuardianBase *gsg,
@@ -43,26 +65,90 @@ public:
                            GraphicsStateGuardianBase *gsg,
                            const PStatCollector &draw_region_pcollector);
 
+  virtual PT(CullBin) make_next() const;
+
   virtual void add_object(CullableObject *object, Thread *current_thread);
   virtual void finish_cull(SceneSetup *scene_setup, Thread *current_thread);
   virtual void draw(bool force, Thread *current_thread);
 
+  INLINE static void flush_level();
+
 protected:
   virtual void fill_result_graph(ResultGraphBuilder &builder);
 
 private:
   class ObjectData {
   public:
-    INLINE ObjectData(CullableObject *object);
+    INLINE ObjectData(CullableObject *object, uint64_t sort_key);
     INLINE bool operator < (const ObjectData &other) const;
+    INLINE bool compare_state(const ObjectData &other) const;
 
+    uint64_t _sort_key;
     CullableObject *_object;
-    const GeomVertexFormat *_format;
   };
 
   typedef pvector<ObjectData> Objects;
   Objects _objects;
 
+  typedef SimpleHashMap<const void *, uint64_t, pointer_hash> Ids;
+
+  uint64_t get_state_key(const RenderState *state);
+  uint64_t get_id(Ids &ids, const void *ptr, int num_bits);
+  uint64_t get_depth_key(const CullableObject *object) const;
+  static void radix_sort(Objects &objects);
+
+  void collapse_instances();
+  size_t collapse_run(size_t begin, size_t end, const ShaderAttrib *sattr);
+
+  // The number of bits allotted to each field of the sort key, from most
+  // significant to least significant.
+  enum SortKeyBits {
+    SKB_shader = 10,
+    SKB_texture = 14,
+    SKB_material = 8,
+    SKB_state = 14,
+    SKB_format = 8,
+    SKB_depth = 10,
+  };
+
+  // A state made by collapse_run() for an instanced draw call, and the
+  // instance transforms in its shader input, which are overwritten each time
+  // the state is used again.
+  class InstanceState {
+  public:
+    CPT(RenderState) _state;
+    PTA_LMatrix4 _transforms;
+  };
+  typedef pvector<InstanceState> InstanceStates;
+  typedef pmap<CPT(RenderState), InstanceStates> InstanceCache;
+
+  // The instanced states used by this frame, keyed by the state of the
+  // objects they replace, in the order the groups were found.  The states of
+  // a frame may still be in use by a later stage of the render pipeline until
+  // as many frames have passed as there are stages, so _old_instances holds
+  // the states of the frames in between, most recent first, and only the
+  // states of the frame before those are free to be reused.
+  InstanceCache _instances;
+  pdeque<InstanceCache> _old_instances;
+  InstanceCache _free_instances;
+
+  Ids _shader_ids;
+  Ids _texture_ids;
+  Ids _material_ids;
+  Ids _format_ids;
+  Ids _state_keys;
+
+  const RenderState *_last_state;
+  uint64_t _last_state_key;
+
+  // Set if there were too many distinct values to fit in some field of the
+  // sort key, in which case we fall back to comparing the states.
+  bool _keys_overflowed;
+
+public:
+  // Counts the objects that were drawn as part of an instanced draw call.
+  static PStatCollector _instanced_pcollector;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -0,0 +1,336 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_cullbin.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "pandabase.h"
+#include "cullBinStateSorted.h"
+#include "config_cull.h"
+#include "graphicsStateGuardian.h"
+#include "textureAttrib.h"
+#include "colorAttrib.h"
+#include "shaderAttrib.h"
+#include "geomNode.h"
+#include "pipeline.h"
+#include "texture.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "randomizer.h"
+#include "trueClock.h"
+
+// This program first checks that a CullBinStateSorted collapses the objects
+// that draw the same Geom with an instancing shader into instanced objects,
+// and reuses their states in later frames.  It then measures the time taken
+// to add a large number of objects to a CullBinStateSorted and sort them,
+// first by comparing their RenderStates directly and then by radix-sorting
+// their packed sort keys.
+
+// The number of times to repeat each measurement; the best time is kept.
+static const int num_trials = 10;
+
+namespace {
+  // A GSG that claims to support geometry instancing.
+  class InstancingGSG : public GraphicsStateGuardian {
+  public:
+    InstancingGSG() : GraphicsStateGuardian(CS_zup_right, nullptr, nullptr) {
+      _supports_geometry_instancing = true;
+    }
+  };
+
+  // What became of one frame's objects.
+  class FrameResult {
+  public:
+    pvector<CPT(RenderState)> _instanced_states;
+    vector_int _instance_counts;
+    pvector<PN_stdfloat> _positions;
+    int _num_plain;
+  };
+
+  int num_failures = 0;
+
+  void
+  check(bool condition, const char *description) {
+    if (!condition) {
+      nout << "FAILED: " << description << "\n";
+      ++num_failures;
+    }
+  }
+}
+
+/**
+ * Adds a frame's objects to the bin: ten copies of geom_a and three of geom_b
+ * with the instancing state, and three of geom_a with the plain one.  Each
+ * is at a different x position, shifted by the indicated offset.  Returns the
+ * positions of the objects with the instancing state, in ascending order.
+ */
+static pvector<PN_stdfloat>
+add_frame(CullBinStateSorted &bin, const Geom *geom_a, const Geom *geom_b,
+          const RenderState *instanced, const RenderState *plain,
+          const GeomVertexData *vdata, PN_stdfloat offset) {
+  Thread *current_thread = Thread::get_current_thread();
+  pvector<PN_stdfloat> positions;
+  for (int i = 0; i < 16; ++i) {
+    const Geom *geom = (i >= 10 && i < 13) ? geom_b : geom_a;
+    const RenderState *state = (i < 13) ? instanced : plain;
+    PN_stdfloat x = i + offset;
+    CullableObject *object = new CullableObject(
+      geom, state, TransformState::make_pos(LVecBase3(x, 0, 0)));
+    object->_munged_data = vdata;
+    bin.add_object(object, current_thread);
+    if (state == instanced) {
+      positions.push_back(x);
+    }
+  }
+  std::sort(positions.begin(), positions.end());
+  return positions;
+}
+
+/**
+ * Examines the objects left in the bin after finish_cull().  The position of
+ * each instance is recovered from the transform of its instanced object and
+ * its own relative transform.
+ */
+static FrameResult
+get_result(CullBin &bin) {
+  static CPT_InternalName transforms_name("instance_transforms");
+  FrameResult result;
+  result._num_plain = 0;
+
+  PT(PandaNode) root = bin.make_result_graph();
+  for (size_t i = 0; i < root->get_num_children(); ++i) {
+    PandaNode *node = root->get_child(i);
+    const ShaderAttrib *sattr;
+    if (!node->get_state()->get_attrib(sattr) || sattr->get_instance_count() == 0) {
+      result._num_plain += DCAST(GeomNode, node)->get_num_geoms();
+      continue;
+    }
+    result._instanced_states.push_back(node->get_state());
+    result._instance_counts.push_back(sattr->get_instance_count());
+
+    const Shader::ShaderPtrData &ptr =
+      sattr->get_shader_input(transforms_name).get_ptr();
+    const LMatrix4 *transforms = (const LMatrix4 *)ptr._ptr;
+    check(ptr._size == (size_t)sattr->get_instance_count() * 16,
+          "there is one instance transform per instance");
+    check(transforms[0] == LMatrix4::ident_mat(),
+          "the first instance transform is the identity");
+    for (size_t k = 0; k < ptr._size / 16; ++k) {
+      LMatrix4 mat = transforms[k] * node->get_transform()->get_mat();
+      result._positions.push_back(mat.get_row3(3)[0]);
+    }
+  }
+  std::sort(result._positions.begin(), result._positions.end());
+  return result;
+}
+
+/**
+ * Returns true if none of the states in a are also in b.
+ */
+static bool
+no_common_states(const pvector<CPT(RenderState)> &a,
+                 const pvector<CPT(RenderState)> &b) {
+  for (const CPT(RenderState) &state : a) {
+    if (std::find(b.begin(), b.end(), state) != b.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Culls a few frames with an instancing shader, with the indicated number of
+ * stages in the render pipeline, and checks the objects that are left to
+ * draw.
+ */
+static void
+check_instancing(const Geom *geom_a, const GeomVertexData *vdata, int num_stages) {
+  PT(Geom) geom_b = geom_a->make_copy();
+  CPT(RenderState) instanced = RenderState::make(
+    DCAST(ShaderAttrib, ShaderAttrib::make())->set_flag(ShaderAttrib::F_hardware_instancing, true));
+  CPT(RenderState) plain = RenderState::make(
+    ColorAttrib::make_flat(LColor(1, 0, 0, 1)));
+
+  PT(GraphicsStateGuardian) gsg = new InstancingGSG;
+  PStatCollector collector("test");
+  Thread *current_thread = Thread::get_current_thread();
+  Pipeline::get_render_pipeline()->set_num_stages(num_stages);
+  int orig_max_instances = state_sorted_max_instances;
+  state_sorted_max_instances = 4;
+
+  // No more than four instances are drawn at once, so the ten copies of
+  // geom_a are drawn in groups of 4, 4 and 2.  The objects with the plain
+  // state are left alone.  In the last frame, up to eight are drawn at once.
+  int num_frames = num_stages + 2;
+  pvector<FrameResult> results;
+  PT(CullBin) bin = new CullBinStateSorted("test", gsg, collector);
+  for (int frame = 0; frame < num_frames; ++frame) {
+    bool last = (frame == num_frames - 1);
+    if (last) {
+      state_sorted_max_instances = 8;
+    }
+    CullBinStateSorted *state_sorted = DCAST(CullBinStateSorted, bin);
+    pvector<PN_stdfloat> positions = add_frame(
+      *state_sorted, geom_a, geom_b, instanced, plain, vdata, frame * 100.0f);
+    bin->finish_cull(nullptr, current_thread);
+    results.push_back(get_result(*bin));
+
+    const FrameResult &result = results.back();
+    check(result._num_plain == 3, "the plain objects are not instanced");
+    check(result._positions == positions,
+          "every instance is drawn once, at its own position");
+
+    vector_int counts = result._instance_counts;
+    std::sort(counts.begin(), counts.end());
+    static const int split_4[] = {2, 3, 4, 4};
+    static const int split_8[] = {2, 3, 8};
+    vector_int expected = last ? vector_int(split_8, split_8 + 3)
+                               : vector_int(split_4, split_4 + 4);
+    check(counts == expected, "the instances are split by state-sorted-max-instances");
+
+    PT(CullBin) next = bin->make_next();
+    check(next != nullptr, "the instanced states are kept for the next frame");
+    if (next == nullptr) {
+      break;
+    }
+    bin = next;
+  }
+
+  // The states of a frame may still be in use by the later stages of the
+  // pipeline, so they are only reused once as many frames have passed as
+  // there are stages.  When the groups change size, new states are needed.
+  if ((int)results.size() == num_frames) {
+    for (int frame = 1; frame < num_stages; ++frame) {
+      check(no_common_states(results[frame]._instanced_states,
+                             results[0]._instanced_states),
+            "the instanced states are not reused while the pipeline may use them");
+    }
+    check(results[num_stages]._instanced_states == results[0]._instanced_states,
+          "the instanced states are reused once the pipeline is done with them");
+
+    const FrameResult &result = results.back();
+    for (size_t i = 0; i < result._instanced_states.size(); ++i) {
+      if (result._instance_counts[i] == 8) {
+        pvector<CPT(RenderState)> states(1, result._instanced_states[i]);
+        for (int frame = 0; frame < num_frames - 1; ++frame) {
+          check(no_common_states(states, results[frame]._instanced_states),
+                "groups of a different size get new states");
+        }
+      }
+    }
+  }
+
+  state_sorted_max_instances = orig_max_instances;
+  Pipeline::get_render_pipeline()->set_num_stages(1);
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_objects = 50000;
+  int num_states = 500;
+  int num_textures = 100;
+  if (argc > 1) {
+    num_objects = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    num_states = atoi(argv[2]);
+  }
+  if (num_objects < 1 || num_states < 1) {
+    nout << "Usage: test_cullbin [num_objects [num_states]]\n";
+    return 1;
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("tri", GeomVertexFormat::get_v3(), Geom::UH_static);
+  {
+    // The writer must be gone before the number of pipeline stages changes.
+    GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+    vertex.add_data3(0, 0, 0);
+    vertex.add_data3(1, 0, 0);
+    vertex.add_data3(0, 0, 1);
+  }
+  PT(GeomTriangles) tris = new GeomTriangles(Geom::UH_static);
+  tris->add_vertices(0, 1, 2);
+  PT(Geom) geom = new Geom(vdata);
+  geom->add_primitive(tris);
+
+  for (int num_stages = 1; num_stages <= 3; ++num_stages) {
+    check_instancing(geom, vdata, num_stages);
+  }
+  if (num_failures != 0) {
+    nout << num_failures << " checks failed.\n";
+    return 1;
+  }
+  nout << "All checks passed.\n";
+
+  pvector<PT(Texture)> textures;
+  for (int i = 0; i < num_textures; ++i) {
+    textures.push_back(new Texture("tex"));
+  }
+
+  Randomizer random(1);
+  pvector<CPT(RenderState)> states;
+  for (int i = 0; i < num_states; ++i) {
+    Texture *tex = textures[random.random_int(num_textures)];
+    states.push_back(RenderState::make(
+      TextureAttrib::make(tex),
+      ColorAttrib::make_flat(LColor(random.random_real(1), 0, 0, 1))));
+  }
+
+  // Objects are added in scene graph order, so runs of a few objects tend to
+  // share the same state.
+  pvector<CPT(RenderState)> object_states;
+  pvector<CPT(TransformState)> object_transforms;
+  for (int i = 0; i < num_objects; ++i) {
+    if (i == 0 || random.random_int(4) == 0) {
+      object_states.push_back(states[random.random_int(num_states)]);
+    } else {
+      object_states.push_back(object_states.back());
+    }
+    object_transforms.push_back(TransformState::make_pos(
+      LVecBase3(random.random_real(200) - 100, random.random_real(500), 0)));
+  }
+
+  PT(GraphicsStateGuardian) gsg = new GraphicsStateGuardian(CS_zup_right, nullptr, nullptr);
+  PStatCollector collector("test");
+  Thread *current_thread = Thread::get_current_thread();
+  TrueClock *clock = TrueClock::get_global_ptr();
+
+  for (int radix = 0; radix <= 1; ++radix) {
+    state_sorted_radix_sort = (radix != 0);
+
+    double best_add = 1.0e30;
+    double best_sort = 1.0e30;
+    for (int trial = 0; trial < num_trials; ++trial) {
+      CullBinStateSorted bin("test", gsg, collector);
+
+      double start = clock->get_short_time();
+      for (int i = 0; i < num_objects; ++i) {
+        CullableObject *object =
+          new CullableObject(geom, object_states[i], object_transforms[i]);
+        object->_munged_data = vdata;
+        bin.add_object(object, current_thread);
+      }
+      double added = clock->get_short_time();
+      bin.finish_cull(nullptr, current_thread);
+      double sorted = clock->get_short_time();
+
+      best_add = std::min(best_add, added - start);
+      best_sort = std::min(best_sort, sorted - added);
+    }
+
+    nout << (radix ? "radix sort: " : "std::sort:  ")
+         << num_objects << " objects, " << num_states << " states: add "
+         << best_add * 1000.0 << " ms, sort " << best_sort * 1000.0
+         << " ms, total " << (best_add + best_sort) * 1000.0 << " ms\n";
+  }
+
+  return 0;
+}
@@ -21,6 +21,7 @@
 #include "binCullHandler.h"
 #include "cullResult.h"
 #include "cullTraverser.h"
+#include "cullBinStateSorted.h"
 #include "clockObject.h"
 #include "pStatTimer.h"
 #include "pStatGPUTimer.h"
@@ -40,6 +41,7 @@
 #include "bamCache.h"
 #include "cullableObject.h"
 #include "geomVertexArrayData.h"
+#include "geomVertexData.h"
 #include "vertexDataSaveFile.h"
 #include "vertexDataBook.h"
 #include "vertexDataPage.h"
@@ -71,6 +73,7 @@ PStatCollector GraphicsEngine::_yield_pcollector("App:Yield");
 PStatCollector GraphicsEngine::_cull_pcollector("Cull");
 PStatCollector GraphicsEngine::_cull_setup_pcollector("Cull:Setup");
 PStatCollector GraphicsEngine::_cull_sort_pcollector("Cull:Sort");
+PStatCollector GraphicsEngine::_cull_parallel_pcollector("Cull:Parallel");
 PStatCollector GraphicsEngine::_draw_pcollector("Draw");
 PStatCollector GraphicsEngine::_sync_pcollector("Draw:Sync");
 PStatCollector GraphicsEngine::_flip_pcollector("Wait:Flip");
@@ -116,6 +119,7 @@ PStatCollector GraphicsEngine::_volume_inv_sphere_pcollector("Collision Volumes:
 PStatCollector GraphicsEngine::_test_inv_sphere_pcollector("Collision Tests:CollisionInvSphere");
 PStatCollector GraphicsEngine::_volume_geom_pcollector("Collision Volumes:CollisionGeom");
 PStatCollector GraphicsEngine::_test_geom_pcollector("Collision Tests:CollisionGeom");
+PStatCollector GraphicsEngine::_collision_entries_pcollector("Collision Entries");
 PStatCollector GraphicsEngine::_occlusion_untested_pcollector("Occlusion results:Not tested");
 PStatCollector GraphicsEngine::_occlusion_passed_pcollector("Occlusion results:Visible");
 PStatCollector GraphicsEngine::_occlusion_failed_pcollector("Occlusion results:Occluded");
@@ -138,6 +142,39 @@ INLINE static bool operator < (const CullKey &a, const CullKey &b) {
   return a._lens_index < b._lens_index;
 }
 
+// This records a DisplayRegion whose cull has been deferred, in the parallel
+// cull model.  If _cull is false, the region shares the CullResult of an
+// earlier region with the same camera, and need not be culled itself.
+struct ParallelCull {
+  PT(GraphicsOutput) _win;
+  GraphicsStateGuardian *_gsg;
+  PT(DisplayRegion) _dr;
+  PT(SceneSetup) _scene_setup;
+  PT(CullResult) _cull_result;
+  bool _cull;
+};
+typedef pvector<ParallelCull> ParallelCulls;
+
+/**
+ * Culls each of a list of DisplayRegions, on the threads of the WorkerPool.
+ */
+class GraphicsEngine::ParallelCullJob : public WorkerPool::Job {
+public:
+  ParallelCullJob(GraphicsEngine *engine, ParallelCulls &culls) :
+    _engine(engine), _culls(culls) {}
+
+  virtual void run_item(size_t index, Thread *current_thread) {
+    ParallelCull &pc = _culls[index];
+    if (pc._cull) {
+      _engine->cull_to_bins(pc._win, pc._gsg, pc._dr, pc._scene_setup,
+                            pc._cull_result, current_thread);
+    }
+  }
+
+  GraphicsEngine *_engine;
+  ParallelCulls &_culls;
+};
+
 /**
  * Creates a new GraphicsEngine object.  The Pipeline is normally left to
  * default to NULL, which indicates the global render pipeline, but it may be
@@ -821,6 +858,8 @@ render_frame() {
 
     GeomCacheManager::flush_level();
     CullTraverser::flush_level();
+    CullBinStateSorted::flush_level();
+    GeomVertexData::flush_level();
     RenderState::flush_level();
     TransformState::flush_level();
     CullableObject::flush_level();
@@ -845,6 +884,8 @@ render_frame() {
     CullTraverser::_nodes_pcollector.clear_level();
     CullTraverser::_geom_nodes_pcollector.clear_level();
     CullTraverser::_geoms_pcollector.clear_level();
+    CullBinStateSorted::_instanced_pcollector.clear_level();
+    GeomVertexData::_skinned_vertices_pcollector.clear_level();
     GeomCacheManager::_geom_cache_active_pcollector.clear_level();
     GeomCacheManager::_geom_cache_record_pcollector.clear_level();
     GeomCacheManager::_geom_cache_erase_pcollector.clear_level();
@@ -881,6 +922,7 @@ render_frame() {
     _test_inv_sphere_pcollector.clear_level();
     _volume_geom_pcollector.clear_level();
     _test_geom_pcollector.clear_level();
+    _collision_entries_pcollector.clear_level();
     _occlusion_untested_pcollector.clear_level();
     _occlusion_passed_pcollector.clear_level();
     _occlusion_failed_pcollector.clear_level();
@@ -1546,6 +1588,10 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
   typedef pmap<CullKey, DisplayRegion *> AlreadyCulled;
   AlreadyCulled already_culled;
 
+  // In the parallel cull model, the regions are only set up in the loop
+  // below; they are all culled together afterwards.
+  ParallelCulls parallel_culls;
+
   size_t wlist_size = wlist.size();
   for (size_t wi = 0; wi < wlist_size; ++wi) {
     GraphicsOutput *win = wlist[wi];
@@ -1584,6 +1630,10 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
               cull_result = new CullResult(gsg, dr->get_draw_region_pcollector());
             }
             (*aci).second = dr;
+            if (gsg->get_threading_model().get_parallel_cull()) {
+              parallel_culls.push_back({win, gsg, dr, std::move(scene_setup), std::move(cull_result), true});
+              continue;
+            }
             cull_to_bins(win, gsg, dr, scene_setup, cull_result, current_thread);
 
           } else {
@@ -1594,6 +1644,18 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
             // image.)  Of course, the cull result will be the same, so just
             // use the result from the other DisplayRegion.
             DisplayRegion *other_dr = (*aci).second;
+            if (gsg->get_threading_model().get_parallel_cull()) {
+              // The other region hasn't been culled yet, so we can't ask it
+              // for its result; find the one we made for it.
+              for (const ParallelCull &pc : parallel_culls) {
+                if (pc._dr == other_dr) {
+                  cull_result = pc._cull_result;
+                  break;
+                }
+              }
+              parallel_culls.push_back({win, gsg, dr, std::move(scene_setup), std::move(cull_result), false});
+              continue;
+            }
             cull_result = other_dr->get_cull_result(current_thread);
           }
 
@@ -1603,6 +1665,19 @@ cull_to_bins(GraphicsEngine::Windows wlist, Thread *current_thread) {
       }
     }
   }
+
+  if (!parallel_culls.empty()) {
+    {
+      PStatTimer timer(_cull_parallel_pcollector, current_thread);
+      ParallelCullJob job(this, parallel_culls);
+      WorkerPool::get_global_ptr()->run(job, parallel_culls.size(), current_thread);
+    }
+
+    // Save the results for next frame.
+    for (ParallelCull &pc : parallel_culls) {
+      pc._dr->set_cull_result(std::move(pc._cull_result), std::move(pc._scene_setup), current_thread);
+    }
+  }
 }
 
 /**
@@ -32,6 +32,7 @@
 #include "indirectLess.h"
 #include "loader.h"
 #include "referenceCount.h"
+#include "workerPool.h"
 
 class Pipeline;
 class DisplayRegion;
@@ -150,6 +151,8 @@ private:
   void cull_and_draw_together(GraphicsOutput *win, DisplayRegion *dr,
                               Thread *current_thread);
 
+  class ParallelCullJob;
+
   void cull_to_bins(Windows wlist, Thread *current_thread);
   void cull_to_bins(GraphicsOutput *win, GraphicsStateGuardian *gsg,
                     DisplayRegion *dr, SceneSetup *scene_setup,
@@ -365,6 +368,7 @@ private:
   static PStatCollector _cull_pcollector;
   static PStatCollector _cull_setup_pcollector;
   static PStatCollector _cull_sort_pcollector;
+  static PStatCollector _cull_parallel_pcollector;
   static PStatCollector _draw_pcollector;
   static PStatCollector _sync_pcollector;
   static PStatCollector _flip_pcollector;
@@ -407,6 +411,7 @@ private:
   static PStatCollector _test_inv_sphere_pcollector;
   static PStatCollector _volume_geom_pcollector;
   static PStatCollector _test_geom_pcollector;
+  static PStatCollector _collision_entries_pcollector;
 
   static PStatCollector _occlusion_untested_pcollector;
   static PStatCollector _occlusion_passed_pcollector;
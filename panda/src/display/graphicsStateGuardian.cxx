@@ -17,6 +17,7 @@
 
 #include "graphicsStateGuardian.h"
 #include "graphicsEngine.h"
+#include "lightMutexHolder.h"
 #include "config_display.h"
 #include "textureContext.h"
 #include "vertexBufferContext.h"
@@ -301,6 +302,7 @@ GraphicsStateGuardian::
   // Note that if uniquify-states is false, we can't iterate over all the
   // states, and some GSGs will linger.  Let's hope this isn't a problem.
   LightReMutexHolder holder(*RenderState::_states_lock);
+  LightMutexHolder mungers_holder(RenderState::_mungers_lock);
   size_t size = RenderState::_states->get_num_entries();
   for (size_t si = 0; si < size; ++si) {
     const RenderState *state = RenderState::_states->get_key(si);
@@ -754,38 +756,45 @@ PT(GeomMunger) GraphicsStateGuardian::
 get_geom_munger(const RenderState *state, Thread *current_thread) {
   RenderState::Mungers &mungers = state->_mungers;
 
-  if (!mungers.is_empty()) {
-    // Before we even look up the map, see if the _last_mi value points to
-    // this GSG.  This is likely because we tend to visit the same state
-    // multiple times during a frame.  Also, this might well be the only GSG
-    // in the world anyway.
-    int mi = state->_last_mi;
-    if (mi >= 0 && (size_t)mi < mungers.get_num_entries() && mungers.get_key(mi) == _id) {
-      PT(GeomMunger) munger = mungers.get_data(mi);
-      if (munger->is_registered()) {
-        return munger;
+  // A munger that is no longer registered is removed from the map, but it is
+  // not released until after the lock has been released.
+  PT(GeomMunger) munger;
+  {
+    LightMutexHolder holder(RenderState::_mungers_lock);
+    if (!mungers.is_empty()) {
+      // Before we even look up the map, see if the _last_mi value points to
+      // this GSG.  This is likely because we tend to visit the same state
+      // multiple times during a frame.  Also, this might well be the only GSG
+      // in the world anyway.
+      int mi = state->_last_mi;
+      if (mi >= 0 && (size_t)mi < mungers.get_num_entries() && mungers.get_key(mi) == _id) {
+        munger = mungers.get_data(mi);
+        if (munger->is_registered()) {
+          return munger;
+        }
       }
-    }
 
-    // Nope, we have to look it up in the map.
-    mi = mungers.find(_id);
-    if (mi >= 0) {
-      PT(GeomMunger) munger = mungers.get_data(mi);
-      if (munger->is_registered()) {
-        state->_last_mi = mi;
-        return munger;
-      } else {
-        // This GeomMunger is no longer registered.  Remove it from the map.
-        mungers.remove_element(mi);
+      // Nope, we have to look it up in the map.
+      mi = mungers.find(_id);
+      if (mi >= 0) {
+        munger = mungers.get_data(mi);
+        if (munger->is_registered()) {
+          state->_last_mi = mi;
+          return munger;
+        } else {
+          // This GeomMunger is no longer registered.  Remove it from the map.
+          mungers.remove_element(mi);
+        }
       }
     }
   }
 
   // Nothing in the map; create a new entry.
-  PT(GeomMunger) munger = make_geom_munger(state, current_thread);
+  munger = make_geom_munger(state, current_thread);
   nassertr(munger != nullptr && munger->is_registered(), munger);
   nassertr(munger->is_of_type(StateMunger::get_class_type()), munger);
 
+  LightMutexHolder holder(RenderState::_mungers_lock);
   state->_last_mi = mungers.store(_id, munger);
   return munger;
 }
@@ -3423,6 +3432,9 @@ ensure_generated_shader(const RenderState *state) {
   state->get_attrib_def(shader_attrib);
 
   if (shader_attrib->auto_shader()) {
+    // When DisplayRegions are culled in parallel, this may be called from
+    // several threads at once.
+    MutexHolder holder(_shader_generator_lock);
     if (_shader_generator == nullptr) {
       if (!_supports_basic_shaders) {
         return;
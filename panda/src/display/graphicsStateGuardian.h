@@ -50,6 +50,8 @@
 #include "texGenAttrib.h"
 #include "textureAttrib.h"
 #include "shaderGenerator.h"
+#include "pmutex.h"
+#include "mutexHolder.h"
 
 class DrawableRegion;
 class GraphicsEngine;
@@ -647,6 +649,9 @@ protected:
   PN_stdfloat _gamma;
   Texture::QualityLevel _texture_quality_override;
 
+  // Protects _shader_generator and the _generated_shader cached on each
+  // RenderState, since shaders may be generated by several cull threads.
+  Mutex _shader_generator_lock;
   PT(ShaderGenerator) _shader_generator;
 
 #ifndef NDEBUG
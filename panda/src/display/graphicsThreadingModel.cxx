@@ -32,17 +32,29 @@ using std::string;
  * culled and drawn in the main thread; that is to say, a single-process
  * model.
  *
- * Finally, if the threading model begins with a "-" character, then cull and
- * draw are run simultaneously, in the same thread, with no binning or state
- * sorting.  It simplifies the cull process but it forces the scene to render
- * in scene graph order; state sorting and alpha sorting is lost.
+ * If the threading model begins with a "-" character, then cull and draw are
+ * run simultaneously, in the same thread, with no binning or state sorting.
+ * It simplifies the cull process but it forces the scene to render in scene
+ * graph order; state sorting and alpha sorting is lost.
+ *
+ * Finally, if the threading model begins with a "+" character, as in
+ * "+cull/draw", then the DisplayRegions of each window are culled in
+ * parallel by the threads of the global WorkerPool (see worker-pool-threads),
+ * rather than one after another.  The cull thread waits for all of them to
+ * finish before handing the results to draw.  This is useful when there are
+ * many cameras, such as for the faces of a cube map or for shadow cascades.
  */
 GraphicsThreadingModel::
 GraphicsThreadingModel(const string &model) {
   _cull_sorting = true;
+  _parallel_cull = false;
   size_t start = 0;
-  if (!model.empty() && model[0] == '-') {
+  if (!model.empty() && model[0] == '+') {
     start = 1;
+    _parallel_cull = true;
+  }
+  if (model.size() > start && model[start] == '-') {
+    ++start;
     _cull_sorting = false;
   }
 
@@ -63,10 +75,11 @@ GraphicsThreadingModel(const string &model) {
  */
 string GraphicsThreadingModel::
 get_model() const {
+  string prefix = get_parallel_cull() ? "+" : "";
   if (get_cull_sorting()) {
-    return get_cull_name() + "/" + get_draw_name();
+    return prefix + get_cull_name() + "/" + get_draw_name();
   } else {
-    return string("-") + get_cull_name();
+    return prefix + "-" + get_cull_name();
   }
 }
 
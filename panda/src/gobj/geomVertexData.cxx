@@ -35,6 +35,8 @@ PStatCollector GeomVertexData::_convert_pcollector("*:Munge:Convert");
 PStatCollector GeomVertexData::_scale_color_pcollector("*:Munge:Scale color");
 PStatCollector GeomVertexData::_set_color_pcollector("*:Munge:Set color");
 PStatCollector GeomVertexData::_animation_pcollector("*:Animation");
+PStatCollector GeomVertexData::_skinned_vertices_pcollector("Skinned vertices");
+AtomicAdjust::Integer GeomVertexData::_num_skinned_vertices = 0;
 
 
 /**
@@ -1444,6 +1446,134 @@ uint8_rgba_to_packed_argb(unsigned char *to, int to_stride,
   }
 }
 
+/**
+ * Computes the matrix by which the vectors in a column should be transformed,
+ * when the points are transformed by the indicated matrix.  Returns true if
+ * the transformed vectors must also be normalized.
+ */
+static bool
+get_vector_xform(const LMatrix4 &mat, bool is_normal, LMatrix4 &xform) {
+  if (!is_normal) {
+    xform = mat;
+    return false;
+  }
+
+  // This is to preserve perpendicularity to the surface.
+  LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
+                     mat.get_row3(1).length_squared(),
+                     mat.get_row3(2).length_squared());
+  if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
+      IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
+    // There is a uniform scale.
+    LVecBase3 scale, shear, hpr;
+    if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
+      // No scale to worry about.
+      xform = mat;
+    } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
+      // Make a new matrix with scale/translate taken out of the equation.
+      compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
+    } else {
+      return true;
+    }
+    return false;
+  }
+
+  // There is a non-uniform scale, so we need to do all this to preserve
+  // orthogonality to the surface.
+  xform.invert_from(mat);
+  xform.transpose_in_place();
+  return true;
+}
+
+/**
+ * Transforms the 3-component vectors in a table, each by the matrix of the
+ * blend whose index is stored for the same row in blendt, which has been
+ * filled in by get_blend_indices().  The translation
+ * component of the matrices is only applied if is_point is true.  If
+ * normalize is true, the vectors whose blend has a nonzero entry in
+ * renormalize are also normalized.
+ *
+ * This produces the same results as transforming each run of vertices that
+ * shares a blend with table_xform_point3f() and friends, but it doesn't need
+ * the vertices to be sorted by blend, which they rarely are.
+ */
+template<bool is_point, bool normalize>
+static void
+table_blend_xform3f(unsigned char *datat, size_t num_rows, size_t stride,
+                    const unsigned short *blendt, const LMatrix4f *mats,
+                    const unsigned char *renormalize) {
+  size_t i = 0;
+
+#ifdef LINMATH_SSE2
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 threshold = _mm_set1_ps(NEARLY_ZERO(float) * NEARLY_ZERO(float));
+  const __m128 neg_threshold = _mm_sub_ps(zero, threshold);
+
+  for (; i + 4 <= num_rows; i += 4) {
+    float *p[4];
+    __m128 r[4];
+    for (int k = 0; k < 4; ++k) {
+      p[k] = (float *)(datat + (i + k) * stride);
+      const float *m = mats[blendt[i + k]].get_data();
+      __m128 v = lsimd_load3(p[k]);
+      __m128 rk = _mm_add_ps(_mm_mul_ps(lsimd_splat(v, 0), _mm_loadu_ps(m)),
+                             _mm_mul_ps(lsimd_splat(v, 1), _mm_loadu_ps(m + 4)));
+      rk = _mm_add_ps(rk, _mm_mul_ps(lsimd_splat(v, 2), _mm_loadu_ps(m + 8)));
+      if (is_point) {
+        rk = _mm_add_ps(rk, _mm_loadu_ps(m + 12));
+      }
+      r[k] = rk;
+    }
+
+    if (normalize) {
+      // Normalize the four vectors together, as in sse2_table_xform3f(), but
+      // leave alone the ones whose blend doesn't call for it.
+      __m128 rx = r[0], ry = r[1], rz = r[2], rw = r[3];
+      _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+      __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz));
+      __m128 recip = _mm_div_ps(one, _mm_sqrt_ps(l2));
+      __m128 d = _mm_sub_ps(l2, one);
+      __m128 is_unit = _mm_and_ps(_mm_cmplt_ps(d, threshold), _mm_cmpgt_ps(d, neg_threshold));
+      __m128 is_zero = _mm_cmpeq_ps(l2, zero);
+      __m128 scale = _mm_or_ps(_mm_and_ps(is_unit, one),
+                               _mm_andnot_ps(_mm_or_ps(is_unit, is_zero), recip));
+      __m128 mask = _mm_castsi128_ps(_mm_set_epi32(-(int)(renormalize[blendt[i + 3]] != 0),
+                                                   -(int)(renormalize[blendt[i + 2]] != 0),
+                                                   -(int)(renormalize[blendt[i + 1]] != 0),
+                                                   -(int)(renormalize[blendt[i]] != 0)));
+      scale = _mm_or_ps(_mm_and_ps(mask, scale), _mm_andnot_ps(mask, one));
+      rx = _mm_mul_ps(rx, scale);
+      ry = _mm_mul_ps(ry, scale);
+      rz = _mm_mul_ps(rz, scale);
+      rw = zero;
+      _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+      r[0] = rx;
+      r[1] = ry;
+      r[2] = rz;
+      r[3] = rw;
+    }
+
+    for (int k = 0; k < 4; ++k) {
+      lsimd_store3(p[k], r[k]);
+    }
+  }
+#endif  // LINMATH_SSE2
+
+  for (; i < num_rows; ++i) {
+    unsigned short bi = blendt[i];
+    LVecBase3f &vertex = *(LVecBase3f *)(datat + i * stride);
+    if (is_point) {
+      vertex = mats[bi].xform_point(vertex);
+    } else {
+      vertex = mats[bi].xform_vec(vertex);
+    }
+    if (normalize && renormalize[bi]) {
+      vertex.normalize();
+    }
+  }
+}
+
 /**
  * Recomputes the results of computing the vertex animation on the CPU, and
  * applies them to the existing animated_vertices object.
@@ -1578,6 +1708,9 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
 
     const SparseArray &rows = tb_table->get_rows();
     int num_subranges = rows.get_num_subranges();
+#ifdef DO_PSTATS
+    AtomicAdjust::add(_num_skinned_vertices, rows.get_num_on_bits());
+#endif
 
     int blend_array_index = orig_format->get_array_with(InternalName::get_transform_blend());
     if (blend_array_index < 0) {
@@ -1589,6 +1722,99 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
 
     CPT(GeomVertexArrayFormat) blend_array_format = orig_format->get_array(blend_array_index);
 
+    // The float32 3-component columns, by far the most common kind, are
+    // transformed one vertex at a time, each by the matrix of its own blend,
+    // since the vertices are rarely sorted by blend.  The other columns are
+    // transformed a run of vertices at a time, below.
+    size_t num_points = new_format->get_num_points();
+    size_t num_vectors = new_format->get_num_vectors();
+    pvector<bool> points_done(num_points, false);
+    pvector<bool> vectors_done(num_vectors, false);
+
+    pvector<unsigned short> blend_indices;
+    if (get_blend_indices(cdata, blend_array_index, tb_table->get_num_blends(),
+                          rows, blend_indices, current_thread)) {
+      size_t num_blends = tb_table->get_num_blends();
+      pvector<LMatrix4f> mats;
+
+      for (size_t ci = 0; ci < num_points; ++ci) {
+        GeomVertexRewriter data(new_data, new_format->get_point(ci));
+        const GeomVertexColumn *data_column = data.get_column();
+        if (data_column->get_num_values() != 3 ||
+            data_column->get_numeric_type() != NT_float32) {
+          continue;
+        }
+        if (mats.empty()) {
+          mats.resize(num_blends);
+          for (size_t bi = 0; bi < num_blends; ++bi) {
+            LMatrix4 mat;
+            tb_table->get_blend(bi).get_blend(mat, current_thread);
+            mats[bi] = LCAST(float, mat);
+          }
+        }
+        size_t stride = data.get_stride();
+        unsigned char *datat = data.get_array_handle()->get_write_pointer();
+        datat += data_column->get_start();
+        for (int i = 0; i < num_subranges; ++i) {
+          int begin = rows.get_subrange_begin(i);
+          int end = rows.get_subrange_end(i);
+          table_blend_xform3f<true, false>(datat + begin * stride, end - begin, stride,
+                                           &blend_indices[begin], &mats[0], nullptr);
+        }
+        points_done[ci] = true;
+      }
+
+      // The vectors other than normals are transformed by the same matrices,
+      // just without the translation.  The normals need matrices of their
+      // own.
+      pvector<LMatrix4f> normal_mats;
+      pvector<unsigned char> renormalize;
+      bool any_renormalize = false;
+
+      for (size_t ci = 0; ci < num_vectors; ++ci) {
+        GeomVertexRewriter data(new_data, new_format->get_vector(ci));
+        const GeomVertexColumn *data_column = data.get_column();
+        if (data_column->get_num_values() != 3 ||
+            data_column->get_numeric_type() != NT_float32) {
+          continue;
+        }
+        bool is_normal = (data_column->get_contents() == C_normal);
+        pvector<LMatrix4f> &vmats = is_normal ? normal_mats : mats;
+        if (vmats.empty()) {
+          vmats.resize(num_blends);
+          if (is_normal) {
+            renormalize.resize(num_blends);
+          }
+          for (size_t bi = 0; bi < num_blends; ++bi) {
+            LMatrix4 mat, xform;
+            tb_table->get_blend(bi).get_blend(mat, current_thread);
+            if (is_normal) {
+              renormalize[bi] = get_vector_xform(mat, true, xform);
+              any_renormalize = any_renormalize || renormalize[bi];
+            } else {
+              xform = mat;
+            }
+            vmats[bi] = LCAST(float, xform);
+          }
+        }
+        size_t stride = data.get_stride();
+        unsigned char *datat = data.get_array_handle()->get_write_pointer();
+        datat += data_column->get_start();
+        for (int i = 0; i < num_subranges; ++i) {
+          int begin = rows.get_subrange_begin(i);
+          int end = rows.get_subrange_end(i);
+          if (is_normal && any_renormalize) {
+            table_blend_xform3f<false, true>(datat + begin * stride, end - begin, stride,
+                                             &blend_indices[begin], &vmats[0], &renormalize[0]);
+          } else {
+            table_blend_xform3f<false, false>(datat + begin * stride, end - begin, stride,
+                                              &blend_indices[begin], &vmats[0], nullptr);
+          }
+        }
+        vectors_done[ci] = true;
+      }
+    }
+
     if (blend_array_format->get_stride() == 2 &&
         blend_array_format->get_column(0)->get_component_bytes() == 2) {
       // The blend indices are a table of ushorts.  Optimize this common case.
@@ -1597,7 +1823,10 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
       const unsigned short *blendt = (const unsigned short *)blend_array_handle->get_read_pointer(true);
 
       size_t ci;
-      for (ci = 0; ci < new_format->get_num_points(); ci++) {
+      for (ci = 0; ci < num_points; ci++) {
+        if (points_done[ci]) {
+          continue;
+        }
         GeomVertexRewriter data(new_data, new_format->get_point(ci));
 
         for (int i = 0; i < num_subranges; ++i) {
@@ -1637,7 +1866,10 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
         }
       }
 
-      for (ci = 0; ci < new_format->get_num_vectors(); ci++) {
+      for (ci = 0; ci < num_vectors; ci++) {
+        if (vectors_done[ci]) {
+          continue;
+        }
         GeomVertexRewriter data(new_data, new_format->get_vector(ci));
 
         for (int i = 0; i < num_subranges; ++i) {
@@ -1684,7 +1916,10 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
       nassertv(blendi.has_column());
 
       size_t ci;
-      for (ci = 0; ci < new_format->get_num_points(); ci++) {
+      for (ci = 0; ci < num_points; ci++) {
+        if (points_done[ci]) {
+          continue;
+        }
         GeomVertexRewriter data(new_data, new_format->get_point(ci));
 
         for (int i = 0; i < num_subranges; ++i) {
@@ -1725,7 +1960,10 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
         }
       }
 
-      for (ci = 0; ci < new_format->get_num_vectors(); ci++) {
+      for (ci = 0; ci < num_vectors; ci++) {
+        if (vectors_done[ci]) {
+          continue;
+        }
         GeomVertexRewriter data(new_data, new_format->get_vector(ci));
 
         for (int i = 0; i < num_subranges; ++i) {
@@ -1770,6 +2008,69 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
 }
 
 
+/**
+ * Fills blend_indices with the blend index of each of the indicated rows, as
+ * stored in the transform_blend column, which is in the indicated array.  The
+ * other entries are left undefined.  Returns true on success, or false if the
+ * column isn't stored as one unsigned integer per row, or if any of the
+ * indices is not less than num_blends.
+ */
+bool GeomVertexData::
+get_blend_indices(const CData *cdata, int blend_array_index, size_t num_blends,
+                  const SparseArray &rows, pvector<unsigned short> &blend_indices,
+                  Thread *current_thread) const {
+  if (num_blends == 0 || num_blends > 0x10000 || rows.is_inverse()) {
+    return false;
+  }
+
+  const GeomVertexArrayFormat *array_format = cdata->_format->get_array(blend_array_index);
+  const GeomVertexColumn *column = array_format->get_column(InternalName::get_transform_blend());
+  if (column == nullptr || column->get_num_components() != 1) {
+    return false;
+  }
+  NumericType numeric_type = column->get_numeric_type();
+  if (numeric_type != NT_uint8 && numeric_type != NT_uint16 &&
+      numeric_type != NT_uint32) {
+    return false;
+  }
+
+  CPT(GeomVertexArrayDataHandle) handle =
+    new GeomVertexArrayDataHandle(cdata->_arrays[blend_array_index].get_read_pointer(current_thread), current_thread);
+  const unsigned char *blendt = handle->get_read_pointer(true) + column->get_start();
+  size_t stride = array_format->get_stride();
+  int num_rows = handle->get_num_rows();
+
+  blend_indices.resize(num_rows);
+  int num_subranges = rows.get_num_subranges();
+  for (int i = 0; i < num_subranges; ++i) {
+    int begin = rows.get_subrange_begin(i);
+    int end = rows.get_subrange_end(i);
+    if (begin < 0 || end > num_rows) {
+      return false;
+    }
+    for (int j = begin; j < end; ++j) {
+      const unsigned char *p = blendt + j * stride;
+      size_t bi;
+      switch (numeric_type) {
+      case NT_uint8:
+        bi = *p;
+        break;
+      case NT_uint16:
+        bi = *(const uint16_t *)p;
+        break;
+      default:
+        bi = *(const uint32_t *)p;
+        break;
+      }
+      if (bi >= num_blends) {
+        return false;
+      }
+      blend_indices[j] = (unsigned short)bi;
+    }
+  }
+  return true;
+}
+
 /**
  * Transforms a range of vertices for one particular column, as a point.
  */
@@ -1827,35 +2128,7 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   int num_values = data_column->get_num_values();
 
   LMatrix4 xform;
-  bool normalize = false;
-  if (data_column->get_contents() == C_normal) {
-    // This is to preserve perpendicularity to the surface.
-    LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
-                       mat.get_row3(1).length_squared(),
-                       mat.get_row3(2).length_squared());
-    if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
-        IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
-      // There is a uniform scale.
-      LVecBase3 scale, shear, hpr;
-      if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
-        // No scale to worry about.
-        xform = mat;
-      } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
-        // Make a new matrix with scale/translate taken out of the equation.
-        compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
-      } else {
-        normalize = true;
-      }
-    } else {
-      // There is a non-uniform scale, so we need to do all this to preserve
-      // orthogonality to the surface.
-      xform.invert_from(mat);
-      xform.transpose_in_place();
-      normalize = true;
-    }
-  } else {
-    xform = mat;
-  }
+  bool normalize = get_vector_xform(mat, data_column->get_contents() == C_normal, xform);
 
   if ((num_values == 3 || num_values == 4) &&
       data_column->get_numeric_type() == NT_float32) {
@@ -1897,6 +2170,79 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   }
 }
 
+#ifdef LINMATH_SSE2
+/**
+ * Transforms the 3-component vectors in a table by the indicated matrix, four
+ * rows at a time, and returns the number of rows that were transformed; the
+ * remaining rows are left for the caller.  The translation component of the
+ * matrix is only applied if is_point is true.  If normalize is true, the
+ * results are normalized the same way as by LVecBase3f::normalize().
+ */
+template<bool is_point, bool normalize>
+static size_t
+sse2_table_xform3f(unsigned char *datat, size_t num_rows, size_t stride,
+                   const LMatrix4f &matf) {
+  __m128 m00 = _mm_set1_ps(matf(0, 0)), m01 = _mm_set1_ps(matf(0, 1)), m02 = _mm_set1_ps(matf(0, 2));
+  __m128 m10 = _mm_set1_ps(matf(1, 0)), m11 = _mm_set1_ps(matf(1, 1)), m12 = _mm_set1_ps(matf(1, 2));
+  __m128 m20 = _mm_set1_ps(matf(2, 0)), m21 = _mm_set1_ps(matf(2, 1)), m22 = _mm_set1_ps(matf(2, 2));
+  __m128 m30 = _mm_set1_ps(matf(3, 0)), m31 = _mm_set1_ps(matf(3, 1)), m32 = _mm_set1_ps(matf(3, 2));
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 threshold = _mm_set1_ps(NEARLY_ZERO(float) * NEARLY_ZERO(float));
+  const __m128 neg_threshold = _mm_sub_ps(zero, threshold);
+
+  size_t i = 0;
+  for (; i + 4 <= num_rows; i += 4) {
+    float *p0 = (float *)(datat + i * stride);
+    float *p1 = (float *)((unsigned char *)p0 + stride);
+    float *p2 = (float *)((unsigned char *)p1 + stride);
+    float *p3 = (float *)((unsigned char *)p2 + stride);
+
+    // Each row is loaded separately, so that we never touch the memory
+    // beyond the column, and then rearranged so that x, y and z each hold
+    // one component of all four rows.
+    __m128 x = lsimd_load3(p0);
+    __m128 y = lsimd_load3(p1);
+    __m128 z = lsimd_load3(p2);
+    __m128 w = lsimd_load3(p3);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+
+    __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20));
+    __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21));
+    __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22));
+    if (is_point) {
+      rx = _mm_add_ps(rx, m30);
+      ry = _mm_add_ps(ry, m31);
+      rz = _mm_add_ps(rz, m32);
+    }
+
+    if (normalize) {
+      __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz));
+      __m128 recip = _mm_div_ps(one, _mm_sqrt_ps(l2));
+
+      // Zero-length vectors become zero, and vectors that are already close
+      // enough to unit length are left alone.
+      __m128 d = _mm_sub_ps(l2, one);
+      __m128 is_unit = _mm_and_ps(_mm_cmplt_ps(d, threshold), _mm_cmpgt_ps(d, neg_threshold));
+      __m128 is_zero = _mm_cmpeq_ps(l2, zero);
+      __m128 scale = _mm_or_ps(_mm_and_ps(is_unit, one),
+                               _mm_andnot_ps(_mm_or_ps(is_unit, is_zero), recip));
+      rx = _mm_mul_ps(rx, scale);
+      ry = _mm_mul_ps(ry, scale);
+      rz = _mm_mul_ps(rz, scale);
+    }
+
+    w = zero;
+    _MM_TRANSPOSE4_PS(rx, ry, rz, w);
+    lsimd_store3(p0, rx);
+    lsimd_store3(p1, ry);
+    lsimd_store3(p2, rz);
+    lsimd_store3(p3, w);
+  }
+  return i;
+}
+#endif  // LINMATH_SSE2
+
 /**
  * Transforms each of the LPoint3f objects in the indicated table by the
  * indicated matrix.
@@ -1904,9 +2250,20 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
 void GeomVertexData::
 table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
                     const LMatrix4f &matf) {
+  if (stride == sizeof(LPoint3f)) {
+    // A table of nothing but points can be transformed as an array.
+    LPoint3f *table = (LPoint3f *)datat;
+    matf.xform_point_array(table, table, num_rows);
+    return;
+  }
+
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component point.
-  for (size_t i = 0; i < num_rows; ++i) {
+  size_t i = 0;
+#ifdef LINMATH_SSE2
+  i = sse2_table_xform3f<true, false>(datat, num_rows, stride, matf);
+#endif
+  for (; i < num_rows; ++i) {
     LPoint3f &vertex = *(LPoint3f *)(&datat[i * stride]);
     vertex *= matf;
   }
@@ -1921,7 +2278,11 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
-  for (size_t i = 0; i < num_rows; ++i) {
+  size_t i = 0;
+#ifdef LINMATH_SSE2
+  i = sse2_table_xform3f<false, true>(datat, num_rows, stride, matf);
+#endif
+  for (; i < num_rows; ++i) {
     LNormalf &vertex = *(LNormalf *)(&datat[i * stride]);
     vertex *= matf;
     vertex.normalize();
@@ -1935,9 +2296,19 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
+  if (stride == sizeof(LVector3f)) {
+    LVector3f *table = (LVector3f *)datat;
+    matf.xform_vec_array(table, table, num_rows);
+    return;
+  }
+
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
-  for (size_t i = 0; i < num_rows; ++i) {
+  size_t i = 0;
+#ifdef LINMATH_SSE2
+  i = sse2_table_xform3f<false, false>(datat, num_rows, stride, matf);
+#endif
+  for (; i < num_rows; ++i) {
     LVector3f &vertex = *(LVector3f *)(&datat[i * stride]);
     vertex *= matf;
   }
@@ -1964,6 +2335,28 @@ table_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
   }
 #endif  // HAVE_EIGEN
 
+  if (stride == sizeof(LVecBase4f)) {
+    LVecBase4f *table = (LVecBase4f *)datat;
+    matf.xform_array(table, table, num_rows);
+    return;
+  }
+
+#ifdef LINMATH_SSE2
+  __m128 row0 = _mm_loadu_ps(matf.get_data());
+  __m128 row1 = _mm_loadu_ps(matf.get_data() + 1 * 4);
+  __m128 row2 = _mm_loadu_ps(matf.get_data() + 2 * 4);
+  __m128 row3 = _mm_loadu_ps(matf.get_data() + 3 * 4);
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *data = (float *)(datat + i * stride);
+    __m128 v = _mm_loadu_ps(data);
+    __m128 r = _mm_mul_ps(lsimd_splat(v, 0), row0);
+    r = _mm_add_ps(r, _mm_mul_ps(lsimd_splat(v, 1), row1));
+    r = _mm_add_ps(r, _mm_mul_ps(lsimd_splat(v, 2), row2));
+    r = _mm_add_ps(r, _mm_mul_ps(lsimd_splat(v, 3), row3));
+    _mm_storeu_ps(data, r);
+  }
+
+#else
   // If the table is properly aligned (or we don't require alignment), we can
   // directly use the high-level LVecBase4f object, which will do the right
   // thing.
@@ -1971,6 +2364,7 @@ table_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
     LVecBase4f &vertex = *(LVecBase4f *)(&datat[i * stride]);
     vertex *= matf;
   }
+#endif  // LINMATH_SSE2
 }
 
 /**
@@ -38,6 +38,7 @@
 #include "pmap.h"
 #include "pvector.h"
 #include "deletedChain.h"
+#include "atomicAdjust.h"
 
 class FactoryParams;
 class GeomVertexColumn;
@@ -184,6 +185,8 @@ public:
   static INLINE float unpack_ufloat_b(uint32_t data);
   static INLINE float unpack_ufloat_c(uint32_t data);
 
+  INLINE static void flush_level();
+
 private:
   static void do_set_color(GeomVertexData *vdata, const LColor &color);
 
@@ -335,6 +338,10 @@ private:
 
 private:
   void update_animated_vertices(CData *cdata, Thread *current_thread);
+  bool get_blend_indices(const CData *cdata, int blend_array_index,
+                         size_t num_blends, const SparseArray &rows,
+                         pvector<unsigned short> &blend_indices,
+                         Thread *current_thread) const;
   void do_transform_point_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
@@ -358,6 +365,14 @@ private:
   PStatCollector _morphs_pcollector;
   PStatCollector _blends_pcollector;
 
+  // The number of vertices skinned since the last flush_level().  This is
+  // counted atomically, since several threads may be animating vertices at
+  // once.
+  static AtomicAdjust::Integer _num_skinned_vertices;
+
+public:
+  static PStatCollector _skinned_vertices_pcollector;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
@@ -0,0 +1,905 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file meshSimplifier.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "meshSimplifier.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "geomVertexReader.h"
+#include "lodNode.h"
+#include "pandaNode.h"
+#include "vector_int.h"
+
+#include <algorithm>
+#include <functional>
+
+// The weight of the planes that hold open edges and seams in place, relative
+// to the planes of the triangles themselves.
+static const double boundary_weight = 100.0;
+
+/**
+ * Returns the number of triangles in the Geom.
+ */
+static int
+count_triangles(const Geom *geom) {
+  int num_triangles = 0;
+  for (size_t i = 0; i < geom->get_num_primitives(); ++i) {
+    num_triangles += geom->get_primitive(i)->get_num_faces();
+  }
+  return num_triangles;
+}
+
+/**
+ * The working copy of the triangles of one Geom while it is being simplified.
+ * Rows of the vertex data that have exactly the same position are welded
+ * into a single vertex, so that the triangles on either side of a texture
+ * seam or a normal crease are still considered connected.
+ */
+class MeshSimplifier::Mesh {
+public:
+  Mesh(const GeomVertexData *vdata, bool lock_boundaries,
+       Thread *current_thread);
+
+  bool add_primitive(const GeomPrimitive *prim, Thread *current_thread);
+  void setup();
+  void simplify(int target_triangles, double max_error);
+  void get_corners(vector_int &corners) const;
+
+  int _num_triangles;
+  GeomEnums::ShadeModel _shade_model;
+
+private:
+  /**
+   * A symmetric 4x4 matrix that measures the sum of the squared distances
+   * from a point to a set of planes, each weighted by the area of the
+   * triangle it came from.
+   */
+  class Quadric {
+  public:
+    Quadric() : _weight(0.0) {
+      for (int i = 0; i < 10; ++i) {
+        _m[i] = 0.0;
+      }
+    }
+
+    // Adds the plane with the indicated unit normal and offset, such that
+    // dot(normal, p) + d == 0 for points on the plane.
+    void add_plane(const LVector3d &normal, double d, double weight) {
+      double a = normal[0];
+      double b = normal[1];
+      double c = normal[2];
+      _m[0] += weight * a * a;
+      _m[1] += weight * a * b;
+      _m[2] += weight * a * c;
+      _m[3] += weight * a * d;
+      _m[4] += weight * b * b;
+      _m[5] += weight * b * c;
+      _m[6] += weight * b * d;
+      _m[7] += weight * c * c;
+      _m[8] += weight * c * d;
+      _m[9] += weight * d * d;
+    }
+
+    void add(const Quadric &other) {
+      for (int i = 0; i < 10; ++i) {
+        _m[i] += other._m[i];
+      }
+      _weight += other._weight;
+    }
+
+    // Returns the weighted sum of the squared distances from the point to all
+    // of the planes.
+    double evaluate(const LPoint3d &point) const {
+      double x = point[0];
+      double y = point[1];
+      double z = point[2];
+      return x * x * _m[0] + 2.0 * x * y * _m[1] + 2.0 * x * z * _m[2] +
+             2.0 * x * _m[3] + y * y * _m[4] + 2.0 * y * z * _m[5] +
+             2.0 * y * _m[6] + z * z * _m[7] + 2.0 * z * _m[8] + _m[9];
+    }
+
+    double _m[10];
+    double _weight;
+  };
+
+  /**
+   * A candidate edge collapse, which moves vertex _from onto vertex _to.  It
+   * is only valid as long as the version numbers of both vertices are
+   * unchanged.
+   */
+  class Collapse {
+  public:
+    bool operator > (const Collapse &other) const {
+      return _cost > other._cost;
+    }
+
+    double _cost;
+    int _from;
+    int _to;
+    int _from_version;
+    int _to_version;
+  };
+
+  INLINE int get_vertex(int triangle, int corner) const;
+  INLINE bool is_locked(int v) const;
+  void add_boundary_plane(int a, int b, int triangle);
+  void add_boundary_edge(int a, int b);
+  bool is_boundary_edge(int a, int b) const;
+  void push_collapse(int from, int to);
+  void push_neighbors(int v);
+  bool try_collapse(int from, int to);
+  void get_neighbors(int v, vector_int &neighbors) const;
+
+  bool _lock_boundaries;
+
+  pvector<LPoint3d> _positions;
+  vector_int _row_vertex;
+
+  // Three rows of the vertex data for each triangle.
+  vector_int _corners;
+  pvector<bool> _triangle_alive;
+
+  pvector<vector_int> _vertex_triangles;
+  pvector<Quadric> _quadrics;
+  vector_int _versions;
+  pvector<bool> _vertex_alive;
+  pvector<bool> _boundary;
+
+  // For each vertex, the other ends of its open, seam or non-manifold edges.
+  pvector<vector_int> _boundary_edges;
+
+  pvector<Collapse> _heap;
+
+  // Scratch space for try_collapse().
+  pvector<std::pair<int, int> > _row_map;
+  vector_int _from_neighbors;
+  vector_int _to_neighbors;
+  vector_int _opposite;
+};
+
+/**
+ * Reads the vertex positions and welds together the rows that share one.
+ */
+MeshSimplifier::Mesh::
+Mesh(const GeomVertexData *vdata, bool lock_boundaries,
+     Thread *current_thread) :
+  _num_triangles(0),
+  _shade_model(GeomEnums::SM_uniform),
+  _lock_boundaries(lock_boundaries)
+{
+  int num_rows = vdata->get_num_rows();
+  pvector<LPoint3d> row_positions;
+  row_positions.reserve(num_rows);
+  GeomVertexReader vertex(vdata, InternalName::get_vertex(), current_thread);
+  for (int i = 0; i < num_rows; ++i) {
+    row_positions.push_back(vertex.get_data3d());
+  }
+
+  // Sort the rows by position, so that identical positions are adjacent.
+  vector_int order(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    const LPoint3d &pa = row_positions[a];
+    const LPoint3d &pb = row_positions[b];
+    if (pa[0] != pb[0]) {
+      return pa[0] < pb[0];
+    }
+    if (pa[1] != pb[1]) {
+      return pa[1] < pb[1];
+    }
+    if (pa[2] != pb[2]) {
+      return pa[2] < pb[2];
+    }
+    return a < b;
+  });
+
+  _row_vertex.resize(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    const LPoint3d &point = row_positions[order[i]];
+    if (_positions.empty() || point[0] != _positions.back()[0] ||
+        point[1] != _positions.back()[1] || point[2] != _positions.back()[2]) {
+      _positions.push_back(point);
+    }
+    _row_vertex[order[i]] = (int)_positions.size() - 1;
+  }
+}
+
+/**
+ * Adds the triangles of the indicated primitive, which must be made of
+ * polygons.  Triangles that have two corners at the same position are
+ * dropped.  Returns false if the primitive could not be decomposed into
+ * triangles.
+ */
+bool MeshSimplifier::Mesh::
+add_primitive(const GeomPrimitive *prim, Thread *current_thread) {
+  CPT(GeomPrimitive) triangles = prim->decompose();
+  if (!triangles->is_of_type(GeomTriangles::get_class_type())) {
+    return false;
+  }
+  if (_corners.empty()) {
+    _shade_model = triangles->get_shade_model();
+  }
+
+  GeomPrimitivePipelineReader reader(triangles, current_thread);
+  int num_vertices = reader.get_num_vertices();
+  int num_rows = (int)_row_vertex.size();
+  for (int i = 0; i + 2 < num_vertices; i += 3) {
+    int r0 = reader.get_vertex(i);
+    int r1 = reader.get_vertex(i + 1);
+    int r2 = reader.get_vertex(i + 2);
+    nassertr(r0 >= 0 && r0 < num_rows && r1 >= 0 && r1 < num_rows &&
+             r2 >= 0 && r2 < num_rows, false);
+    int v0 = _row_vertex[r0];
+    int v1 = _row_vertex[r1];
+    int v2 = _row_vertex[r2];
+    if (v0 != v1 && v1 != v2 && v2 != v0) {
+      _corners.push_back(r0);
+      _corners.push_back(r1);
+      _corners.push_back(r2);
+    }
+  }
+  return true;
+}
+
+/**
+ * Called after all of the triangles have been added to compute the quadrics
+ * and the initial set of candidate collapses.
+ */
+void MeshSimplifier::Mesh::
+setup() {
+  _num_triangles = (int)_corners.size() / 3;
+  _triangle_alive.assign(_num_triangles, true);
+
+  size_t num_vertices = _positions.size();
+  _vertex_triangles.resize(num_vertices);
+  _quadrics.resize(num_vertices);
+  _versions.assign(num_vertices, 0);
+  _vertex_alive.assign(num_vertices, true);
+  _boundary.assign(num_vertices, false);
+  _boundary_edges.resize(num_vertices);
+
+  for (int t = 0; t < _num_triangles; ++t) {
+    const LPoint3d &p0 = _positions[get_vertex(t, 0)];
+    const LPoint3d &p1 = _positions[get_vertex(t, 1)];
+    const LPoint3d &p2 = _positions[get_vertex(t, 2)];
+    LVector3d normal = (p1 - p0).cross(p2 - p0);
+    double length = normal.length();
+
+    for (int c = 0; c < 3; ++c) {
+      int v = get_vertex(t, c);
+      _vertex_triangles[v].push_back(t);
+      if (length > 0.0) {
+        double area = length * 0.5;
+        LVector3d unit = normal / length;
+        _quadrics[v].add_plane(unit, -unit.dot(p0), area);
+        _quadrics[v]._weight += area;
+      }
+    }
+  }
+
+  // Find the edges, as pairs of vertices, along with the rows that each
+  // triangle uses at either end.  An edge that has only one triangle is on an
+  // open boundary, and an edge whose triangles disagree on the rows is on a
+  // seam.
+  class Edge {
+  public:
+    bool operator < (const Edge &other) const {
+      if (_a != other._a) {
+        return _a < other._a;
+      }
+      return _b < other._b;
+    }
+
+    int _a, _b;
+    int _row_a, _row_b;
+    int _triangle;
+  };
+  pvector<Edge> edges;
+  edges.reserve(_num_triangles * 3);
+  for (int t = 0; t < _num_triangles; ++t) {
+    for (int c = 0; c < 3; ++c) {
+      int ra = _corners[t * 3 + c];
+      int rb = _corners[t * 3 + (c + 1) % 3];
+      Edge edge;
+      edge._a = _row_vertex[ra];
+      edge._b = _row_vertex[rb];
+      edge._row_a = ra;
+      edge._row_b = rb;
+      edge._triangle = t;
+      if (edge._a > edge._b) {
+        std::swap(edge._a, edge._b);
+        std::swap(edge._row_a, edge._row_b);
+      }
+      edges.push_back(edge);
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+
+  size_t begin = 0;
+  while (begin < edges.size()) {
+    const Edge &first = edges[begin];
+    size_t end = begin + 1;
+    bool seam = false;
+    while (end < edges.size() && edges[end]._a == first._a &&
+           edges[end]._b == first._b) {
+      if (edges[end]._row_a != first._row_a ||
+          edges[end]._row_b != first._row_b) {
+        seam = true;
+      }
+      ++end;
+    }
+
+    if (end - begin == 1 || end - begin > 2 || seam) {
+      // An open edge, a non-manifold edge or a seam.
+      for (size_t i = begin; i < end; ++i) {
+        add_boundary_plane(first._a, first._b, edges[i]._triangle);
+      }
+      add_boundary_edge(first._a, first._b);
+    }
+    begin = end;
+  }
+
+  begin = 0;
+  while (begin < edges.size()) {
+    const Edge &first = edges[begin];
+    push_collapse(first._a, first._b);
+    push_collapse(first._b, first._a);
+    do {
+      ++begin;
+    } while (begin < edges.size() && edges[begin]._a == first._a &&
+             edges[begin]._b == first._b);
+  }
+}
+
+/**
+ * Performs the cheapest collapses, one at a time, until there are no more
+ * than the indicated number of triangles left, or the next collapse would
+ * exceed the indicated error, if it is nonzero.
+ */
+void MeshSimplifier::Mesh::
+simplify(int target_triangles, double max_error) {
+  double max_cost = max_error * max_error;
+  while (_num_triangles > target_triangles && !_heap.empty()) {
+    std::pop_heap(_heap.begin(), _heap.end(), std::greater<Collapse>());
+    Collapse collapse = _heap.back();
+    _heap.pop_back();
+
+    if (!_vertex_alive[collapse._from] || !_vertex_alive[collapse._to] ||
+        _versions[collapse._from] != collapse._from_version ||
+        _versions[collapse._to] != collapse._to_version) {
+      // This candidate is out of date.
+      continue;
+    }
+    if (max_error > 0.0 && collapse._cost > max_cost) {
+      break;
+    }
+    if (try_collapse(collapse._from, collapse._to)) {
+      push_neighbors(collapse._to);
+    }
+  }
+}
+
+/**
+ * Fills the indicated vector with three rows for each of the remaining
+ * triangles, in their original order.
+ */
+void MeshSimplifier::Mesh::
+get_corners(vector_int &corners) const {
+  corners.clear();
+  corners.reserve(_num_triangles * 3);
+  for (size_t t = 0; t < _triangle_alive.size(); ++t) {
+    if (_triangle_alive[t]) {
+      corners.push_back(_corners[t * 3]);
+      corners.push_back(_corners[t * 3 + 1]);
+      corners.push_back(_corners[t * 3 + 2]);
+    }
+  }
+}
+
+/**
+ * Returns the welded vertex at the indicated corner of the triangle.
+ */
+INLINE int MeshSimplifier::Mesh::
+get_vertex(int triangle, int corner) const {
+  return _row_vertex[_corners[triangle * 3 + corner]];
+}
+
+/**
+ * Returns true if the indicated vertex may not be moved.
+ */
+INLINE bool MeshSimplifier::Mesh::
+is_locked(int v) const {
+  return _lock_boundaries && _boundary[v];
+}
+
+/**
+ * Adds a plane through the edge from a to b, perpendicular to the indicated
+ * triangle, to the quadrics of both vertices, so that moving them away from
+ * the line of the edge is expensive.
+ */
+void MeshSimplifier::Mesh::
+add_boundary_plane(int a, int b, int triangle) {
+  const LPoint3d &p0 = _positions[get_vertex(triangle, 0)];
+  const LPoint3d &p1 = _positions[get_vertex(triangle, 1)];
+  const LPoint3d &p2 = _positions[get_vertex(triangle, 2)];
+  LVector3d normal = (p1 - p0).cross(p2 - p0);
+  LVector3d edge = _positions[b] - _positions[a];
+  LVector3d plane = edge.cross(normal);
+  double length = plane.length();
+  if (length <= 0.0) {
+    return;
+  }
+  plane /= length;
+  double weight = boundary_weight * edge.length_squared();
+  double d = -plane.dot(_positions[a]);
+  _quadrics[a].add_plane(plane, d, weight);
+  _quadrics[b].add_plane(plane, d, weight);
+}
+
+/**
+ * Records that the edge between the two vertices is on a boundary.
+ */
+void MeshSimplifier::Mesh::
+add_boundary_edge(int a, int b) {
+  if (!is_boundary_edge(a, b)) {
+    _boundary_edges[a].push_back(b);
+    _boundary_edges[b].push_back(a);
+  }
+  _boundary[a] = true;
+  _boundary[b] = true;
+}
+
+/**
+ * Returns true if the edge between the two vertices is on a boundary.
+ */
+bool MeshSimplifier::Mesh::
+is_boundary_edge(int a, int b) const {
+  const vector_int &edges = _boundary_edges[a];
+  return std::find(edges.begin(), edges.end(), b) != edges.end();
+}
+
+/**
+ * Adds a candidate collapse of the indicated vertex onto the other one to
+ * the heap.
+ */
+void MeshSimplifier::Mesh::
+push_collapse(int from, int to) {
+  if (is_locked(from)) {
+    return;
+  }
+  Quadric quadric = _quadrics[from];
+  quadric.add(_quadrics[to]);
+  double cost = quadric.evaluate(_positions[to]);
+  if (quadric._weight > 0.0) {
+    cost /= quadric._weight;
+  }
+
+  Collapse collapse;
+  collapse._cost = std::max(cost, 0.0);
+  collapse._from = from;
+  collapse._to = to;
+  collapse._from_version = _versions[from];
+  collapse._to_version = _versions[to];
+  _heap.push_back(collapse);
+  std::push_heap(_heap.begin(), _heap.end(), std::greater<Collapse>());
+}
+
+/**
+ * Adds new candidate collapses for all of the edges around the indicated
+ * vertex, after its quadric has changed.
+ */
+void MeshSimplifier::Mesh::
+push_neighbors(int v) {
+  get_neighbors(v, _to_neighbors);
+  for (int w : _to_neighbors) {
+    push_collapse(v, w);
+    push_collapse(w, v);
+  }
+}
+
+/**
+ * Moves the vertex from onto the vertex to, if this can be done without
+ * tearing a seam, folding a triangle over or making the mesh non-manifold.
+ * Returns true if the collapse was made.
+ */
+bool MeshSimplifier::Mesh::
+try_collapse(int from, int to) {
+  // A vertex on a boundary may only slide along it.
+  if (_boundary[from] && !is_boundary_edge(from, to)) {
+    return false;
+  }
+
+  // Each row used at the from vertex must have a corresponding row at the to
+  // vertex, which we can learn from the triangles along the edge.
+  _row_map.clear();
+  _opposite.clear();
+  int num_edge_triangles = 0;
+  for (int t : _vertex_triangles[from]) {
+    if (!_triangle_alive[t]) {
+      continue;
+    }
+    int from_row = -1;
+    int to_row = -1;
+    int other = -1;
+    for (int c = 0; c < 3; ++c) {
+      int v = get_vertex(t, c);
+      if (v == from) {
+        from_row = _corners[t * 3 + c];
+      } else if (v == to) {
+        to_row = _corners[t * 3 + c];
+      } else {
+        other = v;
+      }
+    }
+    if (to_row == -1) {
+      continue;
+    }
+    ++num_edge_triangles;
+    _opposite.push_back(other);
+    bool found = false;
+    for (const std::pair<int, int> &mapping : _row_map) {
+      if (mapping.first == from_row) {
+        if (mapping.second != to_row) {
+          return false;
+        }
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      _row_map.push_back(std::pair<int, int>(from_row, to_row));
+    }
+  }
+  if (num_edge_triangles == 0) {
+    return false;
+  }
+
+  // The only vertices adjacent to both ends of the edge may be the ones
+  // opposite it, or the collapse would pinch the surface.
+  get_neighbors(from, _from_neighbors);
+  get_neighbors(to, _to_neighbors);
+  std::sort(_opposite.begin(), _opposite.end());
+  _opposite.erase(std::unique(_opposite.begin(), _opposite.end()), _opposite.end());
+  size_t num_common = 0;
+  vector_int::const_iterator fi = _from_neighbors.begin();
+  vector_int::const_iterator ti = _to_neighbors.begin();
+  while (fi != _from_neighbors.end() && ti != _to_neighbors.end()) {
+    if (*fi < *ti) {
+      ++fi;
+    } else if (*ti < *fi) {
+      ++ti;
+    } else {
+      ++num_common;
+      ++fi;
+      ++ti;
+    }
+  }
+  if (num_common != _opposite.size()) {
+    return false;
+  }
+
+  const LPoint3d &to_point = _positions[to];
+  for (int t : _vertex_triangles[from]) {
+    if (!_triangle_alive[t]) {
+      continue;
+    }
+    int from_corner = -1;
+    bool has_to = false;
+    for (int c = 0; c < 3; ++c) {
+      int v = get_vertex(t, c);
+      if (v == from) {
+        from_corner = c;
+      } else if (v == to) {
+        has_to = true;
+      }
+    }
+    if (has_to) {
+      continue;
+    }
+
+    // This triangle will survive, so its row at the from vertex must have a
+    // counterpart at the to vertex.
+    int from_row = _corners[t * 3 + from_corner];
+    bool found = false;
+    for (const std::pair<int, int> &mapping : _row_map) {
+      if (mapping.first == from_row) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+
+    // And it must not be turned over.
+    const LPoint3d &p0 = _positions[get_vertex(t, 0)];
+    const LPoint3d &p1 = _positions[get_vertex(t, 1)];
+    const LPoint3d &p2 = _positions[get_vertex(t, 2)];
+    LVector3d before = (p1 - p0).cross(p2 - p0);
+    LPoint3d q[3] = { p0, p1, p2 };
+    q[from_corner] = to_point;
+    LVector3d after = (q[1] - q[0]).cross(q[2] - q[0]);
+    if (before.dot(after) <= 0.25 * before.length() * after.length()) {
+      return false;
+    }
+  }
+
+  // Now make the collapse.
+  vector_int &to_triangles = _vertex_triangles[to];
+  for (int t : _vertex_triangles[from]) {
+    if (!_triangle_alive[t]) {
+      continue;
+    }
+    bool has_to = false;
+    for (int c = 0; c < 3; ++c) {
+      if (get_vertex(t, c) == to) {
+        has_to = true;
+      }
+    }
+    if (has_to) {
+      _triangle_alive[t] = false;
+      --_num_triangles;
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      int &row = _corners[t * 3 + c];
+      if (_row_vertex[row] == from) {
+        for (const std::pair<int, int> &mapping : _row_map) {
+          if (mapping.first == row) {
+            row = mapping.second;
+            break;
+          }
+        }
+      }
+    }
+    to_triangles.push_back(t);
+  }
+
+  to_triangles.erase(std::remove_if(to_triangles.begin(), to_triangles.end(),
+                                    [this](int t) {
+                                      return !_triangle_alive[t];
+                                    }),
+                     to_triangles.end());
+
+  // The boundary edges of the from vertex now belong to the to vertex.
+  for (int w : _boundary_edges[from]) {
+    vector_int &edges = _boundary_edges[w];
+    edges.erase(std::find(edges.begin(), edges.end(), from));
+    if (w != to) {
+      add_boundary_edge(to, w);
+    }
+  }
+  _boundary_edges[from].clear();
+
+  _quadrics[to].add(_quadrics[from]);
+  _vertex_alive[from] = false;
+  _vertex_triangles[from].clear();
+  ++_versions[to];
+  return true;
+}
+
+/**
+ * Fills the indicated vector with the sorted list of vertices that share a
+ * triangle with the indicated vertex.
+ */
+void MeshSimplifier::Mesh::
+get_neighbors(int v, vector_int &neighbors) const {
+  neighbors.clear();
+  for (int t : _vertex_triangles[v]) {
+    if (!_triangle_alive[t]) {
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      int w = get_vertex(t, c);
+      if (w != v) {
+        neighbors.push_back(w);
+      }
+    }
+  }
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+/**
+ *
+ */
+MeshSimplifier::
+MeshSimplifier() :
+  _max_error(0.0f),
+  _lock_boundaries(false)
+{
+}
+
+/**
+ * Returns a new Geom, sharing the format of the indicated one, with its
+ * triangles reduced to approximately the indicated fraction of their
+ * original number.  Vertices that are no longer used are removed from the
+ * new Geom's vertex data.
+ *
+ * Returns NULL if the Geom does not contain triangles.
+ */
+PT(Geom) MeshSimplifier::
+simplify_geom(const Geom *geom, PN_stdfloat ratio) const {
+  nassertr(geom != nullptr, nullptr);
+  Thread *current_thread = Thread::get_current_thread();
+
+  if (geom->get_primitive_type() != Geom::PT_polygons ||
+      geom->get_num_primitives() == 0) {
+    return nullptr;
+  }
+  CPT(GeomVertexData) vdata = geom->get_vertex_data(current_thread);
+  if (!vdata->has_column(InternalName::get_vertex())) {
+    return nullptr;
+  }
+
+  Mesh mesh(vdata, _lock_boundaries, current_thread);
+  GeomEnums::UsageHint usage_hint = GeomEnums::UH_static;
+  for (size_t i = 0; i < geom->get_num_primitives(); ++i) {
+    CPT(GeomPrimitive) prim = geom->get_primitive(i);
+    if (i == 0) {
+      usage_hint = prim->get_usage_hint();
+    }
+    if (!mesh.add_primitive(prim, current_thread)) {
+      return nullptr;
+    }
+  }
+  mesh.setup();
+
+  ratio = std::min(std::max(ratio, (PN_stdfloat)0), (PN_stdfloat)1);
+  int target = std::max((int)(mesh._num_triangles * ratio + 0.5f), 1);
+  mesh.simplify(target, _max_error);
+
+  vector_int corners;
+  mesh.get_corners(corners);
+
+  // Copy the rows that are still in use, in the order they are first used,
+  // which also tends to help the vertex cache.
+  vector_int new_rows(vdata->get_num_rows(), -1);
+  vector_int old_rows;
+  for (int &row : corners) {
+    if (new_rows[row] == -1) {
+      new_rows[row] = (int)old_rows.size();
+      old_rows.push_back(row);
+    }
+    row = new_rows[row];
+  }
+
+  PT(GeomVertexData) new_vdata = new GeomVertexData(*vdata);
+  new_vdata->unclean_set_num_rows((int)old_rows.size());
+  for (size_t i = 0; i < old_rows.size(); ++i) {
+    new_vdata->copy_row_from((int)i, vdata, old_rows[i], current_thread);
+  }
+
+  PT(Geom) new_geom = geom->make_copy();
+  new_geom->clear_primitives();
+  new_geom->set_vertex_data(new_vdata);
+  if (!corners.empty()) {
+    PT(GeomTriangles) triangles = new GeomTriangles(usage_hint);
+    triangles->set_shade_model(mesh._shade_model);
+    triangles->reserve_num_vertices((int)corners.size());
+    for (size_t i = 0; i < corners.size(); i += 3) {
+      triangles->add_vertices(corners[i], corners[i + 1], corners[i + 2]);
+    }
+    new_geom->add_primitive(triangles);
+  }
+  return new_geom;
+}
+
+/**
+ * Simplifies all of the Geoms at and below the indicated node in place, to
+ * approximately the indicated fraction of their triangles.  A Geom that is
+ * shared by several GeomNodes is simplified only once.  Returns the number of
+ * triangles that were removed.
+ */
+int MeshSimplifier::
+simplify(const NodePath &root, PN_stdfloat ratio) const {
+  nassertr(!root.is_empty(), 0);
+  GeomMap geoms;
+  return r_simplify(root.node(), ratio, geoms);
+}
+
+/**
+ * Generates a series of increasingly simplified copies of the indicated
+ * model, and puts them together with the model itself under a new LODNode,
+ * which takes the model's place in the scene graph.  Returns the new LODNode.
+ *
+ * Each level has the indicated fraction of the triangles of the level before
+ * it.  The original model is shown up to switch_distance from the camera,
+ * and each successive level up to distance_factor times farther than the one
+ * before it.  Beyond the last level, the model is not drawn at all.
+ *
+ * The node is created with LODNode::make_default_lod(), so it is a
+ * FadeLODNode if the default-lod-type variable says so.
+ */
+NodePath MeshSimplifier::
+make_lod(const NodePath &model, int num_levels, PN_stdfloat switch_distance,
+         PN_stdfloat distance_factor, PN_stdfloat ratio) const {
+  nassertr(!model.is_empty(), NodePath::fail());
+  nassertr(num_levels > 0 && switch_distance > 0.0f && distance_factor > 1.0f,
+           NodePath::fail());
+
+  PT(LODNode) lod = LODNode::make_default_lod(model.get_name());
+  NodePath lod_np;
+  NodePath parent = model.get_parent();
+  if (parent.is_empty()) {
+    lod_np = NodePath(lod);
+  } else {
+    lod_np = parent.attach_new_node(lod, model.get_sort());
+  }
+
+  NodePath level = model;
+  level.reparent_to(lod_np);
+
+  LPoint3 min_point, max_point;
+  if (level.calc_tight_bounds(min_point, max_point, lod_np)) {
+    lod->set_center((min_point + max_point) * 0.5f);
+  }
+
+  PN_stdfloat out = 0.0f;
+  PN_stdfloat in = switch_distance;
+  PN_stdfloat level_ratio = 1.0f;
+  for (int i = 0; i < num_levels; ++i) {
+    if (i != 0) {
+      // Each level is simplified from the original model, rather than from
+      // the previous level, so that the errors do not accumulate.
+      level_ratio *= ratio;
+      PT(PandaNode) copy = model.node()->copy_subgraph();
+      NodePath copy_np = lod_np.attach_new_node(copy);
+      simplify(copy_np, level_ratio);
+    }
+    lod->add_switch(in, out);
+    out = in;
+    in *= distance_factor;
+  }
+
+  return lod_np;
+}
+
+/**
+ * The recursive implementation of simplify().
+ */
+int MeshSimplifier::
+r_simplify(PandaNode *node, PN_stdfloat ratio, GeomMap &geoms) const {
+  int num_removed = 0;
+
+  if (node->is_geom_node()) {
+    GeomNode *gnode = DCAST(GeomNode, node);
+    int num_geoms = gnode->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      CPT(Geom) geom = gnode->get_geom(i);
+      GeomMap::iterator gi = geoms.find(geom);
+      if (gi == geoms.end()) {
+        PT(Geom) new_geom = simplify_geom(geom, ratio);
+        if (new_geom != nullptr) {
+          num_removed += count_triangles(geom) - count_triangles(new_geom);
+        }
+        gi = geoms.insert(GeomMap::value_type(geom, new_geom)).first;
+      }
+      if ((*gi).second != nullptr) {
+        gnode->set_geom(i, (*gi).second);
+      }
+    }
+  }
+
+  int num_children = node->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    num_removed += r_simplify(node->get_child(i), ratio, geoms);
+  }
+  int num_stashed = node->get_num_stashed();
+  for (int i = 0; i < num_stashed; ++i) {
+    num_removed += r_simplify(node->get_stashed(i), ratio, geoms);
+  }
+
+  return num_removed;
+}
@@ -0,0 +1,72 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file meshSimplifier.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include "pandabase.h"
+#include "geom.h"
+#include "nodePath.h"
+#include "pointerTo.h"
+#include "pmap.h"
+
+class PandaNode;
+
+/**
+ * This object reduces the number of triangles in a model, for use at a
+ * distance, using the quadric error metric of Garland and Heckbert.
+ *
+ * Edges are collapsed one at a time, cheapest first, by moving one of their
+ * vertices onto the other one.  Since no new vertices are created, all of
+ * the other vertex columns are preserved exactly.  Vertices that share a
+ * position are welded together while the mesh is simplified, and a vertex
+ * may only be moved along an edge that keeps its texture seams and normal
+ * creases intact.  Open edges and seams are also weighted so that their
+ * outline is preserved as well as possible.
+ *
+ * make_lod() uses this to generate a series of increasingly coarse copies of
+ * a model and wrap them in an LODNode.
+ */
+class EXPCL_PANDA_GRUTIL MeshSimplifier {
+PUBLISHED:
+  MeshSimplifier();
+
+  INLINE void set_max_error(PN_stdfloat max_error);
+  INLINE PN_stdfloat get_max_error() const;
+  MAKE_PROPERTY(max_error, get_max_error, set_max_error);
+
+  INLINE void set_lock_boundaries(bool lock_boundaries);
+  INLINE bool get_lock_boundaries() const;
+  MAKE_PROPERTY(lock_boundaries, get_lock_boundaries, set_lock_boundaries);
+
+  PT(Geom) simplify_geom(const Geom *geom, PN_stdfloat ratio) const;
+  int simplify(const NodePath &root, PN_stdfloat ratio) const;
+
+  NodePath make_lod(const NodePath &model, int num_levels,
+                    PN_stdfloat switch_distance,
+                    PN_stdfloat distance_factor = 2.0f,
+                    PN_stdfloat ratio = 0.5f) const;
+
+private:
+  typedef pmap<CPT(Geom), PT(Geom) > GeomMap;
+  int r_simplify(PandaNode *node, PN_stdfloat ratio, GeomMap &geoms) const;
+
+  class Mesh;
+
+  PN_stdfloat _max_error;
+  bool _lock_boundaries;
+};
+
+#include "meshSimplifier.I"
+
+#endif
@@ -1,5 +1,6 @@
 #include "meshDrawer.cxx"
 #include "meshDrawer2D.cxx"
+#include "meshSimplifier.cxx"
 #include "movieTexture.cxx"
 #include "nodeVertexTransform.cxx"
 #include "pipeOcclusionCullTraverser.cxx"
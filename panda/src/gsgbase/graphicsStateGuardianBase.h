@@ -126,6 +126,7 @@ PUBLISHED:
   virtual bool get_supports_texture_srgb() const=0;
 
   virtual bool get_supports_hlsl() const=0;
+  virtual bool get_supports_geometry_instancing() const=0;
 
 public:
   // These are some general interface functions; they're defined here mainly
@@ -25,6 +25,7 @@
 
 #include "deg_2_rad.h"
 #include "nearly_zero.h"
+#include "lsimd.h"
 
 #include "coordinateSystem.h"
 #include "lvecBase4.h"
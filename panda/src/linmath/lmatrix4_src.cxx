@@ -375,6 +375,104 @@ generate_hash(ChecksumHashGenerator &hashgen, FLOATTYPE threshold) const {
   }
 }
 
+/**
+ * Transforms count 4-component vectors from the source array by this matrix,
+ * as with xform(), and stores the results in the result array, which may be
+ * the same as the source array.
+ */
+void FLOATNAME(LMatrix4)::
+xform_array(FLOATNAME(LVecBase4) *result,
+            const FLOATNAME(LVecBase4) *source, size_t count) const {
+  TAU_PROFILE("void LMatrix4::xform_array(LVecBase4 *, const LVecBase4 *, size_t)", " ", TAU_USER);
+  size_t i = 0;
+
+#if defined(LINMATH_SSE2) && FLOATTOKEN == 'f'
+  __m128 row0 = _mm_loadu_ps(&_m(0, 0));
+  __m128 row1 = _mm_loadu_ps(&_m(1, 0));
+  __m128 row2 = _mm_loadu_ps(&_m(2, 0));
+  __m128 row3 = _mm_loadu_ps(&_m(3, 0));
+  for (; i < count; ++i) {
+    __m128 v = _mm_loadu_ps(source[i].get_data());
+    __m128 r = _mm_mul_ps(lsimd_splat(v, 0), row0);
+    r = _mm_add_ps(r, _mm_mul_ps(lsimd_splat(v, 1), row1));
+    r = _mm_add_ps(r, _mm_mul_ps(lsimd_splat(v, 2), row2));
+    r = _mm_add_ps(r, _mm_mul_ps(lsimd_splat(v, 3), row3));
+    _mm_storeu_ps(&result[i][0], r);
+  }
+#endif
+
+  for (; i < count; ++i) {
+    result[i] = xform(source[i]);
+  }
+}
+
+/**
+ * Transforms count points from the source array by this matrix, as with
+ * xform_point(), and stores the results in the result array, which may be the
+ * same as the source array.
+ */
+void FLOATNAME(LMatrix4)::
+xform_point_array(FLOATNAME(LVecBase3) *result,
+                  const FLOATNAME(LVecBase3) *source, size_t count) const {
+  TAU_PROFILE("void LMatrix4::xform_point_array(LVecBase3 *, const LVecBase3 *, size_t)", " ", TAU_USER);
+  size_t i = 0;
+
+#if defined(LINMATH_SSE2) && FLOATTOKEN == 'f'
+  if (sizeof(FLOATNAME(LVecBase3)) == sizeof(FLOATTYPE) * 3) {
+    // Four points at a time, with the components rearranged so that each
+    // register holds the same component of all four.
+    __m128 m00 = _mm_set1_ps(_m(0, 0)), m01 = _mm_set1_ps(_m(0, 1)), m02 = _mm_set1_ps(_m(0, 2));
+    __m128 m10 = _mm_set1_ps(_m(1, 0)), m11 = _mm_set1_ps(_m(1, 1)), m12 = _mm_set1_ps(_m(1, 2));
+    __m128 m20 = _mm_set1_ps(_m(2, 0)), m21 = _mm_set1_ps(_m(2, 1)), m22 = _mm_set1_ps(_m(2, 2));
+    __m128 m30 = _mm_set1_ps(_m(3, 0)), m31 = _mm_set1_ps(_m(3, 1)), m32 = _mm_set1_ps(_m(3, 2));
+    for (; i + 4 <= count; i += 4) {
+      __m128 x, y, z;
+      lsimd_load3x4(source[i].get_data(), x, y, z);
+      __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20)), m30);
+      __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21)), m31);
+      __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22)), m32);
+      lsimd_store3x4(&result[i][0], rx, ry, rz);
+    }
+  }
+#endif
+
+  for (; i < count; ++i) {
+    result[i] = xform_point(source[i]);
+  }
+}
+
+/**
+ * Transforms count vectors from the source array by this matrix, as with
+ * xform_vec(), and stores the results in the result array, which may be the
+ * same as the source array.
+ */
+void FLOATNAME(LMatrix4)::
+xform_vec_array(FLOATNAME(LVecBase3) *result,
+                const FLOATNAME(LVecBase3) *source, size_t count) const {
+  TAU_PROFILE("void LMatrix4::xform_vec_array(LVecBase3 *, const LVecBase3 *, size_t)", " ", TAU_USER);
+  size_t i = 0;
+
+#if defined(LINMATH_SSE2) && FLOATTOKEN == 'f'
+  if (sizeof(FLOATNAME(LVecBase3)) == sizeof(FLOATTYPE) * 3) {
+    __m128 m00 = _mm_set1_ps(_m(0, 0)), m01 = _mm_set1_ps(_m(0, 1)), m02 = _mm_set1_ps(_m(0, 2));
+    __m128 m10 = _mm_set1_ps(_m(1, 0)), m11 = _mm_set1_ps(_m(1, 1)), m12 = _mm_set1_ps(_m(1, 2));
+    __m128 m20 = _mm_set1_ps(_m(2, 0)), m21 = _mm_set1_ps(_m(2, 1)), m22 = _mm_set1_ps(_m(2, 2));
+    for (; i + 4 <= count; i += 4) {
+      __m128 x, y, z;
+      lsimd_load3x4(source[i].get_data(), x, y, z);
+      __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), _mm_mul_ps(z, m20));
+      __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), _mm_mul_ps(z, m21));
+      __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m02), _mm_mul_ps(y, m12)), _mm_mul_ps(z, m22));
+      lsimd_store3x4(&result[i][0], rx, ry, rz);
+    }
+  }
+#endif
+
+  for (; i < count; ++i) {
+    result[i] = xform_vec(source[i]);
+  }
+}
+
 /**
  *
  */
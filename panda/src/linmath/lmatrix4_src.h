@@ -281,6 +281,14 @@ PUBLISHED:
   void write_datagram(Datagram &destination) const;
   void read_datagram(DatagramIterator &source);
 
+public:
+  void xform_array(FLOATNAME(LVecBase4) *result,
+                   const FLOATNAME(LVecBase4) *source, size_t count) const;
+  void xform_point_array(FLOATNAME(LVecBase3) *result,
+                         const FLOATNAME(LVecBase3) *source, size_t count) const;
+  void xform_vec_array(FLOATNAME(LVecBase3) *result,
+                       const FLOATNAME(LVecBase3) *source, size_t count) const;
+
 public:
   // The underlying implementation is via the Eigen library, if available.
 
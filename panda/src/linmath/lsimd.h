@@ -0,0 +1,163 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file lsimd.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef LSIMD_H
+#define LSIMD_H
+
+#include "pandabase.h"
+
+// When Eigen is not available, the single-precision LMatrix4 operations that
+// matter most (multiply, invert and transforming arrays of points) are
+// written out by hand with SSE2, if it is known to be available at compile
+// time.  Other architectures, and the double-precision classes, use the
+// scalar code.
+#if !defined(HAVE_EIGEN) && !defined(CPPPARSER) && \
+  (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+#define LINMATH_SSE2
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
+#ifdef LINMATH_SSE2
+
+/**
+ * Returns the dot product of all four components of a and b, in all four
+ * components of the result.
+ */
+ALWAYS_INLINE __m128
+lsimd_dot4(__m128 a, __m128 b) {
+  __m128 m = _mm_mul_ps(a, b);
+  m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+/**
+ * Returns the cross product of the first three components of a and b.  The
+ * fourth component of the result is zero, as long as the fourth components
+ * of a and b are finite.
+ */
+ALWAYS_INLINE __m128
+lsimd_cross3(__m128 a, __m128 b) {
+  __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+  return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+/**
+ * Returns the indicated component of v in all four components.
+ */
+#define lsimd_splat(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+/**
+ * Loads a single 3-component vector, without reading past its end.  The
+ * fourth component of the result is zero.
+ */
+ALWAYS_INLINE __m128
+lsimd_load3(const float *data) {
+  __m128 xy = _mm_castpd_ps(_mm_load_sd((const double *)data));
+  return _mm_movelh_ps(xy, _mm_load_ss(data + 2));
+}
+
+/**
+ * Stores the first three components of v, without writing past their end.
+ */
+ALWAYS_INLINE void
+lsimd_store3(float *data, __m128 v) {
+  _mm_store_sd((double *)data, _mm_castps_pd(v));
+  _mm_store_ss(data + 2, _mm_movehl_ps(v, v));
+}
+
+/**
+ * Loads four tightly packed 3-component vectors, transposed so that x, y and
+ * z each receive the corresponding component of all four.
+ */
+ALWAYS_INLINE void
+lsimd_load3x4(const float *data, __m128 &x, __m128 &y, __m128 &z) {
+  __m128 a = _mm_loadu_ps(data);      // x0 y0 z0 x1
+  __m128 b = _mm_loadu_ps(data + 4);  // y1 z1 x2 y2
+  __m128 c = _mm_loadu_ps(data + 8);  // z2 x3 y3 z3
+  x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+  y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                     _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+  z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                     _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/**
+ * The inverse of lsimd_load3x4(): stores the x, y and z components of four
+ * vectors as four tightly packed 3-component vectors.
+ */
+ALWAYS_INLINE void
+lsimd_store3x4(float *data, __m128 x, __m128 y, __m128 z) {
+  __m128 a = _mm_shuffle_ps(_mm_unpacklo_ps(x, y),
+                            _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+  __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                            _mm_unpackhi_ps(x, y), _MM_SHUFFLE(1, 0, 2, 0));
+  __m128 c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                            _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+  _mm_storeu_ps(data, a);      // x0 y0 z0 x1
+  _mm_storeu_ps(data + 4, b);  // y1 z1 x2 y2
+  _mm_storeu_ps(data + 8, c);  // z2 x3 y3 z3
+}
+
+/**
+ * Computes the sine and cosine of each of the four angles in x, which are
+ * given in radians.  This uses the range reduction and the minimax
+ * polynomials of the Cephes library's sinf() and cosf(), which are accurate
+ * to within a few ulps for angles up to several thousand radians.
+ */
+ALWAYS_INLINE void
+lsimd_sincos(__m128 x, __m128 &s, __m128 &c) {
+  const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+  __m128 sign_s = _mm_and_ps(x, sign_mask);
+  x = _mm_andnot_ps(sign_mask, x);
+
+  // Find the octant, rounded up to an even number, and whether the sine and
+  // cosine polynomials must be swapped or negated there.
+  __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+  j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+  __m128 y = _mm_cvtepi32_ps(j);
+
+  sign_s = _mm_xor_ps(sign_s, _mm_castsi128_ps(
+    _mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29)));
+  __m128 sign_c = _mm_castsi128_ps(_mm_slli_epi32(
+    _mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+  __m128 use_sin = _mm_castsi128_ps(_mm_cmpeq_epi32(
+    _mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+  // Subtract the octant times pi/4, in three steps for extra precision.
+  x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+  __m128 z = _mm_mul_ps(x, x);
+
+  __m128 pc = _mm_set1_ps(2.443315711809948e-5f);
+  pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(-1.388731625493765e-3f));
+  pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(4.166664568298827e-2f));
+  pc = _mm_mul_ps(_mm_mul_ps(pc, z), z);
+  pc = _mm_sub_ps(pc, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  pc = _mm_add_ps(pc, _mm_set1_ps(1.0f));
+
+  __m128 ps = _mm_set1_ps(-1.9515295891e-4f);
+  ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(8.3321608736e-3f));
+  ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(-1.6666654611e-1f));
+  ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), x), x);
+
+  s = _mm_xor_ps(_mm_or_ps(_mm_and_ps(use_sin, ps), _mm_andnot_ps(use_sin, pc)), sign_s);
+  c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(use_sin, pc), _mm_andnot_ps(use_sin, ps)), sign_c);
+}
+
+#endif  // LINMATH_SSE2
+
+#endif
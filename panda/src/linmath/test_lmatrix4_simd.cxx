@@ -0,0 +1,334 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_lmatrix4_simd.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "lmatrix.h"
+#include "luse.h"
+#include "compose_matrix.h"
+#include "randomizer.h"
+#include "trueClock.h"
+
+// This program measures LMatrix4f multiply, invert_from and the array
+// transforms against the scalar code they replace when LINMATH_SSE2 is
+// defined, and reports the largest difference between the results.  The
+// scalar code is reproduced below.
+
+// The number of times to repeat each measurement; the best time is kept.
+static const int num_trials = 10;
+
+static void
+scalar_multiply(LMatrix4f &res, const LMatrix4f &a, const LMatrix4f &b) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      res(i, j) = a(i, 0) * b(0, j) + a(i, 1) * b(1, j) + a(i, 2) * b(2, j) + a(i, 3) * b(3, j);
+    }
+  }
+}
+
+static bool
+scalar_invert_affine(LMatrix4f &res, const LMatrix4f &other) {
+  LMatrix3f rot;
+  if (!rot.invert_from(other.get_upper_3())) {
+    return false;
+  }
+  res.set_upper_3(rot);
+  res.set_col(3, LVecBase4f(0.0f, 0.0f, 0.0f, 1.0f));
+  for (int j = 0; j < 3; ++j) {
+    res(3, j) = -(other(3, 0) * res(0, j) + other(3, 1) * res(1, j) + other(3, 2) * res(2, j));
+  }
+  return true;
+}
+
+// The LU decomposition used by invert_from() for non-affine matrices.
+static bool
+scalar_invert_general(LMatrix4f &res, const LMatrix4f &other) {
+  LMatrix4f lu = other;
+  int index[4];
+  float vv[4];
+  for (int i = 0; i < 4; i++) {
+    float big = 0.0f;
+    for (int j = 0; j < 4; j++) {
+      big = std::max(big, (float)fabs(lu(i, j)));
+    }
+    if (IS_THRESHOLD_ZERO(big, (NEARLY_ZERO(float) * NEARLY_ZERO(float)))) {
+      return false;
+    }
+    vv[i] = 1.0f / big;
+  }
+  for (int j = 0; j < 4; j++) {
+    for (int i = 0; i < j; i++) {
+      float sum = lu(i, j);
+      for (int k = 0; k < i; k++) {
+        sum -= lu(i, k) * lu(k, j);
+      }
+      lu(i, j) = sum;
+    }
+    float big = 0.0f;
+    int imax = -1;
+    for (int i = j; i < 4; i++) {
+      float sum = lu(i, j);
+      for (int k = 0; k < j; k++) {
+        sum -= lu(i, k) * lu(k, j);
+      }
+      lu(i, j) = sum;
+      float dum = vv[i] * fabs(sum);
+      if (dum >= big) {
+        big = dum;
+        imax = i;
+      }
+    }
+    if (j != imax) {
+      for (int k = 0; k < 4; k++) {
+        std::swap(lu(imax, k), lu(j, k));
+      }
+      vv[imax] = vv[j];
+    }
+    index[j] = imax;
+    if (lu(j, j) == 0.0f) {
+      lu(j, j) = NEARLY_ZERO(float);
+    }
+    if (j != 3) {
+      float dum = 1.0f / lu(j, j);
+      for (int i = j + 1; i < 4; i++) {
+        lu(i, j) *= dum;
+      }
+    }
+  }
+
+  LMatrix4f inv = LMatrix4f::ident_mat();
+  for (int row = 0; row < 4; row++) {
+    int ii = -1;
+    for (int i = 0; i < 4; i++) {
+      int ip = index[i];
+      float sum = inv(row, ip);
+      inv(row, ip) = inv(row, i);
+      if (ii >= 0) {
+        for (int j = ii; j <= i - 1; j++) {
+          sum -= lu(i, j) * inv(row, j);
+        }
+      } else if (sum) {
+        ii = i;
+      }
+      inv(row, i) = sum;
+    }
+    for (int i = 3; i >= 0; i--) {
+      float sum = inv(row, i);
+      for (int j = i + 1; j < 4; j++) {
+        sum -= lu(i, j) * inv(row, j);
+      }
+      inv(row, i) = sum / lu(i, i);
+    }
+  }
+  res.transpose_from(inv);
+  return true;
+}
+
+static void
+scalar_xform_point_array(const LMatrix4f &m, LVecBase3f *result,
+                         const LVecBase3f *source, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const LVecBase3f &v = source[i];
+    result[i].set(v[0] * m(0, 0) + v[1] * m(1, 0) + v[2] * m(2, 0) + m(3, 0),
+                  v[0] * m(0, 1) + v[1] * m(1, 1) + v[2] * m(2, 1) + m(3, 1),
+                  v[0] * m(0, 2) + v[1] * m(1, 2) + v[2] * m(2, 2) + m(3, 2));
+  }
+}
+
+static void
+scalar_xform_array(const LMatrix4f &m, LVecBase4f *result,
+                   const LVecBase4f *source, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const LVecBase4f &v = source[i];
+    for (int j = 0; j < 4; ++j) {
+      result[i][j] = v[0] * m(0, j) + v[1] * m(1, j) + v[2] * m(2, j) + v[3] * m(3, j);
+    }
+  }
+}
+
+static LMatrix4f
+random_affine(Randomizer &random) {
+  LMatrix4f mat;
+  compose_matrix(mat,
+                 LVecBase3f(random.random_real(4) + 0.25f, random.random_real(4) + 0.25f, random.random_real(4) + 0.25f),
+                 LVecBase3f(random.random_real(0.5) - 0.25f, 0.0f, 0.0f),
+                 LVecBase3f(random.random_real(360), random.random_real(360), random.random_real(360)),
+                 LVecBase3f(random.random_real(200) - 100, random.random_real(200) - 100, random.random_real(200) - 100));
+  return mat;
+}
+
+static LMatrix4f
+random_projective(Randomizer &random) {
+  LMatrix4f mat = random_affine(random);
+  mat.set_col(3, LVecBase4f(random.random_real(0.2) - 0.1f, random.random_real(0.2) - 0.1f, random.random_real(2) + 0.5f, random.random_real(0.5)));
+  return mat;
+}
+
+static float
+max_difference(const LMatrix4f &a, const LMatrix4f &b) {
+  float diff = 0.0f;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      diff = std::max(diff, (float)fabs(a(i, j) - b(i, j)) / std::max(1.0f, (float)fabs(b(i, j))));
+    }
+  }
+  return diff;
+}
+
+static void
+report(const char *name, int count, double scalar_time, double simd_time, float diff) {
+  nout << name << ":\n"
+       << "  scalar: " << scalar_time * 1.0e9 / count << " ns each\n"
+       << "  simd:   " << simd_time * 1.0e9 / count << " ns each ("
+       << scalar_time / simd_time << "x)\n"
+       << "  largest relative difference: " << diff << "\n";
+}
+
+int
+main(int argc, char *argv[]) {
+  int count = 10000;
+  if (argc > 1) {
+    count = atoi(argv[1]);
+  }
+
+#ifdef LINMATH_SSE2
+  nout << "LINMATH_SSE2 is defined\n";
+#else
+  nout << "LINMATH_SSE2 is not defined; both columns measure the scalar code\n";
+#endif
+
+  Randomizer random(1);
+  pvector<LMatrix4f> affine, projective;
+  pvector<LMatrix4d> projective_d;
+  for (int i = 0; i < count; ++i) {
+    affine.push_back(random_affine(random));
+    projective.push_back(random_projective(random));
+    projective_d.push_back(LCAST(double, projective.back()));
+  }
+  pvector<LMatrix4f> scalar_result(count), simd_result(count);
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double scalar_time = 1.0e30;
+  double simd_time = 1.0e30;
+  float diff = 0.0f;
+
+  // Multiply.
+  for (int trial = 0; trial < num_trials; ++trial) {
+    double start = clock->get_short_time();
+    for (int i = 0; i < count; ++i) {
+      scalar_multiply(scalar_result[i], affine[i], projective[(i + 1) % count]);
+    }
+    scalar_time = std::min(scalar_time, clock->get_short_time() - start);
+
+    start = clock->get_short_time();
+    for (int i = 0; i < count; ++i) {
+      simd_result[i].multiply(affine[i], projective[(i + 1) % count]);
+    }
+    simd_time = std::min(simd_time, clock->get_short_time() - start);
+  }
+  for (int i = 0; i < count; ++i) {
+    diff = std::max(diff, max_difference(simd_result[i], scalar_result[i]));
+  }
+  report("multiply", count, scalar_time, simd_time, diff);
+
+  // Affine inverse.
+  scalar_time = simd_time = 1.0e30;
+  diff = 0.0f;
+  for (int trial = 0; trial < num_trials; ++trial) {
+    double start = clock->get_short_time();
+    for (int i = 0; i < count; ++i) {
+      scalar_invert_affine(scalar_result[i], affine[i]);
+    }
+    scalar_time = std::min(scalar_time, clock->get_short_time() - start);
+
+    start = clock->get_short_time();
+    for (int i = 0; i < count; ++i) {
+      simd_result[i].invert_from(affine[i]);
+    }
+    simd_time = std::min(simd_time, clock->get_short_time() - start);
+  }
+  for (int i = 0; i < count; ++i) {
+    diff = std::max(diff, max_difference(simd_result[i], scalar_result[i]));
+  }
+  report("invert_from (affine)", count, scalar_time, simd_time, diff);
+
+  // General inverse.  Both are also compared with the double-precision
+  // result, to show that the accuracy has not suffered.
+  scalar_time = simd_time = 1.0e30;
+  diff = 0.0f;
+  for (int trial = 0; trial < num_trials; ++trial) {
+    double start = clock->get_short_time();
+    for (int i = 0; i < count; ++i) {
+      scalar_invert_general(scalar_result[i], projective[i]);
+    }
+    scalar_time = std::min(scalar_time, clock->get_short_time() - start);
+
+    start = clock->get_short_time();
+    for (int i = 0; i < count; ++i) {
+      simd_result[i].invert_from(projective[i]);
+    }
+    simd_time = std::min(simd_time, clock->get_short_time() - start);
+  }
+  float scalar_error = 0.0f;
+  float simd_error = 0.0f;
+  for (int i = 0; i < count; ++i) {
+    LMatrix4d exact;
+    exact.invert_from(projective_d[i]);
+    diff = std::max(diff, max_difference(simd_result[i], scalar_result[i]));
+    scalar_error = std::max(scalar_error, max_difference(scalar_result[i], LCAST(float, exact)));
+    simd_error = std::max(simd_error, max_difference(simd_result[i], LCAST(float, exact)));
+  }
+  report("invert_from (general)", count, scalar_time, simd_time, diff);
+  nout << "  largest relative error: scalar " << scalar_error
+       << ", simd " << simd_error << "\n";
+
+  // Transforming arrays of points and 4-component vectors.
+  pvector<LVecBase3f> points(count), scalar_points(count), simd_points(count);
+  pvector<LVecBase4f> vecs(count), scalar_vecs(count), simd_vecs(count);
+  for (int i = 0; i < count; ++i) {
+    points[i].set(random.random_real(20) - 10, random.random_real(20) - 10, random.random_real(20) - 10);
+    vecs[i].set(points[i][0], points[i][1], points[i][2], random.random_real(1));
+  }
+  const LMatrix4f &mat = projective[0];
+
+  for (int type = 0; type < 2; ++type) {
+    scalar_time = simd_time = 1.0e30;
+    diff = 0.0f;
+    for (int trial = 0; trial < num_trials; ++trial) {
+      double start = clock->get_short_time();
+      if (type == 0) {
+        scalar_xform_point_array(mat, &scalar_points[0], &points[0], count);
+      } else {
+        scalar_xform_array(mat, &scalar_vecs[0], &vecs[0], count);
+      }
+      scalar_time = std::min(scalar_time, clock->get_short_time() - start);
+
+      start = clock->get_short_time();
+      if (type == 0) {
+        mat.xform_point_array(&simd_points[0], &points[0], count);
+      } else {
+        mat.xform_array(&simd_vecs[0], &vecs[0], count);
+      }
+      simd_time = std::min(simd_time, clock->get_short_time() - start);
+    }
+    for (int i = 0; i < count; ++i) {
+      for (int j = 0; j < 3 + type; ++j) {
+        float a = (type == 0) ? simd_points[i][j] : simd_vecs[i][j];
+        float b = (type == 0) ? scalar_points[i][j] : scalar_vecs[i][j];
+        diff = std::max(diff, (float)fabs(a - b));
+      }
+    }
+    report((type == 0) ? "xform_point_array" : "xform_array", count,
+           scalar_time, simd_time, diff);
+  }
+
+  return 0;
+}
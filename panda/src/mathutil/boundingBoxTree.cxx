@@ -0,0 +1,266 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file boundingBoxTree.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "boundingBoxTree.h"
+#include "boundingBox.h"
+#include "geometricBoundingVolume.h"
+
+#include <algorithm>
+
+/**
+ *
+ */
+BoundingBoxTree::
+BoundingBoxTree() :
+  _stale(false)
+{
+}
+
+/**
+ * Changes the number of items in the tree.  Any new items are initially
+ * empty.  The tree must be rebuilt afterwards.
+ */
+void BoundingBoxTree::
+set_num_items(size_t num_items) {
+  Item empty_item;
+  empty_item._empty = true;
+  _items.resize(num_items, empty_item);
+  _stale = true;
+}
+
+/**
+ * Builds the tree from scratch, from the current boxes of the items.
+ */
+void BoundingBoxTree::
+rebuild() {
+  _stale = false;
+  _order.clear();
+  _nodes.clear();
+
+  for (size_t i = 0; i < _items.size(); ++i) {
+    if (!_items[i]._empty) {
+      _order.push_back((int)i);
+    }
+  }
+  if (_order.empty()) {
+    return;
+  }
+
+  _nodes.reserve(_order.size() * 2 / max_leaf_items + 1);
+  _nodes.push_back(Node());
+  r_build(0, 0, (int)_order.size());
+}
+
+/**
+ * Updates the bounds of the tree to match the current boxes of the items,
+ * keeping its existing structure.  If items have been added or emptied since
+ * the tree was built, this rebuilds it instead.
+ */
+void BoundingBoxTree::
+refit() {
+  if (_stale) {
+    rebuild();
+  } else if (!_nodes.empty()) {
+    r_refit(0);
+  }
+}
+
+/**
+ * Appends to result the indices of all of the items whose boxes might
+ * intersect the indicated volume, which should be in the same coordinate
+ * space as the boxes.  The indices are appended in no particular order.
+ */
+void BoundingBoxTree::
+find_overlaps(const GeometricBoundingVolume *volume, vector_int &result) const {
+  nassertv(!_stale);
+  if (!_nodes.empty()) {
+    r_find_overlaps(0, volume, result);
+  }
+}
+
+/**
+ * Appends to result the indices of all of the items whose boxes overlap the
+ * indicated box.  The indices are appended in no particular order.
+ */
+void BoundingBoxTree::
+find_overlaps(const LPoint3 &min, const LPoint3 &max, vector_int &result) const {
+  nassertv(!_stale);
+  if (!_nodes.empty()) {
+    r_find_overlaps(0, min, max, result);
+  }
+}
+
+/**
+ * Fills in the indicated node, which will contain the indicated range of
+ * _order, splitting it further if it has too many items.
+ */
+void BoundingBoxTree::
+r_build(int ni, int first, int count) {
+  const Item &item0 = _items[_order[first]];
+  LPoint3 min = item0._min;
+  LPoint3 max = item0._max;
+  LPoint3 cmin = (item0._min + item0._max) * 0.5f;
+  LPoint3 cmax = cmin;
+  for (int i = 1; i < count; ++i) {
+    const Item &item = _items[_order[first + i]];
+    LPoint3 center = (item._min + item._max) * 0.5f;
+    for (int a = 0; a < 3; ++a) {
+      min[a] = std::min(min[a], item._min[a]);
+      max[a] = std::max(max[a], item._max[a]);
+      cmin[a] = std::min(cmin[a], center[a]);
+      cmax[a] = std::max(cmax[a], center[a]);
+    }
+  }
+
+  Node &node = _nodes[ni];
+  node._min = min;
+  node._max = max;
+  node._first = first;
+  node._count = count;
+  node._left = -1;
+
+  if (count <= max_leaf_items) {
+    return;
+  }
+
+  // Split the items at the median of their centers along the longest axis.
+  LVecBase3 extent = cmax - cmin;
+  int axis = 0;
+  if (extent[1] > extent[axis]) {
+    axis = 1;
+  }
+  if (extent[2] > extent[axis]) {
+    axis = 2;
+  }
+
+  int half = count / 2;
+  const Items &items = _items;
+  std::nth_element(_order.begin() + first, _order.begin() + first + half,
+                   _order.begin() + first + count,
+                   [&items, axis](int a, int b) {
+    return items[a]._min[axis] + items[a]._max[axis] <
+           items[b]._min[axis] + items[b]._max[axis];
+  });
+
+  int left = (int)_nodes.size();
+  _nodes.push_back(Node());
+  _nodes.push_back(Node());
+  _nodes[ni]._left = left;
+  r_build(left, first, half);
+  r_build(left + 1, first + half, count - half);
+}
+
+/**
+ * Recomputes the bounds of the indicated node and all nodes below it.
+ */
+void BoundingBoxTree::
+r_refit(int ni) {
+  Node &node = _nodes[ni];
+  if (node._left < 0) {
+    const Item &item0 = _items[_order[node._first]];
+    node._min = item0._min;
+    node._max = item0._max;
+    for (int i = 1; i < node._count; ++i) {
+      const Item &item = _items[_order[node._first + i]];
+      for (int a = 0; a < 3; ++a) {
+        node._min[a] = std::min(node._min[a], item._min[a]);
+        node._max[a] = std::max(node._max[a], item._max[a]);
+      }
+    }
+  } else {
+    r_refit(node._left);
+    r_refit(node._left + 1);
+    const Node &a = _nodes[node._left];
+    const Node &b = _nodes[node._left + 1];
+    for (int i = 0; i < 3; ++i) {
+      node._min[i] = std::min(a._min[i], b._min[i]);
+      node._max[i] = std::max(a._max[i], b._max[i]);
+    }
+  }
+}
+
+/**
+ * The recursive implementation of find_overlaps() for a general volume.
+ */
+void BoundingBoxTree::
+r_find_overlaps(int ni, const GeometricBoundingVolume *volume,
+                vector_int &result) const {
+  const Node &node = _nodes[ni];
+  BoundingBox box(node._min, node._max);
+  box.local_object();
+
+  int contains = volume->contains(&box);
+  if (contains == BoundingVolume::IF_no_intersection) {
+    return;
+  }
+  if ((contains & BoundingVolume::IF_all) != 0) {
+    // Everything below this node is within the volume.
+    r_add_all(ni, result);
+    return;
+  }
+
+  if (node._left >= 0) {
+    r_find_overlaps(node._left, volume, result);
+    r_find_overlaps(node._left + 1, volume, result);
+    return;
+  }
+
+  for (int i = 0; i < node._count; ++i) {
+    int n = _order[node._first + i];
+    const Item &item = _items[n];
+    box.set_min_max(item._min, item._max);
+    if (volume->contains(&box) != BoundingVolume::IF_no_intersection) {
+      result.push_back(n);
+    }
+  }
+}
+
+/**
+ * The recursive implementation of find_overlaps() for a box.
+ */
+void BoundingBoxTree::
+r_find_overlaps(int ni, const LPoint3 &min, const LPoint3 &max,
+                vector_int &result) const {
+  const Node &node = _nodes[ni];
+  if (node._min[0] > max[0] || node._max[0] < min[0] ||
+      node._min[1] > max[1] || node._max[1] < min[1] ||
+      node._min[2] > max[2] || node._max[2] < min[2]) {
+    return;
+  }
+
+  if (node._left >= 0) {
+    r_find_overlaps(node._left, min, max, result);
+    r_find_overlaps(node._left + 1, min, max, result);
+    return;
+  }
+
+  for (int i = 0; i < node._count; ++i) {
+    int n = _order[node._first + i];
+    const Item &item = _items[n];
+    if (item._min[0] <= max[0] && item._max[0] >= min[0] &&
+        item._min[1] <= max[1] && item._max[1] >= min[1] &&
+        item._min[2] <= max[2] && item._max[2] >= min[2]) {
+      result.push_back(n);
+    }
+  }
+}
+
+/**
+ * Appends all of the items below the indicated node to result.
+ */
+void BoundingBoxTree::
+r_add_all(int ni, vector_int &result) const {
+  const Node &node = _nodes[ni];
+  result.insert(result.end(), _order.begin() + node._first,
+                _order.begin() + node._first + node._count);
+}
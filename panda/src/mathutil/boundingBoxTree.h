@@ -0,0 +1,103 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file boundingBoxTree.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef BOUNDINGBOXTREE_H
+#define BOUNDINGBOXTREE_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+#include "vector_int.h"
+
+class GeometricBoundingVolume;
+
+/**
+ * A bounding volume hierarchy over a list of axis-aligned boxes, each of
+ * which is identified by its index in the list.  It answers the question
+ * "which of the boxes might intersect this volume" in roughly logarithmic
+ * time, by rejecting whole groups of boxes at once.
+ *
+ * The boxes may be changed after the tree has been built; refit() then
+ * adjusts the bounds of the tree to match, without changing its shape.  This
+ * is much faster than rebuild(), but the tree becomes less efficient if the
+ * boxes move far from where they started.
+ */
+class EXPCL_PANDA_MATHUTIL BoundingBoxTree {
+public:
+  BoundingBoxTree();
+
+  INLINE void clear();
+  INLINE size_t get_num_items() const;
+  void set_num_items(size_t num_items);
+  INLINE void set_item(size_t n, const LPoint3 &min, const LPoint3 &max);
+  INLINE void set_item_empty(size_t n);
+  INLINE bool is_item_empty(size_t n) const;
+  INLINE const LPoint3 &get_item_min(size_t n) const;
+  INLINE const LPoint3 &get_item_max(size_t n) const;
+  INLINE bool is_stale() const;
+
+  void rebuild();
+  void refit();
+
+  void find_overlaps(const GeometricBoundingVolume *volume,
+                     vector_int &result) const;
+  void find_overlaps(const LPoint3 &min, const LPoint3 &max,
+                     vector_int &result) const;
+
+private:
+  class Item {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    bool _empty;
+  };
+
+  // A node of the tree.  Each node covers a range of _order; interior nodes
+  // have their two children at _left and _left + 1, while leaves have -1.
+  class Node {
+  public:
+    LPoint3 _min;
+    LPoint3 _max;
+    int _left;
+    int _first;
+    int _count;
+  };
+
+  void r_build(int ni, int first, int count);
+  void r_refit(int ni);
+  void r_find_overlaps(int ni, const GeometricBoundingVolume *volume,
+                       vector_int &result) const;
+  void r_find_overlaps(int ni, const LPoint3 &min, const LPoint3 &max,
+                       vector_int &result) const;
+  void r_add_all(int ni, vector_int &result) const;
+
+  enum {
+    // The maximum number of items in each leaf.
+    max_leaf_items = 4,
+  };
+
+  typedef pvector<Item> Items;
+  Items _items;
+
+  typedef pvector<Node> Nodes;
+  Nodes _nodes;
+
+  // The non-empty items, sorted so that the items of each leaf are together.
+  vector_int _order;
+
+  bool _stale;
+};
+
+#include "boundingBoxTree.I"
+
+#endif
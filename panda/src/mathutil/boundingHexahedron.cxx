@@ -20,6 +20,14 @@
 #include <math.h>
 #include <algorithm>
 
+// The batched tests below process four volumes at a time with SSE2 when
+// this is known to be available at compile time.
+#if !defined(STDFLOAT_DOUBLE) && (defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64))
+#define BOUNDING_HEXAHEDRON_SSE2
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
 using std::max;
 using std::min;
 
@@ -194,6 +202,212 @@ as_bounding_hexahedron() const {
   return this;
 }
 
+#ifdef BOUNDING_HEXAHEDRON_SSE2
+/**
+ * Loads four consecutive points, transposed so that x, y and z each receive
+ * the corresponding component of all four.
+ */
+static INLINE void
+load_points4(const LPoint3 *points, __m128 &x, __m128 &y, __m128 &z) {
+  if (sizeof(LPoint3) == sizeof(float) * 3) {
+    // The points are tightly packed, so we can load them as three vectors
+    // and shuffle the components into place.
+    const float *data = (const float *)points;
+    __m128 a = _mm_loadu_ps(data);      // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(data + 4);  // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(data + 8);  // z2 x3 y3 z3
+
+    __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 2));
+    x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(3, 0, 3, 0));
+    __m128 t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    __m128 t2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    y = _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+    t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    z = _mm_shuffle_ps(t, c, _MM_SHUFFLE(3, 0, 2, 0));
+  } else {
+    x = _mm_setr_ps(points[0][0], points[1][0], points[2][0], points[3][0]);
+    y = _mm_setr_ps(points[0][1], points[1][1], points[2][1], points[3][1]);
+    z = _mm_setr_ps(points[0][2], points[1][2], points[2][2], points[3][2]);
+  }
+}
+
+/**
+ * Stores the results of four tests, given the bitmasks returned by
+ * _mm_movemask_ps() of the volumes that are outside of some plane and of the
+ * volumes that straddle some plane.
+ */
+static INLINE void
+store_results4(int out_bits, int partial_bits, int *results) {
+  for (int j = 0; j < 4; ++j) {
+    if (out_bits & (1 << j)) {
+      results[j] = BoundingVolume::IF_no_intersection;
+    } else if (partial_bits & (1 << j)) {
+      results[j] = BoundingVolume::IF_possible | BoundingVolume::IF_some;
+    } else {
+      results[j] = BoundingVolume::IF_possible | BoundingVolume::IF_some |
+                   BoundingVolume::IF_all;
+    }
+  }
+}
+#endif  // BOUNDING_HEXAHEDRON_SSE2
+
+/**
+ * Tests each of the indicated spheres against this hexahedron, and stores the
+ * results in the results array, which must have room for num_spheres
+ * elements.  Each result is the same as contains() would return for a
+ * BoundingSphere with the corresponding center and radius, but the spheres
+ * are tested several at a time where the hardware supports it.  None of the
+ * spheres may be empty or infinite.
+ */
+void BoundingHexahedron::
+contains_spheres(const LPoint3 *centers, const PN_stdfloat *radii,
+                 size_t num_spheres, int *results) const {
+  nassertv(!is_empty());
+
+  size_t i = 0;
+
+#ifdef BOUNDING_HEXAHEDRON_SSE2
+  __m128 pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = _mm_set1_ps(_planes[p][0]);
+    pb[p] = _mm_set1_ps(_planes[p][1]);
+    pc[p] = _mm_set1_ps(_planes[p][2]);
+    pd[p] = _mm_set1_ps(_planes[p][3]);
+  }
+  const __m128 sign_bit = _mm_set1_ps(-0.0f);
+
+  for (; i + 4 <= num_spheres; i += 4) {
+    __m128 x, y, z;
+    load_points4(centers + i, x, y, z);
+    __m128 r = _mm_loadu_ps(radii + i);
+    __m128 neg_r = _mm_xor_ps(r, sign_bit);
+
+    __m128 out = _mm_setzero_ps();
+    __m128 partial = _mm_setzero_ps();
+    for (int p = 0; p < num_planes; ++p) {
+      __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pa[p], x),
+                                          _mm_mul_ps(pb[p], y)),
+                               _mm_add_ps(_mm_mul_ps(pc[p], z), pd[p]));
+      out = _mm_or_ps(out, _mm_cmpgt_ps(dist, r));
+      partial = _mm_or_ps(partial, _mm_cmpgt_ps(dist, neg_r));
+    }
+
+    store_results4(_mm_movemask_ps(out), _mm_movemask_ps(partial),
+                   results + i);
+  }
+#endif  // BOUNDING_HEXAHEDRON_SSE2
+
+  // Handle the remaining spheres one at a time.
+  for (; i < num_spheres; ++i) {
+    const LPoint3 &center = centers[i];
+    PN_stdfloat radius = radii[i];
+
+    int result = IF_possible | IF_some | IF_all;
+    for (int p = 0; p < num_planes; ++p) {
+      PN_stdfloat dist = _planes[p].dist_to_plane(center);
+      if (dist > radius) {
+        result = IF_no_intersection;
+        break;
+      } else if (dist > -radius) {
+        result &= ~IF_all;
+      }
+    }
+    results[i] = result;
+  }
+}
+
+/**
+ * Tests each of the indicated axis-aligned boxes against this hexahedron, and
+ * stores the results in the results array, which must have room for
+ * num_boxes elements.  Each result is the same as contains() would return
+ * for a BoundingBox with the corresponding corners, but the boxes are tested
+ * several at a time where the hardware supports it.  None of the boxes may
+ * be empty or infinite.
+ */
+void BoundingHexahedron::
+contains_boxes(const LPoint3 *mins, const LPoint3 *maxs,
+               size_t num_boxes, int *results) const {
+  nassertv(!is_empty());
+
+  // Rather than testing all eight corners of each box against each plane,
+  // we compare the distance from the plane to the box's center with the
+  // box's extent along the plane's normal, which tells us the distances to
+  // the nearest and farthest corners.
+  size_t i = 0;
+
+#ifdef BOUNDING_HEXAHEDRON_SSE2
+  __m128 pa[num_planes], pb[num_planes], pc[num_planes], pd[num_planes];
+  __m128 abs_pa[num_planes], abs_pb[num_planes], abs_pc[num_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    pa[p] = _mm_set1_ps(_planes[p][0]);
+    pb[p] = _mm_set1_ps(_planes[p][1]);
+    pc[p] = _mm_set1_ps(_planes[p][2]);
+    pd[p] = _mm_set1_ps(_planes[p][3]);
+    abs_pa[p] = _mm_set1_ps(fabsf(_planes[p][0]));
+    abs_pb[p] = _mm_set1_ps(fabsf(_planes[p][1]));
+    abs_pc[p] = _mm_set1_ps(fabsf(_planes[p][2]));
+  }
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 sign_bit = _mm_set1_ps(-0.0f);
+
+  for (; i + 4 <= num_boxes; i += 4) {
+    __m128 min_x, min_y, min_z, max_x, max_y, max_z;
+    load_points4(mins + i, min_x, min_y, min_z);
+    load_points4(maxs + i, max_x, max_y, max_z);
+
+    __m128 cx = _mm_mul_ps(_mm_add_ps(min_x, max_x), half);
+    __m128 cy = _mm_mul_ps(_mm_add_ps(min_y, max_y), half);
+    __m128 cz = _mm_mul_ps(_mm_add_ps(min_z, max_z), half);
+    __m128 ex = _mm_sub_ps(max_x, cx);
+    __m128 ey = _mm_sub_ps(max_y, cy);
+    __m128 ez = _mm_sub_ps(max_z, cz);
+
+    __m128 out = _mm_setzero_ps();
+    __m128 partial = _mm_setzero_ps();
+    for (int p = 0; p < num_planes; ++p) {
+      __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pa[p], cx),
+                                          _mm_mul_ps(pb[p], cy)),
+                               _mm_add_ps(_mm_mul_ps(pc[p], cz), pd[p]));
+      __m128 extent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_pa[p], ex),
+                                            _mm_mul_ps(abs_pb[p], ey)),
+                                 _mm_mul_ps(abs_pc[p], ez));
+
+      // The box is outside if even its nearest corner is in front of the
+      // plane, and straddles the plane if its farthest corner is.
+      out = _mm_or_ps(out, _mm_cmpge_ps(dist, extent));
+      partial = _mm_or_ps(partial,
+        _mm_cmpge_ps(dist, _mm_xor_ps(extent, sign_bit)));
+    }
+
+    store_results4(_mm_movemask_ps(out), _mm_movemask_ps(partial),
+                   results + i);
+  }
+#endif  // BOUNDING_HEXAHEDRON_SSE2
+
+  // Handle the remaining boxes one at a time.
+  for (; i < num_boxes; ++i) {
+    LPoint3 center = (mins[i] + maxs[i]) * 0.5f;
+    LVector3 extent = maxs[i] - center;
+
+    int result = IF_possible | IF_some | IF_all;
+    for (int p = 0; p < num_planes; ++p) {
+      const LPlane &plane = _planes[p];
+      PN_stdfloat dist = plane.dist_to_plane(center);
+      PN_stdfloat radius =
+        cabs(plane[0]) * extent[0] +
+        cabs(plane[1]) * extent[1] +
+        cabs(plane[2]) * extent[2];
+      if (dist >= radius) {
+        result = IF_no_intersection;
+        break;
+      } else if (dist >= -radius) {
+        result &= ~IF_all;
+      }
+    }
+    results[i] = result;
+  }
+}
+
 /**
  *
  */
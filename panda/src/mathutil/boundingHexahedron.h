@@ -68,6 +68,11 @@ PUBLISHED:
 public:
   virtual const BoundingHexahedron *as_bounding_hexahedron() const;
 
+  void contains_spheres(const LPoint3 *centers, const PN_stdfloat *radii,
+                        size_t num_spheres, int *results) const;
+  void contains_boxes(const LPoint3 *mins, const LPoint3 *maxs,
+                      size_t num_boxes, int *results) const;
+
 protected:
   virtual bool extend_other(BoundingVolume *other) const;
   virtual bool around_other(BoundingVolume *other,
@@ -1,6 +1,7 @@
 #include "boundingHexahedron.cxx"
 #include "boundingLine.cxx"
 #include "boundingBox.cxx"
+#include "boundingBoxTree.cxx"
 #include "boundingPlane.cxx"
 #include "boundingSphere.cxx"
 #include "boundingVolume.cxx"
@@ -0,0 +1,113 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_frustum_batch.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "pandabase.h"
+#include "boundingHexahedron.h"
+#include "boundingSphere.h"
+#include "boundingBox.h"
+#include "frustum.h"
+#include "randomizer.h"
+#include "trueClock.h"
+
+// This program measures the number of bounding volumes per second that can
+// be tested against a view frustum, first one at a time with
+// BoundingVolume::contains(), and then in batches with
+// BoundingHexahedron::contains_spheres() and contains_boxes().  It also
+// checks that both methods agree.
+
+// The number of times to repeat each measurement; the best time is kept.
+static const int num_trials = 10;
+
+int
+main(int argc, char *argv[]) {
+  int num_volumes = 100000;
+  if (argc > 1) {
+    num_volumes = atoi(argv[1]);
+  }
+
+  LFrustum frustum;
+  frustum.make_perspective_hfov(60.0f, 4.0f / 3.0f, 1.0f, 1000.0f);
+  BoundingHexahedron hexahedron(frustum, false);
+
+  // Scatter the volumes around the camera, so that some are inside the
+  // frustum, some are outside and some straddle it.
+  Randomizer random(1);
+  pvector<LPoint3> centers, mins, maxs;
+  pvector<PN_stdfloat> radii;
+  pvector<PT(BoundingSphere)> spheres;
+  pvector<PT(BoundingBox)> boxes;
+  for (int i = 0; i < num_volumes; ++i) {
+    LPoint3 center(random.random_real(2000) - 1000,
+                   random.random_real(2000) - 1000,
+                   random.random_real(200) - 100);
+    PN_stdfloat radius = random.random_real(20) + 0.1f;
+    LVector3 extent(radius, radius * 0.5f, radius * 2.0f);
+    centers.push_back(center);
+    radii.push_back(radius);
+    mins.push_back(center - extent);
+    maxs.push_back(center + extent);
+    spheres.push_back(new BoundingSphere(center, radius));
+    boxes.push_back(new BoundingBox(center - extent, center + extent));
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  pvector<int> single(num_volumes), batched(num_volumes);
+
+  for (int type = 0; type < 2; ++type) {
+    double single_time = 1.0e30;
+    double batch_time = 1.0e30;
+
+    for (int trial = 0; trial < num_trials; ++trial) {
+      double start = clock->get_short_time();
+      for (int i = 0; i < num_volumes; ++i) {
+        if (type == 0) {
+          single[i] = hexahedron.contains(spheres[i]);
+        } else {
+          single[i] = hexahedron.contains(boxes[i]);
+        }
+      }
+      single_time = std::min(single_time, clock->get_short_time() - start);
+
+      start = clock->get_short_time();
+      if (type == 0) {
+        hexahedron.contains_spheres(&centers[0], &radii[0], num_volumes,
+                                    &batched[0]);
+      } else {
+        hexahedron.contains_boxes(&mins[0], &maxs[0], num_volumes,
+                                  &batched[0]);
+      }
+      batch_time = std::min(batch_time, clock->get_short_time() - start);
+    }
+
+    int num_visible = 0;
+    int num_different = 0;
+    for (int i = 0; i < num_volumes; ++i) {
+      if (single[i] != BoundingVolume::IF_no_intersection) {
+        ++num_visible;
+      }
+      if (single[i] != batched[i]) {
+        ++num_different;
+      }
+    }
+
+    nout << (type == 0 ? "spheres" : "boxes") << ": "
+         << num_visible << " of " << num_volumes << " visible\n"
+         << "  one at a time: " << num_volumes / single_time / 1.0e6
+         << " million per second\n"
+         << "  batched:       " << num_volumes / batch_time / 1.0e6
+         << " million per second\n"
+         << "  results differ for " << num_different << " volumes\n";
+  }
+
+  return 0;
+}
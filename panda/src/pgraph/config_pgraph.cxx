@@ -130,6 +130,36 @@ ConfigVariableBool debug_portal_cull
           "(You first need to enable portal culling, using the allow-portal-cull"
           "variable.)"));
 
+ConfigVariableInt cull_batch_min_children
+("cull-batch-min-children", 16,
+ PRC_DESC("When a node has at least this many children, the cull traversal "
+          "tests their bounding volumes against the view frustum in batches, "
+          "using SIMD instructions where available, before visiting any of "
+          "them.  This is much faster than testing each child as it is "
+          "visited when most of the children are outside of the frustum.  "
+          "Set this to 0 to disable batching."));
+
+ConfigVariableInt parallel_cull_depth
+("parallel-cull-depth", 0,
+ PRC_DESC("Set this to a positive number to split the cull traversal of "
+          "each DisplayRegion at the indicated depth below the scene root.  "
+          "The subtrees rooted at that depth are then culled in parallel by "
+          "the threads of the global WorkerPool (see worker-pool-threads), "
+          "and their results are merged in the same order in which a "
+          "single-threaded traversal would have produced them.  This has no "
+          "effect if worker-pool-threads is 0, or when portal culling is "
+          "enabled.  Any cull callbacks in the scene must be thread-safe."));
+
+ConfigVariableBool parallel_animate_vertices
+("parallel-animate-vertices", false,
+ PRC_DESC("Set this true to compute the vertex animation that must be done "
+          "on the CPU, such as the skinning of Actors that cannot be animated "
+          "in hardware, for all of the objects of a cull traversal at once, "
+          "on the threads of the global WorkerPool (see worker-pool-threads), "
+          "rather than one object at a time as they are culled.  Vertex datas "
+          "that share a TransformBlendTable are animated on the same thread.  "
+          "This has no effect if worker-pool-threads is 0."));
+
 ConfigVariableBool show_occluder_volumes
 ("show-occluder-volumes", false,
  PRC_DESC("Set this true to enable debug visualization of the volumes used "
@@ -204,6 +234,27 @@ ConfigVariableDouble garbage_collect_states_rate
           "performance if states accumulate faster than they can be "
           "cleaned up."));
 
+ConfigVariableDouble garbage_collect_states_budget
+("garbage-collect-states-budget", 0.0,
+ PRC_DESC("The maximum amount of time, in microseconds, that each call to "
+          "TransformState::garbage_collect() or RenderState::garbage_collect() "
+          "may spend processing states.  If the time runs out, the "
+          "collection stops early, and the next call resumes where it left "
+          "off.  This trades a slightly slower cleanup of unused states for "
+          "a steadier frame time.  Set this to 0 to impose no limit."));
+
+ConfigVariableInt garbage_collect_states_generations
+("garbage-collect-states-generations", 0,
+ PRC_DESC("The number of generations used by the TransformState and "
+          "RenderState garbage collector.  Each time a state survives "
+          "examination by the collector, it is promoted to the next "
+          "generation, up to this limit; a state in generation n is only "
+          "examined once every 2^n passes over the cache.  This means that "
+          "long-lived states are rarely rescanned, while recently-created "
+          "states, which are the most likely to be discarded, are examined "
+          "on every pass.  Set this to 0 to examine all states on every "
+          "pass.  The maximum is 7."));
+
 ConfigVariableBool transform_cache
 ("transform-cache", true,
  PRC_DESC("Set this true to enable the cache of TransformState objects.  "
@@ -373,6 +424,44 @@ ConfigVariableBool allow_live_flatten
           "only has an effect when Panda is not compiled for a release "
           "build."));
 
+ConfigVariableBool parallel_flatten
+("parallel-flatten", false,
+ PRC_DESC("Set this true to allow the SceneGraphReducer to spread the work "
+          "of flatten(), collect_vertex_data(), unify() and "
+          "remove_unused_vertices() across the threads of the global "
+          "WorkerPool (see worker-pool-threads).  Only subgraphs and vertex "
+          "datas that are not shared with another part of the scene graph "
+          "are processed in parallel, so that the result is the same as "
+          "without this option.  This has no effect if worker-pool-threads "
+          "is 0."));
+
+/**
+ * Returns the value of the composition-cache-shards config variable.  This is
+ * read by TransformState::init_states() and RenderState::init_states(), which
+ * may run at static init time, before the variables in this file have been
+ * constructed.
+ */
+int
+get_composition_cache_shards() {
+  static ConfigVariableInt *composition_cache_shards = nullptr;
+
+  if (composition_cache_shards == nullptr) {
+    composition_cache_shards = new ConfigVariableInt
+      ("composition-cache-shards", 0,
+       PRC_DESC("Set this to a nonzero number to enable a sharded cache in front "
+                "of the TransformState and RenderState composition caches.  "
+                "Lookups in this cache don't need to grab the global state lock, "
+                "which reduces lock contention when several threads (for "
+                "instance, the App, Cull and Draw threads) are composing states "
+                "at the same time.  The value is the number of independently "
+                "locked shards; each shard holds 16 compositions.  The cached "
+                "states are kept alive until they are evicted or clear_cache() "
+                "is called."));
+  }
+
+  return *composition_cache_shards;
+}
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
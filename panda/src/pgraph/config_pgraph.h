@@ -34,6 +34,9 @@ extern ConfigVariableBool fake_view_frustum_cull;
 extern ConfigVariableBool clip_plane_cull;
 extern ConfigVariableBool allow_portal_cull;
 extern ConfigVariableBool debug_portal_cull;
+extern ConfigVariableInt cull_batch_min_children;
+extern ConfigVariableInt parallel_cull_depth;
+extern ConfigVariableBool parallel_animate_vertices;
 extern ConfigVariableBool show_occluder_volumes;
 extern ConfigVariableBool unambiguous_graph;
 extern ConfigVariableBool detect_graph_cycles;
@@ -45,6 +48,8 @@ extern ConfigVariableBool paranoid_const;
 extern ConfigVariableBool auto_break_cycles;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool garbage_collect_states;
 extern ConfigVariableDouble garbage_collect_states_rate;
+extern ConfigVariableDouble garbage_collect_states_budget;
+extern ConfigVariableInt garbage_collect_states_generations;
 extern ConfigVariableBool transform_cache;
 extern ConfigVariableBool state_cache;
 extern ConfigVariableBool uniquify_transforms;
@@ -73,6 +78,9 @@ extern ConfigVariableList load_file_type;
 extern ConfigVariableString default_model_extension;
 
 extern ConfigVariableBool allow_live_flatten;
+extern ConfigVariableBool parallel_flatten;
+
+extern int get_composition_cache_shards();
 
 extern EXPCL_PANDA_PGRAPH void init_libpgraph();
 
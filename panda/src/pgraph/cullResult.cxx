@@ -28,6 +28,7 @@
 #include "config_pgraph.h"
 #include "depthOffsetAttrib.h"
 #include "colorBlendAttrib.h"
+#include "workerPool.h"
 
 TypeHandle CullResult::_type_handle;
 
@@ -51,6 +52,31 @@ TypeHandle CullResult::_type_handle;
 static const PN_stdfloat dual_opaque_level = 252.0 / 256.0;
 static const double bin_color_flash_rate = 1.0;  // 1 state change per second
 
+/**
+ * Computes the CPU vertex animation of a number of GeomVertexDatas, on the
+ * threads of the WorkerPool.  Each item is a group of vertex datas that share
+ * a TransformBlendTable or SliderTable, and so must be animated on the same
+ * thread, since animating them updates the blends in the shared table.
+ */
+class CullResult::AnimateJob : public WorkerPool::Job {
+public:
+  class Entry {
+  public:
+    const GeomVertexData *_data;
+    bool _force;
+  };
+  typedef pvector<Entry> Group;
+  typedef pvector<Group> Groups;
+
+  virtual void run_item(size_t index, Thread *current_thread) {
+    for (const Entry &entry : _groups[index]) {
+      entry._data->animate_vertices(entry._force, current_thread);
+    }
+  }
+
+  Groups _groups;
+};
+
 /**
  *
  */
@@ -67,6 +93,9 @@ CullResult(GraphicsStateGuardianBase *gsg,
 #ifndef NDEBUG
   _show_transparency = show_transparency.get_value();
 #endif
+
+  _parallel_animate = parallel_animate_vertices &&
+    WorkerPool::get_global_ptr()->get_num_threads() > 0;
 }
 
 /**
@@ -137,12 +166,12 @@ add_object(CullableObject *object, const CullTraverser *traverser) {
 
       if (wireframe_part->munge_geom
           (_gsg, _gsg->get_geom_munger(wireframe_part->_state, current_thread),
-           traverser, force)) {
+           traverser, force, !_parallel_animate)) {
         int wireframe_bin_index = bin_manager->find_bin("fixed");
         CullBin *bin = get_bin(wireframe_bin_index);
         nassertv(bin != nullptr);
         check_flash_bin(wireframe_part->_state, bin_manager, wireframe_bin_index);
-        bin->add_object(wireframe_part, current_thread);
+        add_to_bin(bin, wireframe_part, force, current_thread);
       } else {
         delete wireframe_part;
       }
@@ -208,12 +237,12 @@ add_object(CullableObject *object, const CullTraverser *traverser) {
               transparent_part->_state = object->_state->compose(transparent_state);
               if (transparent_part->munge_geom
                   (_gsg, _gsg->get_geom_munger(transparent_part->_state, current_thread),
-                   traverser, force)) {
+                   traverser, force, !_parallel_animate)) {
                 int transparent_bin_index = transparent_part->_state->get_bin_index();
                 CullBin *bin = get_bin(transparent_bin_index);
                 nassertv(bin != nullptr);
                 check_flash_bin(transparent_part->_state, bin_manager, transparent_bin_index);
-                bin->add_object(transparent_part, current_thread);
+                add_to_bin(bin, transparent_part, force, current_thread);
               } else {
                 delete transparent_part;
               }
@@ -246,11 +275,12 @@ add_object(CullableObject *object, const CullTraverser *traverser) {
 
   // Munge vertices as needed for the GSG's requirements, and the object's
   // current state.
-  if (object->munge_geom(_gsg, _gsg->get_geom_munger(object->_state, current_thread), traverser, force)) {
+  if (object->munge_geom(_gsg, _gsg->get_geom_munger(object->_state, current_thread),
+                         traverser, force, !_parallel_animate)) {
     // The object may or may not now be fully resident, but this may not
     // matter, since the GSG may have the necessary buffers already loaded.
     // We'll let the GSG ultimately decide whether to render it.
-    bin->add_object(object, current_thread);
+    add_to_bin(bin, object, force, current_thread);
   } else {
     delete object;
   }
@@ -263,6 +293,10 @@ add_object(CullableObject *object, const CullTraverser *traverser) {
  */
 void CullResult::
 finish_cull(SceneSetup *scene_setup, Thread *current_thread) {
+  if (!_pending.empty()) {
+    animate_pending(current_thread);
+  }
+
   CullBinManager *bin_manager = CullBinManager::get_global_ptr();
 
   for (size_t i = 0; i < _bins.size(); ++i) {
@@ -280,6 +314,79 @@ finish_cull(SceneSetup *scene_setup, Thread *current_thread) {
   }
 }
 
+/**
+ * Adds a munged object to the indicated bin, or, if its vertex animation
+ * has been deferred to finish_cull(), queues it up to be added then.
+ */
+void CullResult::
+add_to_bin(CullBin *bin, CullableObject *object, bool force,
+           Thread *current_thread) {
+  if (_parallel_animate) {
+    bool animate = false;
+    if (object->_munged_data != nullptr) {
+      const GeomVertexFormat *format = object->_munged_data->get_format();
+      animate = (format->get_animation().get_animation_type() == Geom::AT_panda);
+    }
+    if (animate || !_pending.empty()) {
+      _pending.push_back({object, bin, force, animate});
+      return;
+    }
+  }
+
+  bin->add_object(object, current_thread);
+}
+
+/**
+ * Animates the vertices of all of the objects whose animation was deferred
+ * by add_to_bin(), using the threads of the WorkerPool, and then adds the
+ * pending objects to their bins, in order.
+ */
+void CullResult::
+animate_pending(Thread *current_thread) {
+  AnimateJob job;
+  {
+    // Each vertex data only needs to be animated once, even if several
+    // objects (or several Geoms) share it.
+    pset<const GeomVertexData *> seen;
+    pmap<const void *, size_t> group_index;
+    for (const PendingObject &pending : _pending) {
+      if (!pending._animate) {
+        continue;
+      }
+      const GeomVertexData *data = pending._object->_munged_data;
+      if (!seen.insert(data).second) {
+        continue;
+      }
+
+      CPT(TransformBlendTable) table = data->get_transform_blend_table();
+      const void *key = table.p();
+      if (key == nullptr) {
+        key = data->get_slider_table();
+        if (key == nullptr) {
+          key = data;
+        }
+      }
+      auto result = group_index.insert(std::make_pair(key, job._groups.size()));
+      if (result.second) {
+        job._groups.push_back(AnimateJob::Group());
+      }
+      job._groups[result.first->second].push_back({data, pending._force});
+    }
+  }
+
+  WorkerPool::get_global_ptr()->run(job, job._groups.size(), current_thread);
+
+  // Now that the animated vertices have been computed, this just picks up
+  // the cached results, and may also change the state of the object.
+  for (const PendingObject &pending : _pending) {
+    if (pending._animate) {
+      pending._object->animate_vertices(pending._force, current_thread);
+    }
+    pending._bin->add_object(pending._object, current_thread);
+  }
+  _pending.clear();
+}
+
 /**
  * Asks all the bins to draw themselves in the correct order.
  */
@@ -79,12 +79,34 @@ private:
   static const RenderState *get_wireframe_filled_state();
   static CPT(RenderState) get_wireframe_overlay_state(const RenderModeAttrib *rmode);
 
+  void add_to_bin(CullBin *bin, CullableObject *object, bool force,
+                  Thread *current_thread);
+  void animate_pending(Thread *current_thread);
+
   GraphicsStateGuardianBase *_gsg;
   PStatCollector _draw_region_pcollector;
 
   typedef pvector< PT(CullBin) > Bins;
   Bins _bins;
 
+  // With parallel-animate-vertices, the objects that still need their
+  // vertices animated on the CPU, and all of the objects that were added
+  // after the first of those, are held here until finish_cull().  This way
+  // the animation can all be done at once, and the bins still receive the
+  // objects in the order in which they were added.
+  class PendingObject {
+  public:
+    CullableObject *_object;
+    CullBin *_bin;
+    bool _force;
+    bool _animate;
+  };
+  typedef pvector<PendingObject> PendingObjects;
+  PendingObjects _pending;
+  bool _parallel_animate;
+
+  class AnimateJob;
+
 #ifndef NDEBUG
   bool _show_transparency;
 #endif
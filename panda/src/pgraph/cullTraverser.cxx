@@ -34,6 +34,7 @@
 #include "geomLinestrips.h"
 #include "geomLines.h"
 #include "geomVertexWriter.h"
+#include "cullPlanes.h"
 
 PStatCollector CullTraverser::_nodes_pcollector("Nodes");
 PStatCollector CullTraverser::_geom_nodes_pcollector("Nodes:GeomNodes");
@@ -42,6 +43,70 @@ PStatCollector CullTraverser::_geoms_occluded_pcollector("Geoms:Occluded");
 
 TypeHandle CullTraverser::_type_handle;
 
+/**
+ * A CullHandler that simply holds on to the objects it is given, so that
+ * they can be passed on to the real CullHandler later, in a well-defined
+ * order.
+ */
+class BufferedCullHandler : public CullHandler {
+public:
+  virtual void record_object(CullableObject *object,
+                             const CullTraverser *traverser);
+
+  typedef pvector<CullableObject *> Objects;
+  Objects _objects;
+};
+
+/**
+ * A subtree whose traversal has been deferred, to be performed by one of the
+ * threads of the WorkerPool.  This stores everything needed to pick up the
+ * traversal where it left off.
+ */
+class CullTraverser::SplitTask {
+public:
+  NodePath _node_path;
+  CPT(TransformState) _net_transform;
+  CPT(RenderState) _state;
+  PT(GeometricBoundingVolume) _view_frustum;
+  CPT(CullPlanes) _cull_planes;
+  DrawMask _draw_mask;
+  int _portal_depth;
+
+  // The number of objects that had been recorded by the serial part of the
+  // traversal when this subtree was encountered.  This subtree's objects
+  // are inserted at this point when the results are merged.
+  size_t _insert_point;
+
+  BufferedCullHandler _handler;
+};
+
+/**
+ * The state of a parallel traversal in progress.
+ */
+class CullTraverser::ParallelTraversal {
+public:
+  int _split_depth;
+  BufferedCullHandler _handler;
+
+  typedef pvector<SplitTask> Tasks;
+  Tasks _tasks;
+};
+
+/**
+ * Traverses the subtrees collected in a ParallelTraversal, each with its own
+ * copy of the CullTraverser.
+ */
+class CullTraverser::ParallelJob : public WorkerPool::Job {
+public:
+  ParallelJob(const CullTraverser *trav, ParallelTraversal *parallel) :
+    _trav(trav), _parallel(parallel) {}
+
+  virtual void run_item(size_t index, Thread *current_thread);
+
+  const CullTraverser *_trav;
+  ParallelTraversal *_parallel;
+};
+
 /**
  *
  */
@@ -56,6 +121,8 @@ CullTraverser() :
   _cull_handler = nullptr;
   _portal_clipper = nullptr;
   _effective_incomplete_render = true;
+  _parallel = nullptr;
+  _depth = 0;
 }
 
 /**
@@ -73,7 +140,9 @@ CullTraverser(const CullTraverser &copy) :
   _view_frustum(copy._view_frustum),
   _cull_handler(copy._cull_handler),
   _portal_clipper(copy._portal_clipper),
-  _effective_incomplete_render(copy._effective_incomplete_render)
+  _effective_incomplete_render(copy._effective_incomplete_render),
+  _parallel(nullptr),
+  _depth(0)
 {
 }
 
@@ -150,6 +219,16 @@ traverse(const NodePath &root) {
                            _initial_state, _view_frustum,
                            _current_thread);
 
+    // Only a plain CullTraverser can be split up; a derived class may keep
+    // state of its own during the traversal.
+    if (parallel_cull_depth > 0 && get_type() == get_class_type()) {
+      WorkerPool *pool = WorkerPool::get_global_ptr();
+      if (pool->get_num_threads() > 0) {
+        do_parallel_traverse(data, pool);
+        return;
+      }
+    }
+
     do_traverse(data);
   }
 }
@@ -196,8 +275,27 @@ traverse_below(CullTraverserData &data) {
   // Now visit all the node's children.
   PandaNode::Children children = node_reader->get_children();
   node_reader->release();
+
+  if (_parallel != nullptr && _depth + 1 == _parallel->_split_depth) {
+    // Leave the children for the worker threads.
+    split_children(data, children);
+    return;
+  }
+
+  ++_depth;
   int num_children = children.get_num_children();
-  if (!node->has_selective_visibility()) {
+  const BoundingHexahedron *frustum = nullptr;
+  int batch_min_children = cull_batch_min_children;
+  if (batch_min_children > 0 && num_children >= batch_min_children &&
+      data._view_frustum != nullptr &&
+      !fake_view_frustum_cull && get_type() == get_class_type()) {
+    frustum = data._view_frustum->as_bounding_hexahedron();
+  }
+
+  if (frustum != nullptr && !node->has_selective_visibility()) {
+    traverse_children_batched(data, frustum, children);
+
+  } else if (!node->has_selective_visibility()) {
     for (int i = 0; i < num_children; ++i) {
       CullTraverserData next_data(data, children.get_child(i));
       do_traverse(next_data);
@@ -210,6 +308,78 @@ traverse_below(CullTraverserData &data) {
       i = node->get_next_visible_child(i);
     }
   }
+  --_depth;
+}
+
+/**
+ * Visits the indicated children, which all have the same parent, after first
+ * testing their bounding volumes against the view frustum several at a time.
+ * The children that are found to be outside of the frustum are skipped
+ * without further ado; the rest are traversed normally.
+ */
+void CullTraverser::
+traverse_children_batched(CullTraverserData &data,
+                          const BoundingHexahedron *frustum,
+                          const PandaNode::Children &children) {
+  static const int batch_size = 64;
+
+  LPoint3 centers[batch_size];
+  PN_stdfloat radii[batch_size];
+  int sphere_indices[batch_size];
+  LPoint3 mins[batch_size];
+  LPoint3 maxs[batch_size];
+  int box_indices[batch_size];
+  int results[batch_size];
+  bool culled[batch_size];
+
+  int num_children = children.get_num_children();
+  for (int first = 0; first < num_children; first += batch_size) {
+    int count = std::min(batch_size, num_children - first);
+    int num_spheres = 0;
+    int num_boxes = 0;
+
+    for (int i = 0; i < count; ++i) {
+      culled[i] = false;
+      CPT(BoundingVolume) bounds =
+        children.get_child(first + i)->get_bounds(_current_thread);
+
+      if (bounds->is_empty()) {
+        culled[i] = true;
+
+      } else if (!bounds->is_infinite()) {
+        // Anything other than a sphere or a box is left for the normal test.
+        const BoundingSphere *sphere = bounds->as_bounding_sphere();
+        if (sphere != nullptr) {
+          centers[num_spheres] = sphere->get_center();
+          radii[num_spheres] = sphere->get_radius();
+          sphere_indices[num_spheres++] = i;
+        } else {
+          const BoundingBox *box = bounds->as_bounding_box();
+          if (box != nullptr) {
+            mins[num_boxes] = box->get_minq();
+            maxs[num_boxes] = box->get_maxq();
+            box_indices[num_boxes++] = i;
+          }
+        }
+      }
+    }
+
+    frustum->contains_spheres(centers, radii, num_spheres, results);
+    for (int j = 0; j < num_spheres; ++j) {
+      culled[sphere_indices[j]] = (results[j] == BoundingVolume::IF_no_intersection);
+    }
+    frustum->contains_boxes(mins, maxs, num_boxes, results);
+    for (int j = 0; j < num_boxes; ++j) {
+      culled[box_indices[j]] = (results[j] == BoundingVolume::IF_no_intersection);
+    }
+
+    for (int i = 0; i < count; ++i) {
+      if (!culled[i]) {
+        CullTraverserData next_data(data, children.get_child(first + i));
+        do_traverse(next_data);
+      }
+    }
+  }
 }
 
 /**
@@ -221,6 +391,89 @@ end_traverse() {
   _cull_handler->end_traverse();
 }
 
+/**
+ * Performs the traversal begun by traverse(), but hands off the subtrees at
+ * depth parallel-cull-depth to the indicated WorkerPool.  The nodes above
+ * that depth are traversed by the current thread first.
+ *
+ * Each subtree records its objects into a separate buffer.  When all of them
+ * are done, the buffers are passed on to the real CullHandler in the same
+ * order in which a serial traversal would have produced them, so the result
+ * does not depend on the number of threads or on how the work was divided.
+ */
+void CullTraverser::
+do_parallel_traverse(CullTraverserData &data, WorkerPool *pool) {
+  ParallelTraversal parallel;
+  parallel._split_depth = parallel_cull_depth;
+
+  CullHandler *cull_handler = _cull_handler;
+  _cull_handler = &parallel._handler;
+  _parallel = &parallel;
+  _depth = 0;
+
+  do_traverse(data);
+
+  _parallel = nullptr;
+  _cull_handler = cull_handler;
+
+  if (!parallel._tasks.empty()) {
+    ParallelJob job(this, &parallel);
+    pool->run(job, parallel._tasks.size(), _current_thread);
+  }
+
+  // Now merge the results.
+  const BufferedCullHandler::Objects &objects = parallel._handler._objects;
+  size_t oi = 0;
+  for (const SplitTask &task : parallel._tasks) {
+    for (; oi < task._insert_point; ++oi) {
+      _cull_handler->record_object(objects[oi], this);
+    }
+    for (CullableObject *object : task._handler._objects) {
+      _cull_handler->record_object(object, this);
+    }
+  }
+  for (; oi < objects.size(); ++oi) {
+    _cull_handler->record_object(objects[oi], this);
+  }
+}
+
+/**
+ * Called by traverse_below() during a parallel traversal, when it reaches the
+ * depth at which the traversal is split.  Rather than visiting the children,
+ * records a SplitTask for each one, to be traversed later by a worker thread.
+ */
+void CullTraverser::
+split_children(CullTraverserData &data, const PandaNode::Children &children) {
+  // The worker threads won't have our CullTraverserData chain, so they'll
+  // need an actual NodePath to start from.
+  NodePath node_path = data.get_node_path();
+  PandaNode *node = data.node();
+
+  ParallelTraversal::Tasks &tasks = _parallel->_tasks;
+  size_t insert_point = _parallel->_handler._objects.size();
+
+  int num_children = children.get_num_children();
+  int i = node->has_selective_visibility() ? node->get_first_visible_child() : 0;
+  while (i < num_children) {
+    tasks.push_back(SplitTask());
+    SplitTask &task = tasks.back();
+    task._node_path = NodePath(node_path, children.get_child(i), _current_thread);
+    task._net_transform = data._net_transform;
+    task._state = data._state;
+    task._view_frustum = data._view_frustum;
+    task._cull_planes = data._cull_planes;
+    task._draw_mask = data._draw_mask;
+    task._portal_depth = data._portal_depth;
+    task._insert_point = insert_point;
+
+    if (node->has_selective_visibility()) {
+      i = node->get_next_visible_child(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
 /**
  * Draws an appropriate visualization of the indicated bounding volume.
  */
@@ -531,3 +784,36 @@ get_depth_offset_state() {
   }
   return state;
 }
+
+/**
+ *
+ */
+void BufferedCullHandler::
+record_object(CullableObject *object, const CullTraverser *traverser) {
+  _objects.push_back(object);
+}
+
+/**
+ * Traverses the subtree of the indicated SplitTask.  This is called by each
+ * of the threads of the WorkerPool in turn.
+ */
+void CullTraverser::ParallelJob::
+run_item(size_t index, Thread *current_thread) {
+  SplitTask &task = _parallel->_tasks[index];
+
+  CullTraverser trav(*_trav);
+  trav.local_object();
+  trav._current_thread = current_thread;
+  trav._cull_handler = &task._handler;
+
+  CullTraverserData data(task._node_path, task._net_transform, task._state,
+                         task._view_frustum, current_thread);
+  data._cull_planes = task._cull_planes;
+  data._draw_mask = task._draw_mask;
+  data._portal_depth = task._portal_depth;
+  if (!data._cull_planes->is_empty()) {
+    data._node_reader.check_cached(true);
+  }
+
+  trav.do_traverse(data);
+}
@@ -27,6 +27,7 @@
 #include "typedReferenceCount.h"
 #include "pStatCollector.h"
 #include "fogAttrib.h"
+#include "workerPool.h"
 
 class GraphicsStateGuardian;
 class PandaNode;
@@ -101,6 +102,17 @@ public:
   static PStatCollector _geoms_occluded_pcollector;
 
 private:
+  class SplitTask;
+  class ParallelTraversal;
+  class ParallelJob;
+
+  void do_parallel_traverse(CullTraverserData &data, WorkerPool *pool);
+  void split_children(CullTraverserData &data,
+                      const PandaNode::Children &children);
+  void traverse_children_batched(CullTraverserData &data,
+                                 const BoundingHexahedron *frustum,
+                                 const PandaNode::Children &children);
+
   void show_bounds(CullTraverserData &data, bool tight);
   static PT(Geom) make_bounds_viz(const BoundingVolume *vol);
   PT(Geom) make_tight_bounds_viz(PandaNode *node) const;
@@ -122,6 +134,10 @@ private:
   PortalClipper *_portal_clipper;
   bool _effective_incomplete_render;
 
+  // These are only used during a parallel traversal.
+  ParallelTraversal *_parallel;
+  int _depth;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
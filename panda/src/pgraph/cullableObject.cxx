@@ -49,10 +49,14 @@ TypeHandle CullableObject::_type_handle;
  * If force is false, this may do nothing and return false if the vertex data
  * is nonresident.  If force is true, this will always return true, but it may
  * have to block while the vertex data is paged in.
+ *
+ * If animate is false, any vertex animation that must be computed on the CPU
+ * is left undone, and the caller must call animate_vertices() later, before
+ * the object is drawn.
  */
 bool CullableObject::
 munge_geom(GraphicsStateGuardianBase *gsg, GeomMunger *munger,
-           const CullTraverser *traverser, bool force) {
+           const CullTraverser *traverser, bool force, bool animate) {
   nassertr(munger != nullptr, false);
 
   Thread *current_thread = traverser->get_current_thread();
@@ -164,32 +168,44 @@ munge_geom(GraphicsStateGuardianBase *gsg, GeomMunger *munger,
     // If there is any animation left in the vertex data after it has been
     // munged--that is, we couldn't arrange to handle the animation in
     // hardware--then we have to calculate that animation now.
-    bool cpu_animated = false;
-
-    CPT(GeomVertexData) animated_vertices =
-      _munged_data->animate_vertices(force, current_thread);
-    if (animated_vertices != _munged_data) {
-      cpu_animated = true;
-      std::swap(_munged_data, animated_vertices);
+    if (animate) {
+      animate_vertices(force, current_thread);
     }
+  }
+
+  return true;
+}
+
+/**
+ * Computes the vertex animation that the munged vertex data still requires
+ * on the CPU, if any, and replaces the munged data with the result.  This is
+ * normally done by munge_geom(), unless it was asked not to.
+ */
+void CullableObject::
+animate_vertices(bool force, Thread *current_thread) {
+  bool cpu_animated = false;
+
+  CPT(GeomVertexData) animated_vertices =
+    _munged_data->animate_vertices(force, current_thread);
+  if (animated_vertices != _munged_data) {
+    cpu_animated = true;
+    std::swap(_munged_data, animated_vertices);
+  }
 
 #ifndef NDEBUG
-    if (show_vertex_animation) {
-      GeomVertexDataPipelineReader data_reader(_munged_data, current_thread);
-      bool hardware_animated = (data_reader.get_format()->get_animation().get_animation_type() == Geom::AT_hardware);
-      if (cpu_animated || hardware_animated) {
-        // These vertices were animated, so flash them red or blue.
-        static const double flash_rate = 1.0;  // 1 state change per second
-        int cycle = (int)(ClockObject::get_global_clock()->get_frame_time() * flash_rate);
-        if ((cycle & 1) == 0) {
-          _state = cpu_animated ? get_flash_cpu_state() : get_flash_hardware_state();
-        }
+  if (show_vertex_animation) {
+    GeomVertexDataPipelineReader data_reader(_munged_data, current_thread);
+    bool hardware_animated = (data_reader.get_format()->get_animation().get_animation_type() == Geom::AT_hardware);
+    if (cpu_animated || hardware_animated) {
+      // These vertices were animated, so flash them red or blue.
+      static const double flash_rate = 1.0;  // 1 state change per second
+      int cycle = (int)(ClockObject::get_global_clock()->get_frame_time() * flash_rate);
+      if ((cycle & 1) == 0) {
+        _state = cpu_animated ? get_flash_cpu_state() : get_flash_hardware_state();
       }
     }
-#endif
   }
-
-  return true;
+#endif
 }
 
 /**
@@ -48,7 +48,9 @@ public:
   INLINE void operator = (const CullableObject &copy);
 
   bool munge_geom(GraphicsStateGuardianBase *gsg, GeomMunger *munger,
-                  const CullTraverser *traverser, bool force);
+                  const CullTraverser *traverser, bool force,
+                  bool animate = true);
+  void animate_vertices(bool force, Thread *current_thread);
   INLINE void draw(GraphicsStateGuardianBase *gsg,
                    bool force, Thread *current_thread);
 
@@ -30,6 +30,8 @@
 #include "textureAttrib.h"
 #include "colorAttrib.h"
 #include "config_pgraph.h"
+#include "workerPool.h"
+#include "pset.h"
 
 PStatCollector GeomTransformer::_apply_vertex_collector("*:Flatten:apply:vertex");
 PStatCollector GeomTransformer::_apply_texcoord_collector("*:Flatten:apply:texcoord");
@@ -40,6 +42,32 @@ PStatCollector GeomTransformer::_apply_set_format_collector("*:Flatten:apply:set
 
 TypeHandle GeomTransformer::NewCollectedData::_type_handle;
 
+/**
+ * Removes the unused vertices from several GeomVertexDatas at once, one per
+ * item.  See finish_apply_parallel().
+ */
+class GeomTransformer::ApplyJob : public WorkerPool::Job {
+public:
+  virtual void run_item(size_t index, Thread *current_thread);
+
+  pvector<VertexDataAssocMap::iterator> _assocs;
+};
+
+/**
+ * Builds several collected GeomVertexDatas at once, one per item.  See
+ * finish_collect_parallel().
+ */
+class GeomTransformer::CollectJob : public WorkerPool::Job {
+public:
+  CollectJob(bool format_only) : _format_only(format_only) {}
+
+  virtual void run_item(size_t index, Thread *current_thread);
+
+  bool _format_only;
+  NewCollectedList _ncds;
+  vector_int _num_adjusted;
+};
+
 /**
  *
  */
@@ -911,12 +939,18 @@ reverse(GeomNode *node) {
  */
 void GeomTransformer::
 finish_apply() {
-  VertexDataAssocMap::iterator vi;
-  for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
-    const GeomVertexData *vdata = (*vi).first;
-    VertexDataAssoc &assoc = (*vi).second;
-    if (assoc._might_have_unused) {
-      assoc.remove_unused_vertices(vdata);
+  WorkerPool *pool = SceneGraphReducer::get_parallel_pool();
+  if (pool != nullptr) {
+    finish_apply_parallel(pool);
+
+  } else {
+    VertexDataAssocMap::iterator vi;
+    for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
+      const GeomVertexData *vdata = (*vi).first;
+      VertexDataAssoc &assoc = (*vi).second;
+      if (assoc._might_have_unused) {
+        assoc.remove_unused_vertices(vdata);
+      }
     }
   }
   _vdata_assoc.clear();
@@ -1091,17 +1125,29 @@ int GeomTransformer::
 finish_collect(bool format_only) {
   int num_adjusted = 0;
 
+  WorkerPool *pool = SceneGraphReducer::get_parallel_pool();
+  if (pool != nullptr && _new_collected_list.size() >= 2) {
+    num_adjusted = finish_collect_parallel(format_only, pool);
+
+  } else {
+    NewCollectedList::iterator nci;
+    for (nci = _new_collected_list.begin();
+         nci != _new_collected_list.end();
+         ++nci) {
+      NewCollectedData *ncd = (*nci);
+      if (format_only) {
+        num_adjusted += ncd->apply_format_only_changes();
+      } else {
+        num_adjusted += ncd->apply_collect_changes();
+      }
+    }
+  }
+
   NewCollectedList::iterator nci;
   for (nci = _new_collected_list.begin();
        nci != _new_collected_list.end();
        ++nci) {
-    NewCollectedData *ncd = (*nci);
-    if (format_only) {
-      num_adjusted += ncd->apply_format_only_changes();
-    } else {
-      num_adjusted += ncd->apply_collect_changes();
-    }
-    delete ncd;
+    delete (*nci);
   }
 
   _new_collected_list.clear();
@@ -1111,6 +1157,112 @@ finish_collect(bool format_only) {
   return num_adjusted;
 }
 
+/**
+ * The parallel implementation of finish_apply().  Each GeomVertexData is
+ * processed on the indicated WorkerPool, unless the same Geom was registered
+ * with more than one of them, in which case they are all processed on the
+ * calling thread instead.
+ */
+void GeomTransformer::
+finish_apply_parallel(WorkerPool *pool) {
+  ApplyJob job;
+  pset<Geom *> geoms;
+  bool independent = true;
+
+  VertexDataAssocMap::iterator vi;
+  for (vi = _vdata_assoc.begin();
+       vi != _vdata_assoc.end() && independent;
+       ++vi) {
+    VertexDataAssoc &assoc = (*vi).second;
+    if (assoc._might_have_unused) {
+      job._assocs.push_back(vi);
+
+      // A Geom may appear more than once in the same list, but not in two
+      // different lists.
+      pset<Geom *> assoc_geoms;
+      for (Geom *geom : assoc._geoms) {
+        if (assoc_geoms.insert(geom).second && !geoms.insert(geom).second) {
+          independent = false;
+          break;
+        }
+      }
+    }
+  }
+
+  if (independent) {
+    pool->run(job, job._assocs.size());
+    return;
+  }
+
+  for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
+    const GeomVertexData *vdata = (*vi).first;
+    VertexDataAssoc &assoc = (*vi).second;
+    if (assoc._might_have_unused) {
+      assoc.remove_unused_vertices(vdata);
+    }
+  }
+}
+
+/**
+ * The parallel implementation of finish_collect().  Each of the new
+ * GeomVertexDatas is built on the indicated WorkerPool, except for those
+ * that need a TransformTable or SliderTable, which are built afterwards on
+ * the calling thread.  Does not delete the NewCollectedData objects.
+ */
+int GeomTransformer::
+finish_collect_parallel(bool format_only, WorkerPool *pool) {
+  CollectJob job(format_only);
+  NewCollectedList serial_ncds;
+
+  NewCollectedList::iterator nci;
+  for (nci = _new_collected_list.begin();
+       nci != _new_collected_list.end();
+       ++nci) {
+    NewCollectedData *ncd = (*nci);
+    if (!format_only && ncd->has_registered_tables()) {
+      serial_ncds.push_back(ncd);
+    } else {
+      job._ncds.push_back(ncd);
+    }
+  }
+
+  job._num_adjusted.assign(job._ncds.size(), 0);
+  pool->run(job, job._ncds.size());
+
+  int num_adjusted = 0;
+  for (int n : job._num_adjusted) {
+    num_adjusted += n;
+  }
+
+  for (nci = serial_ncds.begin(); nci != serial_ncds.end(); ++nci) {
+    num_adjusted += (*nci)->apply_collect_changes();
+  }
+
+  return num_adjusted;
+}
+
+/**
+ * Removes the unused vertices from the indicated GeomVertexData.
+ */
+void GeomTransformer::ApplyJob::
+run_item(size_t index, Thread *current_thread) {
+  VertexDataAssocMap::iterator vi = _assocs[index];
+  (*vi).second.remove_unused_vertices((*vi).first);
+}
+
+/**
+ * Applies the changes for the indicated NewCollectedData.
+ */
+void GeomTransformer::CollectJob::
+run_item(size_t index, Thread *current_thread) {
+  NewCollectedData *ncd = _ncds[index];
+  if (_format_only) {
+    _num_adjusted[index] = ncd->apply_format_only_changes();
+  } else {
+    _num_adjusted[index] = ncd->apply_collect_changes();
+  }
+}
+
 /**
  * Uses the indicated munger to premunge the given Geom to optimize it for
  * eventual rendering.  See SceneGraphReducer::premunge().
@@ -1146,6 +1298,26 @@ NewCollectedData(const GeomVertexData *source_data) {
   _num_vertices = 0;
 }
 
+/**
+ * Returns true if any of the source datas has a TransformTable or a
+ * SliderTable.  Combining these means registering a new table, which
+ * modifies the VertexTransform and VertexSlider objects that may also be
+ * referenced by other NewCollectedData objects, so this must not be done in
+ * parallel with them.
+ */
+bool GeomTransformer::NewCollectedData::
+has_registered_tables() const {
+  SourceDatas::const_iterator sdi;
+  for (sdi = _source_datas.begin(); sdi != _source_datas.end(); ++sdi) {
+    const GeomVertexData *vdata = (*sdi)._vdata;
+    if (vdata->get_transform_table() != nullptr ||
+        vdata->get_slider_table() != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /**
  * Actually adjusts the GeomVertexDatas found in a collect_vertex_data()
  * format-only call to have the same vertex format.  Returns the number of
@@ -26,6 +26,7 @@ class RenderState;
 class InternalName;
 class GeomMunger;
 class Texture;
+class WorkerPool;
 
 /**
  * An object specifically designed to transform the vertices of a Geom without
@@ -91,6 +92,9 @@ public:
   PT(Geom) premunge_geom(const Geom *geom, GeomMunger *munger);
 
 private:
+  void finish_apply_parallel(WorkerPool *pool);
+  int finish_collect_parallel(bool format_only, WorkerPool *pool);
+
   int _max_collect_vertices;
 
   typedef pvector<PT(Geom) > GeomList;
@@ -218,6 +222,7 @@ private:
 
     NewCollectedData(const GeomVertexData *source_data);
     void add_source_data(const GeomVertexData *source_data);
+    bool has_registered_tables() const;
     int apply_format_only_changes();
     int apply_collect_changes();
 
@@ -264,6 +269,9 @@ private:
   typedef pmap<CPT(GeomVertexData), AlreadyCollectedData> AlreadyCollectedMap;
   AlreadyCollectedMap _already_collected_map;
 
+  class ApplyJob;
+  class CollectJob;
+
   static PStatCollector _apply_vertex_collector;
   static PStatCollector _apply_texcoord_collector;
   static PStatCollector _apply_set_color_collector;
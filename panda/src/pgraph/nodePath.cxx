@@ -5555,6 +5555,41 @@ flatten_strong() {
   return num_removed;
 }
 
+/**
+ * An alternative to flatten_strong() for large, static environments.  This
+ * applies all of the transforms to the vertices, as in flatten_medium(), and
+ * then regroups the geometry into spatial clusters, each of which has no more
+ * than approximately max_triangles triangles and is no larger than cell_size
+ * along any axis, arranged into a balanced hierarchy.
+ *
+ * This keeps the number of Geoms low, as flatten_strong() does, while still
+ * allowing the parts of the environment that are out of view to be culled
+ * efficiently.  See SceneGraphReducer::make_clusters() for the details.
+ * Nodes with special properties, and the geometry below them, are left
+ * alone.
+ *
+ * The return value is the number of clusters created.
+ */
+int NodePath::
+flatten_clustered(PN_stdfloat cell_size, int max_triangles) {
+  nassertr_always(!is_empty(), 0);
+  SceneGraphReducer gr;
+  gr.apply_attribs(node());
+
+  gr.set_cluster_cell_size(cell_size);
+  gr.set_cluster_max_triangles(max_triangles);
+  int num_clusters = gr.make_clusters(node());
+
+  if (flatten_geoms) {
+    // CVD_one_node_only keeps the clusters apart.
+    gr.make_compatible_state(node());
+    gr.collect_vertex_data(node(), ~(SceneGraphReducer::CVD_format | SceneGraphReducer::CVD_name | SceneGraphReducer::CVD_animation_type));
+    gr.unify(node(), false);
+  }
+
+  return num_clusters;
+}
+
 /**
  * Removes textures from Geoms at this node and below by applying the texture
  * colors to the vertices.  This is primarily useful to simplify a low-LOD
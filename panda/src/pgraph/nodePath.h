@@ -908,6 +908,7 @@ PUBLISHED:
   int flatten_light();
   int flatten_medium();
   int flatten_strong();
+  int flatten_clustered(PN_stdfloat cell_size, int max_triangles = 4096);
   void apply_texture_colors();
   INLINE int clear_model_nodes();
 
@@ -31,6 +31,7 @@
 #include "deletedChain.h"
 #include "simpleHashMap.h"
 #include "cacheStats.h"
+#include "shardedCompositionCache.h"
 #include "renderAttribRegistry.h"
 
 class FactoryParams;
@@ -191,6 +192,8 @@ private:
 
   static CPT(RenderState) return_new(RenderState *state);
   static CPT(RenderState) return_unique(RenderState *state);
+  CPT(RenderState) do_cached_compose(const RenderState *other) const;
+  CPT(RenderState) do_cached_invert_compose(const RenderState *other) const;
   CPT(RenderState) do_compose(const RenderState *other) const;
   CPT(RenderState) do_invert_compose(const RenderState *other) const;
   void detect_and_break_cycles();
@@ -235,11 +238,23 @@ private:
   static States *_states;
   static const RenderState *_empty_state;
 
+  // These front the per-object composition caches, so that repeated
+  // compositions can be answered without grabbing _states_lock.  They are
+  // disabled unless composition-cache-shards is set.
+  typedef ShardedCompositionCache<RenderState> CompositionShards;
+  static CompositionShards _composition_shards;
+  static CompositionShards _invert_composition_shards;
+
   // This iterator records the entry corresponding to this RenderState object
   // in the above global set.  We keep the index around so we can remove it
   // when the RenderState destructs.
   int _saved_entry;
 
+  // The number of garbage collection passes this state has survived, up to
+  // garbage-collect-states-generations; see garbage_collect().  This fits in
+  // the padding after _saved_entry.
+  unsigned char _gc_generation;
+
   // This data structure manages the job of caching the composition of two
   // RenderStates.  It's complicated because we have to be sure to remove the
   // entry if *either* of the input RenderStates destructs.  To implement
@@ -277,6 +292,11 @@ private:
   typedef SimpleHashMap<size_t, WCPT(RenderState), size_t_hash> MungedStates;
   mutable MungedStates _munged_states;
 
+  // This protects _mungers, _last_mi and _munged_states of all states, since
+  // several threads may be culling for the same GSG at once.  No reference
+  // to a RenderState may be released while it is held.
+  static LightMutex _mungers_lock;
+
   // This is used to mark nodes as we visit them to detect cycles.
   UpdateSeq _cycle_detect;
   static UpdateSeq _last_cycle_detect;
@@ -285,6 +305,10 @@ private:
   // cycle.
   static size_t _garbage_index;
 
+  // This counts the number of complete passes the garbage collector has made
+  // through the cache, which determines which generations are examined.
+  static unsigned int _garbage_pass;
+
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
   static PStatCollector _state_compose_pcollector;
@@ -22,6 +22,11 @@
 #include "geomNode.h"
 #include "config_gobj.h"
 #include "thread.h"
+#include "workerPool.h"
+#include "vector_int.h"
+#include "finiteBoundingVolume.h"
+
+#include <algorithm>
 
 PStatCollector SceneGraphReducer::_flatten_collector("*:Flatten:flatten");
 PStatCollector SceneGraphReducer::_apply_collector("*:Flatten:apply");
@@ -31,8 +36,127 @@ PStatCollector SceneGraphReducer::_collect_collector("*:Flatten:collect");
 PStatCollector SceneGraphReducer::_make_nonindexed_collector("*:Flatten:make nonindexed");
 PStatCollector SceneGraphReducer::_unify_collector("*:Flatten:unify");
 PStatCollector SceneGraphReducer::_remove_unused_collector("*:Flatten:remove unused vertices");
+PStatCollector SceneGraphReducer::_cluster_collector("*:Flatten:cluster");
 PStatCollector SceneGraphReducer::_premunge_collector("*:Premunge");
 
+/**
+ * Flattens the children of several unshared subgraphs at once, one subgraph
+ * per item.  See flatten_children_parallel().
+ */
+class SceneGraphReducer::FlattenJob : public WorkerPool::Job {
+public:
+  FlattenJob(SceneGraphReducer *reducer) : _reducer(reducer) {}
+
+  virtual void run_item(size_t index, Thread *current_thread);
+
+  class Subtree {
+  public:
+    PT(PandaNode) _node;
+    int _combine_siblings_bits;
+    int _num_nodes;
+  };
+  typedef pvector<Subtree> Subtrees;
+
+  SceneGraphReducer *_reducer;
+  Subtrees _subtrees;
+};
+
+/**
+ * Unifies several GeomNodes at once, one node per item.  See
+ * unify_parallel().
+ */
+class SceneGraphReducer::UnifyJob : public WorkerPool::Job {
+public:
+  UnifyJob(int max_indices, bool preserve_order) :
+    _max_indices(max_indices), _preserve_order(preserve_order) {}
+
+  void r_collect(PandaNode *node);
+  virtual void run_item(size_t index, Thread *current_thread);
+
+  // A GeomNode that is instanced in several places is visited once for each
+  // instance by r_unify(), so we do the same.
+  class Entry {
+  public:
+    PT(GeomNode) _node;
+    int _num_visits;
+  };
+  typedef pvector<Entry> Entries;
+  typedef pmap<GeomNode *, size_t> Indices;
+
+  int _max_indices;
+  bool _preserve_order;
+  Entries _entries;
+  Indices _indices;
+};
+
+/**
+ * Orders the items gathered by make_clusters() by the position of their
+ * center along one axis.  Ties are broken by the order in which the items
+ * were gathered, so that the result does not depend on the sort algorithm.
+ */
+class CompareClusterCenters {
+public:
+  CompareClusterCenters(int axis) : _axis(axis) {}
+
+  template<class Item>
+  bool operator () (const Item &a, const Item &b) const {
+    if (a._center[_axis] != b._center[_axis]) {
+      return a._center[_axis] < b._center[_axis];
+    }
+    return a._index < b._index;
+  }
+
+  int _axis;
+};
+
+/**
+ * Returns true if the indicated node has no properties of its own that would
+ * be lost if its geometry were moved elsewhere in the graph by
+ * make_clusters().
+ */
+static bool
+is_plain_node(PandaNode *node) {
+  return node->get_num_parents() == 1 &&
+         node->get_transform()->is_identity() &&
+         node->get_state()->is_empty() &&
+         node->get_effects()->is_empty() &&
+         node->get_draw_control_mask().is_zero() &&
+         node->get_draw_show_mask().is_all_on() &&
+         !node->has_tags() &&
+         node->safe_to_combine() &&
+         node->safe_to_flatten_below();
+}
+
+/**
+ * Returns true if the indicated node and all of the nodes below it,
+ * including stashed nodes, have only one parent, so that no other part of
+ * the scene graph can see any changes made to them.
+ */
+static bool
+is_unshared_subgraph(PandaNode *node) {
+  if (node->get_num_parents() != 1) {
+    return false;
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    if (!is_unshared_subgraph(children.get_child(i))) {
+      return false;
+    }
+  }
+
+  PandaNode::Stashed stashed = node->get_stashed();
+  int num_stashed = stashed.get_num_stashed();
+  for (int i = 0; i < num_stashed; ++i) {
+    if (!is_unshared_subgraph(stashed.get_stashed(i))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 /**
  * Specifies the particular GraphicsStateGuardian that this object will
  * attempt to optimize to.  The GSG may specify parameters such as maximum
@@ -86,22 +210,12 @@ flatten(PandaNode *root, int combine_siblings_bits) {
   nassertr(check_live_flatten(root), 0);
 
   PStatTimer timer(_flatten_collector);
+  WorkerPool *pool = get_parallel_pool();
   int num_total_nodes = 0;
   int num_pass_nodes;
 
   do {
-    num_pass_nodes = 0;
-
-    // Get a copy of the children list, so we don't have to worry about self-
-    // modifications.
-    PandaNode::Children cr = root->get_children();
-
-    // Now visit each of the children in turn.
-    int num_children = cr.get_num_children();
-    for (int i = 0; i < num_children; i++) {
-      PT(PandaNode) child_node = cr.get_child(i);
-      num_pass_nodes += r_flatten(root, child_node, combine_siblings_bits);
-    }
+    num_pass_nodes = flatten_children(root, combine_siblings_bits, pool);
 
     if (combine_siblings_bits != 0 &&
         root->get_num_children() >= 2 &&
@@ -183,7 +297,11 @@ unify(PandaNode *root, bool preserve_order) {
   if (_gsg != nullptr) {
     max_indices = std::min(max_indices, _gsg->get_max_vertices_per_primitive());
   }
-  r_unify(root, max_indices, preserve_order);
+
+  WorkerPool *pool = get_parallel_pool();
+  if (pool == nullptr || !unify_parallel(root, max_indices, preserve_order, pool)) {
+    r_unify(root, max_indices, preserve_order);
+  }
 }
 
 /**
@@ -202,6 +320,47 @@ remove_unused_vertices(PandaNode *root) {
   Thread::consider_yield();
 }
 
+/**
+ * Gathers up all of the Geoms in the GeomNodes at the indicated root and
+ * below, and redistributes them into a new hierarchy of clusters below root,
+ * according to their position in space.
+ *
+ * The Geoms are divided in half again and again, each time along the longest
+ * axis of the region containing their centers, until each part contains no
+ * more than get_cluster_max_triangles() triangles and is no larger than
+ * get_cluster_cell_size().  Each part then becomes a GeomNode.  The result
+ * is a balanced binary tree of nodes whose bounding volumes can be culled
+ * effectively, unlike the single large node that flatten() may produce when
+ * it combines siblings.  This should be followed by collect_vertex_data()
+ * with CVD_one_node_only and by unify(), to combine the Geoms within each
+ * cluster.
+ *
+ * Only GeomNodes whose path to root consists of nodes without any transform,
+ * state, effects, tags or other special properties are affected, so it is
+ * usually a good idea to call apply_attribs() first.  Other nodes are left
+ * in place, as are any GeomNodes below them.  Nodes that are left empty are
+ * removed.
+ *
+ * The return value is the number of cluster GeomNodes created.
+ */
+int SceneGraphReducer::
+make_clusters(PandaNode *root) {
+  nassertr(root != nullptr, 0);
+  nassertr(check_live_flatten(root), 0);
+
+  PStatTimer timer(_cluster_collector);
+
+  ClusterItems items;
+  r_collect_cluster_items(root, items);
+  if (items.empty()) {
+    return 0;
+  }
+
+  int num_clusters = 0;
+  root->add_child(r_make_clusters(items.begin(), items.end(), num_clusters));
+  return num_clusters;
+}
+
 /**
  * In a non-release build, returns false if the node is correctly not in a
  * live scene graph.  (Calling flatten on a node that is part of a live scene
@@ -226,6 +385,20 @@ check_live_flatten(PandaNode *node) {
   return true;
 }
 
+/**
+ * Returns the WorkerPool that the flatten operations should spread their
+ * work over, or NULL if they should run entirely on the calling thread.  See
+ * parallel-flatten.
+ */
+WorkerPool *SceneGraphReducer::
+get_parallel_pool() {
+  if (!parallel_flatten) {
+    return nullptr;
+  }
+  WorkerPool *pool = WorkerPool::get_global_ptr();
+  return (pool->get_num_threads() > 0) ? pool : nullptr;
+}
+
 /**
  * The recursive implementation of apply_attribs().
  */
@@ -369,11 +542,13 @@ r_apply_attribs(PandaNode *node, const AccumulatedAttribs &attribs,
 
 
 /**
- * The recursive implementation of flatten().
+ * The recursive implementation of flatten().  If pool is not NULL, the
+ * unshared subgraphs at the first level below parent_node with more than one
+ * child are flattened in parallel.
  */
 int SceneGraphReducer::
 r_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
-          int combine_siblings_bits) {
+          int combine_siblings_bits, WorkerPool *pool) {
   if (pgraph_cat.is_spam()) {
     pgraph_cat.spam()
       << "SceneGraphReducer::r_flatten(" << *grandparent_node << ", "
@@ -381,105 +556,212 @@ r_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
       << ")\n";
   }
 
-  if ((combine_siblings_bits & (CS_geom_node | CS_other | CS_recurse)) != 0) {
-    // Unset CS_within_radius, since we're going to flatten everything anyway.
-    // This avoids needlessly calculating the bounding volume.
-    combine_siblings_bits &= ~CS_within_radius;
-  }
-
-  int num_nodes = 0;
-
   if (!parent_node->safe_to_flatten_below()) {
     if (pgraph_cat.is_spam()) {
       pgraph_cat.spam()
         << "Not traversing further; " << *parent_node
         << " doesn't allow flattening below itself.\n";
     }
+    return 0;
+  }
 
-  } else {
-    if ((combine_siblings_bits & CS_within_radius) != 0) {
-      CPT(BoundingVolume) bv = parent_node->get_bounds();
-      if (bv->is_of_type(BoundingSphere::get_class_type())) {
-        const BoundingSphere *bs = DCAST(BoundingSphere, bv);
+  combine_siblings_bits = choose_combine_bits(parent_node, combine_siblings_bits);
+
+  // First, recurse on each of the children.
+  int num_nodes = flatten_children(parent_node, combine_siblings_bits, pool);
+
+  // Then see what is left to do at this level.
+  num_nodes += finish_flatten(grandparent_node, parent_node, combine_siblings_bits);
+  return num_nodes;
+}
+
+/**
+ * Returns the set of combine_siblings_bits that should be used to flatten
+ * the indicated node and its children, which may be more aggressive than
+ * the set that was passed in if CS_within_radius is in effect.
+ */
+int SceneGraphReducer::
+choose_combine_bits(PandaNode *parent_node, int combine_siblings_bits) {
+  if ((combine_siblings_bits & (CS_geom_node | CS_other | CS_recurse)) != 0) {
+    // Unset CS_within_radius, since we're going to flatten everything anyway.
+    // This avoids needlessly calculating the bounding volume.
+    combine_siblings_bits &= ~CS_within_radius;
+  }
+
+  if ((combine_siblings_bits & CS_within_radius) != 0) {
+    CPT(BoundingVolume) bv = parent_node->get_bounds();
+    if (bv->is_of_type(BoundingSphere::get_class_type())) {
+      const BoundingSphere *bs = DCAST(BoundingSphere, bv);
+      if (pgraph_cat.is_spam()) {
+        pgraph_cat.spam()
+          << "considering radius of " << *parent_node
+          << ": " << *bs << " vs. " << _combine_radius << "\n";
+      }
+      if (!bs->is_infinite() && (bs->is_empty() || bs->get_radius() <= _combine_radius)) {
+        // This node fits within the specified radius; from here on down, we
+        // will have CS_other set, instead of CS_within_radius.
         if (pgraph_cat.is_spam()) {
           pgraph_cat.spam()
-            << "considering radius of " << *parent_node
-            << ": " << *bs << " vs. " << _combine_radius << "\n";
-        }
-        if (!bs->is_infinite() && (bs->is_empty() || bs->get_radius() <= _combine_radius)) {
-          // This node fits within the specified radius; from here on down, we
-          // will have CS_other set, instead of CS_within_radius.
-          if (pgraph_cat.is_spam()) {
-            pgraph_cat.spam()
-              << "node fits within radius; flattening tighter.\n";
-          }
-          combine_siblings_bits &= ~CS_within_radius;
-          combine_siblings_bits |= (CS_geom_node | CS_other | CS_recurse);
+            << "node fits within radius; flattening tighter.\n";
         }
+        combine_siblings_bits &= ~CS_within_radius;
+        combine_siblings_bits |= (CS_geom_node | CS_other | CS_recurse);
       }
     }
+  }
 
-    // First, recurse on each of the children.
-    {
-      PandaNode::Children cr = parent_node->get_children();
-      int num_children = cr.get_num_children();
-      for (int i = 0; i < num_children; i++) {
-        PT(PandaNode) child_node = cr.get_child(i);
-        num_nodes += r_flatten(parent_node, child_node, combine_siblings_bits);
-      }
+  return combine_siblings_bits;
+}
+
+/**
+ * Calls r_flatten() on each of the children of the indicated node.  Returns
+ * the number of nodes removed from the graph.
+ */
+int SceneGraphReducer::
+flatten_children(PandaNode *parent_node, int combine_siblings_bits,
+                 WorkerPool *pool) {
+  if (pool != nullptr && parent_node->get_num_children() >= 2) {
+    return flatten_children_parallel(parent_node, combine_siblings_bits, pool);
+  }
+
+  int num_nodes = 0;
+
+  // Get a copy of the children list, so we don't have to worry about self-
+  // modifications.
+  PandaNode::Children cr = parent_node->get_children();
+  int num_children = cr.get_num_children();
+  for (int i = 0; i < num_children; i++) {
+    PT(PandaNode) child_node = cr.get_child(i);
+    num_nodes += r_flatten(parent_node, child_node, combine_siblings_bits, pool);
+  }
+
+  return num_nodes;
+}
+
+/**
+ * The parallel implementation of flatten_children().  The children of each
+ * child whose subgraph is not shared with any other part of the scene graph
+ * are flattened on the indicated WorkerPool, since nothing done within one
+ * such subgraph can affect another.  After that, the remaining work of
+ * r_flatten() is done for each child in turn, in the same order as
+ * flatten_children() would, so the result is the same.
+ */
+int SceneGraphReducer::
+flatten_children_parallel(PandaNode *parent_node, int combine_siblings_bits,
+                          WorkerPool *pool) {
+  PandaNode::Children cr = parent_node->get_children();
+  int num_children = cr.get_num_children();
+
+  FlattenJob job(this);
+  vector_int subtree_index(num_children, -1);
+  for (int i = 0; i < num_children; i++) {
+    PandaNode *child_node = cr.get_child(i);
+    if (child_node->safe_to_flatten_below() && is_unshared_subgraph(child_node)) {
+      subtree_index[i] = (int)job._subtrees.size();
+      FlattenJob::Subtree subtree;
+      subtree._node = child_node;
+      subtree._combine_siblings_bits = combine_siblings_bits;
+      subtree._num_nodes = 0;
+      job._subtrees.push_back(std::move(subtree));
     }
+  }
 
-    // Now that the above loop has removed some children, the child list saved
-    // above is no longer accurate, so hereafter we must ask the node for its
-    // real child list.
+  if (job._subtrees.size() >= 2) {
+    pool->run(job, job._subtrees.size());
+  } else {
+    // Not worth it; but there might be more luck further down.
+    job._subtrees.clear();
+    subtree_index.assign(num_children, -1);
+  }
 
-    // If we have CS_recurse set, then we flatten siblings before trying to
-    // flatten children.  Otherwise, we flatten children first, and then
-    // flatten siblings, which avoids overly enthusiastic flattening.
-    if ((combine_siblings_bits & CS_recurse) != 0 &&
-        parent_node->get_num_children() >= 2 &&
-        parent_node->safe_to_combine_children()) {
-      num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
+  int num_nodes = 0;
+  for (int i = 0; i < num_children; i++) {
+    PT(PandaNode) child_node = cr.get_child(i);
+    if (subtree_index[i] < 0) {
+      num_nodes += r_flatten(parent_node, child_node, combine_siblings_bits, pool);
+    } else {
+      const FlattenJob::Subtree &subtree = job._subtrees[subtree_index[i]];
+      num_nodes += subtree._num_nodes;
+      num_nodes += finish_flatten(parent_node, child_node, subtree._combine_siblings_bits);
     }
+  }
 
-    if (parent_node->get_num_children() == 1) {
-      // If we now have exactly one child, consider flattening the node out.
-      PT(PandaNode) child_node = parent_node->get_child(0);
-      int child_sort = parent_node->get_child_sort(0);
+  return num_nodes;
+}
 
-      if (consider_child(grandparent_node, parent_node, child_node)) {
-        // Ok, do it.
-        parent_node->remove_child(child_node);
+/**
+ * Flattens the children of the indicated subgraph.
+ */
+void SceneGraphReducer::FlattenJob::
+run_item(size_t index, Thread *current_thread) {
+  Subtree &subtree = _subtrees[index];
+  subtree._combine_siblings_bits =
+    _reducer->choose_combine_bits(subtree._node, subtree._combine_siblings_bits);
+  subtree._num_nodes =
+    _reducer->flatten_children(subtree._node, subtree._combine_siblings_bits, nullptr);
+}
 
-        if (do_flatten_child(grandparent_node, parent_node, child_node)) {
-          // Done!
-          num_nodes++;
-        } else {
-          // Chicken out.
-          parent_node->add_child(child_node, child_sort);
-        }
+/**
+ * Performs the part of r_flatten() that follows the flattening of the
+ * children of parent_node: flattening siblings, collapsing parent_node with
+ * its only remaining child, and removing empty children.  Returns the number
+ * of nodes removed from the graph.
+ */
+int SceneGraphReducer::
+finish_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
+               int combine_siblings_bits) {
+  int num_nodes = 0;
+
+  // Now that flatten_children() has removed some children, the child list
+  // it saved is no longer accurate, so hereafter we must ask the node for its
+  // real child list.
+
+  // If we have CS_recurse set, then we flatten siblings before trying to
+  // flatten children.  Otherwise, we flatten children first, and then
+  // flatten siblings, which avoids overly enthusiastic flattening.
+  if ((combine_siblings_bits & CS_recurse) != 0 &&
+      parent_node->get_num_children() >= 2 &&
+      parent_node->safe_to_combine_children()) {
+    num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
+  }
+
+  if (parent_node->get_num_children() == 1) {
+    // If we now have exactly one child, consider flattening the node out.
+    PT(PandaNode) child_node = parent_node->get_child(0);
+    int child_sort = parent_node->get_child_sort(0);
+
+    if (consider_child(grandparent_node, parent_node, child_node)) {
+      // Ok, do it.
+      parent_node->remove_child(child_node);
+
+      if (do_flatten_child(grandparent_node, parent_node, child_node)) {
+        // Done!
+        num_nodes++;
+      } else {
+        // Chicken out.
+        parent_node->add_child(child_node, child_sort);
       }
     }
+  }
 
-    if ((combine_siblings_bits & CS_recurse) == 0 &&
-        (combine_siblings_bits & ~CS_recurse) != 0 &&
-        parent_node->get_num_children() >= 2 &&
-        parent_node->safe_to_combine_children()) {
-      num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
-    }
-
-    // Finally, if any of our remaining children are plain PandaNodes with no
-    // children, just remove them.
-    if (parent_node->safe_to_combine_children()) {
-      for (int i = parent_node->get_num_children() - 1; i >= 0; --i) {
-        PandaNode *child_node = parent_node->get_child(i);
-        if (child_node->is_exact_type(PandaNode::get_class_type()) &&
-            child_node->get_num_children() == 0 &&
-            child_node->get_transform()->is_identity() &&
-            child_node->get_effects()->is_empty()) {
-          parent_node->remove_child(child_node);
-          ++num_nodes;
-        }
+  if ((combine_siblings_bits & CS_recurse) == 0 &&
+      (combine_siblings_bits & ~CS_recurse) != 0 &&
+      parent_node->get_num_children() >= 2 &&
+      parent_node->safe_to_combine_children()) {
+    num_nodes += flatten_siblings(parent_node, combine_siblings_bits);
+  }
+
+  // Finally, if any of our remaining children are plain PandaNodes with no
+  // children, just remove them.
+  if (parent_node->safe_to_combine_children()) {
+    for (int i = parent_node->get_num_children() - 1; i >= 0; --i) {
+      PandaNode *child_node = parent_node->get_child(i);
+      if (child_node->is_exact_type(PandaNode::get_class_type()) &&
+          child_node->get_num_children() == 0 &&
+          child_node->get_transform()->is_identity() &&
+          child_node->get_effects()->is_empty()) {
+        parent_node->remove_child(child_node);
+        ++num_nodes;
       }
     }
   }
@@ -913,6 +1195,71 @@ r_unify(PandaNode *node, int max_indices, bool preserve_order) {
   Thread::consider_yield();
 }
 
+/**
+ * The parallel implementation of unify().  Each GeomNode is unified on the
+ * indicated WorkerPool.  Returns false, having done nothing, if there are
+ * not enough GeomNodes to make this worthwhile.
+ */
+bool SceneGraphReducer::
+unify_parallel(PandaNode *root, int max_indices, bool preserve_order,
+               WorkerPool *pool) {
+  UnifyJob job(max_indices, preserve_order);
+  job.r_collect(root);
+  if (job._entries.size() < 2) {
+    return false;
+  }
+
+  pool->run(job, job._entries.size());
+  return true;
+}
+
+/**
+ * Recursively collects the GeomNodes at the indicated node and below, in the
+ * order in which r_unify() would visit them.
+ */
+void SceneGraphReducer::UnifyJob::
+r_collect(PandaNode *node) {
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    std::pair<Indices::iterator, bool> result =
+      _indices.insert(Indices::value_type(geom_node, _entries.size()));
+    if (result.second) {
+      // GeomNode::unify() makes a copy of any Geom it modifies that is shared
+      // with another GeomNode.  Separate them now, in the same order as
+      // r_unify() would have, so that each GeomNode in the job may be
+      // modified independently of the others.
+      int num_geoms = geom_node->get_num_geoms();
+      for (int i = 0; i < num_geoms; ++i) {
+        geom_node->modify_geom(i);
+      }
+
+      Entry entry;
+      entry._node = geom_node;
+      entry._num_visits = 1;
+      _entries.push_back(std::move(entry));
+    } else {
+      ++_entries[(*result.first).second]._num_visits;
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_collect(children.get_child(i));
+  }
+}
+
+/**
+ * Unifies the indicated GeomNode.
+ */
+void SceneGraphReducer::UnifyJob::
+run_item(size_t index, Thread *current_thread) {
+  const Entry &entry = _entries[index];
+  for (int i = 0; i < entry._num_visits; ++i) {
+    entry._node->unify(_max_indices, _preserve_order);
+  }
+}
+
 /**
  * Recursively calls GeomTransformer::register_vertices() on all GeomNodes at
  * the indicated root and below.
@@ -931,6 +1278,128 @@ r_register_vertices(PandaNode *node, GeomTransformer &transformer) {
   }
 }
 
+/**
+ * The recursive implementation of make_clusters().  Removes the Geoms from
+ * all of the eligible GeomNodes at the indicated node and below, and adds
+ * them to items.  Also removes any plain nodes that are left empty.
+ */
+void SceneGraphReducer::
+r_collect_cluster_items(PandaNode *node, ClusterItems &items) {
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    PandaNode *child_node = children.get_child(i);
+    if (!is_plain_node(child_node)) {
+      continue;
+    }
+
+    if (child_node->is_exact_type(GeomNode::get_class_type())) {
+      GeomNode *geom_node = DCAST(GeomNode, child_node);
+      int num_geoms = geom_node->get_num_geoms();
+      for (int gi = 0; gi < num_geoms; ++gi) {
+        ClusterItem item;
+        item._geom = geom_node->get_geom(gi);
+        item._state = geom_node->get_geom_state(gi);
+        item._index = items.size();
+
+        item._num_faces = 0;
+        size_t num_primitives = item._geom->get_num_primitives();
+        for (size_t pi = 0; pi < num_primitives; ++pi) {
+          item._num_faces += item._geom->get_primitive(pi)->get_num_faces();
+        }
+
+        CPT(BoundingVolume) bounds = item._geom->get_bounds();
+        if (!bounds->is_empty() && bounds->is_of_type(FiniteBoundingVolume::get_class_type())) {
+          const FiniteBoundingVolume *fbv = (const FiniteBoundingVolume *)bounds.p();
+          item._min = fbv->get_min();
+          item._max = fbv->get_max();
+        } else {
+          item._min = LPoint3::zero();
+          item._max = LPoint3::zero();
+        }
+        item._center = (item._min + item._max) * 0.5f;
+        items.push_back(std::move(item));
+      }
+      geom_node->remove_all_geoms();
+
+    } else if (!child_node->is_exact_type(PandaNode::get_class_type())) {
+      // Some other kind of node; leave it alone.
+      continue;
+    }
+
+    r_collect_cluster_items(child_node, items);
+
+    if (child_node->get_num_children() == 0 &&
+        child_node->get_num_stashed() == 0) {
+      node->remove_child(child_node);
+    }
+  }
+}
+
+/**
+ * The recursive implementation of make_clusters().  Builds a cluster
+ * hierarchy for the indicated range of items, and returns its root.
+ * Increments num_clusters by the number of GeomNodes created.
+ */
+PT(PandaNode) SceneGraphReducer::
+r_make_clusters(ClusterItems::iterator begin, ClusterItems::iterator end,
+                int &num_clusters) {
+  nassertr(begin != end, nullptr);
+
+  // Measure the space occupied by the geometry, and by its centers.
+  LPoint3 min_point = (*begin)._min;
+  LPoint3 max_point = (*begin)._max;
+  LPoint3 min_center = (*begin)._center;
+  LPoint3 max_center = (*begin)._center;
+  int num_faces = 0;
+
+  ClusterItems::iterator ii;
+  for (ii = begin; ii != end; ++ii) {
+    const ClusterItem &item = (*ii);
+    min_point = min_point.fmin(item._min);
+    max_point = max_point.fmax(item._max);
+    min_center = min_center.fmin(item._center);
+    max_center = max_center.fmax(item._center);
+    num_faces += item._num_faces;
+  }
+
+  LVector3 size = max_point - min_point;
+  PN_stdfloat max_size = std::max(size[0], std::max(size[1], size[2]));
+
+  size_t num_items = end - begin;
+  if (num_items == 1 ||
+      (num_faces <= _cluster_max_triangles &&
+       (_cluster_cell_size <= 0.0f || max_size <= _cluster_cell_size))) {
+    // This is small enough to be a cluster on its own.
+    PT(GeomNode) geom_node = new GeomNode("cluster");
+    for (ii = begin; ii != end; ++ii) {
+      const ClusterItem &item = (*ii);
+      geom_node->add_geom((Geom *)item._geom.p(), item._state);
+    }
+    ++num_clusters;
+    return geom_node;
+  }
+
+  // Split the items in half along the axis on which their centers are the
+  // most spread out.
+  LVector3 spread = max_center - min_center;
+  int axis = 0;
+  if (spread[1] > spread[axis]) {
+    axis = 1;
+  }
+  if (spread[2] > spread[axis]) {
+    axis = 2;
+  }
+
+  ClusterItems::iterator middle = begin + num_items / 2;
+  std::nth_element(begin, middle, end, CompareClusterCenters(axis));
+
+  PT(PandaNode) node = new PandaNode("cluster");
+  node->add_child(r_make_clusters(begin, middle, num_clusters));
+  node->add_child(r_make_clusters(middle, end, num_clusters));
+  return node;
+}
+
 /**
  * The recursive implementation of decompose().
  */
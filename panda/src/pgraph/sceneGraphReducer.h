@@ -25,8 +25,10 @@
 #include "typedObject.h"
 #include "pointerTo.h"
 #include "graphicsStateGuardianBase.h"
+#include "pvector.h"
 
 class PandaNode;
+class WorkerPool;
 
 /**
  * An interface for simplifying ("flattening") scene graphs by eliminating
@@ -120,6 +122,11 @@ PUBLISHED:
   INLINE void set_combine_radius(PN_stdfloat combine_radius);
   INLINE PN_stdfloat get_combine_radius() const;
 
+  INLINE void set_cluster_cell_size(PN_stdfloat cell_size);
+  INLINE PN_stdfloat get_cluster_cell_size() const;
+  INLINE void set_cluster_max_triangles(int max_triangles);
+  INLINE int get_cluster_max_triangles() const;
+
   INLINE void apply_attribs(PandaNode *node, int attrib_types = ~(TT_clip_plane | TT_cull_face | TT_apply_texture_color));
   INLINE void apply_attribs(PandaNode *node, const AccumulatedAttribs &attribs,
                             int attrib_types, GeomTransformer &transformer);
@@ -137,16 +144,27 @@ PUBLISHED:
   INLINE int make_nonindexed(PandaNode *root, int nonindexed_bits = ~0);
   void unify(PandaNode *root, bool preserve_order);
   void remove_unused_vertices(PandaNode *root);
+  int make_clusters(PandaNode *root);
 
   INLINE void premunge(PandaNode *root, const RenderState *initial_state);
   bool check_live_flatten(PandaNode *node);
 
+public:
+  static WorkerPool *get_parallel_pool();
+
 protected:
   void r_apply_attribs(PandaNode *node, const AccumulatedAttribs &attribs,
                        int attrib_types, GeomTransformer &transformer);
 
   int r_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
-                int combine_siblings_bits);
+                int combine_siblings_bits, WorkerPool *pool = nullptr);
+  int choose_combine_bits(PandaNode *parent_node, int combine_siblings_bits);
+  int flatten_children(PandaNode *parent_node, int combine_siblings_bits,
+                       WorkerPool *pool);
+  int flatten_children_parallel(PandaNode *parent_node,
+                                int combine_siblings_bits, WorkerPool *pool);
+  int finish_flatten(PandaNode *grandparent_node, PandaNode *parent_node,
+                     int combine_siblings_bits);
   int flatten_siblings(PandaNode *parent_node,
                        int combine_siblings_bits);
 
@@ -175,14 +193,39 @@ protected:
                             GeomTransformer &transformer, bool format_only);
   int r_make_nonindexed(PandaNode *node, int collect_bits);
   void r_unify(PandaNode *node, int max_indices, bool preserve_order);
+  bool unify_parallel(PandaNode *root, int max_indices, bool preserve_order,
+                      WorkerPool *pool);
   void r_register_vertices(PandaNode *node, GeomTransformer &transformer);
   void r_decompose(PandaNode *node);
 
   void r_premunge(PandaNode *node, const RenderState *state);
 
+  // One Geom gathered up by make_clusters().
+  class ClusterItem {
+  public:
+    CPT(Geom) _geom;
+    CPT(RenderState) _state;
+    LPoint3 _min;
+    LPoint3 _max;
+    LPoint3 _center;
+    int _num_faces;
+    size_t _index;
+  };
+  typedef pvector<ClusterItem> ClusterItems;
+
+  void r_collect_cluster_items(PandaNode *node, ClusterItems &items);
+  PT(PandaNode) r_make_clusters(ClusterItems::iterator begin,
+                                ClusterItems::iterator end,
+                                int &num_clusters);
+
 private:
+  class FlattenJob;
+  class UnifyJob;
+
   PT(GraphicsStateGuardianBase) _gsg;
   PN_stdfloat _combine_radius;
+  PN_stdfloat _cluster_cell_size;
+  int _cluster_max_triangles;
   GeomTransformer _transformer;
 
   static PStatCollector _flatten_collector;
@@ -193,6 +236,7 @@ private:
   static PStatCollector _make_nonindexed_collector;
   static PStatCollector _unify_collector;
   static PStatCollector _remove_unused_collector;
+  static PStatCollector _cluster_collector;
   static PStatCollector _premunge_collector;
 };
 
@@ -51,6 +51,7 @@ PUBLISHED:
     F_subsume_alpha_test  = 1,  // Shader promises to subsume the alpha test using TEXKILL
     F_hardware_skinning   = 2,  // Shader needs pre-animated vertices
     F_shader_point_size   = 3,  // Shader provides point size, not RenderModeAttrib
+    F_hardware_instancing = 4,  // Shader reads per-instance transforms; see CullBinStateSorted
   };
 
   INLINE bool               has_shader() const;
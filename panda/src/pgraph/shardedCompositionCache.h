@@ -0,0 +1,84 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file shardedCompositionCache.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef SHARDEDCOMPOSITIONCACHE_H
+#define SHARDEDCOMPOSITIONCACHE_H
+
+#include "pandabase.h"
+#include "pointerTo.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+
+/**
+ * A small, fixed-size front for the composition caches of TransformState and
+ * RenderState.  It is consulted by compose() and invert_compose() before the
+ * global _states_lock is grabbed, so that threads which repeatedly compose
+ * the same pairs of states (as the App, Cull and Draw threads all do) don't
+ * have to contend on that lock.
+ *
+ * The cache is divided into a number of shards, each of which is a
+ * direct-mapped table protected by its own LightMutex.  A pair of states
+ * always maps to the same slot of the same shard, so threads working on
+ * different pairs rarely touch the same lock.
+ *
+ * Each entry holds a reference to both of its operands as well as to the
+ * result, so the pointers stored here can never be recycled while the entry
+ * remains in the cache.  Entries are evicted simply by being overwritten.
+ *
+ * The shard locks are always leaf locks: no reference is ever released while
+ * one is held, since releasing a state may require grabbing _states_lock.
+ */
+template<class State>
+class ShardedCompositionCache {
+public:
+  ShardedCompositionCache() = default;
+  ShardedCompositionCache(const ShardedCompositionCache &copy) = delete;
+
+  void init(int num_shards);
+  INLINE bool is_enabled() const;
+
+  bool lookup(const State *a, const State *b, CPT(State) &result) const;
+  void store(const State *a, const State *b, const State *result);
+  void clear();
+
+  ShardedCompositionCache &operator = (const ShardedCompositionCache &copy) = delete;
+
+private:
+  INLINE static size_t hash_pair(const State *a, const State *b);
+
+  enum {
+    // The number of slots in each shard.  Must be a power of two.
+    num_slots = 16,
+  };
+
+  class Entry {
+  public:
+    CPT(State) _a;
+    CPT(State) _b;
+    CPT(State) _result;
+  };
+
+  class Shard {
+  public:
+    LightMutex _lock;
+    Entry _entries[num_slots];
+  };
+
+  Shard *_shards = nullptr;
+  size_t _num_shards = 0;
+};
+
+#include "shardedCompositionCache.I"
+#include "shardedCompositionCache.T"
+
+#endif
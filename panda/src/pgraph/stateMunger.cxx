@@ -12,6 +12,7 @@
  */
 
 #include "stateMunger.h"
+#include "lightMutexHolder.h"
 
 TypeHandle StateMunger::_type_handle;
 
@@ -28,20 +29,27 @@ StateMunger::
 CPT(RenderState) StateMunger::
 munge_state(const RenderState *state) {
   RenderState::MungedStates &munged_states = state->_munged_states;
-
   int id = get_gsg()->_id;
-  int mi = munged_states.find(id);
-  if (mi != -1) {
-    if (auto munged_state = munged_states.get_data(mi).lock()) {
-      return munged_state;
-    } else {
+
+  // The result is declared outside of the lock, since releasing it might
+  // destruct a RenderState.
+  CPT(RenderState) result;
+  {
+    LightMutexHolder holder(RenderState::_mungers_lock);
+    int mi = munged_states.find(id);
+    if (mi != -1) {
+      result = munged_states.get_data(mi).lock();
+      if (result != nullptr) {
+        return result;
+      }
       munged_states.remove_element(mi);
     }
   }
 
-  CPT(RenderState) result = munge_state_impl(state);
-  munged_states.store(id, result);
+  result = munge_state_impl(state);
 
+  LightMutexHolder holder(RenderState::_mungers_lock);
+  munged_states.store(id, result);
   return result;
 }
 
@@ -0,0 +1,128 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_compose.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "pandabase.h"
+#include "transformState.h"
+#include "renderState.h"
+#include "colorAttrib.h"
+#include "colorScaleAttrib.h"
+#include "thread.h"
+#include "pmutex.h"
+#include "mutexHolder.h"
+#include "trueClock.h"
+
+// This program hammers TransformState::compose() and RenderState::compose()
+// from a number of threads at once, and reports the number of compositions
+// per second achieved.  Run it once with the default settings and once with
+// "composition-cache-shards 64" in your Config.prc to see the effect of the
+// sharded composition cache.
+
+// The amount of time, in seconds, for each thread to run.
+static const double thread_run_time = 3.0;
+
+// The number of distinct states each thread composes together.
+static const int num_states = 32;
+
+static Mutex _output_lock;
+
+#define OUTPUT(stuff) { \
+  MutexHolder holder(_output_lock); \
+  stuff; \
+}
+
+class ComposeThread : public Thread {
+public:
+  ComposeThread(const std::string &name) :
+    Thread(name, name),
+    _num_ops(0),
+    _elapsed(0.0)
+  {
+  }
+
+  virtual void thread_main() {
+    // All threads share the same set of states, which is the worst case for
+    // contention, and also typical of the App, Cull and Draw threads.
+    CPT(TransformState) transforms[num_states];
+    CPT(RenderState) states[num_states];
+    for (int i = 0; i < num_states; ++i) {
+      transforms[i] = TransformState::make_pos_hpr(LVecBase3(i, 0, 0), LVecBase3(0, i, 0));
+      states[i] = RenderState::make(ColorScaleAttrib::make(LVecBase4(i, i, i, 1)),
+                                    ColorAttrib::make_flat(LColor(i % 4, 0, 0, 1)));
+    }
+
+    TrueClock *clock = TrueClock::get_global_ptr();
+    double start_time = clock->get_short_time();
+    double elapsed = 0.0;
+    long long num_ops = 0;
+
+    while (elapsed < thread_run_time) {
+      for (int i = 0; i < num_states; ++i) {
+        for (int j = 0; j < num_states; ++j) {
+          CPT(TransformState) t = transforms[i]->compose(transforms[j]);
+          CPT(TransformState) ti = transforms[i]->invert_compose(transforms[j]);
+          CPT(RenderState) s = states[i]->compose(states[j]);
+        }
+      }
+      num_ops += num_states * num_states * 3;
+      elapsed = clock->get_short_time() - start_time;
+    }
+
+    _num_ops = num_ops;
+    _elapsed = elapsed;
+  }
+
+  long long _num_ops;
+  double _elapsed;
+};
+
+int
+main(int argc, char *argv[]) {
+  int max_threads = 4;
+  if (argc > 1) {
+    max_threads = atoi(argv[1]);
+  }
+  if (max_threads < 1) {
+    nout << "Usage: test_compose [max_threads]\n";
+    return 1;
+  }
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    // Start each round with an empty cache, so the rounds are comparable.
+    TransformState::clear_cache();
+    RenderState::clear_cache();
+
+    typedef pvector< PT(ComposeThread) > Threads;
+    Threads threads;
+    for (int ti = 0; ti < num_threads; ++ti) {
+      char name = 'a' + ti;
+      PT(ComposeThread) thread = new ComposeThread(std::string(1, name));
+      threads.push_back(thread);
+      thread->start(TP_normal, true);
+    }
+
+    double ops_per_second = 0.0;
+    for (ComposeThread *thread : threads) {
+      thread->join();
+      ops_per_second += thread->_num_ops / thread->_elapsed;
+    }
+
+    OUTPUT(nout << num_threads << " threads: "
+           << ops_per_second / 1000000.0
+           << " million compositions per second ("
+           << ops_per_second / num_threads / 1000000.0
+           << " per thread).\n");
+  }
+
+  Thread::prepare_for_exit();
+  return 0;
+}
@@ -19,6 +19,7 @@
 #include "indent.h"
 #include "compareTo.h"
 #include "pStatTimer.h"
+#include "trueClock.h"
 #include "config_pgraph.h"
 #include "lightReMutexHolder.h"
 #include "lightMutexHolder.h"
@@ -32,6 +33,7 @@ CPT(TransformState) TransformState::_identity_state;
 CPT(TransformState) TransformState::_invalid_state;
 UpdateSeq TransformState::_last_cycle_detect;
 size_t TransformState::_garbage_index = 0;
+unsigned int TransformState::_garbage_pass = 0;
 bool TransformState::_uniquify_matrix = true;
 
 PStatCollector TransformState::_cache_update_pcollector("*:State Cache:Update");
@@ -47,6 +49,8 @@ PStatCollector TransformState::_node_counter("TransformStates:On nodes");
 PStatCollector TransformState::_cache_counter("TransformStates:Cached");
 
 CacheStats TransformState::_cache_stats;
+TransformState::CompositionShards TransformState::_composition_shards;
+TransformState::CompositionShards TransformState::_invert_composition_shards;
 
 TypeHandle TransformState::_type_handle;
 
@@ -61,6 +65,7 @@ TransformState() : _lock("TransformState") {
     init_states();
   }
   _saved_entry = -1;
+  _gc_generation = 0;
   _flags = F_is_identity | F_singular_known | F_is_2d;
   _inv_mat = nullptr;
   _cache_stats.add_num_states(1);
@@ -602,73 +607,17 @@ compose(const TransformState *other) const {
     return do_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
-  // Is this composition already cached?
-  int index = _composition_cache.find(other);
-  if (index != -1) {
-    const Composition &comp = _composition_cache.get_data(index);
-    if (comp._result != nullptr) {
-      // Success!
-      _cache_stats.inc_hits();
-      return comp._result;
-    }
-  }
-
-  // Not in the cache.  Compute a new result.  It's important that we don't
-  // hold the lock while we do this, or we lose the benefit of
-  // parallelization.
-  CPT(TransformState) result = do_compose(other);
-
-  if (index != -1) {
-    Composition &comp = _composition_cache.modify_data(index);
-    // Well, it wasn't cached already, but we already had an entry (probably
-    // created for the reverse direction), so use the same entry to store
-    // the new result.
-    comp._result = result;
-
-    if (result != (const TransformState *)this) {
-      // See the comments below about the need to up the reference count
-      // only when the result is not the same as this.
-      result->cache_ref();
-    }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return result;
-  }
-  _cache_stats.inc_misses();
-
-  // We need to make a new cache entry, both in this object and in the other
-  // object.  We make both records so the other TransformState object will
-  // know to delete the entry from this object when it destructs, and vice-
-  // versa.
-
-  // The cache entry in this object is the only one that indicates the result;
-  // the other will be NULL for now.
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_composition_cache.is_empty());
-
-  _composition_cache[other]._result = result;
-
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_composition_cache.is_empty());
-    other->_composition_cache[this]._result = nullptr;
+  if (!_composition_shards.is_enabled()) {
+    return do_cached_compose(other);
   }
 
-  if (result != (TransformState *)this) {
-    // If the result of do_compose() is something other than this, explicitly
-    // increment the reference count.  We have to be sure to decrement it
-    // again later, when the composition entry is removed from the cache.
-    result->cache_ref();
-
-    // (If the result was just this again, we still store the result, but we
-    // don't increment the reference count, since that would be a self-
-    // referential leak.)
+  // Try the sharded cache first.  A hit here doesn't need to grab the global
+  // _states_lock at all.
+  CPT(TransformState) result;
+  if (!_composition_shards.lookup(this, other, result)) {
+    result = do_cached_compose(other);
+    _composition_shards.store(this, other, result);
   }
-
-  _cache_stats.maybe_report("TransformState");
-
   return result;
 }
 
@@ -709,70 +658,15 @@ invert_compose(const TransformState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
-  int index = _invert_composition_cache.find(other);
-  if (index != -1) {
-    const Composition &comp = _invert_composition_cache.get_data(index);
-    if (comp._result != nullptr) {
-      // Success!
-      _cache_stats.inc_hits();
-      return comp._result;
-    }
+  if (!_invert_composition_shards.is_enabled()) {
+    return do_cached_invert_compose(other);
   }
 
-  // Not in the cache.  Compute a new result.  It's important that we don't
-  // hold the lock while we do this, or we lose the benefit of
-  // parallelization.
-  CPT(TransformState) result = do_invert_compose(other);
-
-  // Is this composition already cached?
-  if (index != -1) {
-    Composition &comp = _invert_composition_cache.modify_data(index);
-    // Well, it wasn't cached already, but we already had an entry (probably
-    // created for the reverse direction), so use the same entry to store
-    // the new result.
-    comp._result = result;
-
-    if (result != (const TransformState *)this) {
-      // See the comments below about the need to up the reference count
-      // only when the result is not the same as this.
-      result->cache_ref();
-    }
-    // Here's the cache!
-    _cache_stats.inc_hits();
-    return result;
+  CPT(TransformState) result;
+  if (!_invert_composition_shards.lookup(this, other, result)) {
+    result = do_cached_invert_compose(other);
+    _invert_composition_shards.store(this, other, result);
   }
-  _cache_stats.inc_misses();
-
-  // We need to make a new cache entry, both in this object and in the other
-  // object.  We make both records so the other TransformState object will
-  // know to delete the entry from this object when it destructs, and vice-
-  // versa.
-
-  // The cache entry in this object is the only one that indicates the result;
-  // the other will be NULL for now.
-  _cache_stats.add_total_size(1);
-  _cache_stats.inc_adds(_invert_composition_cache.is_empty());
-  _invert_composition_cache[other]._result = result;
-
-  if (other != this) {
-    _cache_stats.add_total_size(1);
-    _cache_stats.inc_adds(other->_invert_composition_cache.is_empty());
-    other->_invert_composition_cache[this]._result = nullptr;
-  }
-
-  if (result != (TransformState *)this) {
-    // If the result of compose() is something other than this, explicitly
-    // increment the reference count.  We have to be sure to decrement it
-    // again later, when the composition entry is removed from the cache.
-    result->cache_ref();
-
-    // (If the result was just this again, we still store the result, but we
-    // don't increment the reference count, since that would be a self-
-    // referential leak.)
-  }
-
   return result;
 }
 
@@ -1098,6 +992,12 @@ clear_cache() {
   if (_states == nullptr) {
     return 0;
   }
+
+  // The sharded caches hold references to their states, so we must empty
+  // them before we can expect any states to be released.
+  _composition_shards.clear();
+  _invert_composition_shards.clear();
+
   LightReMutexHolder holder(*_states_lock);
 
   PStatTimer timer(_cache_update_pcollector);
@@ -1162,6 +1062,11 @@ clear_cache() {
  * garbage-collect-states is true to ensure that TransformStates get cleaned
  * up appropriately.  It does no harm to call it even if this variable is not
  * true, but there is probably no advantage in that case.
+ *
+ * The amount of work done by each call is limited by
+ * garbage-collect-states-rate and garbage-collect-states-budget; whatever is
+ * left over is picked up by the next call.  Long-lived states are examined
+ * less often according to garbage-collect-states-generations.
  */
 int TransformState::
 garbage_collect() {
@@ -1191,41 +1096,81 @@ garbage_collect() {
   num_this_pass = std::min(num_this_pass, size);
   size_t stop_at_element = (si + num_this_pass) % size;
 
+  // A generation of 0 means that every state is examined on every pass.
+  unsigned char max_generation = (unsigned char)
+    std::max(0, std::min((int)garbage_collect_states_generations, 7));
+
+  // If we have a time budget, we check the clock every so often, and stop
+  // early if we have used it up.  The next call resumes where we left off.
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double stop_time = 0.0;
+  if (garbage_collect_states_budget > 0.0) {
+    stop_time = clock->get_short_time() + garbage_collect_states_budget * 0.000001;
+  }
+
+  // Rather than reading the clock for every state, we keep a rough tally of
+  // the work done, counting a deletion as much more expensive than a visit.
+  size_t work = 0;
+
   do {
     TransformState *state = (TransformState *)_states->get_key(si);
-    if (break_and_uniquify) {
-      if (state->get_cache_ref_count() > 0 &&
-          state->get_ref_count() == state->get_cache_ref_count()) {
-        // If we have removed all the references to this state not in the
-        // cache, leaving only references in the cache, then we need to
-        // check for a cycle involving this TransformState and break it if
-        // it exists.
-        state->detect_and_break_cycles();
+    unsigned char generation = state->_gc_generation;
+    if (generation != 0 &&
+        ((_garbage_pass + si) & ((1u << generation) - 1)) != 0) {
+      // This state has survived a number of passes already.  We only look at
+      // states in generation n once every 2^n passes; staggering by the
+      // index spreads this work out evenly over the passes.
+
+    } else {
+      if (break_and_uniquify) {
+        if (state->get_cache_ref_count() > 0 &&
+            state->get_ref_count() == state->get_cache_ref_count()) {
+          // If we have removed all the references to this state not in the
+          // cache, leaving only references in the cache, then we need to
+          // check for a cycle involving this TransformState and break it if
+          // it exists.
+          state->detect_and_break_cycles();
+        }
       }
-    }
 
-    if (state->get_ref_count() == 1) {
-      // This state has recently been unreffed to 1 (the one we added when
-      // we stored it in the cache).  Now it's time to delete it.  This is
-      // safe, because we're holding the _states_lock, so it's not possible
-      // for some other thread to find the state in the cache and ref it
-      // while we're doing this.
-      state->release_new();
-      state->remove_cache_pointers();
-      state->cache_unref();
-      delete state;
-
-      // When we removed it from the hash map, it swapped the last element
-      // with the one we just removed.  So the current index contains one we
-      // still need to visit.
-      --size;
-      --si;
-      if (stop_at_element > 0) {
-        --stop_at_element;
+      if (state->get_ref_count() == 1) {
+        // This state has recently been unreffed to 1 (the one we added when
+        // we stored it in the cache).  Now it's time to delete it.  This is
+        // safe, because we're holding the _states_lock, so it's not possible
+        // for some other thread to find the state in the cache and ref it
+        // while we're doing this.
+        state->release_new();
+        state->remove_cache_pointers();
+        state->cache_unref();
+        delete state;
+
+        // When we removed it from the hash map, it swapped the last element
+        // with the one we just removed.  So the current index contains one we
+        // still need to visit.
+        --size;
+        --si;
+        if (stop_at_element > 0) {
+          --stop_at_element;
+        }
+        work += 64;
+
+      } else if (generation < max_generation) {
+        // The state survived, so promote it to the next generation.
+        state->_gc_generation = generation + 1;
       }
     }
 
     si = (si + 1) % size;
+    if (si == 0) {
+      ++_garbage_pass;
+    }
+
+    if (stop_time != 0.0 && ++work >= 64) {
+      work = 0;
+      if (clock->get_short_time() >= stop_time) {
+        break;
+      }
+    }
   } while (si != stop_at_element);
   _garbage_index = si;
 
@@ -1435,6 +1380,10 @@ init_states() {
   // presumably when there is still only one thread in the world.
   _states_lock = new LightReMutex("TransformState::_states_lock");
   _cache_stats.init();
+
+  int composition_cache_shards = get_composition_cache_shards();
+  _composition_shards.init(composition_cache_shards);
+  _invert_composition_shards.init(composition_cache_shards);
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
 }
 
@@ -1512,6 +1461,156 @@ return_unique(TransformState *state) {
   return pt_state;
 }
 
+/**
+ * The part of compose() that looks up and updates the composition cache
+ * stored on this object, under protection of the _states_lock.
+ */
+CPT(TransformState) TransformState::
+do_cached_compose(const TransformState *other) const {
+  LightReMutexHolder holder(*_states_lock);
+
+  // Is this composition already cached?
+  int index = _composition_cache.find(other);
+  if (index != -1) {
+    const Composition &comp = _composition_cache.get_data(index);
+    if (comp._result != nullptr) {
+      // Success!
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
+  }
+
+  // Not in the cache.  Compute a new result.  It's important that we don't
+  // hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  CPT(TransformState) result = do_compose(other);
+
+  if (index != -1) {
+    Composition &comp = _composition_cache.modify_data(index);
+    // Well, it wasn't cached already, but we already had an entry (probably
+    // created for the reverse direction), so use the same entry to store
+    // the new result.
+    comp._result = result;
+
+    if (result != (const TransformState *)this) {
+      // See the comments below about the need to up the reference count
+      // only when the result is not the same as this.
+      result->cache_ref();
+    }
+    // Here's the cache!
+    _cache_stats.inc_hits();
+    return result;
+  }
+  _cache_stats.inc_misses();
+
+  // We need to make a new cache entry, both in this object and in the other
+  // object.  We make both records so the other TransformState object will
+  // know to delete the entry from this object when it destructs, and vice-
+  // versa.
+
+  // The cache entry in this object is the only one that indicates the result;
+  // the other will be NULL for now.
+  _cache_stats.add_total_size(1);
+  _cache_stats.inc_adds(_composition_cache.is_empty());
+
+  _composition_cache[other]._result = result;
+
+  if (other != this) {
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(other->_composition_cache.is_empty());
+    other->_composition_cache[this]._result = nullptr;
+  }
+
+  if (result != (TransformState *)this) {
+    // If the result of do_compose() is something other than this, explicitly
+    // increment the reference count.  We have to be sure to decrement it
+    // again later, when the composition entry is removed from the cache.
+    result->cache_ref();
+
+    // (If the result was just this again, we still store the result, but we
+    // don't increment the reference count, since that would be a self-
+    // referential leak.)
+  }
+
+  _cache_stats.maybe_report("TransformState");
+
+  return result;
+}
+
+/**
+ * The part of invert_compose() that looks up and updates the invert
+ * composition cache stored on this object, under protection of the
+ * _states_lock.
+ */
+CPT(TransformState) TransformState::
+do_cached_invert_compose(const TransformState *other) const {
+  LightReMutexHolder holder(*_states_lock);
+
+  int index = _invert_composition_cache.find(other);
+  if (index != -1) {
+    const Composition &comp = _invert_composition_cache.get_data(index);
+    if (comp._result != nullptr) {
+      // Success!
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
+  }
+
+  // Not in the cache.  Compute a new result.  It's important that we don't
+  // hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  CPT(TransformState) result = do_invert_compose(other);
+
+  // Is this composition already cached?
+  if (index != -1) {
+    Composition &comp = _invert_composition_cache.modify_data(index);
+    // Well, it wasn't cached already, but we already had an entry (probably
+    // created for the reverse direction), so use the same entry to store
+    // the new result.
+    comp._result = result;
+
+    if (result != (const TransformState *)this) {
+      // See the comments below about the need to up the reference count
+      // only when the result is not the same as this.
+      result->cache_ref();
+    }
+    // Here's the cache!
+    _cache_stats.inc_hits();
+    return result;
+  }
+  _cache_stats.inc_misses();
+
+  // We need to make a new cache entry, both in this object and in the other
+  // object.  We make both records so the other TransformState object will
+  // know to delete the entry from this object when it destructs, and vice-
+  // versa.
+
+  // The cache entry in this object is the only one that indicates the result;
+  // the other will be NULL for now.
+  _cache_stats.add_total_size(1);
+  _cache_stats.inc_adds(_invert_composition_cache.is_empty());
+  _invert_composition_cache[other]._result = result;
+
+  if (other != this) {
+    _cache_stats.add_total_size(1);
+    _cache_stats.inc_adds(other->_invert_composition_cache.is_empty());
+    other->_invert_composition_cache[this]._result = nullptr;
+  }
+
+  if (result != (TransformState *)this) {
+    // If the result of compose() is something other than this, explicitly
+    // increment the reference count.  We have to be sure to decrement it
+    // again later, when the composition entry is removed from the cache.
+    result->cache_ref();
+
+    // (If the result was just this again, we still store the result, but we
+    // don't increment the reference count, since that would be a self-
+    // referential leak.)
+  }
+
+  return result;
+}
+
 /**
  * The private implemention of compose(); this actually composes two
  * TransformStates, without bothering with the cache.
@@ -1893,6 +1992,7 @@ release_new() {
 
   if (_saved_entry != -1) {
     _saved_entry = -1;
+    _gc_generation = 0;
     nassertv_always(_states->remove(this));
   }
 }
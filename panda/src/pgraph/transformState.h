@@ -31,6 +31,7 @@
 #include "deletedChain.h"
 #include "simpleHashMap.h"
 #include "cacheStats.h"
+#include "shardedCompositionCache.h"
 #include "extension.h"
 
 class GraphicsStateGuardianBase;
@@ -232,6 +233,8 @@ private:
   static CPT(TransformState) return_new(TransformState *state);
   static CPT(TransformState) return_unique(TransformState *state);
 
+  CPT(TransformState) do_cached_compose(const TransformState *other) const;
+  CPT(TransformState) do_cached_invert_compose(const TransformState *other) const;
   CPT(TransformState) do_compose(const TransformState *other) const;
   CPT(TransformState) do_invert_compose(const TransformState *other) const;
   void detect_and_break_cycles();
@@ -257,11 +260,23 @@ private:
   static CPT(TransformState) _identity_state;
   static CPT(TransformState) _invalid_state;
 
+  // These front the per-object composition caches, so that repeated
+  // compositions can be answered without grabbing _states_lock.  They are
+  // disabled unless composition-cache-shards is set.
+  typedef ShardedCompositionCache<TransformState> CompositionShards;
+  static CompositionShards _composition_shards;
+  static CompositionShards _invert_composition_shards;
+
   // This iterator records the entry corresponding to this TransformState
   // object in the above global set.  We keep the index around so we can
   // remove it when the TransformState destructs.
   int _saved_entry;
 
+  // The number of garbage collection passes this state has survived, up to
+  // garbage-collect-states-generations; see garbage_collect().  This fits in
+  // the padding after _saved_entry.
+  unsigned char _gc_generation;
+
   // This data structure manages the job of caching the composition of two
   // TransformStates.  It's complicated because we have to be sure to remove
   // the entry if *either* of the input TransformStates destructs.  To
@@ -294,6 +309,10 @@ private:
   // cycle.
   static size_t _garbage_index;
 
+  // This counts the number of complete passes the garbage collector has made
+  // through the cache, which determines which generations are examined.
+  static unsigned int _garbage_pass;
+
   static bool _uniquify_matrix;
 
   static PStatCollector _cache_update_pcollector;
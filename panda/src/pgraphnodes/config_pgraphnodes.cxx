@@ -27,9 +27,11 @@
 #include "nodeCullCallbackData.h"
 #include "pointLight.h"
 #include "rectangleLight.h"
+#include "retainedCullNode.h"
 #include "selectiveChildNode.h"
 #include "sequenceNode.h"
 #include "shaderGenerator.h"
+#include "spatialIndexNode.h"
 #include "sphereLight.h"
 #include "spotlight.h"
 #include "switchNode.h"
@@ -127,9 +129,11 @@ init_libpgraphnodes() {
   NodeCullCallbackData::init_type();
   PointLight::init_type();
   RectangleLight::init_type();
+  RetainedCullNode::init_type();
   SelectiveChildNode::init_type();
   SequenceNode::init_type();
   ShaderGenerator::init_type();
+  SpatialIndexNode::init_type();
   SphereLight::init_type();
   Spotlight::init_type();
   SwitchNode::init_type();
@@ -144,8 +148,10 @@ init_libpgraphnodes() {
   LODNode::register_with_read_factory();
   PointLight::register_with_read_factory();
   RectangleLight::register_with_read_factory();
+  RetainedCullNode::register_with_read_factory();
   SelectiveChildNode::register_with_read_factory();
   SequenceNode::register_with_read_factory();
+  SpatialIndexNode::register_with_read_factory();
   SphereLight::register_with_read_factory();
   Spotlight::register_with_read_factory();
   SwitchNode::register_with_read_factory();
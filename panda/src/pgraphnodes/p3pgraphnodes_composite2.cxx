@@ -1,10 +1,12 @@
 #include "nodeCullCallbackData.cxx"
 #include "pointLight.cxx"
 #include "rectangleLight.cxx"
+#include "retainedCullNode.cxx"
 #include "sceneGraphAnalyzer.cxx"
 #include "selectiveChildNode.cxx"
 #include "sequenceNode.cxx"
 #include "shaderGenerator.cxx"
+#include "spatialIndexNode.cxx"
 #include "sphereLight.cxx"
 #include "spotlight.cxx"
 #include "switchNode.cxx"
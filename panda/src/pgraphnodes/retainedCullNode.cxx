@@ -0,0 +1,378 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file retainedCullNode.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "retainedCullNode.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "cullableObject.h"
+#include "cullHandler.h"
+#include "cullPlanes.h"
+#include "sceneSetup.h"
+#include "lightMutexHolder.h"
+#include "bamReader.h"
+
+TypeHandle RetainedCullNode::_type_handle;
+
+/**
+ *
+ */
+RetainedCullNode::
+RetainedCullNode(const std::string &name) :
+  PandaNode(name),
+  _next_instance(0)
+{
+  set_cull_callback();
+}
+
+/**
+ * The retained results are not copied; the copy will record its own the
+ * first time it is visited.
+ */
+RetainedCullNode::
+RetainedCullNode(const RetainedCullNode &copy) :
+  PandaNode(copy),
+  _next_instance(0)
+{
+}
+
+/**
+ * Discards the retained results, so that the subgraph will be walked again
+ * the next time this node is visited.  It is only necessary to call this
+ * after making a change that is not otherwise detected, such as changing the
+ * RenderEffects of a node below this one.
+ */
+void RetainedCullNode::
+invalidate() {
+  CPT(Capture) capture;
+  CPT(Instance) instances[max_instances];
+
+  LightMutexHolder holder(_lock);
+  _capture.swap(capture);
+  for (int i = 0; i < max_instances; ++i) {
+    _instances[i].swap(instances[i]);
+  }
+}
+
+/**
+ * Returns true if the subgraph of this node can currently be retained, or
+ * false if it contains something that requires the normal cull traversal.
+ */
+bool RetainedCullNode::
+is_retained(Thread *current_thread) {
+  CPT(Capture) capture = get_capture(current_thread);
+  return capture->_retainable;
+}
+
+/**
+ * Returns a newly-allocated Node that is a shallow copy of this one.  It will
+ * be a different Node pointer, but its internal data may or may not be shared
+ * with that of the original Node.
+ */
+PandaNode *RetainedCullNode::
+make_copy() const {
+  return new RetainedCullNode(*this);
+}
+
+/**
+ * Returns true if it is generally safe to combine this particular kind of
+ * PandaNode with other kinds of PandaNodes of compatible type, adding
+ * children or whatever.  For instance, an LODNode should not be combined with
+ * any other PandaNode, because its set of children is meaningful.
+ */
+bool RetainedCullNode::
+safe_to_combine() const {
+  return false;
+}
+
+/**
+ * This function will be called during the cull traversal to perform any
+ * additional operations that should be performed at cull time.  This may
+ * include additional manipulation of render state or additional
+ * visible/invisible decisions, or any other arbitrary operation.
+ *
+ * By the time this function is called, the node has already passed the
+ * bounding-volume test for the viewing frustum, and the node's transform and
+ * state have already been applied to the indicated CullTraverserData object.
+ *
+ * The return value is true if this node should be visible, or false if it
+ * should be culled.
+ */
+bool RetainedCullNode::
+cull_callback(CullTraverser *trav, CullTraverserData &data) {
+  if (!data._cull_planes->is_empty()) {
+    // Clip planes and occluders can't be handled here.
+    return true;
+  }
+
+  CPT(Capture) capture = get_capture(trav->get_current_thread());
+  if (!capture->_retainable) {
+    return true;
+  }
+  if (capture->_has_tags && trav->has_tag_state_key()) {
+    // The camera may substitute a different state for some of the tagged
+    // nodes, which we have not recorded.
+    return true;
+  }
+
+  CPT(Instance) instance =
+    get_instance(capture, trav->get_scene()->get_cs_world_transform(),
+                 data._net_transform, data._state);
+
+  CullHandler *cull_handler = trav->get_cull_handler();
+  GeometricBoundingVolume *view_frustum = data._view_frustum;
+
+  size_t num_entries = capture->_entries.size();
+  trav->_geoms_pcollector.add_level(num_entries);
+  for (size_t i = 0; i < num_entries; ++i) {
+    const Entry &entry = capture->_entries[i];
+    if (view_frustum != nullptr &&
+        view_frustum->contains(entry._bounds) == BoundingVolume::IF_no_intersection) {
+      continue;
+    }
+
+    CullableObject *object =
+      new CullableObject(entry._geom, instance->_states[i],
+                         instance->_internal_transforms[i]);
+    cull_handler->record_object(object, trav);
+  }
+
+  // We have taken care of everything below this node.
+  return false;
+}
+
+/**
+ * Returns the recorded contents of the subgraph, walking it again first if
+ * anything in it has changed since it was last recorded.
+ */
+CPT(RetainedCullNode::Capture) RetainedCullNode::
+get_capture(Thread *current_thread) {
+  // The bounding volume sequence changes whenever the nodes below us do, but
+  // the Geoms of the GeomNodes must be checked separately.
+  UpdateSeq bounds_seq;
+  get_bounds(bounds_seq, current_thread);
+
+  CPT(Capture) current;
+  {
+    LightMutexHolder holder(_lock);
+    if (_capture != nullptr && _capture->_bounds_seq == bounds_seq) {
+      current = _capture;
+    }
+  }
+  if (current != nullptr && is_capture_current(current, current_thread)) {
+    return current;
+  }
+
+  // Walk the subgraph without holding the lock.  If another thread is doing
+  // the same, one of the results simply replaces the other.
+  PT(Capture) capture = new Capture;
+  capture->_bounds_seq = bounds_seq;
+  capture->_retainable = true;
+  capture->_has_tags = false;
+
+  PandaNode::Children children = get_children(current_thread);
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children && capture->_retainable; ++i) {
+    capture->_retainable =
+      r_capture(capture, children.get_child(i), TransformState::make_identity(),
+                RenderState::make_empty(), current_thread);
+  }
+  if (!capture->_retainable) {
+    capture->_entries.clear();
+  }
+
+  CPT(Capture) old_capture;
+  LightMutexHolder holder(_lock);
+  old_capture.swap(_capture);
+  _capture = capture;
+  return capture;
+}
+
+/**
+ * Returns true if each of the GeomNodes recorded in the indicated Capture
+ * still has the same Geoms and Geom states, and none of its Geoms or their
+ * vertices have been modified since.
+ */
+bool RetainedCullNode::
+is_capture_current(const Capture *capture, Thread *current_thread) {
+  for (const NodeRecord &record : capture->_geom_nodes) {
+    GeomNode::Geoms geoms = record._node->get_geoms(current_thread);
+    size_t num_geoms = record._geoms.size();
+    if ((size_t)geoms.get_num_geoms() != num_geoms) {
+      return false;
+    }
+    for (size_t i = 0; i < num_geoms; ++i) {
+      const GeomRecord &geom_record = record._geoms[i];
+      CPT(Geom) geom = geoms.get_geom((int)i);
+      if (geom != geom_record._geom ||
+          geoms.get_geom_state((int)i) != geom_record._state ||
+          geom->get_modified(current_thread) != geom_record._geom_modified ||
+          geom->get_vertex_data(current_thread)->get_modified(current_thread) != geom_record._vertices_modified) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the Instance of the indicated Capture for the indicated camera and
+ * net transform and state, computing it if it is not one of the ones we have
+ * kept.
+ */
+CPT(RetainedCullNode::Instance) RetainedCullNode::
+get_instance(const Capture *capture, const TransformState *cs_world_transform,
+             const TransformState *net_transform, const RenderState *net_state) {
+  {
+    LightMutexHolder holder(_lock);
+    for (int i = 0; i < max_instances; ++i) {
+      const Instance *instance = _instances[i];
+      if (instance != nullptr &&
+          instance->_capture == capture &&
+          instance->_cs_world_transform == cs_world_transform &&
+          instance->_net_transform == net_transform &&
+          instance->_net_state == net_state) {
+        return instance;
+      }
+    }
+  }
+
+  PT(Instance) instance = new Instance;
+  instance->_capture = capture;
+  instance->_cs_world_transform = cs_world_transform;
+  instance->_net_transform = net_transform;
+  instance->_net_state = net_state;
+
+  CPT(TransformState) internal_transform = cs_world_transform->compose(net_transform);
+  size_t num_entries = capture->_entries.size();
+  instance->_states.reserve(num_entries);
+  instance->_internal_transforms.reserve(num_entries);
+  for (const Entry &entry : capture->_entries) {
+    instance->_states.push_back(net_state->compose(entry._state));
+    instance->_internal_transforms.push_back(internal_transform->compose(entry._transform));
+  }
+
+  CPT(Instance) old_instance;
+  LightMutexHolder holder(_lock);
+  old_instance.swap(_instances[_next_instance]);
+  _instances[_next_instance] = instance;
+  _next_instance = (_next_instance + 1) % max_instances;
+  return instance;
+}
+
+/**
+ * Records the Geoms at the indicated node and below into the Capture, given
+ * the transform and state of its parent relative to this node.  Returns false
+ * if something was encountered that can't be retained.
+ */
+bool RetainedCullNode::
+r_capture(Capture *capture, PandaNode *node, const TransformState *transform,
+          const RenderState *state, Thread *current_thread) {
+  // Anything other than a transform or state requires the cull traversal to
+  // look at this node every frame.
+  int fancy_bits = node->get_fancy_bits(current_thread);
+  if ((fancy_bits & ~(PandaNode::FB_transform | PandaNode::FB_state | PandaNode::FB_tag)) != 0 ||
+      node->has_selective_visibility()) {
+    return false;
+  }
+
+  if (fancy_bits & PandaNode::FB_tag) {
+    capture->_has_tags = true;
+  }
+
+  CPT(TransformState) net_transform = transform->compose(node->get_transform(current_thread));
+  CPT(RenderState) net_state = state->compose(node->get_state(current_thread));
+
+  if (node->is_geom_node()) {
+    // The GeomNode is recorded before anything that might make the subgraph
+    // unretainable, so that a change that makes it retainable is noticed.
+    GeomNode::Geoms geoms = ((GeomNode *)node)->get_geoms(current_thread);
+    int num_geoms = geoms.get_num_geoms();
+    capture->_geom_nodes.push_back(NodeRecord());
+    NodeRecord &record = capture->_geom_nodes.back();
+    record._node = (GeomNode *)node;
+    record._geoms.resize(num_geoms);
+    for (int i = 0; i < num_geoms; ++i) {
+      GeomRecord &geom_record = record._geoms[i];
+      geom_record._geom = geoms.get_geom(i);
+      geom_record._state = geoms.get_geom_state(i);
+      geom_record._geom_modified = geom_record._geom->get_modified(current_thread);
+      geom_record._vertices_modified =
+        geom_record._geom->get_vertex_data(current_thread)->get_modified(current_thread);
+    }
+
+    for (const GeomRecord &geom_record : record._geoms) {
+      const Geom *geom = geom_record._geom;
+      if (geom->is_empty()) {
+        continue;
+      }
+
+      Entry entry;
+      entry._state = net_state->compose(geom_record._state);
+      if (entry._state->has_cull_callback()) {
+        return false;
+      }
+      entry._transform = net_transform;
+
+      CPT(BoundingVolume) volume = geom->get_bounds(current_thread);
+      PT(BoundingVolume) bounds = volume->make_copy();
+      entry._bounds = bounds->as_geometric_bounding_volume();
+      nassertr(entry._bounds != nullptr, false);
+      if (!net_transform->is_identity()) {
+        entry._bounds->xform(net_transform->get_mat());
+      }
+
+      entry._geom = geom;
+      capture->_entries.push_back(std::move(entry));
+    }
+
+  } else if (node->is_renderable()) {
+    // Some other kind of node that adds something to the cull result.
+    return false;
+  }
+
+  PandaNode::Children children = node->get_children(current_thread);
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    if (!r_capture(capture, children.get_child(i), net_transform, net_state,
+                   current_thread)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Tells the BamReader how to create objects of type RetainedCullNode.
+ */
+void RetainedCullNode::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type RetainedCullNode is encountered in the Bam file.  It should create the
+ * RetainedCullNode and extract its information from the file.
+ */
+TypedWritable *RetainedCullNode::
+make_from_bam(const FactoryParams &params) {
+  RetainedCullNode *node = new RetainedCullNode("");
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+
+  return node;
+}
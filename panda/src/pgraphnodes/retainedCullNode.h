@@ -0,0 +1,167 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file retainedCullNode.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef RETAINEDCULLNODE_H
+#define RETAINEDCULLNODE_H
+
+#include "pandabase.h"
+#include "pandaNode.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "renderState.h"
+#include "transformState.h"
+#include "geometricBoundingVolume.h"
+#include "updateSeq.h"
+#include "lightMutex.h"
+#include "pvector.h"
+
+/**
+ * A node that retains the results of culling the static geometry beneath it,
+ * so that the cull traversal need not walk its subgraph every frame.
+ *
+ * The first time the node is visited, it walks its subgraph once, and records
+ * each Geom it finds along with its transform and state relative to this
+ * node, and its bounding volume in this node's coordinate space.  On each
+ * subsequent frame, these Geoms are simply tested against the view frustum
+ * and passed on for rendering, without any further traversal.  The composed
+ * states and transforms are also remembered from frame to frame, so long as
+ * the camera and the node's net transform and state remain the same.
+ *
+ * The recorded list is rebuilt automatically whenever the node's bounding
+ * volume is invalidated, which happens whenever a transform, state or child
+ * anywhere below it is changed, and whenever a GeomNode below it has a
+ * different set of Geoms or Geom states, or one of its Geoms or their
+ * vertices is modified.  Changes to RenderEffects and tags are not detected,
+ * however; call invalidate() after making such changes.
+ *
+ * Only plain GeomNodes and PandaNodes can be retained.  If the subgraph
+ * contains anything that must be examined at cull time, such as an LODNode,
+ * a billboard, a hidden node or a cull callback, this node silently falls
+ * back to the normal traversal.  The same happens while there are any clip
+ * planes or occluders in effect, and for a camera with a tag state key, if
+ * any node in the subgraph has tags.
+ */
+class EXPCL_PANDA_PGRAPHNODES RetainedCullNode : public PandaNode {
+PUBLISHED:
+  explicit RetainedCullNode(const std::string &name);
+
+  void invalidate();
+  bool is_retained(Thread *current_thread = Thread::get_current_thread());
+
+protected:
+  RetainedCullNode(const RetainedCullNode &copy);
+
+public:
+  virtual PandaNode *make_copy() const;
+  virtual bool safe_to_combine() const;
+
+  virtual bool cull_callback(CullTraverser *trav, CullTraverserData &data);
+
+private:
+  // One of these is recorded for each Geom in the subgraph.
+  class Entry {
+  public:
+    CPT(Geom) _geom;
+    CPT(RenderState) _state;
+    CPT(TransformState) _transform;
+    PT(GeometricBoundingVolume) _bounds;
+  };
+  typedef pvector<Entry> Entries;
+
+  // Changes to the Geoms of a GeomNode don't necessarily change the bounding
+  // volume sequence, so one of these is recorded for each Geom of each
+  // GeomNode in the subgraph, to be compared against the node each frame.
+  class GeomRecord {
+  public:
+    CPT(Geom) _geom;
+    CPT(RenderState) _state;
+    UpdateSeq _geom_modified;
+    UpdateSeq _vertices_modified;
+  };
+  class NodeRecord {
+  public:
+    CPT(GeomNode) _node;
+    pvector<GeomRecord> _geoms;
+  };
+  typedef pvector<NodeRecord> NodeRecords;
+
+  // The result of walking the subgraph.  This is never modified once it has
+  // been built, so it may be used without holding the lock.
+  class Capture : public ReferenceCount {
+  public:
+    UpdateSeq _bounds_seq;
+    bool _retainable;
+    bool _has_tags;
+    Entries _entries;
+    NodeRecords _geom_nodes;
+  };
+
+  // The states and internal transforms of the entries of a Capture, composed
+  // for a particular camera and net transform and state of this node.  This
+  // is likewise never modified once it has been built.
+  class Instance : public ReferenceCount {
+  public:
+    CPT(Capture) _capture;
+    CPT(TransformState) _cs_world_transform;
+    CPT(TransformState) _net_transform;
+    CPT(RenderState) _net_state;
+    pvector<CPT(RenderState)> _states;
+    pvector<CPT(TransformState)> _internal_transforms;
+  };
+
+  CPT(Capture) get_capture(Thread *current_thread);
+  static bool is_capture_current(const Capture *capture, Thread *current_thread);
+  CPT(Instance) get_instance(const Capture *capture,
+                             const TransformState *cs_world_transform,
+                             const TransformState *net_transform,
+                             const RenderState *net_state);
+  static bool r_capture(Capture *capture, PandaNode *node,
+                        const TransformState *transform,
+                        const RenderState *state, Thread *current_thread);
+
+  enum {
+    // The number of Instances to keep, so that a few cameras viewing the
+    // same node, such as the faces of a cube map, don't evict each other.
+    max_instances = 8,
+  };
+
+  LightMutex _lock;
+  CPT(Capture) _capture;
+  CPT(Instance) _instances[max_instances];
+  int _next_instance;
+
+public:
+  static void register_with_read_factory();
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    PandaNode::init_type();
+    register_type(_type_handle, "RetainedCullNode",
+                  PandaNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#endif
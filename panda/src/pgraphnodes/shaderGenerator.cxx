@@ -577,6 +577,7 @@ analyze_renderstate(ShaderKey &key, const RenderState *rs) {
 void ShaderGenerator::
 rehash_generated_shaders() {
   LightReMutexHolder holder(*RenderState::_states_lock);
+  LightMutexHolder mungers_holder(RenderState::_mungers_lock);
 
   // With uniquify-states turned on, we can actually go through all the states
   // and check whether their generated shader is still OK.
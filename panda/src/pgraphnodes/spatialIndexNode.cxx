@@ -0,0 +1,211 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file spatialIndexNode.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "spatialIndexNode.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "config_pgraph.h"
+#include "finiteBoundingVolume.h"
+#include "lightMutexHolder.h"
+#include "bamReader.h"
+
+#include <algorithm>
+
+TypeHandle SpatialIndexNode::_type_handle;
+
+/**
+ *
+ */
+SpatialIndexNode::
+SpatialIndexNode(const std::string &name) :
+  PandaNode(name)
+{
+  set_cull_callback();
+}
+
+/**
+ * The index is not copied; the copy will build its own the first time it is
+ * needed.
+ */
+SpatialIndexNode::
+SpatialIndexNode(const SpatialIndexNode &copy) :
+  PandaNode(copy)
+{
+}
+
+/**
+ * Fills result with the indices of all of the children whose bounding
+ * volumes might intersect the indicated volume, which should be in this
+ * node's coordinate space.  The indices are returned in increasing order.
+ */
+void SpatialIndexNode::
+find_children(const GeometricBoundingVolume *volume, vector_int &result,
+              Thread *current_thread) {
+  result.clear();
+
+  LightMutexHolder holder(_lock);
+  update_index(current_thread);
+  _tree.find_overlaps(volume, result);
+  result.insert(result.end(), _unindexed.begin(), _unindexed.end());
+  std::sort(result.begin(), result.end());
+}
+
+/**
+ * Returns a newly-allocated Node that is a shallow copy of this one.  It will
+ * be a different Node pointer, but its internal data may or may not be shared
+ * with that of the original Node.
+ */
+PandaNode *SpatialIndexNode::
+make_copy() const {
+  return new SpatialIndexNode(*this);
+}
+
+/**
+ * Returns true if it is generally safe to combine this particular kind of
+ * PandaNode with other kinds of PandaNodes of compatible type, adding
+ * children or whatever.  For instance, an LODNode should not be combined with
+ * any other PandaNode, because its set of children is meaningful.
+ */
+bool SpatialIndexNode::
+safe_to_combine() const {
+  return false;
+}
+
+/**
+ * This function will be called during the cull traversal to perform any
+ * additional operations that should be performed at cull time.  This may
+ * include additional manipulation of render state or additional
+ * visible/invisible decisions, or any other arbitrary operation.
+ *
+ * By the time this function is called, the node has already passed the
+ * bounding-volume test for the viewing frustum, and the node's transform and
+ * state have already been applied to the indicated CullTraverserData object.
+ *
+ * The return value is true if this node should be visible, or false if it
+ * should be culled.
+ */
+bool SpatialIndexNode::
+cull_callback(CullTraverser *trav, CullTraverserData &data) {
+  if (data._view_frustum == nullptr || fake_view_frustum_cull) {
+    // Every child will be visited anyway.
+    return true;
+  }
+
+  Thread *current_thread = trav->get_current_thread();
+  Children children = get_children(current_thread);
+  int num_children = children.get_num_children();
+  if (num_children < min_indexed_children) {
+    return true;
+  }
+
+  vector_int indices;
+  find_children(data._view_frustum, indices, current_thread);
+
+  for (int i : indices) {
+    if (i < num_children) {
+      CullTraverserData next_data(data, children.get_child(i));
+      trav->traverse(next_data);
+    }
+  }
+
+  // We've already visited the children.
+  return false;
+}
+
+/**
+ * Brings the index up to date with the current bounding volumes of the
+ * children, if anything has changed.  Assumes the lock is held.
+ */
+void SpatialIndexNode::
+update_index(Thread *current_thread) {
+  UpdateSeq seq;
+  get_bounds(seq, current_thread);
+  if (seq == _bounds_seq && _children.size() == _tree.get_num_items()) {
+    return;
+  }
+
+  Children children = get_children(current_thread);
+  size_t num_children = children.get_num_children();
+
+  bool list_changed = (num_children != _children.size());
+  _children.resize(num_children);
+  for (size_t i = 0; i < num_children; ++i) {
+    PandaNode *child = children.get_child(i);
+    if (_children[i] != child) {
+      _children[i] = child;
+      list_changed = true;
+    }
+  }
+  if (list_changed) {
+    _tree.set_num_items(num_children);
+  }
+
+  _unindexed.clear();
+  size_t num_moved = 0;
+  for (size_t i = 0; i < num_children; ++i) {
+    CPT(BoundingVolume) bounds = _children[i]->get_bounds(current_thread);
+    const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+
+    if (bounds->is_empty()) {
+      // Nothing will ever be found within this child.
+      _tree.set_item_empty(i);
+
+    } else if (fbv == nullptr || bounds->is_infinite()) {
+      _tree.set_item_empty(i);
+      _unindexed.push_back((int)i);
+
+    } else {
+      LPoint3 min = fbv->get_min();
+      LPoint3 max = fbv->get_max();
+      if (_tree.is_item_empty(i) ||
+          _tree.get_item_min(i) != min || _tree.get_item_max(i) != max) {
+        _tree.set_item(i, min, max);
+        ++num_moved;
+      }
+    }
+  }
+
+  if (_tree.is_stale() || num_moved * 4 > num_children) {
+    // Too much has changed for the old tree to be any good.
+    _tree.rebuild();
+  } else if (num_moved != 0) {
+    _tree.refit();
+  }
+
+  _bounds_seq = seq;
+}
+
+/**
+ * Tells the BamReader how to create objects of type SpatialIndexNode.
+ */
+void SpatialIndexNode::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type SpatialIndexNode is encountered in the Bam file.  It should create the
+ * SpatialIndexNode and extract its information from the file.
+ */
+TypedWritable *SpatialIndexNode::
+make_from_bam(const FactoryParams &params) {
+  SpatialIndexNode *node = new SpatialIndexNode("");
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+
+  return node;
+}
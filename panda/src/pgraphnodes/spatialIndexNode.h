@@ -0,0 +1,101 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file spatialIndexNode.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef SPATIALINDEXNODE_H
+#define SPATIALINDEXNODE_H
+
+#include "pandabase.h"
+#include "pandaNode.h"
+#include "boundingBoxTree.h"
+#include "updateSeq.h"
+#include "lightMutex.h"
+#include "pvector.h"
+#include "vector_int.h"
+
+class GeometricBoundingVolume;
+
+/**
+ * A node that keeps a spatial index of the bounding volumes of its children,
+ * so that a node with a very large number of children, such as the root of
+ * an unflattened level, need not have each child tested individually against
+ * the view frustum.  Both the cull traversal and the CollisionTraverser use
+ * the index to reject whole groups of children at once.
+ *
+ * The index is brought up to date automatically whenever this node's
+ * bounding volume changes.  If the children have only moved a little, the
+ * existing index is simply adjusted to fit; otherwise it is rebuilt.
+ *
+ * Children are still visited in their usual order, so this node renders
+ * exactly the same as a plain PandaNode.
+ */
+class EXPCL_PANDA_PGRAPHNODES SpatialIndexNode : public PandaNode {
+PUBLISHED:
+  explicit SpatialIndexNode(const std::string &name);
+
+  void find_children(const GeometricBoundingVolume *volume,
+                     vector_int &result,
+                     Thread *current_thread = Thread::get_current_thread());
+
+protected:
+  SpatialIndexNode(const SpatialIndexNode &copy);
+
+public:
+  virtual PandaNode *make_copy() const;
+  virtual bool safe_to_combine() const;
+
+  virtual bool cull_callback(CullTraverser *trav, CullTraverserData &data);
+
+private:
+  void update_index(Thread *current_thread);
+
+  enum {
+    // Below this many children, it's not worth consulting the index.
+    min_indexed_children = 8,
+  };
+
+  LightMutex _lock;
+  BoundingBoxTree _tree;
+  UpdateSeq _bounds_seq;
+
+  // The children as of the last update, for detecting changes to the list.
+  pvector<PandaNode *> _children;
+
+  // The children whose bounds are infinite or not boxes; these are always
+  // visited.
+  vector_int _unindexed;
+
+public:
+  static void register_with_read_factory();
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    PandaNode::init_type();
+    register_type(_type_handle, "SpatialIndexNode",
+                  PandaNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#endif
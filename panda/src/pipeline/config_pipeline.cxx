@@ -57,6 +57,14 @@ ConfigVariableInt thread_stack_size
           "created for each newly-created thread.  Not all thread "
           "implementations respect this value."));
 
+ConfigVariableInt worker_pool_threads
+("worker-pool-threads", 0,
+ PRC_DESC("Specifies the number of threads in the global WorkerPool, which "
+          "is used to spread certain per-frame operations, such as culling "
+          "large scenes, over multiple CPU cores.  Set this to 0 to perform "
+          "all such work in the thread that requests it.  A good value is "
+          "one less than the number of available cores."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -21,3 +21,4 @@
 #include "threadSimpleManager.cxx"
 #include "threadWin32Impl.cxx"
 #include "threadPriority.cxx"
+#include "workerPool.cxx"
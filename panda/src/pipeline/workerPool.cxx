@@ -0,0 +1,222 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerPool.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "workerPool.h"
+#include "config_pipeline.h"
+#include "mutexHolder.h"
+
+AtomicAdjust::Pointer WorkerPool::_global_ptr = nullptr;
+Mutex WorkerPool::_global_lock("WorkerPool::_global_lock");
+
+/**
+ *
+ */
+WorkerPool::Job::
+~Job() {
+}
+
+/**
+ * Creates a pool with the indicated number of worker threads.  The threads
+ * are started immediately, and sleep until work is submitted.  If threading
+ * is not available, no threads are created, and all work is performed by the
+ * thread that submits it.
+ */
+WorkerPool::
+WorkerPool(const std::string &name, int num_threads) :
+  _work_cvar(_lock),
+  _done_cvar(_lock),
+  _batches(nullptr),
+  _shutdown(false)
+{
+  if (!Thread::is_threading_supported()) {
+    num_threads = 0;
+  }
+
+  _threads.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    std::ostringstream strm;
+    strm << name << "-" << i;
+    PT(WorkerThread) thread = new WorkerThread(strm.str(), this);
+    if (!thread->start(TP_normal, true)) {
+      pipeline_cat.error()
+        << "Could not start thread " << strm.str() << "\n";
+      break;
+    }
+    _threads.push_back(thread);
+  }
+}
+
+/**
+ * Stops and joins all of the worker threads.  It is an error to destruct the
+ * pool while any thread is still inside run().
+ */
+WorkerPool::
+~WorkerPool() {
+  {
+    MutexHolder holder(_lock);
+    nassertv(_batches == nullptr);
+    _shutdown = true;
+    _work_cvar.notify_all();
+  }
+
+  for (WorkerThread *thread : _threads) {
+    thread->join();
+  }
+  _threads.clear();
+}
+
+/**
+ * Calls job.run_item() once for each index in the range [0, num_items), in
+ * no particular order, spread out over the worker threads and the calling
+ * thread.  Returns when all of the items have been completed.
+ */
+void WorkerPool::
+run(Job &job, size_t num_items, Thread *current_thread) {
+  if (num_items == 0) {
+    return;
+  }
+
+  if (_threads.empty() || num_items == 1) {
+    // Nothing to be gained by handing this off.
+    for (size_t i = 0; i < num_items; ++i) {
+      job.run_item(i, current_thread);
+    }
+    return;
+  }
+
+  Batch batch;
+  batch._job = &job;
+  batch._num_items = num_items;
+  batch._pipeline_stage = current_thread->get_pipeline_stage();
+  batch._next_item = 0;
+  batch._num_done = 0;
+  batch._num_workers = 0;
+
+  {
+    MutexHolder holder(_lock);
+    batch._next = _batches;
+    _batches = &batch;
+    _work_cvar.notify_all();
+  }
+
+  // Now pitch in ourselves.
+  do_work(&batch, current_thread);
+
+  MutexHolder holder(_lock);
+
+  // All of the items have now been claimed, so take the batch off the list.
+  Batch **bp = &_batches;
+  while (*bp != &batch) {
+    bp = &(*bp)->_next;
+  }
+  *bp = batch._next;
+
+  // We can't return while a worker might still be referencing the batch.
+  while (batch._num_done < batch._num_items || batch._num_workers != 0) {
+    _done_cvar.wait();
+  }
+}
+
+/**
+ * Returns the global pool, creating it if necessary.  The number of threads
+ * in the global pool is controlled by the worker-pool-threads config
+ * variable.
+ */
+WorkerPool *WorkerPool::
+get_global_ptr() {
+  // This may be called first from several threads at once, such as the cull
+  // and collision threads, so make sure only one of them creates the pool.
+  WorkerPool *pool = (WorkerPool *)AtomicAdjust::get_ptr(_global_ptr);
+  if (pool == nullptr) {
+    MutexHolder holder(_global_lock);
+    pool = (WorkerPool *)AtomicAdjust::get_ptr(_global_ptr);
+    if (pool == nullptr) {
+      pool = new WorkerPool("worker", worker_pool_threads);
+      AtomicAdjust::set_ptr(_global_ptr, pool);
+    }
+  }
+  return pool;
+}
+
+/**
+ * Claims and runs items from the indicated batch until there are none left,
+ * then records the number of items completed.
+ */
+void WorkerPool::
+do_work(Batch *batch, Thread *current_thread) {
+  size_t num_done = 0;
+  size_t index = (size_t)AtomicAdjust::add(batch->_next_item, 1) - 1;
+  while (index < batch->_num_items) {
+    batch->_job->run_item(index, current_thread);
+    ++num_done;
+    index = (size_t)AtomicAdjust::add(batch->_next_item, 1) - 1;
+  }
+
+  if (num_done != 0) {
+    MutexHolder holder(_lock);
+    batch->_num_done += num_done;
+    if (batch->_num_done == batch->_num_items) {
+      _done_cvar.notify_all();
+    }
+  }
+}
+
+/**
+ * The main loop of each worker thread.
+ */
+void WorkerPool::
+worker_main(Thread *current_thread) {
+  MutexHolder holder(_lock);
+  while (!_shutdown) {
+    // Look for a batch that still has unclaimed items.
+    Batch *batch = _batches;
+    while (batch != nullptr &&
+           (size_t)AtomicAdjust::get(batch->_next_item) >= batch->_num_items) {
+      batch = batch->_next;
+    }
+
+    if (batch == nullptr) {
+      _work_cvar.wait();
+      continue;
+    }
+
+    ++batch->_num_workers;
+    _lock.release();
+
+    current_thread->set_pipeline_stage(batch->_pipeline_stage);
+    do_work(batch, current_thread);
+
+    _lock.acquire();
+    if (--batch->_num_workers == 0) {
+      _done_cvar.notify_all();
+    }
+  }
+}
+
+/**
+ *
+ */
+WorkerPool::WorkerThread::
+WorkerThread(const std::string &name, WorkerPool *pool) :
+  Thread(name, "WorkerPool"),
+  _pool(pool)
+{
+}
+
+/**
+ *
+ */
+void WorkerPool::WorkerThread::
+thread_main() {
+  _pool->worker_main(this);
+}
@@ -0,0 +1,115 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file workerPool.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include "pandabase.h"
+#include "thread.h"
+#include "pmutex.h"
+#include "conditionVarFull.h"
+#include "atomicAdjust.h"
+#include "pvector.h"
+
+/**
+ * A fixed set of worker threads for performing data-parallel work within a
+ * single frame, such as traversing independent subtrees of the scene graph.
+ *
+ * Work is submitted with run() as a Job consisting of some number of
+ * independent items.  The items are claimed one at a time by the idle worker
+ * threads, as well as by the thread that called run(), which participates in
+ * the work and returns only when all of the items have been completed.  Since
+ * items are handed out on demand, a thread that finishes early simply goes
+ * on to claim more, which balances the load between the threads.
+ *
+ * Several jobs may be in progress at once, submitted from different threads,
+ * and a job item may itself submit another job.  Because the submitting
+ * thread always works on its own job, this can never deadlock, even if all
+ * of the workers are busy elsewhere.
+ *
+ * While working on a job, each worker thread adopts the pipeline stage of the
+ * thread that submitted it, so that it sees the same view of the scene graph.
+ */
+class EXPCL_PANDA_PIPELINE WorkerPool {
+public:
+  /**
+   * The base class for a unit of work submitted to the pool.  Redefine
+   * run_item() to do the work for the item with the indicated index.  This
+   * will be called from several threads at once, each with a different
+   * index.
+   */
+  class EXPCL_PANDA_PIPELINE Job {
+  public:
+    virtual ~Job();
+    virtual void run_item(size_t index, Thread *current_thread)=0;
+  };
+
+  WorkerPool(const std::string &name, int num_threads);
+  WorkerPool(const WorkerPool &copy) = delete;
+  ~WorkerPool();
+
+  WorkerPool &operator = (const WorkerPool &copy) = delete;
+
+PUBLISHED:
+  INLINE int get_num_threads() const;
+  MAKE_PROPERTY(num_threads, get_num_threads);
+
+  static WorkerPool *get_global_ptr();
+
+public:
+  void run(Job &job, size_t num_items,
+           Thread *current_thread = Thread::get_current_thread());
+
+private:
+  // One of these is created on the stack of the thread that calls run(), and
+  // lives until all of the items have been completed.
+  class Batch {
+  public:
+    Job *_job;
+    size_t _num_items;
+    int _pipeline_stage;
+    AtomicAdjust::Integer _next_item;
+
+    // These are protected by the pool's _lock.
+    size_t _num_done;
+    int _num_workers;
+    Batch *_next;
+  };
+
+  void do_work(Batch *batch, Thread *current_thread);
+  void worker_main(Thread *current_thread);
+
+  class WorkerThread : public Thread {
+  public:
+    WorkerThread(const std::string &name, WorkerPool *pool);
+    virtual void thread_main();
+
+    WorkerPool *_pool;
+  };
+
+  typedef pvector<PT(WorkerThread)> Threads;
+  Threads _threads;
+
+  Mutex _lock;
+  ConditionVarFull _work_cvar;
+  ConditionVarFull _done_cvar;
+  Batch *_batches;
+  bool _shutdown;
+
+  static AtomicAdjust::Pointer _global_ptr;
+  static Mutex _global_lock;
+};
+
+#include "workerPool.I"
+
+#endif
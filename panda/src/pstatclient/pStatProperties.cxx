@@ -129,6 +129,7 @@ static TimeCollectorProperties time_properties[] = {
   { 0, "*:Munge:Decompose",                { 0.1, 0.3, 0.1 } },
   { 1, "*:PStats",                         { 0.4, 0.8, 1.0 } },
   { 1, "*:Animation",                      { 1.0, 0.0, 1.0 } },
+  { 1, "*:Animation:Parallel update",      { 0.6, 0.0, 0.8 } },
   { 0, "*:Flatten",                        { 0.0, 0.7, 0.4 } },
   { 0, "*:State Cache",                    { 0.4, 0.7, 0.7 } },
   { 0, "*:NodePath",                       { 0.1, 0.6, 0.8 } },
@@ -178,10 +179,17 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "Vertices:Indexed triangle strips", { 0.5, 0.2, 0.8 } },
   { 1, "Vertices:Display lists",           { 0.8, 0.5, 1.0 } },
   { 1, "Vertices:Immediate mode",          { 1.0, 0.5, 0.0 } },
+  { 1, "Skinned vertices",                 { 0.8, 0.2, 0.5 },  "K", 10, 1000 },
+  { 1, "Characters",                       { 0.9, 0.3, 0.9 },  "", 100 },
+  { 1, "Characters:Full",                  { 0.2, 0.8, 0.2 } },
+  { 1, "Characters:Reduced rate",          { 0.8, 0.8, 0.2 } },
+  { 1, "Characters:Held parts",            { 0.9, 0.5, 0.1 } },
+  { 1, "Characters:Frozen",                { 0.5, 0.5, 0.8 } },
   { 1, "Pixels",                           { 0.8, 0.3, 0.7 },  "M", 5, 1000000 },
   { 1, "Nodes",                            { 0.4, 0.2, 0.8 },  "", 500.0 },
   { 1, "Nodes:GeomNodes",                  { 0.8, 0.2, 0.0 } },
   { 1, "Geoms",                            { 0.4, 0.8, 0.3 },  "", 500.0 },
+  { 1, "Geoms:Instanced",                  { 0.9, 0.6, 0.2 } },
   { 1, "Cull volumes",                     { 0.7, 0.6, 0.9 },  "", 500.0 },
   { 1, "Cull volumes:Transforms",          { 0.9, 0.6, 0.0 } },
   { 1, "State changes",                    { 1.0, 0.5, 0.2 },  "", 500.0 },
@@ -219,6 +227,7 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "Dirty PipelineCyclers",            { 0.2, 0.2, 0.2 },  "", 5000 },
   { 1, "Collision Volumes",                { 1.0, 0.8, 0.5 },  "", 500 },
   { 1, "Collision Tests",                  { 0.5, 0.8, 1.0 },  "", 100 },
+  { 1, "Collision Entries",                { 0.8, 0.5, 1.0 },  "", 100 },
   { 1, "Command latency",                  { 0.8, 0.2, 0.0 },  "ms", 10, 1.0 / 1000.0 },
   { 0, nullptr }
 };
@@ -0,0 +1,207 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamSimplify.cxx
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#include "bamSimplify.h"
+
+#include "bamFile.h"
+#include "loader.h"
+#include "loaderOptions.h"
+#include "modelRoot.h"
+#include "nodePath.h"
+#include "meshSimplifier.h"
+#include "sceneGraphAnalyzer.h"
+
+/**
+ *
+ */
+BamSimplify::
+BamSimplify() : WithOutputFile(true, false, true)
+{
+  // Indicate the extension name we expect the user to supply for output
+  // files.
+  _preferred_extension = ".bam";
+
+  set_program_brief("reduce the triangles of a model, or generate LODs for it");
+  set_program_description
+    ("This program reads a model file, in any format that Panda can load, "
+     "reduces the number of triangles in its geometry, and writes the "
+     "result to a bam file.  With -lod, it instead generates a series of "
+     "increasingly simplified copies of the model and puts them under an "
+     "LODNode, so that the coarser copies are drawn at a distance.  Texture "
+     "seams and normal creases are preserved, and no new vertices are "
+     "created.");
+
+  clear_runlines();
+  add_runline("[opts] input.egg output.bam");
+  add_runline("[opts] -o output.bam input.egg");
+
+  add_option
+    ("o", "filename", 0,
+     "Specify the filename to which the resulting .bam file will be written.  "
+     "If this option is omitted, the last parameter name is taken to be the "
+     "name of the output file.",
+     &BamSimplify::dispatch_filename, &_got_output_filename, &_output_filename);
+
+  add_option
+    ("r", "ratio", 0,
+     "Specifies the fraction of the triangles to keep, or with -lod, the "
+     "fraction of the triangles of each level to keep in the next one.  The "
+     "default is 0.5.",
+     &BamSimplify::dispatch_double, nullptr, &_ratio);
+
+  add_option
+    ("lod", "levels", 0,
+     "Generates the indicated number of levels of detail, counting the "
+     "original model, instead of simplifying the model itself.",
+     &BamSimplify::dispatch_int, nullptr, &_num_levels);
+
+  add_option
+    ("dist", "distance", 0,
+     "Specifies the distance from the camera at which the original model "
+     "switches to the first simplified level, when -lod is given.  The "
+     "default is 50.",
+     &BamSimplify::dispatch_double, nullptr, &_switch_distance);
+
+  add_option
+    ("factor", "factor", 0,
+     "Specifies how much farther each level is switched out than the level "
+     "before it, when -lod is given.  The model disappears altogether beyond "
+     "the last level.  The default is 2.",
+     &BamSimplify::dispatch_double, nullptr, &_distance_factor);
+
+  add_option
+    ("e", "error", 0,
+     "Specifies the largest error, in model units, that the simplification "
+     "may introduce.  The simplification stops short of the requested number "
+     "of triangles rather than exceed this.  The default is no limit.",
+     &BamSimplify::dispatch_double, nullptr, &_max_error);
+
+  add_option
+    ("lock", "", 0,
+     "Prevents vertices on open edges and texture seams from being moved at "
+     "all, so that the model still lines up with neighboring pieces.",
+     &BamSimplify::dispatch_none, &_lock_boundaries);
+
+  add_option
+    ("ls", "", 0,
+     "Writes a scene graph listing to standard output after the model has "
+     "been simplified.",
+     &BamSimplify::dispatch_none, &_ls);
+
+  _ratio = 0.5;
+  _num_levels = 0;
+  _switch_distance = 50.0;
+  _distance_factor = 2.0;
+  _max_error = 0.0;
+}
+
+/**
+ *
+ */
+void BamSimplify::
+run() {
+  if (_ratio <= 0.0 || _ratio > 1.0) {
+    nout << "The ratio must be greater than 0 and no more than 1.\n";
+    exit(1);
+  }
+  if (_num_levels > 0 && (_switch_distance <= 0.0 || _distance_factor <= 1.0)) {
+    nout << "The distance must be positive, and the factor greater than 1.\n";
+    exit(1);
+  }
+
+  LoaderOptions options(LoaderOptions::LF_search |
+                        LoaderOptions::LF_report_errors |
+                        LoaderOptions::LF_no_cache);
+  PT(PandaNode) model = Loader::get_global_ptr()->load_sync(_input_filename, options);
+  if (model == nullptr) {
+    nout << "Unable to load " << _input_filename << "\n";
+    exit(1);
+  }
+
+  MeshSimplifier simplifier;
+  simplifier.set_max_error(_max_error);
+  simplifier.set_lock_boundaries(_lock_boundaries);
+
+  SceneGraphAnalyzer before;
+  before.add_node(model);
+
+  PT(PandaNode) root = model;
+  if (_num_levels > 0) {
+    // The LODNode goes under a new ModelRoot, so that the file still loads
+    // as a model.
+    root = new ModelRoot(model->get_name());
+    NodePath model_np = NodePath(root).attach_new_node(model);
+    simplifier.make_lod(model_np, _num_levels, _switch_distance,
+                        _distance_factor, _ratio);
+  } else {
+    simplifier.simplify(NodePath(root), _ratio);
+  }
+
+  SceneGraphAnalyzer after;
+  after.add_node(root);
+  nout << "Reduced " << before.get_num_tris() << " triangles to "
+       << after.get_num_tris() << ".\n";
+
+  if (_ls) {
+    root->ls(nout, 0);
+  }
+
+  // This should be guaranteed because we pass false to the constructor,
+  // above.
+  nassertv(has_output_filename());
+
+  Filename filename = get_output_filename();
+  filename.make_dir();
+  nout << "Writing " << filename << "\n";
+  BamFile bam_file;
+  if (!bam_file.open_write(filename)) {
+    nout << "Error in writing.\n";
+    exit(1);
+  }
+
+  if (!bam_file.write_object(root)) {
+    nout << "Error in writing.\n";
+    exit(1);
+  }
+}
+
+/**
+ *
+ */
+bool BamSimplify::
+handle_args(ProgramBase::Args &args) {
+  if (!check_last_arg(args, 1)) {
+    return false;
+  }
+
+  if (args.empty()) {
+    nout << "You must specify the model file to read on the command line.\n";
+    return false;
+  }
+
+  if (args.size() > 1) {
+    nout << "Specify only one model file on the command line.\n";
+    return false;
+  }
+
+  _input_filename = Filename::from_os_specific(args[0]);
+
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  BamSimplify prog;
+  prog.parse_command_line(argc, argv);
+  prog.run();
+  return 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamSimplify.h
+ * @author bzafarian
+ * @date 2026-10-17
+ */
+
+#ifndef BAMSIMPLIFY_H
+#define BAMSIMPLIFY_H
+
+#include "pandatoolbase.h"
+
+#include "programBase.h"
+#include "withOutputFile.h"
+#include "filename.h"
+
+/**
+ * A program to reduce the number of triangles in a model, or to generate a
+ * series of levels of detail for it, and write the result to a bam file.
+ */
+class BamSimplify : public ProgramBase, public WithOutputFile {
+public:
+  BamSimplify();
+
+  void run();
+
+protected:
+  virtual bool handle_args(Args &args);
+
+private:
+  Filename _input_filename;
+  double _ratio;
+  int _num_levels;
+  double _switch_distance;
+  double _distance_factor;
+  double _max_error;
+  bool _lock_boundaries;
+  bool _ls;
+};
+
+#endif
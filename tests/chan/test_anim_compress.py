@@ -0,0 +1,284 @@
+from panda3d import core
+import math
+import random
+import struct
+
+
+SCALE_TOLERANCE = 0.001
+HPR_TOLERANCE = 0.01
+POS_TOLERANCE = 0.001
+
+NUM_FRAMES = 120
+
+
+def smooth_table(base, amplitude, phase):
+    return [base + amplitude * math.sin(f * 0.05 + phase) for f in range(NUM_FRAMES)]
+
+
+def noisy_table(base, amplitude, seed):
+    rand = random.Random(seed)
+    return [base + amplitude * rand.uniform(-1, 1) for f in range(NUM_FRAMES)]
+
+
+def make_channel(parent, name, make_table):
+    chan = core.AnimChannelMatrixXfmTable(parent, name)
+    chan.set_table(b'i', core.PTA_stdfloat(make_table(1.0, 0.2, 1)))
+    chan.set_table(b'j', core.PTA_stdfloat([1.5]))
+    chan.set_table(b'h', core.PTA_stdfloat(make_table(0.0, 90.0, 2)))
+    chan.set_table(b'p', core.PTA_stdfloat(make_table(10.0, 30.0, 3)))
+    chan.set_table(b'x', core.PTA_stdfloat(make_table(5.0, 2.0, 4)))
+    chan.set_table(b'z', core.PTA_stdfloat(make_table(-3.0, 0.5, 5)))
+    return chan
+
+
+def compress(source, parent, name, scale_tolerance=SCALE_TOLERANCE,
+             hpr_tolerance=HPR_TOLERANCE, pos_tolerance=POS_TOLERANCE):
+    chan = core.AnimChannelMatrixCompressed(parent, name)
+    chan.set_tables(source, scale_tolerance, hpr_tolerance, pos_tolerance)
+    return chan
+
+
+def max_errors(source, chan):
+    """Returns the largest scale, hpr and pos error over all frames."""
+
+    errors = [0.0, 0.0, 0.0]
+    for frame in range(NUM_FRAMES):
+        for i, getter in enumerate(("get_scale", "get_hpr", "get_pos")):
+            expected = core.LVecBase3()
+            actual = core.LVecBase3()
+            getattr(source, getter)(frame, expected)
+            getattr(chan, getter)(frame, actual)
+            for c in range(3):
+                errors[i] = max(errors[i], abs(expected[c] - actual[c]))
+    return errors
+
+
+def assert_within_tolerance(source, chan, scale_tolerance=SCALE_TOLERANCE,
+                            hpr_tolerance=HPR_TOLERANCE, pos_tolerance=POS_TOLERANCE):
+    # Allow for the rounding of the 32-bit values themselves.
+    scale_error, hpr_error, pos_error = max_errors(source, chan)
+    assert scale_error <= scale_tolerance * 1.001 + 1e-6
+    assert hpr_error <= hpr_tolerance * 1.001 + 1e-5
+    assert pos_error <= pos_tolerance * 1.001 + 1e-6
+
+
+def assert_same_values(chan_a, chan_b):
+    for frame in range(NUM_FRAMES):
+        mat_a = core.LMatrix4()
+        mat_b = core.LMatrix4()
+        chan_a.get_value(frame, mat_a)
+        chan_b.get_value(frame, mat_b)
+        assert mat_a == mat_b
+
+
+def test_anim_compress_smooth():
+    # A smooth table is stored as keys between which the values are
+    # interpolated.
+    bundle = core.AnimBundle("anim", 24, NUM_FRAMES)
+    source = make_channel(bundle, "source", smooth_table)
+    chan = compress(source, bundle, "compressed")
+    assert_within_tolerance(source, chan)
+
+    # The keys take much less room than the five animated tables.
+    raw_size = 5 * NUM_FRAMES * 4
+    assert chan.get_data_size() < raw_size // 2
+
+
+def test_anim_compress_noisy():
+    # A noisy table is stored as a quantized value for every frame.
+    bundle = core.AnimBundle("anim", 24, NUM_FRAMES)
+    source = make_channel(bundle, "source", noisy_table)
+    chan = compress(source, bundle, "compressed")
+    assert_within_tolerance(source, chan)
+
+    smooth = compress(make_channel(bundle, "smooth", smooth_table), bundle, "c2")
+    assert chan.get_data_size() > smooth.get_data_size()
+
+
+def test_anim_compress_fine_tolerance():
+    # A tolerance that needs more than 16 bits for the range of the table.
+    bundle = core.AnimBundle("anim", 24, NUM_FRAMES)
+    source = make_channel(bundle, "source", noisy_table)
+    chan = compress(source, bundle, "compressed", 1e-5, 1e-3, 2e-5)
+    assert_within_tolerance(source, chan, 1e-5, 1e-3, 2e-5)
+
+
+def test_anim_compress_constant():
+    bundle = core.AnimBundle("anim", 24, NUM_FRAMES)
+    source = core.AnimChannelMatrixXfmTable(bundle, "source")
+    source.set_table(b'h', core.PTA_stdfloat([45.0] * NUM_FRAMES))
+    source.set_table(b'y', core.PTA_stdfloat([2.0]))
+    chan = compress(source, bundle, "compressed")
+
+    # Constant components are stored exactly.
+    for frame in (0, 1, NUM_FRAMES - 1):
+        hpr = core.LVecBase3()
+        pos = core.LVecBase3()
+        chan.get_hpr(frame, hpr)
+        chan.get_pos(frame, pos)
+        assert hpr == (45, 0, 0)
+        assert pos == (0, 2, 0)
+
+
+def test_anim_compress_bam():
+    bundle = core.AnimBundle("anim", 24, NUM_FRAMES)
+    group = core.AnimGroup(bundle, "<skeleton>")
+    smooth = make_channel(group, "smooth", smooth_table)
+    noisy = make_channel(group, "noisy", noisy_table)
+    compressed = bundle.copy_bundle_compressed()
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.init()
+    writer.write_object(compressed)
+    writer.flush()
+
+    reader = core.BamReader(buffer)
+    reader.init()
+    bundle2 = reader.read_object()
+    reader.resolve()
+
+    assert isinstance(bundle2, core.AnimBundle)
+    for source in (smooth, noisy):
+        chan = compressed.find_child(source.get_name())
+        chan2 = bundle2.find_child(source.get_name())
+        assert isinstance(chan2, core.AnimChannelMatrixCompressed)
+        assert chan2.get_data_size() == chan.get_data_size()
+        assert_same_values(chan, chan2)
+        assert_within_tolerance(source, chan2,
+                                core.ConfigVariableDouble("compress-anim-scale-tolerance").value,
+                                core.ConfigVariableDouble("compress-anim-hpr-tolerance").value,
+                                core.ConfigVariableDouble("compress-anim-pos-tolerance").value)
+
+
+def animate(anim, frames, compile_programs):
+    """Plays the animation on a fresh character, and returns the transform of
+    each joint at each of the indicated frames."""
+
+    var = core.ConfigVariableBool("compile-anim-programs")
+    orig_value = var.value
+    var.value = compile_programs
+    try:
+        character = core.Character("character")
+        bundle = character.get_bundle(0)
+        skeleton = core.PartGroup(bundle, "<skeleton>")
+        joints = []
+        parent = skeleton
+        for name in ("smooth", "noisy"):
+            joint = core.CharacterJoint(character, bundle, parent, name, core.LMatrix4.ident_mat())
+            joints.append(joint)
+            parent = joint
+
+        control = bundle.bind_anim(anim, core.PartGroup.HMF_ok_anim_extra, core.PartSubset())
+        assert control is not None
+
+        result = []
+        for frame in frames:
+            control.pose(frame)
+            character.force_update()
+            result.append([core.LMatrix4(joint.get_transform()) for joint in joints])
+        return result
+    finally:
+        var.value = orig_value
+
+
+def test_anim_compress_program():
+    # The compressed channels give the same joint transforms whether the
+    # bundle is evaluated with an AnimProgram or by walking the hierarchy.
+    bundle = core.AnimBundle("character", 24, NUM_FRAMES)
+    group = core.AnimGroup(bundle, "<skeleton>")
+    smooth = make_channel(group, "smooth", smooth_table)
+    make_channel(smooth, "noisy", noisy_table)
+    compressed = bundle.copy_bundle_compressed()
+
+    frames = [0, 1, 1, 5, 60, 59, NUM_FRAMES - 1, 3]
+    expected = animate(compressed, frames, False)
+    actual = animate(compressed, frames, True)
+    for frame_expected, frame_actual in zip(expected, actual):
+        for mat_expected, mat_actual in zip(frame_expected, frame_actual):
+            assert mat_actual.almost_equal(mat_expected, 1e-4)
+
+
+def write_and_read(bundle, patch=None):
+    """Writes the bundle to a bam stream, calls patch on the bytes if it is
+    given, and returns the bundle read back."""
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.init()
+    writer.write_object(bundle)
+    writer.flush()
+
+    if patch is not None:
+        data = bytearray(buffer.data)
+        patch(data)
+        buffer = core.DatagramBuffer(bytes(data))
+
+    reader = core.BamReader(buffer)
+    reader.init()
+    bundle2 = reader.read_object()
+    reader.resolve()
+    return bundle2
+
+
+def test_anim_compress_bam_corrupt():
+    # The x track goes linearly from 1234.5, so it is stored as two keys, and
+    # its fields can be found in the bam stream by its base value.
+    base = 1234.5
+    bundle = core.AnimBundle("anim", 24, NUM_FRAMES)
+    source = core.AnimChannelMatrixXfmTable(bundle, "chan")
+    source.set_table(b'x', core.PTA_stdfloat([base + f * 0.1 for f in range(NUM_FRAMES)]))
+    source.set_table(b'y', core.PTA_stdfloat(smooth_table(0.0, 1.0, 0)))
+    compressed = bundle.copy_bundle_compressed()
+
+    fmt = '<f' if core.LPoint3 is core.LPoint3f else '<d'
+    float_size = struct.calcsize(fmt)
+
+    def corrupt(field_offset, field_format, value):
+        def patch(data):
+            offset = data.find(struct.pack(fmt, base))
+            assert offset >= 0
+            struct.pack_into(field_format, data, offset + 2 * float_size + field_offset, value)
+        return patch
+
+    corruptions = [
+        corrupt(0, '<I', 1000),         # first_key
+        corrupt(4, '<I', 0xffffffff),   # first_bit
+        corrupt(8, '<H', 3),            # num_keys
+        corrupt(10, '<H', 1),           # num_frames
+        corrupt(12, '<B', 30),          # num_bits
+    ]
+    for patch in corruptions:
+        chan = write_and_read(compressed, patch).find_child("chan")
+        assert isinstance(chan, core.AnimChannelMatrixCompressed)
+
+        # The corrupt track holds its base value, and the others are intact.
+        for frame in (0, 1, NUM_FRAMES - 1):
+            pos = core.LVecBase3()
+            chan.get_pos(frame, pos)
+            assert pos[0] == base
+            assert abs(pos[1] - smooth_table(0.0, 1.0, 0)[frame]) <= 0.01
+
+
+def test_anim_compress_long_table():
+    # A table that is too long to compress is copied uncompressed.
+    num_frames = 70000
+    bundle = core.AnimBundle("anim", 24, num_frames)
+    source = core.AnimChannelMatrixXfmTable(bundle, "long")
+    source.set_table(b'x', core.PTA_stdfloat([f * 0.01 for f in range(num_frames)]))
+    short = core.AnimChannelMatrixXfmTable(bundle, "short")
+    short.set_table(b'x', core.PTA_stdfloat([2.0]))
+    compressed = bundle.copy_bundle_compressed()
+
+    chan = compressed.find_child("long")
+    assert isinstance(chan, core.AnimChannelMatrixXfmTable)
+    pos = core.LVecBase3()
+    chan.get_pos(num_frames - 1, pos)
+    assert pos[0] == source.get_table(b'x')[num_frames - 1]
+
+    assert isinstance(compressed.find_child("short"), core.AnimChannelMatrixCompressed)
+
+    # Compressing it directly holds the first value of the table.
+    chan = compress(source, bundle, "compressed")
+    chan.get_pos(num_frames - 1, pos)
+    assert pos == (0, 0, 0)
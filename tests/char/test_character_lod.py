@@ -0,0 +1,97 @@
+from panda3d import core
+import pytest
+
+
+NUM_FRAMES = 20
+
+
+def make_character():
+    """Returns a Character with a chain of three animated joints, and the
+    AnimControl that plays its animation."""
+
+    character = core.Character("character")
+    bundle = character.get_bundle(0)
+    parent = core.PartGroup(bundle, "<skeleton>")
+
+    anim = core.AnimBundle("character", 24, NUM_FRAMES)
+    anim_parent = core.AnimGroup(anim, "<skeleton>")
+
+    for j, name in enumerate(("j0", "j1", "j2")):
+        parent = core.CharacterJoint(character, bundle, parent, name, core.LMatrix4.ident_mat())
+        anim_parent = core.AnimChannelMatrixXfmTable(anim_parent, name)
+        anim_parent.set_table(b'h', core.PTA_stdfloat([f * (j + 1) * 3.0 for f in range(NUM_FRAMES)]))
+        anim_parent.set_table(b'x', core.PTA_stdfloat([f * 0.1 * (j + 1) for f in range(NUM_FRAMES)]))
+
+    control = bundle.bind_anim(anim, 0, core.PartSubset())
+    assert control is not None
+    return character, control
+
+
+def get_transform(character, name):
+    return core.LMatrix4(character.find_joint(name).get_transform())
+
+
+def test_character_lod_hold_distance():
+    character, control = make_character()
+    expected, expected_control = make_character()
+    bundle = character.get_bundle(0)
+
+    assert character.set_lod_hold_distance("j1", 50)
+    assert not character.set_lod_hold_distance("missing", 50)
+    assert character.find_joint("j1").hold_distance == 50
+
+    def pose(frame):
+        for c in (control, expected_control):
+            c.pose(frame)
+        character.get_bundle(0).force_update()
+        expected.get_bundle(0).force_update()
+
+    # Within the hold distance, the joint is animated as usual.
+    bundle.lod_distance = 10
+    pose(1)
+    assert not character.find_joint("j1").is_held()
+    assert get_transform(character, "j1") == get_transform(expected, "j1")
+
+    # Beyond it, the joint keeps its value, but the others are still animated.
+    bundle.lod_distance = 100
+    held = get_transform(character, "j1")
+    for frame in range(2, 6):
+        pose(frame)
+        assert character.find_joint("j1").is_held()
+        assert get_transform(character, "j1") == held
+        assert get_transform(expected, "j1") != held
+        assert get_transform(character, "j0") == get_transform(expected, "j0")
+
+    # Coming back inside the hold distance, it catches up with the current
+    # frame, even though the frame doesn't change.
+    bundle.lod_distance = 10
+    pose(5)
+    assert not character.find_joint("j1").is_held()
+    assert get_transform(character, "j1") == get_transform(expected, "j1")
+
+    # A hold distance of 0 means the joint is always animated.
+    assert character.set_lod_hold_distance("j1", 0)
+    bundle.lod_distance = 1000
+    pose(7)
+    assert not character.find_joint("j1").is_held()
+    assert get_transform(character, "j1") == get_transform(expected, "j1")
+
+
+def test_character_lod_freeze_size():
+    character, control = make_character()
+    assert character.get_lod_freeze_size() == 0
+    assert not character.is_skinning_frozen()
+
+    character.set_lod_freeze_size(0.05)
+    assert character.get_lod_freeze_size() == pytest.approx(0.05)
+
+    # The decision is made from what the cameras see, so a Character that is
+    # never rendered is never frozen.
+    for frame in range(3):
+        control.pose(frame)
+        character.force_update()
+        assert not character.is_skinning_frozen()
+
+    character.set_lod_freeze_size(0)
+    assert character.get_lod_freeze_size() == 0
+    assert not character.is_skinning_frozen()
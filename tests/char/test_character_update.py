@@ -0,0 +1,81 @@
+from panda3d import core
+import pytest
+
+
+NUM_FRAMES = 20
+
+
+def make_character():
+    """Returns a Character with a chain of three animated joints, and the
+    AnimControl that plays its animation."""
+
+    character = core.Character("character")
+    bundle = character.get_bundle(0)
+    parent = core.PartGroup(bundle, "<skeleton>")
+
+    anim = core.AnimBundle("character", 24, NUM_FRAMES)
+    anim_parent = core.AnimGroup(anim, "<skeleton>")
+
+    for j, name in enumerate(("j0", "j1", "j2")):
+        parent = core.CharacterJoint(character, bundle, parent, name, core.LMatrix4.ident_mat())
+        anim_parent = core.AnimChannelMatrixXfmTable(anim_parent, name)
+        anim_parent.set_table(b'h', core.PTA_stdfloat([f * (j + 1) * 3.0 for f in range(NUM_FRAMES)]))
+        anim_parent.set_table(b'x', core.PTA_stdfloat([f * 0.1 * (j + 1) for f in range(NUM_FRAMES)]))
+
+    control = bundle.bind_anim(anim, 0, core.PartSubset())
+    assert control is not None
+    return character, control
+
+
+def get_transforms(character):
+    return [core.LMatrix4(character.find_joint(name).get_transform())
+            for name in ("j0", "j1", "j2")]
+
+
+def test_character_update_manager(worker_pool, clock):
+    assert worker_pool.num_threads > 0
+
+    mgr = core.CharacterUpdateManager.get_global_ptr()
+    mgr.clear()
+
+    characters = [make_character() for i in range(6)]
+    expected = [make_character() for i in range(6)]
+
+    # The last two Characters share a bundle, so they must be updated by the
+    # same thread, and both take on the animation of the first of them.
+    shared, shared_control = characters[4]
+    other = characters[5][0]
+    other.merge_bundles(other.get_bundle(0), shared.get_bundle(0))
+
+    for frame in range(3):
+        clock.tick()
+        for i, (character, control) in enumerate(characters):
+            control.pose((frame * 3 + i) % NUM_FRAMES)
+            mgr.add_character(character)
+        mgr.add_character(characters[0][0])
+        assert mgr.get_num_characters() == 7
+
+        # Each Character is updated once.
+        assert mgr.update() == 6
+        assert mgr.get_num_characters() == 0
+
+        for i, (character, control) in enumerate(expected):
+            control.pose((frame * 3 + min(i, 4)) % NUM_FRAMES)
+            character.force_update()
+            assert get_transforms(characters[i][0]) == get_transforms(character)
+
+    # A Character that has already been updated this frame isn't updated
+    # again.
+    character, control = characters[0]
+    before = get_transforms(character)
+    control.pose(NUM_FRAMES - 1)
+    mgr.add_character(character)
+    assert mgr.update() == 1
+    assert get_transforms(character) == before
+
+    clock.tick()
+    mgr.add_character(character)
+    mgr.clear()
+    assert mgr.get_num_characters() == 0
+    assert mgr.update() == 0
+    assert get_transforms(character) == before
@@ -0,0 +1,60 @@
+from panda3d import core
+
+
+def collide_many(broadphase, final=False):
+    root = core.NodePath("root")
+
+    for i in range(40):
+        cnode = core.CollisionNode("wall%d" % (i))
+        cnode.add_solid(core.CollisionSphere((0, 0, 0), 2))
+        root.attach_new_node(cnode).set_pos((i % 8) * 10, (i // 8) * 10, 0)
+
+    if final:
+        # Nothing below a final node is tested against its own bounds; only
+        # the (here much smaller) bounds of the final node itself count.
+        group = root.attach_new_node("final")
+        group.node().set_final(True)
+        group.node().set_bounds(core.BoundingSphere((20, 10, 0), 3))
+        for i in range(20):
+            cnode = core.CollisionNode("inner%d" % (i))
+            cnode.add_solid(core.CollisionSphere((0, 0, 0), 2))
+            group.attach_new_node(cnode).set_pos((i % 5) * 10 + 5, (i // 5) * 10 + 5, 0)
+
+    trav = core.CollisionTraverser()
+    trav.broadphase = broadphase
+    queue = core.CollisionHandlerQueue()
+
+    # More colliders than fit in one pass, which also collide with each other.
+    movers = root.attach_new_node("movers")
+    movers.set_scale(1.5)
+    for i in range(100):
+        cnode = core.CollisionNode("mover%d" % (i))
+        cnode.add_solid(core.CollisionSphere((0, 0, 0), 1))
+        np = movers.attach_new_node(cnode)
+        np.set_pos((i * 7) % 50, (i * 13) % 30, 0)
+        trav.add_collider(np, queue)
+
+    # A ray has an unbounded volume.
+    ray_node = core.CollisionNode("ray")
+    ray_node.add_solid(core.CollisionRay((20, 20, 10), (0, 0, -1)))
+    ray_node.set_into_collide_mask(0)
+    trav.add_collider(root.attach_new_node(ray_node), queue)
+
+    core.PandaNode.reset_all_prev_transform()
+    trav.traverse(root)
+    return [(entry.from_node.name, entry.into_node.name) for entry in queue.entries]
+
+
+def test_collision_broadphase():
+    expected = collide_many(False)
+    assert len(expected) > 0
+
+    # Same entries, in the same order.
+    assert collide_many(True) == expected
+
+
+def test_collision_broadphase_final():
+    expected = collide_many(False, final=True)
+    assert len(expected) > 0
+    assert any(into.startswith("inner") for from_, into in expected)
+    assert collide_many(True, final=True) == expected
@@ -0,0 +1,71 @@
+from panda3d import core
+
+
+def collide_many(parallel, broadphase=False):
+    var = core.ConfigVariableBool("parallel-collide")
+    orig_value = var.value
+    var.value = parallel
+    try:
+        return do_collide_many(broadphase)
+    finally:
+        var.value = orig_value
+
+
+def do_collide_many(broadphase):
+    root = core.NodePath("root")
+    for i in range(40):
+        cnode = core.CollisionNode("wall%d" % (i))
+        cnode.add_solid(core.CollisionSphere((0, 0, 0), 2))
+        cnode.add_solid(core.CollisionPlane(core.Plane((0, 0, 1), (0, 0, -0.5))))
+        root.attach_new_node(cnode).set_pos((i % 8) * 10, (i // 8) * 10, 0)
+
+    trav = core.CollisionTraverser()
+    trav.broadphase = broadphase
+    queue = core.CollisionHandlerQueue()
+    pusher = core.CollisionHandlerPusher()
+
+    # Many more colliders than fit in one pass, with different handlers.
+    for i in range(150):
+        cnode = core.CollisionNode("mover%d" % (i))
+        if i % 3 == 0:
+            cnode.add_solid(core.CollisionRay((0, 0, 5), (0, 0, -1)))
+            cnode.set_into_collide_mask(0)
+        else:
+            cnode.add_solid(core.CollisionSphere((0, 0, 0), 1))
+        np = root.attach_new_node(cnode)
+        np.set_pos((i * 7) % 70, (i * 13) % 40, 0)
+        if i % 5 == 0:
+            pusher.add_collider(np, np)
+            trav.add_collider(np, pusher)
+        else:
+            trav.add_collider(np, queue)
+
+    core.PandaNode.reset_all_prev_transform()
+    trav.traverse(root)
+
+    entries = [(entry.from_node.name, entry.into_node.name,
+                tuple(round(v, 4) for v in entry.get_surface_point(root)))
+               for entry in queue.entries]
+    positions = [tuple(round(v, 4) for v in np.get_pos())
+                 for np in trav.get_colliders()]
+    return entries, positions
+
+
+def test_collision_parallel(worker_pool):
+    assert worker_pool.num_threads > 0
+
+    expected = collide_many(False)
+    assert len(expected[0]) > 0
+
+    # The same entries, in the same order, and the same pushes.
+    assert collide_many(True) == expected
+    assert collide_many(True) == expected
+
+
+def test_collision_parallel_broadphase(worker_pool):
+    assert worker_pool.num_threads > 0
+
+    expected = collide_many(False, broadphase=True)
+    assert len(expected[0]) > 0
+    assert collide_many(True, broadphase=True) == expected
+    assert collide_many(False) == expected
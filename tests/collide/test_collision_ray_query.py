@@ -0,0 +1,124 @@
+from panda3d import core
+import pytest
+
+
+def make_scene():
+    root = core.NodePath("root")
+
+    wall = core.CollisionNode("wall")
+    wall.add_solid(core.CollisionPolygon((-5, 0, -5), (5, 0, -5), (5, 0, 5), (-5, 0, 5)))
+    wall_np = root.attach_new_node(wall)
+    wall_np.set_y(10)
+
+    ball = core.CollisionNode("ball")
+    ball.add_solid(core.CollisionSphere((0, 0, 0), 1))
+    ball_np = root.attach_new_node(ball)
+    ball_np.set_pos(0, 5, 0)
+    ball_np.set_scale(2)
+
+    hidden = core.CollisionNode("hidden")
+    hidden.add_solid(core.CollisionBox((0, 0, 0), 1, 1, 1))
+    hidden.set_into_collide_mask(core.CollideMask.bit(5))
+    root.attach_new_node(hidden).set_pos(0, 2, 0)
+    return root
+
+
+def test_collision_ray_query_nearest():
+    root = make_scene()
+
+    query = core.CollisionRayQuery()
+    query.from_collide_mask = core.CollideMask.bit(0)
+    assert query.add_ray((0, 0, 0), (0, 1, 0), 100) == 0
+    assert query.add_ray((4, 0, 0), (0, 2, 0), 100) == 1
+    assert query.add_ray((4, 0, 0), (0, 1, 0), 5) == 2
+    assert query.add_ray((0, 20, 0), (0, 1, 0), 100) == 3
+    query.cast(root)
+
+    # The scaled sphere is in front of the wall.
+    assert query.has_hit(0)
+    assert query.get_hit_distance(0) == pytest.approx(3)
+    assert query.get_hit_point(0).almost_equal((0, 3, 0))
+    assert query.get_hit_normal(0).almost_equal((0, -1, 0))
+    assert query.get_hit_node_path(0).name == "ball"
+
+    # This one misses the sphere, and the distance is not affected by the
+    # length of the direction vector.
+    assert query.has_hit(1)
+    assert query.get_hit_distance(1) == pytest.approx(10)
+    assert query.get_hit_node(1).name == "wall"
+
+    # Too short to reach the wall.
+    assert not query.has_hit(2)
+    assert not query.has_hit(3)
+    assert query.get_hit_node_path(3).is_empty()
+
+
+def test_collision_ray_query_matches_traverser():
+    root = make_scene()
+    root.set_hpr(30, 10, 0)
+
+    query = core.CollisionRayQuery()
+    query.from_collide_mask = core.CollideMask.bit(0)
+    origins = [(x * 0.7 - 3, -2, z * 0.5 - 2) for x in range(10) for z in range(8)]
+    for origin in origins:
+        query.add_ray(origin, (0.1, 1, 0.05), 1000)
+    query.cast(root)
+
+    trav = core.CollisionTraverser()
+    for i, origin in enumerate(origins):
+        node = core.CollisionNode("ray")
+        node.add_solid(core.CollisionRay(origin, (0.1, 1, 0.05)))
+        node.set_from_collide_mask(core.CollideMask.bit(0))
+        node.set_into_collide_mask(0)
+        ray_np = root.attach_new_node(node)
+
+        queue = core.CollisionHandlerQueue()
+        trav.add_collider(ray_np, queue)
+        trav.traverse(root)
+        trav.remove_collider(ray_np)
+        ray_np.remove_node()
+
+        if queue.get_num_entries() == 0:
+            assert not query.has_hit(i)
+            continue
+
+        queue.sort_entries()
+        entry = queue.get_entry(0)
+        assert query.has_hit(i)
+        assert query.get_hit_point(i).almost_equal(entry.get_surface_point(root), 0.001)
+        assert query.get_hit_node_path(i) == entry.into_node_path
+
+
+def test_collision_ray_query_floor_mesh():
+    root = core.NodePath("root")
+    floor = core.CollisionFloorMesh()
+    floor.add_vertex((-5, -5, 0))
+    floor.add_vertex((5, -5, 0))
+    floor.add_vertex((5, 5, 2))
+    floor.add_vertex((-5, 5, 2))
+    floor.add_triangle(0, 1, 2)
+    floor.add_triangle(0, 2, 3)
+    node = core.CollisionNode("floor")
+    node.add_solid(floor)
+    root.attach_new_node(node).set_z(1)
+
+    query = core.CollisionRayQuery()
+    query.from_collide_mask = core.CollideMask.bit(0)
+    origins = [(x - 4.5, y - 4.5, 10) for x in range(10) for y in range(10)]
+    for origin in origins:
+        query.add_ray(origin, (0, 0, -1), 100)
+    query.add_ray((20, 0, 10), (0, 0, -1), 100)
+    query.add_ray((0, 0, 10), (0, 0, -1), 5)
+    query.cast(root)
+
+    for i, (x, y, z) in enumerate(origins):
+        assert query.has_hit(i)
+        floor_z = 1 + (y + 5) * 0.2
+        assert query.get_hit_distance(i) == pytest.approx(10 - floor_z, abs=1e-4)
+        assert query.get_hit_point(i).almost_equal((x, y, floor_z), 1e-4)
+        assert query.get_hit_normal(i).almost_equal((0, 0, 1))
+        assert query.get_hit_node(i).name == "floor"
+
+    # Outside the mesh, and too short to reach it.
+    assert not query.has_hit(len(origins))
+    assert not query.has_hit(len(origins) + 1)
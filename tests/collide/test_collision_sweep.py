@@ -0,0 +1,98 @@
+from panda3d import core
+import pytest
+
+
+def sweep(into_solid, from_solid, start, end):
+    root = core.NodePath("root")
+    into = core.CollisionNode("into")
+    into.add_solid(into_solid)
+    root.attach_new_node(into)
+
+    from_node = core.CollisionNode("from")
+    from_node.add_solid(from_solid)
+    from_node.set_into_collide_mask(0)
+    from_np = root.attach_new_node(from_node)
+
+    from_np.set_pos(start)
+    core.PandaNode.reset_all_prev_transform()
+    from_np.set_fluid_pos(end)
+
+    trav = core.CollisionTraverser()
+    trav.set_respect_prev_transform(True)
+    queue = core.CollisionHandlerQueue()
+    trav.add_collider(from_np, queue)
+    trav.traverse(root)
+    return queue.entries
+
+
+def thin_walls():
+    wall = core.CollisionPolygon((-2, 0, -2), (2, 0, -2), (2, 0, 2), (-2, 0, 2))
+    # The polygon faces -y; make the rest face the same way.
+    assert wall.normal.y < 0
+    yield wall
+    yield core.CollisionBox((0, 0, 0), 2, 0.05, 2)
+
+    mesh = core.CollisionTriangleMesh()
+    for point in wall.points:
+        mesh.add_vertex(point)
+    mesh.add_triangle(0, 1, 2)
+    mesh.add_triangle(0, 2, 3)
+    yield mesh
+
+
+@pytest.mark.parametrize("wall", list(thin_walls()))
+def test_sphere_tunneling(wall):
+    # Moves 10 units in one step, right through the wall.
+    sphere = core.CollisionSphere((0, 0, 0), 0.5)
+    entries = sweep(wall, sphere, (0, -5, 0), (0, 5, 0))
+    assert len(entries) == 1
+
+    entry = entries[0]
+    assert entry.has_contact_pos()
+    t = entry.t
+    assert 0 < t < 0.5
+    assert entry.get_contact_pos(entry.into_node_path).y < -0.4
+    assert entry.get_contact_normal(entry.into_node_path).y < -0.99
+
+    # Pushing it back out along the normal takes it to the front side.
+    surface = entry.get_surface_point(entry.into_node_path)
+    interior = entry.get_interior_point(entry.into_node_path)
+    assert (surface - interior).length() > 5
+
+
+@pytest.mark.parametrize("wall", list(thin_walls()))
+def test_capsule_tunneling(wall):
+    capsule = core.CollisionCapsule((-0.5, 0, 0), (0.5, 0, 0), 0.25)
+    entries = sweep(wall, capsule, (1, -5, 1), (1, 5, 1))
+    assert len(entries) == 1
+    assert 0 < entries[0].t < 0.5
+
+    # Passing beside the wall doesn't hit it.
+    assert not sweep(wall, capsule, (4, -5, 1), (4, 5, 1))
+
+
+def test_capsule_sweep_capsule():
+    into = core.CollisionCapsule((0, 0, -2), (0, 0, 2), 0.1)
+    capsule = core.CollisionCapsule((-0.5, 0, 0), (0.5, 0, 0), 0.1)
+    entries = sweep(into, capsule, (0, -5, 0), (0, 5, 0))
+    assert len(entries) == 1
+    assert entries[0].t == pytest.approx(4.8 / 10, abs=1e-4)
+
+    assert not sweep(into, capsule, (0, -5, 3), (0, 5, 3))
+
+
+def test_capsule_sweep_sphere():
+    into = core.CollisionSphere((0, 0, 0), 0.5)
+    capsule = core.CollisionCapsule((0, 0, -1), (0, 0, 1), 0.25)
+    entries = sweep(into, capsule, (-5, 0, 0), (5, 0, 0))
+    assert len(entries) == 1
+    assert entries[0].t == pytest.approx(4.25 / 10, abs=1e-4)
+
+
+def test_sweep_plane_contact():
+    plane = core.CollisionPlane(core.Plane((0, 0, 1), (0, 0, 0)))
+    sphere = core.CollisionSphere((0, 0, 0), 1)
+    entries = sweep(plane, sphere, (0, 0, 5), (0, 0, -5))
+    assert len(entries) == 1
+    assert entries[0].t == pytest.approx(0.4)
+    assert entries[0].get_contact_pos(entries[0].into_node_path).z == pytest.approx(1)
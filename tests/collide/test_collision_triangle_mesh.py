@@ -0,0 +1,150 @@
+from panda3d import core
+import pytest
+import struct
+
+
+def make_grid(size):
+    vdata = core.GeomVertexData("grid", core.GeomVertexFormat.get_v3(), core.Geom.UH_static)
+    writer = core.GeomVertexWriter(vdata, "vertex")
+    for y in range(size + 1):
+        for x in range(size + 1):
+            writer.add_data3(x, y, (x * y) % 3 * 0.25)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    for y in range(size):
+        for x in range(size):
+            a = y * (size + 1) + x
+            tris.add_vertices(a, a + 1, a + size + 2)
+            tris.add_vertices(a, a + size + 2, a + size + 1)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    return geom
+
+
+def collide(mesh, solid):
+    root = core.NodePath("root")
+    into = core.CollisionNode("mesh")
+    into.add_solid(mesh)
+    root.attach_new_node(into)
+
+    from_node = core.CollisionNode("from")
+    from_node.add_solid(solid)
+    from_node.set_into_collide_mask(0)
+
+    trav = core.CollisionTraverser()
+    queue = core.CollisionHandlerQueue()
+    trav.add_collider(root.attach_new_node(from_node), queue)
+    trav.traverse(root)
+    return queue.entries
+
+
+def test_collision_triangle_mesh_add_geom():
+    mesh = core.CollisionTriangleMesh()
+    mesh.add_geom(make_grid(4))
+    assert mesh.get_num_triangles() == 32
+    assert mesh.get_num_vertices() == 25
+
+
+def test_collision_triangle_mesh_ray():
+    mesh = core.CollisionTriangleMesh()
+    mesh.add_geom(make_grid(10))
+
+    for x in range(10):
+        for y in range(10):
+            entries = collide(mesh, core.CollisionRay((x + 0.3, y + 0.6, 10), (0, 0, -1)))
+            assert len(entries) == 1
+            point = entries[0].get_surface_point(entries[0].into_node_path)
+            assert point.x == pytest.approx(x + 0.3, abs=1e-5)
+            assert point.y == pytest.approx(y + 0.6, abs=1e-5)
+            assert 0 <= point.z <= 0.5
+
+    assert not collide(mesh, core.CollisionRay((-1, 5, 10), (0, 0, -1)))
+    assert not collide(mesh, core.CollisionRay((5, 5, 10), (0, 0, 1)))
+
+
+def test_collision_triangle_mesh_sphere():
+    mesh = core.CollisionTriangleMesh()
+    mesh.add_geom(make_grid(10))
+
+    assert collide(mesh, core.CollisionSphere((5, 5, 0.5), 1))
+    assert not collide(mesh, core.CollisionSphere((5, 5, 3), 1))
+    assert not collide(mesh, core.CollisionSphere((12, 5, 0), 1))
+
+    # Touching only the edge of the grid.
+    entries = collide(mesh, core.CollisionSphere((10.5, 0.5, 0), 1))
+    assert len(entries) == 1
+    assert entries[0].get_surface_normal(entries[0].into_node_path).x > 0.9
+
+
+def test_collision_triangle_mesh_bam():
+    mesh = core.CollisionTriangleMesh()
+    mesh.add_geom(make_grid(6))
+    mesh.build()
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.init()
+    writer.write_object(mesh)
+    writer.flush()
+
+    reader = core.BamReader(buffer)
+    reader.init()
+    mesh2 = reader.read_object()
+    reader.resolve()
+
+    assert isinstance(mesh2, core.CollisionTriangleMesh)
+    assert list(mesh2.vertices) == list(mesh.vertices)
+    assert list(mesh2.triangles) == list(mesh.triangles)
+
+    ray = core.CollisionRay((2.5, 3.5, 10), (0, 0, -1))
+    assert len(collide(mesh2, ray)) == 1
+
+
+def write_and_corrupt(mesh, offset, value):
+    """Writes the mesh, whose only triangle must be (0, 1, 2), to a bam stream,
+    replaces the 32-bit integer at the indicated offset from the start of the
+    triangle with the indicated value, and reads it back."""
+
+    buffer = core.DatagramBuffer()
+    writer = core.BamWriter(buffer)
+    writer.init()
+    writer.write_object(mesh)
+    writer.flush()
+
+    data = bytearray(buffer.data)
+    tri_offset = data.find(struct.pack('<III', 0, 1, 2))
+    assert tri_offset >= 0
+    struct.pack_into('<I', data, tri_offset + offset, value)
+    buffer = core.DatagramBuffer(bytes(data))
+    reader = core.BamReader(buffer)
+    reader.init()
+    mesh2 = reader.read_object()
+    reader.resolve()
+    return mesh2
+
+
+def test_collision_triangle_mesh_bam_corrupt():
+    mesh = core.CollisionTriangleMesh()
+    mesh.add_vertex((0, 0, 0))
+    mesh.add_vertex((1, 0, 0))
+    mesh.add_vertex((0, 1, 0))
+    mesh.add_triangle(0, 1, 2)
+    mesh.build()
+    ray = core.CollisionRay((0.25, 0.25, 10), (0, 0, -1))
+    assert len(collide(mesh, ray)) == 1
+
+    # The triangle is followed by the number of nodes, and the single node of
+    # the tree: its bounds, then the index of its first triangle and the
+    # number of triangles.  A node that covers triangles that don't exist is
+    # rejected, and the tree rebuilt.
+    point_size = 3 * struct.calcsize('f' if core.LPoint3 is core.LPoint3f else 'd')
+    count_offset = 12 + 4 + 2 * point_size + 4
+    mesh2 = write_and_corrupt(mesh, count_offset, 5)
+    assert mesh2.get_num_triangles() == 1
+    assert len(collide(mesh2, ray)) == 1
+
+    # A triangle with a vertex that doesn't exist leaves the mesh empty.
+    mesh2 = write_and_corrupt(mesh, 8, 3)
+    assert mesh2.get_num_triangles() == 0
+    assert not collide(mesh2, ray)
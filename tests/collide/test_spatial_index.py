@@ -0,0 +1,38 @@
+from panda3d import core
+
+
+def collide_with_children(root_node):
+    root = core.NodePath("root")
+    parent = root.attach_new_node(root_node)
+
+    for i in range(100):
+        cnode = core.CollisionNode("into%d" % (i))
+        cnode.add_solid(core.CollisionSphere((0, 0, 0), 1))
+        child = parent.attach_new_node(cnode)
+        child.set_pos(i * 3, (i % 10) * 3, 0)
+
+    from_node = core.CollisionNode("from")
+    from_node.add_solid(core.CollisionSphere((0, 0, 0), 4))
+    from_node.set_into_collide_mask(0)
+    from_np = root.attach_new_node(from_node)
+    from_np.set_pos(30, 0, 0)
+
+    trav = core.CollisionTraverser()
+    queue = core.CollisionHandlerQueue()
+    trav.add_collider(from_np, queue)
+    trav.traverse(root)
+
+    names = sorted(entry.get_into_node().name for entry in queue.entries)
+
+    # Move one of the children into range; the index must notice.
+    parent.find("into99").set_pos(32, 0, 0)
+    trav.traverse(root)
+    moved = sorted(entry.get_into_node().name for entry in queue.entries)
+    return names, moved
+
+
+def test_spatial_index_collide():
+    expected = collide_with_children(core.PandaNode("plain"))
+    result = collide_with_children(core.SpatialIndexNode("indexed"))
+    assert result == expected
+    assert "into99" in result[1]
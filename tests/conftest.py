@@ -0,0 +1,26 @@
+import pytest
+from panda3d import core
+
+
+@pytest.fixture(scope='module')
+def worker_pool():
+    """Returns the global WorkerPool.  It is created with worker threads if
+    nothing has needed it before."""
+
+    page = core.load_prc_file_data("", "worker-pool-threads 2")
+    pool = core.WorkerPool.get_global_ptr()
+    yield pool
+    core.unload_prc_file(page)
+
+
+@pytest.fixture
+def clock():
+    """Returns the global ClockObject, which advances the frame time by a
+    fixed step on each tick for the duration of the test."""
+
+    clock = core.ClockObject.get_global_clock()
+    mode = clock.mode
+    clock.mode = core.ClockObject.M_non_real_time
+    clock.dt = 1.0 / 24
+    yield clock
+    clock.mode = mode
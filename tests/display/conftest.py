@@ -75,3 +75,37 @@ def gsg(graphics_pipe, graphics_engine):
 
     if buffer is not None:
         graphics_engine.remove_window(buffer)
+
+
+@pytest.fixture
+def offscreen_buffer(graphics_pipe, graphics_engine, gsg):
+    """Returns a small offscreen buffer that shares the windowless GSG, for
+    rendering a scene through the GraphicsEngine.  It has no display regions
+    but the overlay region."""
+    from panda3d.core import GraphicsPipe, FrameBufferProperties, WindowProperties
+
+    fbprops = FrameBufferProperties()
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+    fbprops.depth_bits = 1
+
+    buffer = graphics_engine.make_output(
+        graphics_pipe,
+        'offscreen_buffer',
+        0,
+        fbprops,
+        WindowProperties.size(64, 32),
+        GraphicsPipe.BF_refuse_window,
+        gsg
+    )
+    graphics_engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+    buffer.set_clear_depth_active(True)
+
+    yield buffer
+
+    graphics_engine.remove_window(buffer)
@@ -0,0 +1,232 @@
+from panda3d import core
+import pytest
+
+
+NUM_FRAMES = 30
+
+
+def make_triangle():
+    vdata = core.GeomVertexData("tri", core.GeomVertexFormat.get_v3(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    vertex.add_data3(0, 0, 0)
+    vertex.add_data3(1, 0, 0)
+    vertex.add_data3(0, 0, 1)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    return geom
+
+
+def make_character(seed, joint_names, geom):
+    """Returns a Character with a chain of joints and an animation that is
+    determined by the seed, and the AnimControl that plays it.  It has a
+    GeomNode, so that the cull traversal visits it."""
+
+    randomizer = core.Randomizer(seed + 1)
+    character = core.Character("character")
+    bundle = character.get_bundle(0)
+    parent = core.PartGroup(bundle, "<skeleton>")
+
+    anim = core.AnimBundle("character", 24, NUM_FRAMES)
+    anim_parent = core.AnimGroup(anim, "<skeleton>")
+
+    for name in joint_names:
+        parent = core.CharacterJoint(character, bundle, parent, name,
+                                     core.LMatrix4.translate_mat(0, 0, 1))
+        anim_parent = core.AnimChannelMatrixXfmTable(anim_parent, name)
+        for c in b'hpr':
+            table = [randomizer.random_real(30) for f in range(NUM_FRAMES)]
+            anim_parent.set_table(bytes([c]), core.PTA_stdfloat(table))
+
+    control = bundle.bind_anim(anim, 0, core.PartSubset())
+    assert control is not None
+
+    gnode = core.GeomNode("geom")
+    gnode.add_geom(geom)
+    character.add_child(gnode)
+    return character, control
+
+
+def get_net_transforms(character, joint_names):
+    transforms = []
+    for name in joint_names:
+        mat = core.LMatrix4()
+        character.find_joint(name).get_net_transform(mat)
+        transforms.append(mat)
+    return transforms
+
+
+@pytest.fixture
+def parallel_character_update(worker_pool):
+    var = core.ConfigVariableBool("parallel-character-update")
+    orig_value = var.value
+    var.value = True
+    yield
+    var.value = orig_value
+
+
+def test_character_cull_parallel(offscreen_buffer, clock, worker_pool,
+                                 parallel_character_update):
+    # A crowd of Characters, seen by two cameras, is updated during the cull
+    # traversal by the CharacterUpdateManager.  Their joints must end up the
+    # same as those of an identical crowd that is updated one at a time.
+    assert worker_pool.num_threads > 0
+
+    num_characters = 24
+    joint_names = ["j%d" % (j) for j in range(10)]
+    geom = make_triangle()
+    root = core.NodePath("root")
+    culled = []
+    expected = []
+    for i in range(num_characters):
+        character, control = make_character(i, joint_names, geom)
+        culled.append((character, control))
+        root.attach_new_node(character).set_pos((i % 8) - 4, 20 + i // 8, 0)
+        expected.append(make_character(i, joint_names, geom))
+
+    # Two of the Characters share a bundle, so must be updated by the same
+    # thread.
+    for characters in (culled, expected):
+        character = characters[2][0]
+        character.merge_bundles(character.get_bundle_handle(0),
+                                characters[1][0].get_bundle_handle(0))
+
+    # Both cameras see all of the Characters.
+    camera1 = root.attach_new_node(core.Camera("camera1"))
+    camera2 = root.attach_new_node(core.Camera("camera2"))
+    camera2.set_pos(1, -2, 0)
+    offscreen_buffer.make_display_region(0, 0.5, 0, 1).camera = camera1
+    offscreen_buffer.make_display_region(0.5, 1, 0, 1).camera = camera2
+
+    for frame in range(12):
+        for i in range(num_characters):
+            culled[i][1].pose(frame * 1.7 + i % 7)
+            expected[i][1].pose(frame * 1.7 + i % 7)
+
+        # Half-way through, hide some of the Characters for a few frames.
+        hide = (5 <= frame < 8)
+        for i in range(0, num_characters, 3):
+            np = core.NodePath.any_path(culled[i][0])
+            if hide:
+                np.hide()
+            else:
+                np.show()
+
+        offscreen_buffer.engine.render_frame()
+
+        for i in range(num_characters):
+            if hide and i % 3 == 0:
+                continue
+            expected[i][0].update()
+            assert get_net_transforms(culled[i][0], joint_names) == \
+                get_net_transforms(expected[i][0], joint_names)
+
+
+def make_rig():
+    """Returns a Character with a chain of three animated joints and a
+    vertex transform for the last one, and the AnimControl that plays its
+    animation.  The joints start out with identity transforms."""
+
+    character = core.Character("character")
+    bundle = character.get_bundle(0)
+    parent = core.PartGroup(bundle, "<skeleton>")
+
+    anim = core.AnimBundle("character", 24, 40)
+    anim_parent = core.AnimGroup(anim, "<skeleton>")
+
+    for j, name in enumerate(("j0", "j1", "j2")):
+        parent = core.CharacterJoint(character, bundle, parent, name, core.LMatrix4.ident_mat())
+        anim_parent = core.AnimChannelMatrixXfmTable(anim_parent, name)
+        anim_parent.set_table(b'h', core.PTA_stdfloat([f * (j + 1) * 3.0 for f in range(40)]))
+        anim_parent.set_table(b'x', core.PTA_stdfloat([f * 0.1 * (j + 1) for f in range(40)]))
+
+    control = bundle.bind_anim(anim, 0, core.PartSubset())
+    assert control is not None
+
+    transform = core.JointVertexTransform(character.find_joint("j2"))
+    character.set_bounds(core.BoundingSphere((0, 0, 0), 1))
+
+    # Something to render, or the Character won't be visited.
+    character.add_child(core.GeomNode("geom"))
+    return character, control, transform
+
+
+def is_skinning_current(character, transform):
+    skinning = core.LMatrix4()
+    transform.get_matrix(skinning)
+    net = core.LMatrix4()
+    character.find_joint("j2").get_net_transform(net)
+    return skinning.almost_equal(net, 1e-4)
+
+
+def get_transform(character, name):
+    return core.LMatrix4(character.find_joint(name).get_transform())
+
+
+def test_character_cull_lod(offscreen_buffer, clock):
+    # The Character that is culled has a held joint and a freeze size; the
+    # other one is updated every frame without either, for comparison.
+    character, control, transform = make_rig()
+    expected, expected_control, _ = make_rig()
+    assert character.set_lod_hold_distance("j1", 50)
+    character.set_lod_freeze_size(0.05)
+
+    root = core.NodePath("root")
+    root.attach_new_node(character).set_pos(0, 100, 0)
+
+    # The far camera sees the Character at a distance of 100, which is beyond
+    # the hold distance, and too small to be skinned.  The near camera sees it
+    # at a distance of 10.  The far camera is culled first.
+    lens = core.PerspectiveLens()
+    lens.set_fov(40, 40)
+    far_camera = root.attach_new_node(core.Camera("far", lens))
+    near_camera = root.attach_new_node(core.Camera("near", lens))
+    near_camera.set_pos(0, 90, 0)
+    offscreen_buffer.make_display_region(0, 0.5, 0, 1).camera = far_camera
+    near_region = offscreen_buffer.make_display_region(0.5, 1, 0, 1)
+    near_region.camera = near_camera
+
+    for frame in range(24):
+        # Both cameras, then only the far one, then both again.
+        use_near = (frame // 8 != 1)
+        near_region.active = use_near
+
+        control.pose(frame)
+        expected_control.pose(frame)
+        expected.update()
+
+        was_frozen = character.is_skinning_frozen()
+        offscreen_buffer.engine.render_frame()
+        frozen = character.is_skinning_frozen()
+
+        # The level of detail follows the cameras of the previous frame, so
+        # it changes a frame after the near camera comes or goes.  If it were
+        # decided per camera, the near camera would thaw the skinning that the
+        # far camera had frozen in the same frame.  In the first frame, there
+        # is only what the far camera has seen so far.
+        if frame == 0:
+            assert frozen
+            continue
+        elif frame % 8 == 0:
+            assert frozen == was_frozen
+            continue
+
+        j1_current = get_transform(character, "j1").almost_equal(
+            get_transform(expected, "j1"), 1e-4)
+        if use_near:
+            assert not frozen
+            assert is_skinning_current(character, transform)
+            assert not character.find_joint("j1").is_held()
+            assert j1_current
+        else:
+            assert frozen
+            assert not is_skinning_current(character, transform)
+            assert character.find_joint("j1").is_held()
+            assert not j1_current
+
+        # The other joints are always animated.
+        assert get_transform(character, "j0").almost_equal(
+            get_transform(expected, "j0"), 1e-4)
@@ -0,0 +1,130 @@
+from panda3d import core
+import pytest
+
+
+def make_card(x, z, color, table=None):
+    """Returns a GeomNode with a square card at the indicated position.  If a
+    TransformBlendTable is given, the card is animated by its first blend."""
+
+    if table is not None:
+        array = core.GeomVertexArrayFormat()
+        array.add_column("vertex", 3, core.GeomEnums.NT_float32, core.GeomEnums.C_point)
+        array.add_column("transform_blend", 1, core.GeomEnums.NT_uint16, core.GeomEnums.C_index)
+        format = core.GeomVertexFormat()
+        format.add_array(array)
+        spec = core.GeomVertexAnimationSpec()
+        spec.set_panda()
+        format.set_animation(spec)
+        format = core.GeomVertexFormat.register_format(format)
+    else:
+        format = core.GeomVertexFormat.get_v3()
+
+    vdata = core.GeomVertexData("card", format, core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    for dx, dz in ((-1, -1), (1, -1), (1, 1), (-1, 1)):
+        vertex.add_data3(x + dx, 0, z + dz)
+
+    if table is not None:
+        blend = core.GeomVertexWriter(vdata, "transform_blend")
+        for i in range(4):
+            blend.add_data1i(0)
+        vdata.set_transform_blend_table(table)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+    tris.add_vertices(0, 2, 3)
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+
+    gnode = core.GeomNode("card")
+    gnode.add_geom(geom, core.RenderState.make(core.ColorAttrib.make_flat(color)))
+    return gnode
+
+
+def make_table(transform):
+    table = core.TransformBlendTable()
+    table.add_blend(core.TransformBlend(transform, 1.0))
+    table.set_rows(core.SparseArray.range(0, 4))
+    return table
+
+
+@pytest.fixture
+def frame_time():
+    """Holds the frame time of the global clock still, so that
+    show-vertex-animation flashes the same color on every frame."""
+
+    clock = core.ClockObject.get_global_clock()
+    mode = clock.mode
+    clock.mode = core.ClockObject.M_slave
+    clock.frame_time = 0.25
+    yield
+    clock.mode = mode
+
+
+def render(buffer, parallel):
+    var = core.ConfigVariableBool("parallel-animate-vertices")
+    orig_value = var.value
+    var.value = parallel
+    try:
+        texture = core.Texture("color")
+        buffer.add_render_texture(texture, core.GraphicsOutput.RTM_copy_ram,
+                                  core.GraphicsOutput.RTP_color)
+        buffer.engine.render_frame()
+        buffer.clear_render_textures()
+        return bytes(memoryview(texture.get_ram_image_as("RGBA")))
+    finally:
+        var.value = orig_value
+
+
+def test_parallel_animate(offscreen_buffer, worker_pool, frame_time):
+    assert worker_pool.num_threads > 0
+
+    # The cards overlap, and are drawn in the order in which they are culled,
+    # so that the image shows whether the objects that were culled after an
+    # animated one, while its animation was pending, kept their places.  The
+    # first two animated cards share their TransformBlendTable.
+    root = core.NodePath("root")
+    root.set_depth_test(False)
+    root.set_depth_write(False)
+    root.set_bin("unsorted", 0)
+
+    transforms = [core.UserVertexTransform("a"), core.UserVertexTransform("b")]
+    shared_table = make_table(transforms[0])
+    cards = [
+        make_card(-3, 0, (1, 1, 1, 1)),
+        make_card(-2, 0.5, (1, 0, 0, 1), shared_table),
+        make_card(-1, 0, (0, 1, 0, 1)),
+        make_card(0, 0.5, (0, 0, 1, 1), shared_table),
+        make_card(1, 0, (1, 1, 0, 1)),
+        make_card(2, 0.5, (0, 1, 1, 1), make_table(transforms[1])),
+        make_card(3, 0, (1, 0, 1, 1)),
+    ]
+    for card in cards:
+        root.attach_new_node(card).set_y(10)
+
+    lens = core.OrthographicLens()
+    lens.set_film_size(10, 5)
+    camera = root.attach_new_node(core.Camera("camera", lens))
+    offscreen_buffer.make_display_region().camera = camera
+
+    for frame in range(3):
+        transforms[0].set_matrix(core.LMatrix4.translate_mat(0, 0, frame * -0.5))
+        transforms[1].set_matrix(core.LMatrix4.translate_mat(frame * 0.5, 0, 0))
+
+        expected = render(offscreen_buffer, False)
+        assert len(set(expected[i:i + 4] for i in range(0, len(expected), 4))) == 8
+        assert render(offscreen_buffer, True) == expected
+
+    # show-vertex-animation changes the state of the animated objects when
+    # they are animated.
+    var = core.ConfigVariableBool("show-vertex-animation")
+    orig_value = var.value
+    var.value = True
+    try:
+        flashed = render(offscreen_buffer, False)
+        assert render(offscreen_buffer, True) == flashed
+    finally:
+        var.value = orig_value
+
+    if flashed == expected:
+        pytest.skip("show-vertex-animation is compiled out")
@@ -0,0 +1,153 @@
+from panda3d import core
+import pytest
+
+
+RED = core.RenderState.make(core.ColorAttrib.make_flat((1, 0, 0, 1)))
+BLUE = core.RenderState.make(core.ColorAttrib.make_flat((0, 0, 1, 1)))
+
+
+def make_triangle(x):
+    vdata = core.GeomVertexData("tri", core.GeomVertexFormat.get_v3(), core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    vertex.add_data3(x, 0, -2)
+    vertex.add_data3(x + 3, 0, -2)
+    vertex.add_data3(x, 0, 2)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    return geom
+
+
+def make_scene(parent_node, geoms):
+    """Returns a scene with a small static subgraph below the indicated
+    node, and a camera looking at it."""
+
+    root = core.NodePath("root")
+    parent = root.attach_new_node(parent_node)
+    parent.set_pos(0, 10, 0)
+
+    group = parent.attach_new_node("group")
+    group.set_pos(-1, 0, 0)
+    group.set_color_scale(1, 0.5, 0.5, 1)
+
+    gnode = core.GeomNode("geoms")
+    gnode.add_geom(geoms[0], RED)
+    gnode.add_geom(geoms[1])
+    np = group.attach_new_node(gnode)
+    np.set_pos(0, 0, 0.5)
+    np.set_tag("kind", "special")
+
+    camera = root.attach_new_node(core.Camera("camera"))
+    return root, camera
+
+
+def render(buffer, *cameras):
+    """Renders the cameras side by side into the buffer, and returns the
+    image that each of them produced."""
+
+    buffer.remove_all_display_regions()
+    num_cameras = len(cameras)
+    for i, camera in enumerate(cameras):
+        region = buffer.make_display_region(i / num_cameras, (i + 1) / num_cameras, 0, 1)
+        region.camera = camera
+
+    texture = core.Texture("color")
+    buffer.add_render_texture(texture, core.GraphicsOutput.RTM_copy_ram,
+                              core.GraphicsOutput.RTP_color)
+    buffer.engine.render_frame()
+    buffer.clear_render_textures()
+
+    image = bytes(memoryview(texture.get_ram_image_as("RGBA")))
+    row_size = texture.get_x_size() * 4
+    width = row_size // num_cameras
+    images = []
+    for i in range(num_cameras):
+        images.append(b''.join(image[y + i * width:y + (i + 1) * width]
+                               for y in range(0, len(image), row_size)))
+    return images
+
+
+def test_retained_cull(offscreen_buffer):
+    # The same subgraph, once below a RetainedCullNode and once below an
+    # ordinary node.  They share their Geoms.
+    geoms = [make_triangle(-3), make_triangle(0)]
+    retained = core.RetainedCullNode("retained")
+    retained_root, retained_camera = make_scene(retained, geoms)
+    plain_root, plain_camera = make_scene(core.PandaNode("plain"), geoms)
+    retained_geoms = retained_root.find("**/geoms").node()
+    plain_geoms = plain_root.find("**/geoms").node()
+
+    assert retained.is_retained()
+
+    # The first frame records the subgraph, the second uses the recording.
+    first, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert first == expected
+    assert len(set(expected[i:i + 4] for i in range(0, len(expected), 4))) == 3
+    second, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert second == expected
+    assert second == first
+
+    # Changing the state of a Geom must be noticed.
+    retained_geoms.set_geom_state(0, BLUE)
+    plain_geoms.set_geom_state(0, BLUE)
+    image, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert image == expected
+    assert image != first
+
+    # So must replacing a Geom, here with one that is out of view.
+    offscreen = make_triangle(100)
+    retained_geoms.set_geom(1, offscreen)
+    plain_geoms.set_geom(1, offscreen)
+    hidden, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert hidden == expected
+    assert hidden != image
+
+    # And changing the vertices of a Geom in place, which brings it back into
+    # view, outside of the bounds that were recorded for it.
+    vertex = core.GeomVertexWriter(offscreen.modify_vertex_data(), "vertex")
+    vertex.set_data3(0, 0, -2)
+    vertex.set_data3(3, 0, -2)
+    vertex.set_data3(0, 0, 2)
+    del vertex
+    image, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert image == expected
+    assert image != hidden
+
+    # And moving the camera, or a node within the subgraph.
+    for root, camera in ((retained_root, retained_camera), (plain_root, plain_camera)):
+        camera.set_pos(1, -2, 0.5)
+        root.find("**/geoms").set_pos(0, 3, 1)
+    image, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert image == expected
+
+    # A camera with a tag state must see the substituted state on the tagged
+    # node, and must not share the retained states with the other camera.
+    tag_cameras = []
+    for root in (retained_root, plain_root):
+        camera = core.Camera("tag_camera")
+        camera.tag_state_key = "kind"
+        camera.set_tag_state("special", core.RenderState.make(
+            core.ColorScaleAttrib.make((0, 1, 0, 1))))
+        tag_cameras.append(root.attach_new_node(camera))
+    for frame in range(2):
+        tagged, expected_tagged, image, expected = \
+            render(offscreen_buffer, tag_cameras[0], tag_cameras[1],
+                   retained_camera, plain_camera)
+        assert tagged == expected_tagged
+        assert image == expected
+        assert tagged != image
+
+    # Something that needs the cull traversal disables retention, and removing
+    # it enables it again.
+    lod = retained_root.find("retained").attach_new_node(core.LODNode("lod"))
+    assert not retained.is_retained()
+    lod.remove_node()
+    assert retained.is_retained()
+
+    # invalidate() forces the subgraph to be walked again.
+    retained.invalidate()
+    image, expected = render(offscreen_buffer, retained_camera, plain_camera)
+    assert image == expected
@@ -0,0 +1,108 @@
+from panda3d import core
+import pytest
+
+
+def make_vertex_data(format, num_rows):
+    vdata = core.GeomVertexData("", format, core.GeomEnums.UH_static)
+    vdata.set_num_rows(num_rows)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    for i in range(num_rows):
+        vertex.set_data3(i * 0.5 - 3, i % 3 - 1, i * 0.25)
+        normal.set_data3(core.LVector3(i % 2, 1, i % 5 - 2).normalized())
+    return vdata
+
+
+@pytest.mark.parametrize("format", [
+    core.GeomVertexFormat.get_v3n3(),
+    core.GeomVertexFormat.get_v3n3t2(),
+])
+@pytest.mark.parametrize("num_rows", [1, 4, 7, 13])
+def test_vertex_data_transform(format, num_rows):
+    mat = core.LMatrix4.scale_mat(1, 2, 3) * \
+          core.LMatrix4.rotate_mat(30, (1, 1, 0)) * \
+          core.LMatrix4.translate_mat(1, -2, 5)
+    normal_mat = core.LMatrix4(mat)
+    normal_mat.invert_in_place()
+    normal_mat.transpose_in_place()
+
+    before = make_vertex_data(format, num_rows)
+    after = make_vertex_data(format, num_rows)
+    after.transform_vertices(mat)
+
+    vertex0 = core.GeomVertexReader(before, "vertex")
+    normal0 = core.GeomVertexReader(before, "normal")
+    vertex1 = core.GeomVertexReader(after, "vertex")
+    normal1 = core.GeomVertexReader(after, "normal")
+    for i in range(num_rows):
+        point = vertex1.get_data3()
+        assert point.almost_equal(mat.xform_point(vertex0.get_data3()), 0.0001)
+
+        normal = normal1.get_data3()
+        expected = normal_mat.xform_vec(normal0.get_data3()).normalized()
+        assert normal.almost_equal(expected, 0.0001)
+        assert normal.length() == pytest.approx(1)
+
+
+@pytest.mark.parametrize("index_type", [
+    core.GeomEnums.NT_uint8,
+    core.GeomEnums.NT_uint16,
+    core.GeomEnums.NT_uint32,
+])
+@pytest.mark.parametrize("num_rows", [1, 6, 13])
+def test_vertex_data_animate_vertices(index_type, num_rows):
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.GeomEnums.NT_float32, core.GeomEnums.C_point)
+    array.add_column("normal", 3, core.GeomEnums.NT_float32, core.GeomEnums.C_normal)
+    blend_array = core.GeomVertexArrayFormat()
+    blend_array.add_column("transform_blend", 1, index_type, core.GeomEnums.C_index)
+    format = core.GeomVertexFormat()
+    format.add_array(array)
+    format.add_array(blend_array)
+    spec = core.GeomVertexAnimationSpec()
+    spec.set_panda()
+    format.set_animation(spec)
+    format = core.GeomVertexFormat.register_format(format)
+
+    # One rigid blend, and one between two transforms, one of which has a
+    # non-uniform scale, so the normals have to be renormalized.
+    mat0 = core.LMatrix4.rotate_mat(30, (0, 0, 1)) * core.LMatrix4.translate_mat(1, 2, 3)
+    mat1 = core.LMatrix4.scale_mat(1, 2, 3) * core.LMatrix4.translate_mat(-1, 0, 0)
+    xform0 = core.UserVertexTransform("a")
+    xform0.set_matrix(mat0)
+    xform1 = core.UserVertexTransform("b")
+    xform1.set_matrix(mat1)
+    table = core.TransformBlendTable()
+    blends = [
+        table.add_blend(core.TransformBlend(xform0, 1.0)),
+        table.add_blend(core.TransformBlend(xform0, 0.5, xform1, 0.5)),
+    ]
+    table.set_rows(core.SparseArray.range(0, num_rows))
+
+    vdata = make_vertex_data(format, num_rows)
+    blend = core.GeomVertexWriter(vdata, "transform_blend")
+    for i in range(num_rows):
+        blend.set_data1i(blends[(i * 7 // 3) % 2])
+    vdata.set_transform_blend_table(table)
+
+    animated = vdata.animate_vertices(True, core.Thread.get_current_thread())
+    assert animated != vdata
+
+    mat01 = mat0 * 0.5
+    mat01 += mat1 * 0.5
+    mats = [mat0, mat01]
+    vertex0 = core.GeomVertexReader(vdata, "vertex")
+    normal0 = core.GeomVertexReader(vdata, "normal")
+    vertex1 = core.GeomVertexReader(animated, "vertex")
+    normal1 = core.GeomVertexReader(animated, "normal")
+    for i in range(num_rows):
+        mat = mats[(i * 7 // 3) % 2]
+        point = vertex1.get_data3()
+        assert point.almost_equal(mat.xform_point(vertex0.get_data3()), 0.0001)
+
+        normal_mat = core.LMatrix4(mat)
+        normal_mat.invert_in_place()
+        normal_mat.transpose_in_place()
+        normal = normal1.get_data3()
+        expected = normal_mat.xform_vec(normal0.get_data3()).normalized()
+        assert normal.almost_equal(expected, 0.0001)
@@ -0,0 +1,103 @@
+from panda3d import core
+import math
+
+
+def make_grid(size):
+    vdata = core.GeomVertexData("grid", core.GeomVertexFormat.get_v3n3t2(),
+                                core.GeomEnums.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    normal = core.GeomVertexWriter(vdata, "normal")
+    texcoord = core.GeomVertexWriter(vdata, "texcoord")
+    for j in range(size + 1):
+        for i in range(size + 1):
+            vertex.add_data3(i, j, 0.1 * math.sin(i * 0.5) * math.cos(j * 0.5))
+            normal.add_data3(0, 0, 1)
+            texcoord.add_data2(i / size, j / size)
+
+    tris = core.GeomTriangles(core.GeomEnums.UH_static)
+    for j in range(size):
+        for i in range(size):
+            a = j * (size + 1) + i
+            tris.add_vertices(a, a + 1, a + size + 2)
+            tris.add_vertices(a, a + size + 2, a + size + 1)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    return geom
+
+
+def get_triangles(geom):
+    vertex = core.GeomVertexReader(geom.get_vertex_data(), "vertex")
+    result = []
+    for prim in geom.get_primitives():
+        prim = prim.decompose()
+        for i in range(0, prim.get_num_vertices(), 3):
+            points = []
+            for k in range(3):
+                vertex.set_row(prim.get_vertex(i + k))
+                points.append(core.LPoint3(vertex.get_data3()))
+            result.append(points)
+    return result
+
+
+def test_mesh_simplifier_geom():
+    geom = make_grid(20)
+    simplifier = core.MeshSimplifier()
+    simple = simplifier.simplify_geom(geom, 0.25)
+    assert simple is not None
+
+    triangles = get_triangles(simple)
+    assert len(triangles) <= 200
+    assert len(triangles) > 100
+
+    # Unused vertices are removed.
+    assert simple.get_vertex_data().get_num_rows() < geom.get_vertex_data().get_num_rows()
+
+    # The outline is kept, and no triangle is turned over.
+    xs = [p.x for tri in triangles for p in tri]
+    ys = [p.y for tri in triangles for p in tri]
+    assert min(xs) == 0 and max(xs) == 20
+    assert min(ys) == 0 and max(ys) == 20
+    for a, b, c in triangles:
+        assert (b - a).cross(c - a).z > 0
+
+
+def test_mesh_simplifier_non_triangles():
+    vdata = core.GeomVertexData("lines", core.GeomVertexFormat.get_v3(),
+                                core.GeomEnums.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    vertex.add_data3(0, 0, 0)
+    vertex.add_data3(1, 0, 0)
+    lines = core.GeomLines(core.GeomEnums.UH_static)
+    lines.add_vertices(0, 1)
+    geom = core.Geom(vdata)
+    geom.add_primitive(lines)
+
+    assert core.MeshSimplifier().simplify_geom(geom, 0.5) is None
+
+
+def test_mesh_simplifier_make_lod():
+    root = core.NodePath("root")
+    gnode = core.GeomNode("grid")
+    gnode.add_geom(make_grid(16))
+    model = root.attach_new_node(gnode)
+    model.set_pos(5, 0, 0)
+
+    lod_np = core.MeshSimplifier().make_lod(model, 3, 10.0)
+    assert lod_np.get_parent() == root
+    assert model.get_parent() == lod_np
+
+    lod = lod_np.node()
+    assert isinstance(lod, core.LODNode)
+    assert lod.get_num_switches() == 3
+    assert lod.get_num_children() == 3
+    assert lod.get_out(0) == 0 and lod.get_in(0) == 10
+    assert lod.get_out(1) == 10 and lod.get_in(1) == 20
+    assert lod.get_out(2) == 20 and lod.get_in(2) == 40
+
+    counts = [len(get_triangles(lod.get_child(i).get_geom(0))) for i in range(3)]
+    assert counts[0] == 512
+    assert counts[0] > counts[1] > counts[2]
+
+    # The copies keep the model's transform.
+    assert lod_np.get_child(1).get_pos() == (5, 0, 0)
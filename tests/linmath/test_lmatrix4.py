@@ -87,3 +87,33 @@ def test_mat4_invert_correct(type):
 
     assert (mat * inv).is_identity()
     assert (inv * mat).is_identity()
+
+
+@pytest.mark.parametrize("type", (core.LMatrix4d, core.LMatrix4f))
+def test_mat4_invert_general(type):
+    mat = type((2, 0, 1, 0.5,
+                0, 3, 0, 0,
+                1, 0, 1, 2,
+                4, 5, 6, 1))
+    inv = type()
+    assert inv.invert_from(mat)
+
+    assert (mat * inv).almost_equal(type.ident_mat(), 1e-5)
+    assert (inv * mat).almost_equal(type.ident_mat(), 1e-5)
+
+
+@pytest.mark.parametrize("type", (core.LMatrix4d, core.LMatrix4f))
+def test_mat4_multiply(type):
+    mat1 = type((1, 2, 3, 4,
+                 5, 6, 7, 8,
+                 9, 10, 11, 12,
+                 13, 14, 15, 16))
+    mat2 = type((0, 1, 0, 0,
+                 0, 0, 1, 0,
+                 1, 0, 0, 0,
+                 0, 0, 0, 2))
+
+    assert mat1 * mat2 == type((3, 1, 2, 8,
+                                7, 5, 6, 16,
+                                11, 9, 10, 24,
+                                15, 13, 14, 32))
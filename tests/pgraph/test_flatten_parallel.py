@@ -0,0 +1,135 @@
+from panda3d import core
+import pytest
+
+
+def make_geom(seed, num_vertices=12):
+    """Returns a Geom with a strip of triangles, with a vertex color column."""
+
+    vdata = core.GeomVertexData("strip%d" % (seed), core.GeomVertexFormat.get_v3c4(),
+                                core.Geom.UH_static)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    color = core.GeomVertexWriter(vdata, "color")
+    for i in range(num_vertices):
+        vertex.add_data3(i * 0.5, (i % 2) + seed, seed * 0.25)
+        color.add_data4(seed * 0.1 % 1, i * 0.05, 0.5, 1)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    for i in range(num_vertices - 2):
+        tris.add_vertices(i, i + 1, i + 2)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    return geom
+
+
+def make_scene():
+    """Returns a scene with many GeomNodes below a few levels of transforms
+    and states, some of which share their Geoms, and one subgraph that has
+    two parents."""
+
+    root = core.NodePath("root")
+    geoms = [make_geom(i) for i in range(6)]
+
+    for g in range(8):
+        group = root.attach_new_node("group%d" % (g))
+        group.set_pos(g * 10, 0, 0)
+        if g % 2 == 0:
+            group.set_color(g * 0.1, 0.2, 0.3, 1)
+        for i in range(10):
+            gnode = core.GeomNode("geom%d_%d" % (g, i))
+            gnode.add_geom(geoms[(g + i) % len(geoms)])
+            if i % 3 == 0:
+                # A second Geom, which this node doesn't share.
+                gnode.add_geom(make_geom(100 + g * 10 + i, 8))
+            np = group.attach_new_node(gnode)
+            np.set_pos_hpr_scale(i, i * 2, 0, i * 15, 0, 0, 1 + i * 0.1, 1, 1)
+            if i % 4 == 1:
+                np.set_color_scale(1, 0.5, 0.5, 1)
+
+    # An instanced subgraph.
+    shared = core.NodePath("shared")
+    gnode = core.GeomNode("shared_geom")
+    gnode.add_geom(make_geom(50))
+    shared.attach_new_node(gnode).set_pos(1, 2, 3)
+    shared.instance_to(root.find("group1"))
+    shared.instance_to(root.find("group2"))
+    return root
+
+
+def dump_graph(root):
+    """Returns a description of everything below the root that flattening
+    might change, including which Geoms and vertex datas are shared."""
+
+    geoms = []
+    vdatas = []
+
+    def index_of(objects, obj):
+        for i, other in enumerate(objects):
+            if other == obj:
+                return i
+        objects.append(obj)
+        return len(objects) - 1
+
+    def dump_node(node):
+        result = [node.get_type().name, node.name, str(node.get_transform()),
+                  str(node.get_state())]
+        if node.is_geom_node():
+            for i in range(node.get_num_geoms()):
+                geom = node.get_geom(i)
+                vdata = geom.get_vertex_data()
+                arrays = tuple(bytes(memoryview(vdata.get_array(a)))
+                               for a in range(vdata.get_num_arrays()))
+                prims = []
+                for p in range(geom.get_num_primitives()):
+                    prim = geom.get_primitive(p)
+                    prims.append((prim.get_type().name,
+                                  tuple(prim.get_vertex(v) for v in range(prim.get_num_vertices()))))
+                result.append((index_of(geoms, geom), index_of(vdatas, vdata),
+                               str(node.get_geom_state(i)), arrays, tuple(prims)))
+        result.append(tuple(dump_node(child) for child in node.get_children()))
+        return tuple(result)
+
+    return dump_node(root.node())
+
+
+def flatten(operation, parallel):
+    var = core.ConfigVariableBool("parallel-flatten")
+    orig_value = var.value
+    var.value = parallel
+    try:
+        root = make_scene()
+        operation(root)
+        return dump_graph(root)
+    finally:
+        var.value = orig_value
+
+
+@pytest.mark.parametrize("operation", [
+    core.NodePath.flatten_light,
+    core.NodePath.flatten_medium,
+    core.NodePath.flatten_strong,
+])
+def test_flatten_parallel(worker_pool, operation):
+    assert worker_pool.num_threads > 0
+
+    expected = flatten(operation, False)
+    assert flatten(operation, False) == expected
+
+    # Try a few times, since the order in which the jobs are run may vary.
+    for i in range(3):
+        assert flatten(operation, True) == expected
+
+
+def test_flatten_parallel_unify(worker_pool):
+    assert worker_pool.num_threads > 0
+
+    def unify(root):
+        root.flatten_strong()
+        gr = core.SceneGraphReducer()
+        gr.collect_vertex_data(root.node())
+        gr.unify(root.node(), False)
+        gr.remove_unused_vertices(root.node())
+
+    expected = flatten(unify, False)
+    for i in range(3):
+        assert flatten(unify, True) == expected
@@ -149,3 +149,40 @@ def test_nodepath_python_tags():
     rc1 = sys.getrefcount(path.python_tags)
     rc2 = sys.getrefcount(path.python_tags)
     assert rc1 == rc2
+
+
+def test_nodepath_flatten_clustered():
+    from panda3d.core import NodePath, GeomNode, CardMaker, LODNode
+
+    root = NodePath("root")
+    cm = CardMaker("card")
+    cm.set_frame(0, 1, 0, 1)
+    for x in range(8):
+        for y in range(8):
+            card = root.attach_new_node(cm.generate())
+            card.set_pos(x * 10, 0, y * 10)
+
+    lod = root.attach_new_node(LODNode("lod"))
+    lod.attach_new_node(cm.generate())
+
+    bounds = root.get_tight_bounds()
+    num_clusters = root.flatten_clustered(20, 1000)
+    assert num_clusters > 1
+
+    # Each cluster covers only part of the level, and no geometry is lost.
+    clusters = root.find_all_matches("**/+GeomNode")
+    clusters = [np for np in clusters if np.name == "cluster"]
+    assert len(clusters) == num_clusters
+    num_triangles = 0
+    for cluster in clusters:
+        assert cluster.node().get_num_geoms() == 1
+        lo, hi = cluster.get_tight_bounds()
+        assert max(hi - lo) <= 20 + 1
+        num_triangles += cluster.node().get_geom(0).get_primitive(0).get_num_faces()
+    assert num_triangles == 8 * 8 * 2
+
+    lo, hi = root.get_tight_bounds()
+    assert lo.almost_equal(bounds[0]) and hi.almost_equal(bounds[1])
+
+    # The LOD node is left alone.
+    assert root.find("lod").get_num_children() == 1